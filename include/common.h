@@ -58,6 +58,9 @@
 
 #ifdef STARPU
     #include <starpu.h>
+    #ifdef MPI
+        #include <starpu_mpi.h>
+    #endif
 #endif
 
 #ifdef GSL
@@ -62,7 +62,7 @@ struct
 };
 
 //! Set number of low-rank engines and default one
-#define LRENGINE_NUM 5
+#define LRENGINE_NUM 7
 #define LRENGINE_DEFAULT STARSH_LRENGINE_RSVD
 //! Array of low-rank engines, presented by string and enum value
 struct
@@ -76,17 +76,50 @@ struct
     {"RRQR", STARSH_LRENGINE_RRQR},
     {"RSVD", STARSH_LRENGINE_RSVD},
     {"CROSS", STARSH_LRENGINE_CROSS},
+    {"URSVD", STARSH_LRENGINE_URSVD},
+    {"CHEB", STARSH_LRENGINE_CHEB},
+};
+
+//! Set number of meanings of tolerance and default one
+#define TOLMODE_NUM 2
+#define TOLMODE_DEFAULT STARSH_TOLMODE_TILE
+//! Array of meanings of tolerance, presented by string and enum value
+struct
+{
+    const char *string;
+    enum STARSH_TOLMODE tolmode;
+} const tolmode[TOLMODE_NUM] =
+{
+    {"TILE", STARSH_TOLMODE_TILE},
+    {"GLOBAL", STARSH_TOLMODE_GLOBAL},
+};
+
+//! Set number of distributions of tiles among MPI nodes and default one
+#define MPI_DIST_NUM 3
+#define MPI_DIST_DEFAULT STARSH_MPI_DIST_CYCLIC
+//! Array of distributions of tiles, presented by string and enum value
+struct
+{
+    const char *string;
+    enum STARSH_MPI_DIST mpi_dist;
+} const mpi_dist[MPI_DIST_NUM] =
+{
+    {"CYCLIC", STARSH_MPI_DIST_CYCLIC},
+    {"COST", STARSH_MPI_DIST_COST},
+    {"REBALANCE", STARSH_MPI_DIST_REBALANCE},
 };
 
 //! Parameters of STARS-H
 struct starsh_params starsh_params =
 {
-    STARSH_BACKEND_NOTSELECTED, STARSH_LRENGINE_NOTSELECTED, -1
+    STARSH_BACKEND_NOTSELECTED, STARSH_LRENGINE_NOTSELECTED, -1, -1,
+    STARSH_TOLMODE_NOTSELECTED, -1, -1, STARSH_MPI_DIST_NOTSELECTED
 };
 
 const static struct starsh_params starsh_params_default =
 {
-    BACKEND_DEFAULT, LRENGINE_DEFAULT, 10
+    BACKEND_DEFAULT, LRENGINE_DEFAULT, 10, 0, TOLMODE_DEFAULT, 0, 0,
+    MPI_DIST_DEFAULT
 };
 
 //! Array of approximation functions for NOTSUPPORTED backend
@@ -96,7 +129,8 @@ static STARSH_blrm_approximate *(dlr_none[LRENGINE_NUM]) = {};
 static STARSH_blrm_approximate *(dlr_seq[LRENGINE_NUM]) =
 {
     starsh_blrm__dsdd, starsh_blrm__dsdd, starsh_blrm__dqp3,
-    starsh_blrm__drsdd, starsh_blrm__drsdd
+    starsh_blrm__drsdd, starsh_blrm__drsdd, starsh_blrm__dursdd,
+    starsh_blrm__dcheb
 };
 
 //! Array of approximation functions for OPENMP backend
@@ -104,7 +138,8 @@ static STARSH_blrm_approximate *(dlr_omp[LRENGINE_NUM]) =
 {
     #ifdef OPENMP
     starsh_blrm__dsdd_omp, starsh_blrm__dsdd_omp, starsh_blrm__dqp3_omp,
-    starsh_blrm__drsdd_omp, starsh_blrm__drsdd_omp
+    starsh_blrm__drsdd_omp, starsh_blrm__drsdd_omp, starsh_blrm__dursdd_omp,
+    starsh_blrm__dcheb_omp
     #endif
 };
 
@@ -113,7 +148,8 @@ static STARSH_blrm_approximate *(dlr_mpi[LRENGINE_NUM]) =
 {
     #ifdef MPI
     starsh_blrm__dsdd_mpi, starsh_blrm__dsdd_mpi, starsh_blrm__dqp3_mpi,
-    starsh_blrm__drsdd_mpi, starsh_blrm__drsdd_mpi
+    starsh_blrm__drsdd_mpi, starsh_blrm__drsdd_mpi, starsh_blrm__drsdd_mpi,
+    starsh_blrm__drsdd_mpi
     #endif
 };
 
@@ -123,6 +159,7 @@ static STARSH_blrm_approximate *(dlr_starpu[LRENGINE_NUM]) =
     #ifdef STARPU
     starsh_blrm__dsdd_starpu, starsh_blrm__dsdd_starpu,
     starsh_blrm__dqp3_starpu, starsh_blrm__drsdd_starpu,
+    starsh_blrm__drsdd_starpu, starsh_blrm__drsdd_starpu,
     starsh_blrm__drsdd_starpu
     #endif
 };
@@ -133,6 +170,7 @@ static STARSH_blrm_approximate *(dlr_starpu_mpi[LRENGINE_NUM]) =
     #if defined(STARPU) && defined(MPI)
     starsh_blrm__dsdd_mpi_starpu, starsh_blrm__dsdd_mpi_starpu,
     starsh_blrm__dqp3_mpi_starpu, starsh_blrm__drsdd_mpi_starpu,
+    starsh_blrm__drsdd_mpi_starpu, starsh_blrm__drsdd_mpi_starpu,
     starsh_blrm__drsdd_mpi_starpu
     #endif
 };
@@ -55,6 +55,34 @@ enum STARSH_LRENGINE
     //!< Randomized SVD
     STARSH_LRENGINE_CROSS = 4,
     //!< Cross approximation
+    STARSH_LRENGINE_URSVD = 5,
+    //!< Randomized SVD with shared bases of block rows and columns
+    STARSH_LRENGINE_CHEB = 6,
+    //!< Chebyshev interpolation of kernel
+};
+
+//! Enum for meaning of error tolerance of approximation
+enum STARSH_TOLMODE
+{
+    STARSH_TOLMODE_NOTSELECTED = -2,
+    //!< Meaning of tolerance has not been yet selected
+    STARSH_TOLMODE_TILE = 0,
+    //!< Relative error of each far-field tile
+    STARSH_TOLMODE_GLOBAL = 1
+    //!< Relative error of the entire matrix
+};
+
+//! Enum for distribution of tiles among MPI nodes
+enum STARSH_MPI_DIST
+{
+    STARSH_MPI_DIST_NOTSELECTED = -2,
+    //!< Distribution has not been yet selected
+    STARSH_MPI_DIST_CYCLIC = 0,
+    //!< 2D block cyclic distribution over grid of MPI processes
+    STARSH_MPI_DIST_COST = 1,
+    //!< Pieces of Hilbert curve of tiles with equal estimated cost
+    STARSH_MPI_DIST_REBALANCE = 2
+    //!< The same as COST, but rebalanced by actual cost after approximation
 };
 
 //! Enum for error codes
@@ -74,6 +102,10 @@ enum STARSH_ERRNO
     //!< Error during fprintf()
     STARSH_FWRITE_ERROR = 6,
     //!< Error during fwrite()
+    STARSH_NOT_POSITIVE_DEFINITE = 7,
+    //!< Matrix is not positive definite, factorization failed
+    STARSH_SINGULAR_MATRIX = 8,
+    //!< Matrix is singular, factorization failed
     STARSH_UNKNOWN_ERROR = -1
     //!< Error, not listed in enum STARSH_ERRNO
 };
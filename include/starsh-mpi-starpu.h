@@ -52,10 +52,10 @@ int starsh_blrm__dqp3_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
  * */
 // This will automatically include all entities between @{ and @} into group.
 
-//int starsh_blrm__dmml_mpi_starpu(STARSH_blrm *matrix, int nrhs, double alpha,
-//        double *A, int lda, double beta, double *B, int ldb);
-//int starsh_blrm__dmml_mpi_starpu_tlr(STARSH_blrm *matrix, int nrhs,
-//        double alpha, double *A, int lda, double beta, double *B, int ldb);
+int starsh_blrm__dmml_mpi_starpu(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb);
+int starsh_blrm__dmml_mpi_starpu_tlr(STARSH_blrm *matrix, int nrhs,
+        double alpha, double *A, int lda, double beta, double *B, int ldb);
 
 //! @}
 // End of group
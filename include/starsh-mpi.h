@@ -39,6 +39,18 @@ int starsh_blrf_new_from_coo_mpi(STARSH_blrf **format, STARSH_problem *problem,
         enum STARSH_BLRF_TYPE type);
 int starsh_blrf_new_tlr_mpi(STARSH_blrf **format, STARSH_problem *problem,
         char symm, STARSH_cluster *row_cluster, STARSH_cluster *col_cluster);
+int starsh_blrf_partition_mpi(STARSH_int ntiles, STARSH_int *block,
+        double *cost, int *owner);
+int starsh_blrf_update_far_mpi(STARSH_blrf *format, int *far_rank,
+        Array **far_U, Array **far_V);
+int starsh_blrf_drop_far_mpi(STARSH_blrf *format, int *far_rank,
+        Array **far_U, Array **far_V);
+int starsh_blrf_get_vector_size_mpi(STARSH_blrf *format, char side,
+        STARSH_int *size);
+int starsh_blrf_scatter_vector_mpi(STARSH_blrf *format, char side, int nrhs,
+        double *A, int lda, double *A_local, int ld_local);
+int starsh_blrf_gather_vector_mpi(STARSH_blrf *format, char side, int nrhs,
+        double *A_local, int ld_local, double *A, int lda);
 
 //! @}
 // End of group
@@ -57,6 +69,7 @@ int starsh_blrm_new_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
         int *far_rank, Array **far_U, Array **far_V, int onfly, Array **near_D,
         void *alloc_U, void *alloc_V, void *alloc_D, char alloc_type);
 void starsh_blrm_free_mpi(STARSH_blrm *matrix);
+int starsh_blrm_rebalance_mpi(STARSH_blrm *matrix);
 
 //! @}
 // End of group
@@ -79,6 +92,7 @@ int starsh_blrm__dqp3_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
         int maxrank, double tol, int onfly);
 int starsh_blrm__dna_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
         int maxrank, double tol, int onfly);
+int starsh_blrm__dtol_mpi(STARSH_blrf *format, double tol, double *abstol);
 
 //! @}
 // End of group
@@ -97,6 +111,9 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
         double *A, int lda, double beta, double *B, int ldb);
 int starsh_blrm__dmml_mpi_tlr(STARSH_blrm *matrix, int nrhs, double alpha,
         double *A, int lda, double beta, double *B, int ldb);
+int starsh_blrm__dmml_mpi_dist(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb);
+void starsh_blrm__dmml_mpi_tlr_free(STARSH_blrm *matrix);
 
 //! @}
 // End of group
@@ -117,6 +134,19 @@ double starsh_blrm__dfe_mpi(STARSH_blrm *matrix);
 // End of group
 
 
+///////////////////////////////////////////////////////////////////////////////
+//                          NODE-LEVEL SHARED DATA                           //
+///////////////////////////////////////////////////////////////////////////////
+
+// Forward declaration of structure for particles
+struct starsh_particles;
+
+int starsh_shared_new_mpi(void **ptr, const void *src, size_t nbytes);
+void starsh_shared_free_mpi(void *ptr);
+int starsh_cluster_share_mpi(STARSH_cluster *cluster);
+int starsh_particles_share_mpi(struct starsh_particles *data);
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //                            ITERATIVE SOLVERS                              //
 ///////////////////////////////////////////////////////////////////////////////
@@ -128,6 +158,21 @@ double starsh_blrm__dfe_mpi(STARSH_blrm *matrix);
 
 int starsh_itersolvers__dcg_mpi(STARSH_blrm *matrix, int nrhs, double *B,
         int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dcg_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dpipecg_mpi(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dpipecg_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dgmres_mpi(STARSH_blrm *matrix, int nrhs, double *B,
+        int ldb, double *X, int ldx, int restart, double tol, double *work);
+int starsh_itersolvers__dgmres_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, int restart, double tol,
+        double *work);
+int starsh_itersolvers__dbicgstab_mpi(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dbicgstab_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work);
 
 //! @}
 // End of group
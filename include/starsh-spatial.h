@@ -61,6 +61,42 @@ typedef struct starsh_ssdata
     //!< spatial range parameter (define the correlation between the two variables in the parsimonious bivariate case).
 } STARSH_ssdata;
 
+typedef struct starsh_ssloglik
+//! Persistent state for repeated evaluations of Gaussian log-likelihood.
+/*! Geometry, clusterization and TLR format are created once by
+ * starsh_ssdata_loglik_new() and reused by each call to
+ * starsh_ssdata_loglik(), which only updates and factorizes covariance
+ * matrix for new parameters.
+ *
+ * @ingroup app-spatial
+ * */
+{
+    STARSH_ssdata *data;
+    //!< Spatial statistics data, its parameters are changed by each call.
+    STARSH_problem *problem;
+    //!< Covariance matrix as @ref STARSH_problem object.
+    STARSH_cluster *cluster;
+    //!< Plain clusterization of particles.
+    STARSH_blrf *format;
+    //!< TLR format of covariance matrix.
+    /*!< Approximation drops negligible tiles from its format, so this
+     * format is never approximated itself. Each new approximation works on a
+     * copy, that is owned by field `matrix`.
+     * */
+    STARSH_blrm *matrix;
+    //!< Approximation of covariance matrix for the last parameters.
+    STARSH_blrm *factor;
+    //!< TLR Cholesky factor of approximation for the last parameters.
+    int maxrank;
+    //!< Maximum rank of tiles.
+    double tol;
+    //!< Relative error threshold of tiles.
+    double *work;
+    //!< Temporary buffer for solution of linear system.
+    double params[4];
+    //!< Parameters `sigma`, `beta`, `nu` and `noise` of field `matrix`.
+} STARSH_ssloglik;
+
 enum STARSH_SPATIAL_KERNEL
 //! List of built-in kernels for starsh_ssdata_get_kernel().
 /*! For more info on exact formulas inside kernels, take a look at functions
@@ -189,6 +225,12 @@ int starsh_ssdata_generate_el(STARSH_ssdata **data, STARSH_int count, ...);
 int starsh_ssdata_get_kernel(STARSH_kernel **kernel, STARSH_ssdata *data,
 	enum STARSH_SPATIAL_KERNEL type);
 void starsh_ssdata_free(STARSH_ssdata *data);
+int starsh_ssdata_loglik_new(STARSH_ssloglik **state, STARSH_ssdata *data,
+	enum STARSH_SPATIAL_KERNEL type, STARSH_int block_size, int maxrank,
+	double tol);
+int starsh_ssdata_loglik(STARSH_ssloglik *state, double *z, double *params,
+	double *loglik);
+void starsh_ssdata_loglik_free(STARSH_ssloglik *state);
 
 // KERNELS
 
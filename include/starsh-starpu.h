@@ -43,6 +43,38 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
 // End of group
 
 
+///////////////////////////////////////////////////////////////////////////////
+//                  MATRIX-MATRIX MULTIPLICATION                             //
+///////////////////////////////////////////////////////////////////////////////
+
+/*! @addtogroup matmul
+ * @{
+ * */
+// This will automatically include all entities between @{ and @} into group.
+
+int starsh_blrm__dmml_starpu(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb);
+
+//! @}
+// End of group
+
+
+///////////////////////////////////////////////////////////////////////////////
+//                FACTORIZATIONS AND DIRECT SOLVERS                          //
+///////////////////////////////////////////////////////////////////////////////
+
+/*! @addtogroup factor
+ * @{
+ * */
+// This will automatically include all entities between @{ and @} into group.
+
+int starsh_blrm__dpotrf_starpu(STARSH_blrm **factor, STARSH_blrm *matrix,
+        int maxrank, double tol);
+
+//! @}
+// End of group
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //                  LOW-RANK ROUTINES FOR DENSE                              //
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,8 +88,39 @@ void starsh_dense_dlrsdd_starpu(void *buffers[], void *cl_arg);
 void starsh_dense_dlrrsdd_starpu(void *buffers[], void *cl_arg);
 void starsh_dense_dlrqp3_starpu(void *buffers[], void *cl_arg);
 void starsh_dense_kernel_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_kernel_far_starpu(void *buffers[], void *cl_arg);
 void starsh_dense_dgemm_starpu(void *buffers[], void *cl_arg);
-void starsh_dense_fake_init_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dlrmm_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dmm_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dzero_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dadd_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dpotrf_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dlrtrsm_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dlrsyrk_starpu(void *buffers[], void *cl_arg);
+void starsh_dense_dlrgemm_starpu(void *buffers[], void *cl_arg);
+// Forward declarations for builds without StarPU
+struct starpu_data_filter;
+struct starpu_perfmodel;
+void starsh_dense_filter_starpu(void *father_interface, void *child_interface,
+        struct starpu_data_filter *f, unsigned id, unsigned nchunks);
+void starsh_dense_tile_filter_starpu(void *father_interface,
+        void *child_interface, struct starpu_data_filter *f, unsigned id,
+        unsigned nchunks);
+// History-based performance models of codelets
+extern struct starpu_perfmodel starsh_dense_dlrsdd_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dlrrsdd_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dlrqp3_starpu_model;
+extern struct starpu_perfmodel starsh_dense_kernel_starpu_model;
+extern struct starpu_perfmodel starsh_dense_kernel_far_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dgemm_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dlrmm_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dmm_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dzero_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dadd_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dpotrf_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dlrtrsm_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dlrsyrk_starpu_model;
+extern struct starpu_perfmodel starsh_dense_dlrgemm_starpu_model;
 
 //! @}
 // End of group
@@ -46,6 +46,16 @@ struct starsh_params
     //!< What low-rank engine to use (e.g. RSVD).
     int oversample;
     //!< Oversampling parameter for RSVD and RRQR.
+    int poweriter;
+    //!< Maximum number of power iterations for RSVD.
+    enum STARSH_TOLMODE tolmode;
+    //!< Whether tolerance is per tile or for the entire matrix.
+    int grid_nrows;
+    //!< Number of rows of grid of MPI processes or 0 for automatic choice.
+    int grid_ncols;
+    //!< Number of columns of grid of MPI processes or 0 for automatic choice.
+    enum STARSH_MPI_DIST mpi_dist;
+    //!< How tiles are distributed among MPI processes.
 };
 
 //! Built-in parameters of STARS-H, accessible through environment.
@@ -55,6 +65,10 @@ int starsh_init();
 int starsh_set_backend(const char *string);
 int starsh_set_lrengine(const char *string);
 int starsh_set_oversample(const char *string);
+int starsh_set_poweriter(const char *string);
+int starsh_set_tolmode(const char *string);
+int starsh_set_mpi_grid(const char *string);
+int starsh_set_mpi_dist(const char *string);
 
 //! @}
 // End of group
@@ -106,6 +120,7 @@ typedef struct starsh_blrm STARSH_blrm;
 
 int starsh_application(void **data, STARSH_kernel **kernel, STARSH_int count,
         char dtype, int problem_type, int kernel_type, ...);
+int starsh_application_particles(STARSH_kernel *kernel);
 
 //! @}
 // End of group
@@ -416,6 +431,15 @@ struct starsh_blrf
      * `bcol_far` from index `bcol_far_start[i]` to `bcol_far_start[i+1]-1`
      * inclusively.
      * */
+    int grid_nrows;
+    //!< Number of rows of grid of MPI processes.
+    /*!< Tile in block row `i` and block column `j` is stored on MPI node in
+     * row `i%grid_nrows` and column `j%grid_ncols` of grid, where MPI node of
+     * rank `r` is in row `r%grid_nrows` and column `r/grid_nrows`. Equal to
+     * `1` for formats, that are not distributed among MPI nodes.
+     * */
+    int grid_ncols;
+    //!< Number of columns of grid of MPI processes.
     STARSH_int nblocks_far_local;
     //!< Number of far-field blocks, stored locally on MPI node.
     STARSH_int *block_far_local;
@@ -483,6 +507,10 @@ void starsh_blrf_info(STARSH_blrf *format);
 void starsh_blrf_print(STARSH_blrf *format);
 int starsh_blrf_get_block(STARSH_blrf *format, STARSH_int i, STARSH_int j,
         int *shape, void **D);
+int starsh_blrf_drop_far(STARSH_blrf *format, int *far_rank, Array **far_U,
+        Array **far_V);
+int starsh_blrf_get_dropped(STARSH_blrf *format, STARSH_int *nblocks,
+        STARSH_int **block);
 
 //! @}
 // End of group
@@ -534,6 +562,33 @@ struct starsh_blrm
      * `D_alloc`; `2` if allocating many small buffers for each `far_U`,
      * `far_V` and `near_D`.
      * */
+    int uniform;
+    //!< Equal to `1` if far-field blocks share bases of block rows/columns.
+    /*!< In this case far-field block `bi` in block row `i` and block column
+     * `j` is approximated by `row_U[i]*far_S[bi]*transpose(col_V[j])` with
+     * only as many leading columns of `row_U[i]` and `col_V[j]`, as rows and
+     * columns of `far_S[bi]`, while `far_rank`, `far_U` and `far_V` are not
+     * used. Buffers `alloc_U` and `alloc_V` hold all `row_U` and `col_V`.
+     * */
+    int *row_rank;
+    //!< Rank of shared basis of each block row.
+    Array **row_U;
+    //!< Shared orthonormal basis of each block row.
+    int *col_rank;
+    //!< Rank of shared basis of each block column.
+    /*!< Equal to `row_rank` for symmetric matrices. */
+    Array **col_V;
+    //!< Shared orthonormal basis of each block column.
+    /*!< Equal to `row_U` for symmetric matrices. */
+    Array **far_S;
+    //!< Coupling matrix of each far-field block.
+    void *alloc_S;
+    //!< Pointer to memory buffer, holding all `far_S`.
+    void *mpi_plan;
+    //!< Cached communicators and buffers of MPI matrix multiplication.
+    /*!< Created by the first call of @ref starsh_blrm__dmml_mpi_tlr() and
+     * released by @ref starsh_blrm_free_mpi().
+     * */
     size_t nbytes;
     //!< Total size of block low-rank matrix, including auxiliary buffers.
     size_t data_nbytes;
@@ -543,7 +598,17 @@ struct starsh_blrm
 int starsh_blrm_new(STARSH_blrm **matrix, STARSH_blrf *format, int *far_rank,
         Array **far_U, Array **far_V, int onfly, Array **near_D, void *alloc_U,
         void *alloc_V, void *alloc_D, char alloc_type);
+int starsh_blrm_new_uniform(STARSH_blrm **matrix, STARSH_blrf *format,
+        int *row_rank, Array **row_U, int *col_rank, Array **col_V,
+        Array **far_S, int onfly, Array **near_D, void *alloc_U,
+        void *alloc_V, void *alloc_S, void *alloc_D);
 void starsh_blrm_free(STARSH_blrm *matrix);
+int starsh_blrm_pack_far(STARSH_int nblocks_far, int *far_rank,
+        Array **far_U, Array **far_V, void **alloc_U, void **alloc_V);
+int starsh_blrm_convert(STARSH_blrm **matrix, STARSH_blrm *src,
+        char dtype);
+int starsh_blrm_update_parameters(STARSH_blrm *matrix, char type,
+        double scale, double shift, int maxrank, double tol);
 void starsh_blrm_info(STARSH_blrm *matrix);
 int starsh_blrm_get_block(STARSH_blrm *matrix, STARSH_int i, STARSH_int j,
         int *shape, int *rank, void **U, void **V, void **D);
@@ -588,6 +653,22 @@ int starsh_blrm__dqp3_omp(STARSH_blrm **matrix, STARSH_blrf *format,
 //int starsh_blrm__dna_omp(STARSH_blrm **matrix, STARSH_blrf *format,
 //        int maxrank, double tol, int onfly);
 
+int starsh_blrm__dursdd(STARSH_blrm **matrix, STARSH_blrf *format,
+        int maxrank, double tol, int onfly);
+int starsh_blrm__dursdd_omp(STARSH_blrm **matrix, STARSH_blrf *format,
+        int maxrank, double tol, int onfly);
+
+int starsh_blrm__dcheb(STARSH_blrm **matrix, STARSH_blrf *format, int maxrank,
+        double tol, int onfly);
+int starsh_blrm__dcheb_omp(STARSH_blrm **matrix, STARSH_blrf *format,
+        int maxrank, double tol, int onfly);
+
+int starsh_blrm__dtol(STARSH_blrf *format, double tol, double *abstol);
+int starsh_blrm__dtol_omp(STARSH_blrf *format, double tol, double *abstol);
+int starsh_blrm__dnorm_sample(STARSH_blrf *format, STARSH_int nblocks,
+        STARSH_int *block, STARSH_int start, STARSH_int step, double *norm2,
+        double *count);
+
 //! @}
 // End of group
 
@@ -625,6 +706,8 @@ int starsh_blrm__dmml_omp(STARSH_blrm *matrix, int nrhs, double alpha,
 
 double starsh_blrm__dfe(STARSH_blrm *matrix);
 double starsh_blrm__dfe_omp(STARSH_blrm *matrix);
+int starsh_blrm__dnorm_dropped(STARSH_blrf *format, STARSH_int nblocks,
+        STARSH_int *block, STARSH_int start, STARSH_int step, double *norm2);
 
 // This function should not be in this group, but it is for now.
 int starsh_blrm__dca(STARSH_blrm *matrix, Array *A);
@@ -633,6 +716,53 @@ int starsh_blrm__dca(STARSH_blrm *matrix, Array *A);
 // End of group
 
 
+///////////////////////////////////////////////////////////////////////////////
+//                FACTORIZATIONS AND DIRECT SOLVERS                          //
+///////////////////////////////////////////////////////////////////////////////
+
+/*! @defgroup factor Factorizations
+ * @brief Factorizations of block low-rank matrices and direct solvers
+ * @ingroup blrm
+ * */
+//! @{
+// This will automatically include all entities between @{ and @} into group.
+
+int starsh_blrm__dfactor_init(STARSH_blrm **factor, STARSH_blrm *matrix,
+        char uplo, int maxrank, double tol);
+int starsh_blrm__dfactor_finalize(STARSH_blrm *factor);
+
+int starsh_blrm__dpotrf(STARSH_blrm **factor, STARSH_blrm *matrix,
+        int maxrank, double tol);
+int starsh_blrm__dpotrf_omp(STARSH_blrm **factor, STARSH_blrm *matrix,
+        int maxrank, double tol);
+
+int starsh_blrm__dtrsm(STARSH_blrm *factor, char trans, int nrhs, double *B,
+        int ldb);
+int starsh_blrm__dtrsm_omp(STARSH_blrm *factor, char trans, int nrhs,
+        double *B, int ldb);
+int starsh_blrm__dpotrs(STARSH_blrm *factor, int nrhs, double *B, int ldb);
+int starsh_blrm__dpotrs_omp(STARSH_blrm *factor, int nrhs, double *B,
+        int ldb);
+int starsh_blrm__strsm_omp(STARSH_blrm *factor, char trans, int nrhs,
+        float *B, int ldb);
+int starsh_blrm__spotrs_omp(STARSH_blrm *factor, int nrhs, float *B,
+        int ldb);
+int starsh_blrm__djacobi(STARSH_blrm **factor, STARSH_blrm *matrix);
+int starsh_blrm__djacobi_omp(STARSH_blrm **factor, STARSH_blrm *matrix);
+
+int starsh_blrm__dgetrf(STARSH_blrm **factor, int *ipiv, STARSH_blrm *matrix,
+        int maxrank, double tol);
+int starsh_blrm__dgetrf_omp(STARSH_blrm **factor, int *ipiv,
+        STARSH_blrm *matrix, int maxrank, double tol);
+int starsh_blrm__dgetrs(STARSH_blrm *factor, int *ipiv, int nrhs, double *B,
+        int ldb);
+int starsh_blrm__dgetrs_omp(STARSH_blrm *factor, int *ipiv, int nrhs,
+        double *B, int ldb);
+
+//! @}
+// End of group
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //                  LOW-RANK ROUTINES FOR DENSE                              //
 ///////////////////////////////////////////////////////////////////////////////
@@ -650,13 +780,35 @@ void starsh_dense_dlrsdd(int nrows, int ncols, double *D, int ldD, double *U,
         double *work, int lwork, int *iwork);
 void starsh_dense_dlrrsdd(int nrows, int ncols, double *D, int ldD, double *U,
         int ldU, double *V, int ldV, int *rank, int maxrank, int oversample,
-        double tol, double *work, int lwork, int *iwork);
+        int poweriter, double tol, double *work, int lwork, int *iwork);
+void starsh_dense_dlrrsdd_sketch(int nrows, int ncols, double *D, int ldD,
+        double *U, int ldU, double *V, int ldV, int *rank, int maxrank,
+        int nsketch, double *S, int ldS, int oversample, double tol,
+        double *work, int lwork, int *iwork);
 void starsh_dense_dlrqp3(int nrows, int ncols, double *D, int ldD, double *U,
         int ldU, double *V, int ldV, int *rank, int maxrank, int oversample,
         double tol, double *work, int lwork, int *iwork);
 void starsh_dense_dlrna(int nrows, int ncols, double *D, double *U, double *V,
         int *rank, int maxrank, double tol, double *work, int lwork,
         int *iwork);
+int starsh_dense_dlradd(int nrows, int ncols, int rank2, double alpha,
+        double *U2, int ldU2, double *V2, int ldV2, double *U, int ldU,
+        double *V, int ldV, int *rank, int maxrank, double tol, double *work,
+        int lwork, int *iwork);
+int starsh_dense_dlrgemm(int nrows, int ncols, int nk, int rank1,
+        double *U1, int ldU1, double *V1, int ldV1, int rank2, double *U2,
+        int ldU2, double *V2, int ldV2, double *U, int ldU, double *V,
+        int ldV, int *rank, int maxrank, double tol, double *work, int lwork,
+        int *iwork);
+void starsh_dense_dlrsyrk(int nrows, int ncols, int rank, double *U, int ldU,
+        double *V, int ldV, double *D, int ldD, double *work);
+void starsh_dense_dlrgemmd(int nrows, int ncols, int nk, int rank1,
+        double *U1, int ldU1, double *V1, int ldV1, int rank2, double *U2,
+        int ldU2, double *V2, int ldV2, double *D, int ldD, double *work);
+int starsh_dense_dgetrf(int n, double *D, int ldD, int *ipiv);
+void starsh_dense_dchebqr(int nrows, int ndim, int order, STARSH_int count,
+        double *point, STARSH_int *index, double *node, STARSH_int ldnode,
+        double *Q, double *R, double *work, int lwork);
 
 //! @}
 // End of group
@@ -674,6 +826,19 @@ void starsh_dense_dlrna(int nrows, int ncols, double *D, double *U, double *V,
 
 int starsh_itersolvers__dcg_omp(STARSH_blrm *matrix, int nrhs, double *B,
         int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dbcg_omp(STARSH_blrm *matrix, int nrhs, double *B,
+        int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dpcg_omp(STARSH_blrm *matrix, STARSH_blrm *factor,
+        int nrhs, double *B, int ldb, double *X, int ldx, double tol,
+        double *work);
+int starsh_itersolvers__dgmres_omp(STARSH_blrm *matrix, int nrhs, double *B,
+        int ldb, double *X, int ldx, int restart, double tol, double *work);
+int starsh_itersolvers__dbicgstab_omp(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work);
+int starsh_itersolvers__dlogdet_slq_omp(STARSH_blrm *matrix, int nprobes,
+        int nsteps, int seed, double *logdet);
+int starsh_itersolvers__dtrace_omp(STARSH_blrm *matrix, int nprobes,
+        char method, int seed, double *trace);
 
 //! @}
 // End of group
@@ -114,3 +114,99 @@ int starsh_application(void **data, STARSH_kernel **kernel, STARSH_int count,
     va_end(args);
     return info;
 }
+
+int starsh_application_particles(STARSH_kernel *kernel)
+//! Check if kernel belongs to N-body application with particles.
+/*! Physical data of spatial statistics, electrostatics and electrodynamics
+ * problems starts with @ref STARSH_particles object, and their kernels
+ * depend only on coordinates of particles (and parameters of the problem).
+ * Kernels with spherical (GCD) distance and bivariate kernels are not
+ * included, as they treat coordinates or indexes of particles differently.
+ *
+ * @param[in] kernel: @ref STARSH_kernel function.
+ * @return 1 if kernel is a kernel of N-body application and 0 otherwise.
+ * @sa starsh_blrm__dcheb().
+ * @ingroup applications
+ * */
+{
+    STARSH_kernel *particles_kernel[] =
+    {
+        starsh_ssdata_block_exp_kernel_1d,
+        starsh_ssdata_block_exp_kernel_1d_simd,
+        starsh_ssdata_block_exp_kernel_2d,
+        starsh_ssdata_block_exp_kernel_2d_simd,
+        starsh_ssdata_block_exp_kernel_3d,
+        starsh_ssdata_block_exp_kernel_3d_simd,
+        starsh_ssdata_block_exp_kernel_4d,
+        starsh_ssdata_block_exp_kernel_4d_simd,
+        starsh_ssdata_block_exp_kernel_nd,
+        starsh_ssdata_block_exp_kernel_nd_simd,
+        starsh_ssdata_block_sqrexp_kernel_1d,
+        starsh_ssdata_block_sqrexp_kernel_1d_simd,
+        starsh_ssdata_block_sqrexp_kernel_2d,
+        starsh_ssdata_block_sqrexp_kernel_2d_simd,
+        starsh_ssdata_block_sqrexp_kernel_3d,
+        starsh_ssdata_block_sqrexp_kernel_3d_simd,
+        starsh_ssdata_block_sqrexp_kernel_4d,
+        starsh_ssdata_block_sqrexp_kernel_4d_simd,
+        starsh_ssdata_block_sqrexp_kernel_nd,
+        starsh_ssdata_block_sqrexp_kernel_nd_simd,
+#ifdef GSL
+        starsh_ssdata_block_matern_kernel_1d,
+        starsh_ssdata_block_matern_kernel_1d_simd,
+        starsh_ssdata_block_matern_kernel_2d,
+        starsh_ssdata_block_matern_kernel_2d_simd,
+        starsh_ssdata_block_matern_kernel_3d,
+        starsh_ssdata_block_matern_kernel_3d_simd,
+        starsh_ssdata_block_matern_kernel_4d,
+        starsh_ssdata_block_matern_kernel_4d_simd,
+        starsh_ssdata_block_matern_kernel_nd,
+        starsh_ssdata_block_matern_kernel_nd_simd,
+        starsh_ssdata_block_matern2_kernel_1d,
+        starsh_ssdata_block_matern2_kernel_1d_simd,
+        starsh_ssdata_block_matern2_kernel_2d,
+        starsh_ssdata_block_matern2_kernel_2d_simd,
+        starsh_ssdata_block_matern2_kernel_3d,
+        starsh_ssdata_block_matern2_kernel_3d_simd,
+        starsh_ssdata_block_matern2_kernel_4d,
+        starsh_ssdata_block_matern2_kernel_4d_simd,
+        starsh_ssdata_block_matern2_kernel_nd,
+        starsh_ssdata_block_matern2_kernel_nd_simd,
+#endif
+        starsh_esdata_block_coulomb_potential_kernel_1d,
+        starsh_esdata_block_coulomb_potential_kernel_1d_simd,
+        starsh_esdata_block_coulomb_potential_kernel_2d,
+        starsh_esdata_block_coulomb_potential_kernel_2d_simd,
+        starsh_esdata_block_coulomb_potential_kernel_3d,
+        starsh_esdata_block_coulomb_potential_kernel_3d_simd,
+        starsh_esdata_block_coulomb_potential_kernel_4d,
+        starsh_esdata_block_coulomb_potential_kernel_4d_simd,
+        starsh_esdata_block_coulomb_potential_kernel_nd,
+        starsh_esdata_block_coulomb_potential_kernel_nd_simd,
+        starsh_eddata_block_sin_kernel_1d,
+        starsh_eddata_block_sin_kernel_1d_simd,
+        starsh_eddata_block_sin_kernel_2d,
+        starsh_eddata_block_sin_kernel_2d_simd,
+        starsh_eddata_block_sin_kernel_3d,
+        starsh_eddata_block_sin_kernel_3d_simd,
+        starsh_eddata_block_sin_kernel_4d,
+        starsh_eddata_block_sin_kernel_4d_simd,
+        starsh_eddata_block_sin_kernel_nd,
+        starsh_eddata_block_sin_kernel_nd_simd,
+        starsh_eddata_block_cos_kernel_1d,
+        starsh_eddata_block_cos_kernel_1d_simd,
+        starsh_eddata_block_cos_kernel_2d,
+        starsh_eddata_block_cos_kernel_2d_simd,
+        starsh_eddata_block_cos_kernel_3d,
+        starsh_eddata_block_cos_kernel_3d_simd,
+        starsh_eddata_block_cos_kernel_4d,
+        starsh_eddata_block_cos_kernel_4d_simd,
+        starsh_eddata_block_cos_kernel_nd,
+        starsh_eddata_block_cos_kernel_nd_simd,
+    };
+    size_t k, nkernels = sizeof(particles_kernel)/sizeof(*particles_kernel);
+    for(k = 0; k < nkernels; k++)
+        if(kernel == particles_kernel[k])
+            return 1;
+    return 0;
+}
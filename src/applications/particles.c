@@ -15,6 +15,9 @@
 #include "starsh-particles.h"
 #include "applications/particles.h"
 #include "common.h"
+#ifdef MPI
+#include "starsh-mpi.h"
+#endif
 
 int starsh_particles_new(STARSH_particles **data, STARSH_int count, int ndim)
 //! Allocate memory for @ref STARSH_particles object.
@@ -104,11 +107,47 @@ void starsh_particles_free(STARSH_particles *data)
     if(data != NULL)
     {
         if(data->point != NULL)
+#ifdef MPI
+            starsh_shared_free_mpi(data->point);
+#else
             free(data->point);
+#endif
         free(data);
     }
 }
 
+#ifdef MPI
+int starsh_particles_share_mpi(STARSH_particles *data)
+//! Move coordinates of particles into node-level shared memory.
+/*! Coordinates of particles must be the same on all MPI nodes. After this
+ * call, `data->point` points to a single copy of coordinates per compute
+ * node, and private copy of each MPI node is freed. Kernels read coordinates
+ * through the same pointer, so nothing else changes. Coordinates must not be
+ * modified afterwards. Must be called by all MPI nodes.
+ *
+ * @param[in,out] data: Pointer to @ref STARSH_particles object.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_shared_new_mpi(), starsh_cluster_share_mpi().
+ * @ingroup app-particles
+ * */
+{
+    double *point;
+    int info;
+    if(data == NULL)
+    {
+        STARSH_ERROR("Invalid value of `data`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    info = starsh_shared_new_mpi((void **)&point, data->point,
+            data->count*data->ndim*sizeof(*point));
+    if(info != STARSH_SUCCESS)
+        return info;
+    starsh_shared_free_mpi(data->point);
+    data->point = point;
+    return STARSH_SUCCESS;
+}
+#endif // MPI
+
 int starsh_particles_generate(STARSH_particles **data, STARSH_int count,
         int ndim, enum STARSH_PARTICLES_PLACEMENT ptype)
 //! Generate @ref STARSH_particles with required distribution.
@@ -0,0 +1,271 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/applications/spatial_loglik.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-spatial.h"
+
+int starsh_ssdata_loglik_new(STARSH_ssloglik **state, STARSH_ssdata *data,
+        enum STARSH_SPATIAL_KERNEL type, STARSH_int block_size, int maxrank,
+        double tol)
+//! Create persistent state for evaluations of Gaussian log-likelihood.
+/*! Kernel, @ref STARSH_problem, plain clusterization and TLR format are
+ * created once, so that each following call to starsh_ssdata_loglik() only
+ * recomputes covariance matrix for new parameters. Object `data` is not
+ * copied, its parameters are overwritten by starsh_ssdata_loglik().
+ *
+ * @param[out] state: Address of pointer to @ref STARSH_ssloglik object.
+ * @param[in] data: Spatial statistics data.
+ * @param[in] type: Type of kernel. For more info look at @ref
+ *      STARSH_SPATIAL_KERNEL.
+ * @param[in] block_size: Size of tiles.
+ * @param[in] maxrank: Maximum rank of tiles.
+ * @param[in] tol: Relative error threshold of tiles.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_ssdata_loglik(), starsh_ssdata_loglik_free().
+ * @ingroup app-spatial
+ * */
+{
+    if(state == NULL)
+    {
+        STARSH_ERROR("Invalid value of `state`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(data == NULL)
+    {
+        STARSH_ERROR("Invalid value of `data`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_int n = data->particles.count;
+    STARSH_int shape[2] = {n, n};
+    STARSH_kernel *kernel;
+    STARSH_ssloglik *S;
+    int info;
+    info = starsh_ssdata_get_kernel(&kernel, data, type);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_MALLOC(S, 1);
+    S->data = data;
+    S->matrix = NULL;
+    S->factor = NULL;
+    S->maxrank = maxrank;
+    S->tol = tol;
+    STARSH_MALLOC(S->work, n);
+    info = starsh_problem_new(&S->problem, 2, shape, 'S', 'd', data, data,
+            kernel, "Spatial statistics log-likelihood");
+    if(info != STARSH_SUCCESS)
+        return info;
+    info = starsh_cluster_new_plain(&S->cluster, data, n, block_size);
+    if(info != STARSH_SUCCESS)
+        return info;
+    info = starsh_blrf_new_tlr(&S->format, S->problem, 'S', S->cluster,
+            S->cluster);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *state = S;
+    return STARSH_SUCCESS;
+}
+
+static int ssloglik_copy_format(STARSH_blrf **format, STARSH_blrf *src)
+//! Copy TLR format, so that approximation does not change the original.
+{
+    STARSH_int *block_far = NULL, *block_near = NULL, bi;
+    if(src->nblocks_far > 0)
+    {
+        STARSH_MALLOC(block_far, 2*src->nblocks_far);
+        for(bi = 0; bi < 2*src->nblocks_far; bi++)
+            block_far[bi] = src->block_far[bi];
+    }
+    if(src->nblocks_near > 0)
+    {
+        STARSH_MALLOC(block_near, 2*src->nblocks_near);
+        for(bi = 0; bi < 2*src->nblocks_near; bi++)
+            block_near[bi] = src->block_near[bi];
+    }
+    return starsh_blrf_new_from_coo(format, src->problem, src->symm,
+            src->row_cluster, src->col_cluster, src->nblocks_far, block_far,
+            src->nblocks_near, block_near, src->type);
+}
+
+static void ssloglik_free_matrix(STARSH_ssloglik *state)
+//! Free approximation of covariance matrix together with its format.
+{
+    STARSH_ssloglik *S = state;
+    if(S->matrix != NULL)
+    {
+        STARSH_blrf *F = S->matrix->format;
+        starsh_blrm_free(S->matrix);
+        starsh_blrf_free(F);
+        S->matrix = NULL;
+    }
+}
+
+static void ssloglik_free_factor(STARSH_ssloglik *state)
+//! Free factor of covariance matrix.
+{
+    STARSH_ssloglik *S = state;
+    if(S->factor != NULL)
+    {
+        STARSH_blrf *F = S->factor->format;
+        starsh_blrm_free(S->factor);
+        starsh_blrf_free(F);
+        S->factor = NULL;
+    }
+}
+
+int starsh_ssdata_loglik(STARSH_ssloglik *state, double *z, double *params,
+        double *loglik)
+//! Gaussian log-likelihood of observations for given parameters.
+/*! Computes `-(z^T*A^{-1}*z+log(det(A))+n*log(2*pi))/2`, where `A` is
+ * covariance matrix for parameters `params`. Covariance matrix is
+ * approximated in a copy of TLR format, created by
+ * starsh_ssdata_loglik_new(), factorized by TLR Cholesky factorization, and
+ * both determinant and solution are obtained from the factor. Approximation
+ * and factor are kept in `state` until the next call, so they can be
+ * reused, for example, for kriging.
+ *
+ * Approximation of the previous call is updated by
+ * starsh_blrm_update_parameters() instead of a new approximation. If only
+ * `sigma` and `noise` change, covariance matrix is scaled and shifted
+ * without any call to kernel, and if `noise` changes proportionally to
+ * `sigma`, factor is only scaled and factorization is skipped. If `beta`
+ * or `nu` change, tiles are approximated with previous bases as a sketch.
+ *
+ * @param[in,out] state: Pointer to @ref STARSH_ssloglik object.
+ * @param[in] z: Observations in order of particles of `state->data`.
+ * @param[in] params: Parameters of covariance in the following order:
+ *      `sigma`, `beta`, `nu` and `noise`.
+ * @param[out] loglik: Value of log-likelihood.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_ssdata_loglik_new().
+ * @ingroup app-spatial
+ * */
+{
+    STARSH_ssloglik *S = state;
+    if(S == NULL)
+    {
+        STARSH_ERROR("Invalid value of `state`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(z == NULL || params == NULL || loglik == NULL)
+    {
+        STARSH_ERROR("Invalid value of `z`, `params` or `loglik`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_ssdata *data = S->data;
+    STARSH_cluster *C = S->cluster;
+    STARSH_int n = data->particles.count, k;
+    int info, i;
+    data->sigma = params[0];
+    data->beta = params[1];
+    data->nu = params[2];
+    data->noise = params[3];
+    if(S->matrix == NULL)
+    {
+        // Approximation modifies its format, so it works on a copy
+        STARSH_blrf *F;
+        ssloglik_free_factor(S);
+        info = ssloglik_copy_format(&F, S->format);
+        if(info != STARSH_SUCCESS)
+            return info;
+        info = starsh_blrm_approximate(&S->matrix, F, S->maxrank, S->tol,
+                0);
+        if(info != STARSH_SUCCESS)
+        {
+            starsh_blrf_free(F);
+            S->matrix = NULL;
+            return info;
+        }
+    }
+    else if(params[1] == S->params[1] && params[2] == S->params[2])
+    {
+        // New matrix is scale*A+shift*I
+        double scale = params[0]/S->params[0];
+        double shift = params[3]-scale*S->params[3];
+        info = starsh_blrm_update_parameters(S->matrix, 'D', scale, shift, 0,
+                0.);
+        if(info == STARSH_SUCCESS && shift == 0. && S->factor != NULL)
+            info = starsh_blrm_update_parameters(S->factor, 'D', sqrt(scale),
+                    0., 0, 0.);
+        else
+            ssloglik_free_factor(S);
+    }
+    else
+    {
+        ssloglik_free_factor(S);
+        info = starsh_blrm_update_parameters(S->matrix, 'K', 0., 0.,
+                S->maxrank, S->tol);
+    }
+    if(info != STARSH_SUCCESS)
+    {
+        // Matrix does not correspond to any parameters anymore
+        ssloglik_free_factor(S);
+        ssloglik_free_matrix(S);
+        return info;
+    }
+    for(i = 0; i < 4; i++)
+        S->params[i] = params[i];
+    if(S->factor == NULL)
+    {
+#ifdef OPENMP
+        info = starsh_blrm__dpotrf_omp(&S->factor, S->matrix, S->maxrank,
+                S->tol);
+#else
+        info = starsh_blrm__dpotrf(&S->factor, S->matrix, S->maxrank,
+                S->tol);
+#endif
+        if(info != STARSH_SUCCESS)
+        {
+            S->factor = NULL;
+            return info;
+        }
+    }
+    // Log-determinant is given by diagonal tiles of Cholesky factor
+    double logdet = 0.;
+    for(k = 0; k < C->nblocks; k++)
+    {
+        int nk = C->size[k];
+        double *L = S->factor->near_D[k]->data;
+        for(i = 0; i < nk; i++)
+            logdet += log(L[(size_t)i*(nk+1)]);
+    }
+    logdet *= 2;
+    cblas_dcopy(n, z, 1, S->work, 1);
+#ifdef OPENMP
+    info = starsh_blrm__dtrsm_omp(S->factor, 'N', 1, S->work, n);
+#else
+    info = starsh_blrm__dtrsm(S->factor, 'N', 1, S->work, n);
+#endif
+    if(info != STARSH_SUCCESS)
+        return info;
+    // z^T*A^{-1}*z is a squared norm of L^{-1}*z
+    double quad = cblas_ddot(n, S->work, 1, S->work, 1);
+    double pi = 3.14159265358979323846;
+    *loglik = -0.5*(quad+logdet+n*log(2*pi));
+    return STARSH_SUCCESS;
+}
+
+void starsh_ssdata_loglik_free(STARSH_ssloglik *state)
+//! Free @ref STARSH_ssloglik object, but not its @ref STARSH_ssdata object.
+//! @ingroup app-spatial
+{
+    STARSH_ssloglik *S = state;
+    if(S == NULL)
+        return;
+    ssloglik_free_factor(S);
+    ssloglik_free_matrix(S);
+    starsh_blrf_free(S->format);
+    starsh_cluster_free(S->cluster);
+    starsh_problem_free(S->problem);
+    free(S->work);
+    free(S);
+}
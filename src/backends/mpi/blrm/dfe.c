@@ -46,7 +46,7 @@ double starsh_blrm__dfe_mpi(STARSH_blrm *matrix)
     double *far_block_norm = block_norm;
     double *near_block_norm = block_norm+nblocks_far_local;
     char symm = F->symm;
-    int info;
+    int info = 0;
     // Simple cycle over all far-field blocks
     #pragma omp parallel for schedule(dynamic, 1)
     for(lbi = 0; lbi < nblocks_far_local; lbi++)
@@ -142,8 +142,29 @@ double starsh_blrm__dfe_mpi(STARSH_blrm *matrix)
     value[1] = cblas_dnrm2(nblocks_local, block_norm, 1);
     value[0] *= value[0];
     value[1] *= value[1];
+    // Blocks, dropped as numerical zeros, add to both error and norm. They
+    // are distributed among MPI processes in a cyclic manner.
+    STARSH_int nblocks_drop, *block_drop;
+    double drop_norm2 = 0;
+    if(starsh_blrf_get_dropped(F, &nblocks_drop, &block_drop)
+            != STARSH_SUCCESS)
+        info = STARSH_MALLOC_ERROR;
+    else if(nblocks_drop > 0)
+    {
+        int mpi_size, mpi_rank;
+        MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+        MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+        if(starsh_blrm__dnorm_dropped(F, nblocks_drop, block_drop, mpi_rank,
+                    mpi_size, &drop_norm2) != STARSH_SUCCESS)
+            info = STARSH_MALLOC_ERROR;
+        free(block_drop);
+    }
+    value[0] += drop_norm2;
+    value[1] += drop_norm2;
     double mpi_value[2] = {0, 0};
     MPI_Allreduce(&value, &mpi_value, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if(info != 0)
+        return -1;
     return sqrt(mpi_value[0]/mpi_value[1]);
 }
 
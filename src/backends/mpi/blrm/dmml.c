@@ -14,23 +14,23 @@
 #include "starsh.h"
 #include "starsh-mpi.h"
 
-int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
-        double *A, int lda, double beta, double *B, int ldb)
-//! Multiply blr-matrix by dense matrix on MPI nodes.
-/*! Performs `C=alpha*A*B+beta*C` with @ref STARSH_blrm `A` and dense matrices
- * `B` and `C`. All the integer types are int, since they are used in BLAS
- * calls.
+static int dmml_mpi_local(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double *out, int ldout, int num_threads)
+//! Multiply local tiles by dense matrix, stored entirely on MPI node.
+/*! Adds `alpha` times product of local tiles and `A` to `out`, that holds
+ * `num_threads` buffers of `nrhs` columns with leading dimension `ldout`, one
+ * for each OpenMP thread. Contributions of all the threads are summed up in
+ * the first buffer.
  *
  * @param[in] matrix: Pointer to @ref STARSH_blrm object.
  * @param[in] nrhs: Number of right hand sides.
  * @param[in] alpha: Scalar mutliplier.
  * @param[in] A: Dense matrix, right havd side.
  * @param[in] lda: Leading dimension of `A`.
- * @param[in] beta: Scalar multiplier.
- * @param[in] B: Resulting dense matrix.
- * @param[in] ldb: Leading dimension of B.
+ * @param[in,out] out: Buffers of result for each OpenMP thread.
+ * @param[in] ldout: Leading dimension of each buffer.
+ * @param[in] num_threads: Number of OpenMP threads.
  * @return Error code @ref STARSH_ERRNO.
- * @ingroup blrm
  * */
 {
     STARSH_blrm *M = matrix;
@@ -38,7 +38,6 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
     STARSH_problem *P = F->problem;
     STARSH_kernel *kernel = P->kernel;
     STARSH_int nrows = P->shape[0];
-    STARSH_int ncols = P->shape[P->ndim-1];
     // Shorcuts to information about clusters
     STARSH_cluster *R = F->row_cluster;
     STARSH_cluster *C = F->col_cluster;
@@ -53,46 +52,15 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
         if(maxrank < M->far_rank[lbi])
             maxrank = M->far_rank[lbi];
     STARSH_int maxnb = nrows/F->nbrows;
-    int mpi_size, mpi_rank;
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    for(int i = 0; i < nrhs; i++)
-        MPI_Bcast(A+i*lda, ncols, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    double *temp_D, *temp_B;
-    int num_threads;
-#ifdef OPENMP
-    #pragma omp parallel
-    #pragma omp master
-    num_threads = omp_get_num_threads();
-#else
-    num_threads = 1;
-#endif
+    double *temp_D;
     if(M->onfly == 0)
     {
-        STARSH_MALLOC(temp_D, num_threads*nrhs*maxrank);
+        STARSH_MALLOC(temp_D, num_threads*nrhs*maxrank+1);
     }
     else
     {
-        STARSH_MALLOC(temp_D, num_threads*maxnb*maxnb);
+        STARSH_MALLOC(temp_D, num_threads*maxnb*maxnb+1);
     }
-    STARSH_MALLOC(temp_B, num_threads*nrhs*nrows);
-    // Setting temp_B=beta*B for master thread of root node and B=0 otherwise
-    #pragma omp parallel
-    {
-#ifdef OPENMP
-        double *out = temp_B+omp_get_thread_num()*nrhs*nrows;
-#else
-        double *out = temp_B;
-#endif
-        for(size_t j = 0; j < nrhs*(size_t)nrows; j++)
-            out[j] = 0.;
-    }
-    if(beta != 0. && mpi_rank == 0)
-        #pragma omp parallel for schedule(static)
-        for(STARSH_int i = 0; i < nrows; i++)
-            for(STARSH_int j = 0; j < nrhs; j++)
-                temp_B[j*ldb+i] = beta*B[j*ldb+i];
-    int ldout = nrows;
     // Simple cycle over all far-field admissible blocks
     #pragma omp parallel for schedule(dynamic, 1)
     for(lbi = 0; lbi < nblocks_far_local; lbi++)
@@ -109,19 +77,18 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
             continue;
         // Get pointers to data buffers
         double *U = M->far_U[lbi]->data, *V = M->far_V[lbi]->data;
-        int info = 0;
 #ifdef OPENMP
         double *D = temp_D+omp_get_thread_num()*nrhs*maxrank;
-        double *out = temp_B+omp_get_thread_num()*nrhs*ldout;
+        double *B = out+omp_get_thread_num()*(size_t)nrhs*ldout;
 #else
         double *D = temp_D;
-        double *out = temp_B;
+        double *B = out;
 #endif
         // Multiply low-rank matrix in U*V^T format by a dense matrix
         cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
                 ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
         cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs,
-                rank, alpha, U, nrows, D, rank, 1.0, out+R->start[i], ldout);
+                rank, alpha, U, nrows, D, rank, 1.0, B+R->start[i], ldout);
         if(i != j && symm == 'S')
         {
             // Multiply low-rank matrix in V*U^T format by a dense matrix
@@ -130,7 +97,7 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
                     nrows, 1.0, U, nrows, A+R->start[i], lda, 0.0, D, rank);
             cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
                     nrhs, rank, alpha, V, ncols, D, rank, 1.0,
-                    out+C->start[j], ldout);
+                    B+C->start[j], ldout);
         }
     }
     if(M->onfly == 1)
@@ -144,13 +111,12 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
             STARSH_int j = F->block_near[2*bi+1];
             int nrows = R->size[i];
             int ncols = C->size[j];
-            int info = 0;
 #ifdef OPENMP
             double *D = temp_D+omp_get_thread_num()*maxnb*maxnb;
-            double *out = temp_B+omp_get_thread_num()*nrhs*ldout;
+            double *B = out+omp_get_thread_num()*(size_t)nrhs*ldout;
 #else
             double *D = temp_D;
-            double *out = temp_B;
+            double *B = out;
 #endif
             // Fill temporary buffer with elements of corresponding block
             kernel(nrows, ncols, R->pivot+R->start[i],
@@ -158,13 +124,13 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
             // Multiply 2 dense matrices
             cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
                     nrhs, ncols, alpha, D, nrows, A+C->start[j], lda, 1.0,
-                    out+R->start[i], ldout);
+                    B+R->start[i], ldout);
             if(i != j && symm == 'S')
             {
                 // Repeat in case of symmetric matrix
                 cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, ncols,
                         nrhs, nrows, alpha, D, nrows, A+R->start[i], lda,
-                        1.0, out+C->start[j], ldout);
+                        1.0, B+C->start[j], ldout);
             }
         }
     else
@@ -181,29 +147,94 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
             // Get pointers to data buffers
             double *D = M->near_D[lbi]->data;
 #ifdef OPENMP
-            double *out = temp_B+omp_get_thread_num()*nrhs*ldout;
+            double *B = out+omp_get_thread_num()*(size_t)nrhs*ldout;
 #else
-            double *out = temp_B;
+            double *B = out;
 #endif
             // Multiply 2 dense matrices
             cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
                     nrhs, ncols, alpha, D, nrows, A+C->start[j], lda, 1.0,
-                    out+R->start[i], ldout);
+                    B+R->start[i], ldout);
             if(i != j && symm == 'S')
             {
                 // Repeat in case of symmetric matrix
                 cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, ncols,
                         nrhs, nrows, alpha, D, nrows, A+R->start[i], lda,
-                        1.0, out+C->start[j], ldout);
+                        1.0, B+C->start[j], ldout);
             }
         }
-    // Reduce result to temp_B, corresponding to master openmp thread
+    // Reduce result to buffer, corresponding to master openmp thread
     #pragma omp parallel for schedule(static)
     for(int i = 0; i < ldout; i++)
         for(int j = 0; j < nrhs; j++)
             for(int k = 1; k < num_threads; k++)
-                temp_B[j*(size_t)ldout+i] +=
-                        temp_B[(k*(size_t)nrhs+j)*ldout+i];
+                out[j*(size_t)ldout+i] += out[(k*(size_t)nrhs+j)*ldout+i];
+    free(temp_D);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb)
+//! Multiply blr-matrix by dense matrix on MPI nodes.
+/*! Performs `C=alpha*A*B+beta*C` with @ref STARSH_blrm `A` and dense matrices
+ * `B` and `C`. All the integer types are int, since they are used in BLAS
+ * calls. Input is broadcasted from root node to all nodes, so buffer for it
+ * must be allocated on all nodes, and result is reduced to root node. Works
+ * with any distribution of tiles.
+ *
+ * @param[in] matrix: Pointer to @ref STARSH_blrm object.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] alpha: Scalar mutliplier.
+ * @param[in] A: Dense matrix, right havd side.
+ * @param[in] lda: Leading dimension of `A`.
+ * @param[in] beta: Scalar multiplier.
+ * @param[in] B: Resulting dense matrix.
+ * @param[in] ldb: Leading dimension of B.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_problem *P = F->problem;
+    STARSH_int nrows = P->shape[0];
+    STARSH_int ncols = P->shape[P->ndim-1];
+    int mpi_size, mpi_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    for(int i = 0; i < nrhs; i++)
+        MPI_Bcast(A+i*lda, ncols, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    double *temp_B;
+    int num_threads;
+#ifdef OPENMP
+    #pragma omp parallel
+    #pragma omp master
+    num_threads = omp_get_num_threads();
+#else
+    num_threads = 1;
+#endif
+    STARSH_MALLOC(temp_B, num_threads*nrhs*nrows);
+    // Setting temp_B=beta*B for master thread of root node and B=0 otherwise
+    #pragma omp parallel
+    {
+#ifdef OPENMP
+        double *out = temp_B+omp_get_thread_num()*nrhs*nrows;
+#else
+        double *out = temp_B;
+#endif
+        for(size_t j = 0; j < nrhs*(size_t)nrows; j++)
+            out[j] = 0.;
+    }
+    int ldout = nrows;
+    if(beta != 0. && mpi_rank == 0)
+        #pragma omp parallel for schedule(static)
+        for(STARSH_int i = 0; i < nrows; i++)
+            for(STARSH_int j = 0; j < nrhs; j++)
+                temp_B[j*ldout+i] = beta*B[j*ldb+i];
+    int info = dmml_mpi_local(M, nrhs, alpha, A, lda, temp_B, ldout,
+            num_threads);
+    if(info != STARSH_SUCCESS)
+        return info;
     // Since I keep result only on root node, following code is commented
     //for(int i = 0; i < nrhs; i++)
     //    MPI_Allreduce(temp_B+i*ldout, B+i*ldb, ldout, MPI_DOUBLE, MPI_SUM,
@@ -212,18 +243,424 @@ int starsh_blrm__dmml_mpi(STARSH_blrm *matrix, int nrhs, double alpha,
         MPI_Reduce(temp_B+i*ldout, B+i*ldb, ldout, MPI_DOUBLE, MPI_SUM, 0,
                 MPI_COMM_WORLD);
     free(temp_B);
-    free(temp_D);
     return STARSH_SUCCESS;
 }
 
+struct starsh_dmml_mpi_plan
+//! Communicators and buffers of MPI multiplication of TLR matrix.
+/*! Created by the first call of @ref starsh_blrm__dmml_mpi_tlr() or @ref
+ * starsh_blrm__dmml_mpi_dist() and kept in @ref STARSH_blrm::mpi_plan, so
+ * that consecutive multiplications (e.g. iterations of CG) neither create
+ * communicators nor allocate buffers.
+ * */
+{
+    int grid_nx, grid_ny;
+    //!< Shape of grid of MPI processes.
+    int grid_x, grid_y;
+    //!< Coordinates of current MPI process in grid.
+    int cyclic;
+    //!< Whether tiles are distributed by 2D block cycling over grid.
+    MPI_Comm leadingx, leadingy;
+    //!< Communicators of leading processes of rows and columns of grid.
+    MPI_Comm splitx, splity;
+    //!< Communicators of row and column of grid of current process.
+    int *counts_x, *displs_x;
+    //!< Counts and displacements to scatter remaining block columns.
+    int *counts_y, *displs_y;
+    //!< Counts and displacements to gather remaining block rows.
+    int ld_temp_A, ldout;
+    //!< Leading dimensions of local parts of input and output.
+    int nrhs, num_threads;
+    //!< Number of right hand sides and threads buffers are allocated for.
+    double *temp_A, *temp_B, *temp_D, *final_B;
+    //!< Local parts of input and output and temporary buffers.
+    MPI_Request *request;
+    //!< Requests of non-blocking collective operations.
+    STARSH_int *tiles_col_start, *tiles_col;
+    //!< Local tiles, grouped by local block columns.
+    STARSH_int *tiles_row_start, *tiles_row;
+    //!< Local tiles, grouped by local block rows.
+    STARSH_int *dist_offset_row, *dist_offset_col;
+    //!< Offsets of block rows and block columns of local tiles in buffers.
+    int dist_nrhs, dist_num_threads;
+    //!< Number of right hand sides and threads of distributed buffers.
+    size_t dist_Y_size, dist_D_size;
+    //!< Sizes of output and temporary buffers of each thread.
+    double *dist_X, *dist_Y, *dist_D;
+    //!< Buffers of input, output and temporary tiles.
+    MPI_Request *dist_request;
+    //!< Requests of non-blocking operations.
+    int *dist_done;
+    //!< Whether blocks of input, sent within row of grid, arrived.
+};
+
+static int dmml_mpi_plan(STARSH_blrm *matrix,
+        struct starsh_dmml_mpi_plan **plan)
+//! Get communicators of MPI multiplication of TLR matrix.
+/*! Creates communicators on the first call and returns cached ones after.
+ *
+ * @param[in,out] matrix: Pointer to @ref STARSH_blrm object.
+ * @param[out] plan: Address of pointer to cached plan.
+ * @return Error code @ref STARSH_ERRNO.
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_int maxnb = F->problem->shape[0]/F->nbrows;
+    struct starsh_dmml_mpi_plan *S = M->mpi_plan;
+    if(S == NULL)
+    {
+        // Process grid is defined by format: block row `i` belongs to row
+        // `i%grid_ny` and block column `j` belongs to column `j%grid_nx` of
+        // grid, while MPI ranks are ordered by columns of grid
+        int mpi_rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+        int grid_nx = F->grid_ncols, grid_ny = F->grid_nrows, grid_x, grid_y;
+        grid_x = mpi_rank / grid_ny;
+        grid_y = mpi_rank % grid_ny;
+        STARSH_MALLOC(S, 1);
+        S->grid_nx = grid_nx;
+        S->grid_ny = grid_ny;
+        S->grid_x = grid_x;
+        S->grid_y = grid_y;
+        // Multiplications over rows and columns of grid are possible only if
+        // all the local tiles are in the same block rows and block columns
+        // as in 2D block cycling distribution
+        STARSH_int lbi;
+        S->cyclic = 1;
+        for(lbi = 0; lbi < F->nblocks_far_local; lbi++)
+        {
+            STARSH_int bi = F->block_far_local[lbi];
+            if(F->block_far[2*bi]%grid_ny != grid_y ||
+                    F->block_far[2*bi+1]%grid_nx != grid_x)
+                S->cyclic = 0;
+        }
+        for(lbi = 0; lbi < F->nblocks_near_local; lbi++)
+        {
+            STARSH_int bi = F->block_near_local[lbi];
+            if(F->block_near[2*bi]%grid_ny != grid_y ||
+                    F->block_near[2*bi+1]%grid_nx != grid_x)
+                S->cyclic = 0;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &S->cyclic, 1, MPI_INT, MPI_MIN,
+                MPI_COMM_WORLD);
+        // Leading processes of rows of grid form the first column of grid
+        // and leading processes of columns of grid form the first row
+        MPI_Group mpi_leading_group, mpi_world_group;
+        MPI_Comm_group(MPI_COMM_WORLD, &mpi_world_group);
+        int group_rank[grid_nx > grid_ny ? grid_nx : grid_ny];
+        S->leadingy = MPI_COMM_NULL;
+        if(grid_x == 0)
+        {
+            for(int i = 0; i < grid_ny; i++)
+                group_rank[i] = i;
+            MPI_Group_incl(mpi_world_group, grid_ny, group_rank,
+                    &mpi_leading_group);
+            MPI_Comm_create_group(MPI_COMM_WORLD, mpi_leading_group, 0,
+                    &S->leadingy);
+            MPI_Group_free(&mpi_leading_group);
+        }
+        S->leadingx = MPI_COMM_NULL;
+        if(grid_y == 0)
+        {
+            for(int i = 0; i < grid_nx; i++)
+                group_rank[i] = i*grid_ny;
+            MPI_Group_incl(mpi_world_group, grid_nx, group_rank,
+                    &mpi_leading_group);
+            MPI_Comm_create_group(MPI_COMM_WORLD, mpi_leading_group, 1,
+                    &S->leadingx);
+            MPI_Group_free(&mpi_leading_group);
+        }
+        MPI_Group_free(&mpi_world_group);
+        MPI_Comm_split(MPI_COMM_WORLD, grid_x, mpi_rank, &S->splitx);
+        MPI_Comm_split(MPI_COMM_WORLD, grid_y, mpi_rank, &S->splity);
+        // Block columns and block rows, that do not fill entire row or
+        // column of grid, are scattered and gathered with variable counts
+        int remain_x = F->nbcols%grid_nx, remain_y = F->nbrows%grid_ny;
+        STARSH_MALLOC(S->counts_x, grid_nx);
+        STARSH_MALLOC(S->displs_x, grid_nx);
+        STARSH_MALLOC(S->counts_y, grid_ny);
+        STARSH_MALLOC(S->displs_y, grid_ny);
+        for(int i = 0; i < grid_nx; i++)
+            S->counts_x[i] = i < remain_x ? maxnb : 0;
+        for(int i = 0; i < grid_ny; i++)
+            S->counts_y[i] = i < remain_y ? maxnb : 0;
+        S->displs_x[0] = 0;
+        for(int i = 1; i < grid_nx; i++)
+            S->displs_x[i] = S->displs_x[i-1]+S->counts_x[i-1];
+        S->displs_y[0] = 0;
+        for(int i = 1; i < grid_ny; i++)
+            S->displs_y[i] = S->displs_y[i-1]+S->counts_y[i-1];
+        S->ld_temp_A = (F->nbcols+grid_nx-1-grid_x)/grid_nx*maxnb;
+        S->ldout = (F->nbrows+grid_ny-1-grid_y)/grid_ny*maxnb;
+        S->nrhs = 0;
+        S->num_threads = 0;
+        S->temp_A = NULL;
+        S->temp_B = NULL;
+        S->temp_D = NULL;
+        S->final_B = NULL;
+        S->request = NULL;
+        S->tiles_col_start = NULL;
+        S->tiles_col = NULL;
+        S->tiles_row_start = NULL;
+        S->tiles_row = NULL;
+        S->dist_offset_row = NULL;
+        S->dist_offset_col = NULL;
+        S->dist_nrhs = 0;
+        S->dist_num_threads = 0;
+        S->dist_X = NULL;
+        S->dist_Y = NULL;
+        S->dist_D = NULL;
+        S->dist_request = NULL;
+        S->dist_done = NULL;
+        M->mpi_plan = S;
+    }
+    *plan = S;
+    return STARSH_SUCCESS;
+}
+
+static int dmml_mpi_tiles_group(STARSH_blrf *format, int row,
+        STARSH_int ngroups, int step, STARSH_int **group_start,
+        STARSH_int **group)
+//! Group local tiles by local block rows or local block columns.
+/*! Local tiles are numbered by their local indexes: far-field tiles go
+ * first, followed by near-field tiles, so that index of near-field tile is
+ * shifted by number of local far-field tiles. Tiles of `t`-th group are
+ * `group[group_start[t]]` to `group[group_start[t+1]-1]`.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] row: Whether to group by block rows (1) or columns (0).
+ * @param[in] ngroups: Number of local block rows or columns.
+ * @param[in] step: Number of rows or columns of process grid.
+ * @param[out] group_start: Address of starting positions of groups.
+ * @param[out] group: Address of list of local tiles.
+ * @return Error code @ref STARSH_ERRNO.
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_int nblocks_far_local = F->nblocks_far_local;
+    STARSH_int ntiles = nblocks_far_local+F->nblocks_near_local;
+    STARSH_int lbi, t, *start, *list;
+    STARSH_MALLOC(start, ngroups+1);
+    STARSH_MALLOC(list, ntiles+1);
+    // Count tiles of each group, get starting positions of groups and then
+    // put tiles into their groups
+    for(t = 0; t <= ngroups; t++)
+        start[t] = 0;
+    for(lbi = 0; lbi < ntiles; lbi++)
+    {
+        STARSH_int k = lbi < nblocks_far_local ?
+            F->block_far[2*F->block_far_local[lbi]+1-row] :
+            F->block_near[2*F->block_near_local[lbi-nblocks_far_local]
+            +1-row];
+        start[k/step+1]++;
+    }
+    for(t = 0; t < ngroups; t++)
+        start[t+1] += start[t];
+    for(lbi = 0; lbi < ntiles; lbi++)
+    {
+        STARSH_int k = lbi < nblocks_far_local ?
+            F->block_far[2*F->block_far_local[lbi]+1-row] :
+            F->block_near[2*F->block_near_local[lbi-nblocks_far_local]
+            +1-row];
+        list[start[k/step]++] = lbi;
+    }
+    // Now `start[t]` is the end of `t`-th group
+    for(t = ngroups; t > 0; t--)
+        start[t] = start[t-1];
+    start[0] = 0;
+    *group_start = start;
+    *group = list;
+    return STARSH_SUCCESS;
+}
 
+static int dmml_mpi_tiles_plan(STARSH_blrm *matrix,
+        struct starsh_dmml_mpi_plan *plan)
+//! Group local tiles by local block columns and local block rows.
+/*! Groups are created only once, see dmml_mpi_tiles_group().
+ *
+ * @param[in] matrix: Pointer to @ref STARSH_blrm object.
+ * @param[in,out] plan: Cached plan.
+ * @return Error code @ref STARSH_ERRNO.
+ * */
+{
+    STARSH_blrf *F = matrix->format;
+    struct starsh_dmml_mpi_plan *S = plan;
+    if(S->tiles_col != NULL)
+        return STARSH_SUCCESS;
+    STARSH_int nb_row = (F->nbrows+S->grid_ny-1-S->grid_y)/S->grid_ny;
+    STARSH_int nb_col = (F->nbcols+S->grid_nx-1-S->grid_x)/S->grid_nx;
+    int info = dmml_mpi_tiles_group(F, 1, nb_row, S->grid_ny,
+            &S->tiles_row_start, &S->tiles_row);
+    if(info != STARSH_SUCCESS)
+        return info;
+    return dmml_mpi_tiles_group(F, 0, nb_col, S->grid_nx,
+            &S->tiles_col_start, &S->tiles_col);
+}
+
+static int dmml_mpi_tlr_plan(STARSH_blrm *matrix, int nrhs, int maxrank,
+        STARSH_int maxnb, struct starsh_dmml_mpi_plan **plan)
+//! Get communicators and buffers of MPI multiplication of TLR matrix.
+/*! Creates communicators on the first call and reallocates buffers only if
+ * number of right hand sides or number of OpenMP threads increases.
+ *
+ * @param[in,out] matrix: Pointer to @ref STARSH_blrm object.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] maxrank: Maximum rank of local far-field tiles.
+ * @param[in] maxnb: Size of each tile.
+ * @param[out] plan: Address of pointer to cached plan.
+ * @return Error code @ref STARSH_ERRNO.
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    struct starsh_dmml_mpi_plan *S;
+    int info = dmml_mpi_plan(M, &S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    int num_threads;
+#ifdef OPENMP
+    #pragma omp parallel
+    #pragma omp master
+    num_threads = omp_get_num_threads();
+#else
+    num_threads = 1;
+#endif
+    if(nrhs > S->nrhs || num_threads > S->num_threads)
+    {
+        if(nrhs < S->nrhs)
+            nrhs = S->nrhs;
+        if(num_threads < S->num_threads)
+            num_threads = S->num_threads;
+        free(S->temp_A);
+        free(S->temp_B);
+        free(S->temp_D);
+        free(S->final_B);
+        free(S->request);
+        S->final_B = NULL;
+        // Requests of scatter of A go first, followed by requests of
+        // scatter of B and by requests of broadcast of stripes of A
+        STARSH_int nstripes_x = (F->nbcols+S->grid_nx-1)/S->grid_nx;
+        STARSH_int nstripes_y = (F->nbrows+S->grid_ny-1)/S->grid_ny;
+        STARSH_MALLOC(S->request, (nstripes_x+nstripes_y)*nrhs+nstripes_x);
+        STARSH_MALLOC(S->temp_A, nrhs*(size_t)S->ld_temp_A);
+        STARSH_MALLOC(S->temp_B, num_threads*(size_t)nrhs*(size_t)S->ldout);
+        if(M->onfly == 0)
+        {
+            STARSH_MALLOC(S->temp_D, num_threads*(size_t)nrhs*maxrank);
+        }
+        else
+        {
+            STARSH_MALLOC(S->temp_D, num_threads*(size_t)maxnb*maxnb);
+        }
+        if(S->leadingy != MPI_COMM_NULL)
+        {
+            STARSH_MALLOC(S->final_B, nrhs*(size_t)S->ldout);
+        }
+        S->nrhs = nrhs;
+        S->num_threads = num_threads;
+    }
+    info = dmml_mpi_tiles_plan(M, S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *plan = S;
+    return STARSH_SUCCESS;
+}
+
+static void dmml_mpi_tlr_tiles(STARSH_blrm *matrix, int nrhs, double alpha,
+        STARSH_int maxnb, size_t temp_D_size, STARSH_int *tile,
+        STARSH_int ntiles)
+//! Multiply given local tiles by local stripes of dense matrix.
+/*! Tiles are given by local indexes as in dmml_mpi_tiles_group(). Input,
+ * output and temporary buffers of OpenMP threads are taken from cached plan
+ * of starsh_blrm__dmml_mpi_tlr().
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_kernel *kernel = F->problem->kernel;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_cluster *C = F->col_cluster;
+    void *RD = R->data, *CD = C->data;
+    STARSH_int nblocks_far_local = F->nblocks_far_local;
+    struct starsh_dmml_mpi_plan *S = M->mpi_plan;
+    int grid_nx = S->grid_nx, grid_ny = S->grid_ny;
+    int ld_temp_A = S->ld_temp_A, ldout = S->ldout;
+    double *temp_A = S->temp_A;
+    size_t temp_B_size = (size_t)S->nrhs*(size_t)ldout;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(STARSH_int t = 0; t < ntiles; t++)
+    {
+        STARSH_int lbi = tile[t];
+#ifdef OPENMP
+        double *D = S->temp_D+omp_get_thread_num()*temp_D_size;
+        double *out = S->temp_B+omp_get_thread_num()*temp_B_size;
+#else
+        double *D = S->temp_D;
+        double *out = S->temp_B;
+#endif
+        if(lbi < nblocks_far_local)
+        {
+            STARSH_int bi = F->block_far_local[lbi];
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = F->block_far[2*bi];
+            STARSH_int j = F->block_far[2*bi+1];
+            // Get sizes and rank
+            int nrows = R->size[i];
+            int ncols = C->size[j];
+            int rank = M->far_rank[lbi];
+            if(rank == 0)
+                continue;
+            // Get pointers to data buffers
+            double *U = M->far_U[lbi]->data, *V = M->far_V[lbi]->data;
+            // Multiply low-rank matrix in U*V^T format by a dense matrix
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    ncols, 1.0, V, ncols, temp_A+(j/grid_nx)*maxnb,
+                    ld_temp_A, 0.0, D, rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    nrhs, rank, alpha, U, nrows, D, rank, 1.0,
+                    out+i/grid_ny*maxnb, ldout);
+        }
+        else
+        {
+            lbi -= nblocks_far_local;
+            STARSH_int bi = F->block_near_local[lbi];
+            // Get indexes and sizes of corresponding block row and column
+            STARSH_int i = F->block_near[2*bi];
+            STARSH_int j = F->block_near[2*bi+1];
+            int nrows = R->size[i];
+            int ncols = C->size[j];
+            // Fill temporary buffer with elements of corresponding block,
+            // if it is not stored
+            if(M->onfly == 1)
+                kernel(nrows, ncols, R->pivot+R->start[i],
+                        C->pivot+C->start[j], RD, CD, D, nrows);
+            else
+                D = M->near_D[lbi]->data;
+            // Multiply 2 dense matrices
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    nrhs, ncols, alpha, D, nrows,
+                    temp_A+(j/grid_nx)*(size_t)maxnb, ld_temp_A, 1.0,
+                    out+i/grid_ny*(size_t)maxnb, ldout);
+        }
+    }
+}
 
 int starsh_blrm__dmml_mpi_tlr(STARSH_blrm *matrix, int nrhs, double alpha,
         double *A, int lda, double beta, double *B, int ldb)
 //! Multiply blr-matrix by dense matrix on MPI nodes.
 /*! Performs `C=alpha*A*B+beta*C` with @ref STARSH_blrm `A` and dense matrices
  * `B` and `C`. All the integer types are int, since they are used in BLAS
- * calls. Block-wise low-rank matrix `A` is in TLR format.
+ * calls. Block-wise low-rank matrix `A` is in TLR format. Communicators and
+ * buffers are created by the first call and cached in @ref
+ * STARSH_blrm::mpi_plan until @ref starsh_blrm_free_mpi(). Dense matrices
+ * are distributed with non-blocking collectives: tiles of each stripe of
+ * block columns of `B` are multiplied as soon as the stripe arrives, while
+ * the other stripes are still scattered and broadcasted, scatter of `C`
+ * overlaps with multiplication of tiles and reduction of each column of
+ * result overlaps with summation of contributions of OpenMP threads into the
+ * next one. If tiles are not distributed by 2D block cycling (see @ref
+ * starsh_set_mpi_dist()), @ref starsh_blrm__dmml_mpi() is used instead.
  *
  * @param[in] matrix: Pointer to @ref STARSH_blrm object.
  * @param[in] nrhs: Number of right hand sides.
@@ -240,129 +677,240 @@ int starsh_blrm__dmml_mpi_tlr(STARSH_blrm *matrix, int nrhs, double alpha,
     STARSH_blrm *M = matrix;
     STARSH_blrf *F = M->format;
     STARSH_problem *P = F->problem;
-    STARSH_kernel *kernel = P->kernel;
     STARSH_int nrows = P->shape[0];
-    STARSH_int ncols = P->shape[P->ndim-1];
-    // Shorcuts to information about clusters
-    STARSH_cluster *R = F->row_cluster;
-    STARSH_cluster *C = F->col_cluster;
-    void *RD = R->data, *CD = C->data;
-    // Number of far-field and near-field blocks
+    // Number of far-field blocks
     STARSH_int nblocks_far_local = F->nblocks_far_local;
-    STARSH_int nblocks_near_local = F->nblocks_near_local;
     STARSH_int lbi;
-    char symm = F->symm;
     int maxrank = 0;
     for(lbi = 0; lbi < nblocks_far_local; lbi++)
         if(maxrank < M->far_rank[lbi])
             maxrank = M->far_rank[lbi];
     STARSH_int maxnb = nrows/F->nbrows;
-    int mpi_rank, mpi_size;
+    int mpi_rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-    int grid_nx = sqrt(mpi_size), grid_ny = grid_nx, grid_x, grid_y;
-    if(grid_nx*grid_ny != mpi_size)
-        STARSH_ERROR("MPI SIZE MUST BE SQUARE OF INTEGER!");
-    grid_ny = mpi_size / grid_nx;
-    grid_x = mpi_rank / grid_nx;
-    grid_y = mpi_rank % grid_nx;
-    MPI_Group mpi_leadingx_group, mpi_leadingy_group, mpi_world_group;
-    MPI_Comm mpi_splitx, mpi_splity, mpi_leadingx, mpi_leadingy;
-    MPI_Comm_group(MPI_COMM_WORLD, &mpi_world_group);
-    int group_rank[grid_nx];
-    for(int i = 0; i < grid_ny; i++)
-        group_rank[i] = i;
-    MPI_Group_incl(mpi_world_group, grid_ny, group_rank, &mpi_leadingy_group);
-    MPI_Comm_create_group(MPI_COMM_WORLD, mpi_leadingy_group, 0,
-            &mpi_leadingy);
-    for(int i = 0; i < grid_nx; i++)
-        group_rank[i] = i*grid_ny;
-    MPI_Group_incl(mpi_world_group, grid_nx, group_rank, &mpi_leadingx_group);
-    MPI_Comm_create_group(MPI_COMM_WORLD, mpi_leadingx_group, 0,
-            &mpi_leadingx);
-    MPI_Comm_split(MPI_COMM_WORLD, grid_x, mpi_rank, &mpi_splitx);
-    MPI_Comm_split(MPI_COMM_WORLD, grid_y, mpi_rank, &mpi_splity);
-    int mpi_leadingx_rank=-1, mpi_leadingx_size=-1;
-    int mpi_leadingy_rank=-1, mpi_leadingy_size=-1;
-    int mpi_splitx_rank, mpi_splitx_size;
-    int mpi_splity_rank, mpi_splity_size;
-    if(mpi_leadingx != MPI_COMM_NULL)
-    {
-        MPI_Comm_rank(mpi_leadingx, &mpi_leadingx_rank);
-        MPI_Comm_size(mpi_leadingx, &mpi_leadingx_size);
-    }
-    if(mpi_leadingy != MPI_COMM_NULL)
+    struct starsh_dmml_mpi_plan *S;
+    int info = dmml_mpi_plan(M, &S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Tiles, that are not distributed by 2D block cycling, are multiplied by
+    // dense matrix, broadcasted to all nodes
+    if(S->cyclic == 0)
+        return starsh_blrm__dmml_mpi(M, nrhs, alpha, A, lda, beta, B, ldb);
+    info = dmml_mpi_tlr_plan(M, nrhs, maxrank, maxnb, &S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    int grid_nx = S->grid_nx, grid_ny = S->grid_ny;
+    int grid_x = S->grid_x, grid_y = S->grid_y;
+    MPI_Comm mpi_leadingx = S->leadingx, mpi_leadingy = S->leadingy;
+    int ld_temp_A = S->ld_temp_A, ldout = S->ldout;
+    int num_threads = S->num_threads;
+    double *temp_A = S->temp_A, *temp_B = S->temp_B;
+    double *final_B = S->final_B;
+    size_t temp_B_size = (size_t)S->nrhs*(size_t)ldout;
+    size_t temp_D_size = M->onfly == 0 ? (size_t)S->nrhs*maxrank :
+            (size_t)maxnb*maxnb;
+    STARSH_int nstripes_x = (F->nbcols+grid_nx-1)/grid_nx;
+    STARSH_int nstripes_y = (F->nbrows+grid_ny-1)/grid_ny;
+    MPI_Request *request_A = S->request;
+    MPI_Request *request_B = S->request+nstripes_x*nrhs;
+    int nrequests_A = 0, nrequests_B = 0;
+    // Start scatter of B, that is waited only before reduction of result
+    if(beta != 0. && mpi_leadingy != MPI_COMM_NULL)
     {
-        MPI_Comm_rank(mpi_leadingy, &mpi_leadingy_rank);
-        MPI_Comm_size(mpi_leadingy, &mpi_leadingy_size);
+        STARSH_int i;
+        for(i = 0; i < F->nbrows/grid_ny; i++)
+        {
+            double *src = B+i*maxnb*grid_ny;
+            double *recv = final_B+i*maxnb;
+            for(int j = 0; j < nrhs; j++)
+                MPI_Iscatter(src+j*(size_t)ldb, maxnb, MPI_DOUBLE,
+                        recv+j*(size_t)ldout, maxnb, MPI_DOUBLE, 0,
+                        mpi_leadingy, request_B+nrequests_B++);
+        }
+        if(F->nbrows%grid_ny > 0)
+        {
+            double *src = B+i*maxnb*grid_ny;
+            double *recv = final_B+i*maxnb;
+            for(int j = 0; j < nrhs; j++)
+                MPI_Iscatterv(src+j*(size_t)ldb, S->counts_y, S->displs_y,
+                        MPI_DOUBLE, recv+j*(size_t)ldout, S->counts_y[grid_y],
+                        MPI_DOUBLE, 0, mpi_leadingy, request_B+nrequests_B++);
+        }
     }
-    MPI_Comm_rank(mpi_splitx, &mpi_splitx_rank);
-    MPI_Comm_size(mpi_splitx, &mpi_splitx_size);
-    MPI_Comm_rank(mpi_splity, &mpi_splity_rank);
-    MPI_Comm_size(mpi_splity, &mpi_splity_size);
-    /*
-    STARSH_WARNING("MPI: GLOBAL=%d/%d LEADX=%d/%d LEADY=%d/%d SPLITX=%d/%d "
-            "SPLITY=%d/%d", mpi_rank, mpi_size, mpi_leadingx_rank,
-            mpi_leadingx_size, mpi_leadingy_rank, mpi_leadingy_size,
-            mpi_splitx_rank, mpi_splitx_size, mpi_splity_rank,
-            mpi_splity_size);
-    */
-    int grid_block_size = maxnb*grid_nx;
-    int ld_temp_A = (F->nbcols+grid_nx-1-grid_x)/grid_nx*maxnb;
-    double *temp_A;
-    STARSH_MALLOC(temp_A, nrhs*(size_t)ld_temp_A);
+    // Scatter A to leading processes of columns of grid
     if(mpi_leadingx != MPI_COMM_NULL)
     {
-        for(STARSH_int i = 0; i < F->nbcols/grid_nx; i++)
+        STARSH_int i;
+        for(i = 0; i < F->nbcols/grid_nx; i++)
         {
-            double *src = A+i*grid_block_size;
+            double *src = A+i*maxnb*grid_nx;
             double *recv = temp_A+i*maxnb;
             for(int j = 0; j < nrhs; j++)
-            {
-                MPI_Scatter(src+j*(size_t)lda, maxnb, MPI_DOUBLE,
+                MPI_Iscatter(src+j*(size_t)lda, maxnb, MPI_DOUBLE,
                         recv+j*(size_t)ld_temp_A, maxnb, MPI_DOUBLE, 0,
-                        mpi_leadingx);
-            }
+                        mpi_leadingx, request_A+nrequests_A++);
         }
-        STARSH_int i = F->nbcols/grid_nx;
-        int remain = F->nbcols-i*grid_nx;
-        if(remain > 0)
+        if(F->nbcols%grid_nx > 0)
         {
-            double *src = A+i*(size_t)grid_block_size;
-            double *recv = temp_A+i*(size_t)maxnb;
-            if(mpi_rank == 0)
-            {
-                int sendcounts[grid_nx], displs[grid_nx];
-                for(int j = 0; j < remain; j++)
-                    sendcounts[j] = maxnb;
-                for(int j = remain; j < grid_nx; j++)
-                    sendcounts[j] = 0;
-                displs[0] = 0;
-                for(int j = 1; j < grid_nx; j++)
-                    displs[j] = displs[j-1]+sendcounts[j-1];
-                for(int j = 0; j < nrhs; j++)
-                    MPI_Scatterv(src+j*(size_t)lda, sendcounts, displs,
-                            MPI_DOUBLE, recv+j*(size_t)ld_temp_A, maxnb,
-                            MPI_DOUBLE, 0, mpi_leadingx);
-            }
-            else
+            double *src = A+i*maxnb*grid_nx;
+            double *recv = temp_A+i*maxnb;
+            for(int j = 0; j < nrhs; j++)
+                MPI_Iscatterv(src+j*(size_t)lda, S->counts_x, S->displs_x,
+                        MPI_DOUBLE, recv+j*(size_t)ld_temp_A,
+                        S->counts_x[grid_x], MPI_DOUBLE, 0, mpi_leadingx,
+                        request_A+nrequests_A++);
+        }
+    }
+    // Zero output buffers of all threads while A is being scattered
+    #pragma omp parallel for schedule(static)
+    for(size_t i = 0; i < num_threads*temp_B_size; i++)
+        temp_B[i] = 0.;
+    // Each local stripe of A is broadcasted within column of grid by its
+    // leading process and tiles of the stripe are multiplied as soon as it
+    // arrives, so that communication overlaps with computations. Leading
+    // process has a stripe as soon as it is scattered, so it broadcasts all
+    // the already scattered stripes before multiplication of each stripe.
+    // Collectives are started in the same order on all nodes of a column.
+    STARSH_int nstripes = ld_temp_A/maxnb, nposted = 0, ndone, s;
+    MPI_Request *request_C = request_B+nstripes_y*nrhs;
+    MPI_Datatype stripe_type;
+    MPI_Type_vector(nrhs, maxnb, ld_temp_A, MPI_DOUBLE, &stripe_type);
+    MPI_Type_commit(&stripe_type);
+    if(mpi_leadingx == MPI_COMM_NULL)
+        for(; nposted < nstripes; nposted++)
+            MPI_Ibcast(temp_A+nposted*maxnb, 1, stripe_type, 0, S->splitx,
+                    request_C+nposted);
+    for(ndone = 0; ndone < nstripes; ndone++)
+    {
+        if(mpi_leadingx != MPI_COMM_NULL)
+        {
+            int flag = 1;
+            s = ndone;
+            if(nposted == ndone)
+                MPI_Waitall(nrhs, request_A+nposted*nrhs,
+                        MPI_STATUSES_IGNORE);
+            while(nposted < nstripes && flag)
             {
-                int recvcount = 0;
-                if(grid_x < remain)
-                    recvcount = maxnb;
-                for(int j = 0; j < nrhs; j++)
-                    MPI_Scatterv(NULL, NULL, NULL, MPI_DOUBLE,
-                            recv+j*(size_t)ld_temp_A, recvcount, MPI_DOUBLE, 0,
-                            mpi_leadingx);
+                if(nposted > ndone)
+                    MPI_Testall(nrhs, request_A+nposted*nrhs, &flag,
+                            MPI_STATUSES_IGNORE);
+                if(flag)
+                {
+                    MPI_Ibcast(temp_A+nposted*maxnb, 1, stripe_type, 0,
+                            S->splitx, request_C+nposted);
+                    nposted++;
+                }
             }
         }
+        else
+        {
+            int index;
+            MPI_Waitany(nstripes, request_C, &index, MPI_STATUS_IGNORE);
+            s = index;
+        }
+        dmml_mpi_tlr_tiles(M, nrhs, alpha, maxnb, temp_D_size,
+                S->tiles_col+S->tiles_col_start[s],
+                S->tiles_col_start[s+1]-S->tiles_col_start[s]);
+    }
+    // Broadcasts of leading process and scatter of block columns, that are
+    // not stored by this column of grid, are still to be completed
+    MPI_Waitall(nstripes, request_C, MPI_STATUSES_IGNORE);
+    MPI_Waitall(nrequests_A, request_A, MPI_STATUSES_IGNORE);
+    MPI_Type_free(&stripe_type);
+    // Scattered part of B is added by leading processes of rows of grid
+    MPI_Waitall(nrequests_B, request_B, MPI_STATUSES_IGNORE);
+    int add_B = beta != 0. && mpi_leadingy != MPI_COMM_NULL;
+    // Reduce each column of result to temp_B, corresponding to master
+    // OpenMP thread, and start its reduction over column of grid, so that
+    // communication overlaps with summation of the next column
+    for(int j = 0; j < nrhs; j++)
+    {
+        double *out = temp_B+j*(size_t)ldout;
+        #pragma omp parallel for schedule(static)
+        for(int i = 0; i < ldout; i++)
+        {
+            for(int k = 1; k < num_threads; k++)
+                out[i] += out[k*temp_B_size+i];
+            if(add_B)
+                out[i] += beta*final_B[j*(size_t)ldout+i];
+        }
+        MPI_Ireduce(out, final_B == NULL ? NULL : final_B+j*(size_t)ldout,
+                ldout, MPI_DOUBLE, MPI_SUM, 0, S->splity, request_A+j);
+    }
+    MPI_Waitall(nrhs, request_A, MPI_STATUSES_IGNORE);
+    // Gather result on root node
+    if(mpi_leadingy != MPI_COMM_NULL)
+    {
+        int nrequests = 0;
+        STARSH_int i;
+        for(i = 0; i < F->nbrows/grid_ny; i++)
+        {
+            double *src = final_B+i*(size_t)maxnb;
+            double *recv = B+i*(size_t)maxnb*(size_t)grid_ny;
+            for(int j = 0; j < nrhs; j++)
+                MPI_Igather(src+j*(size_t)ldout, maxnb, MPI_DOUBLE,
+                        recv+j*(size_t)ldb, maxnb, MPI_DOUBLE, 0,
+                        mpi_leadingy, request_B+nrequests++);
+        }
+        if(F->nbrows%grid_ny > 0)
+        {
+            double *src = final_B+i*(size_t)maxnb;
+            double *recv = B+i*(size_t)maxnb*(size_t)grid_ny;
+            for(int j = 0; j < nrhs; j++)
+                MPI_Igatherv(src+j*(size_t)ldout, S->counts_y[grid_y],
+                        MPI_DOUBLE, recv+j*(size_t)ldb, S->counts_y,
+                        S->displs_y, MPI_DOUBLE, 0, mpi_leadingy,
+                        request_B+nrequests++);
+        }
+        MPI_Waitall(nrequests, request_B, MPI_STATUSES_IGNORE);
+    }
+    return STARSH_SUCCESS;
+}
+
+static int dmml_mpi_dist_plan(STARSH_blrm *matrix, int nrhs,
+        struct starsh_dmml_mpi_plan **plan)
+//! Get communicators and buffers of distributed MPI multiplication.
+/*! Buffer `dist_X` holds all the block columns of input, needed by local
+ * tiles, followed by all the block rows of input, needed by transposed
+ * local tiles in case of symmetric matrix. Buffer `dist_Y` holds the same
+ * for output for each OpenMP thread. Each block is stored contiguously with
+ * leading dimension equal to its size. Local tiles are grouped by local
+ * block columns and local block rows, see dmml_mpi_tiles_group().
+ *
+ * @param[in,out] matrix: Pointer to @ref STARSH_blrm object.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[out] plan: Address of pointer to cached plan.
+ * @return Error code @ref STARSH_ERRNO.
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_cluster *R = F->row_cluster, *C = F->col_cluster;
+    struct starsh_dmml_mpi_plan *S;
+    int info = dmml_mpi_plan(M, &S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    int grid_nx = S->grid_nx, grid_ny = S->grid_ny;
+    int grid_x = S->grid_x, grid_y = S->grid_y;
+    STARSH_int nb_row = (F->nbrows+grid_ny-1-grid_y)/grid_ny;
+    STARSH_int nb_col = (F->nbcols+grid_nx-1-grid_x)/grid_nx;
+    // Number of blocks of input, stored in the same row of grid
+    STARSH_int nb_in = (F->nbcols+grid_ny-1-grid_y)/grid_ny;
+    STARSH_int k, t;
+    info = dmml_mpi_tiles_plan(M, S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(S->dist_offset_row == NULL)
+    {
+        STARSH_MALLOC(S->dist_offset_row, nb_row+1);
+        STARSH_MALLOC(S->dist_offset_col, nb_col+1);
+        S->dist_offset_row[0] = 0;
+        for(k = grid_y, t = 0; k < F->nbrows; k += grid_ny, t++)
+            S->dist_offset_row[t+1] = S->dist_offset_row[t]+R->size[k];
+        S->dist_offset_col[0] = 0;
+        for(k = grid_x, t = 0; k < F->nbcols; k += grid_nx, t++)
+            S->dist_offset_col[t+1] = S->dist_offset_col[t]+C->size[k];
     }
-    MPI_Bcast(temp_A, nrhs*(size_t)ld_temp_A, MPI_DOUBLE, 0, mpi_splitx);
-    //if(mpi_rank == 0)
-    //    STARSH_WARNING("DATA DISTRIBUTED!");
-    //for(int i = 0; i < nrhs; i++)
-    //    MPI_Bcast(A+i*lda, ncols, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    double *temp_D, *temp_B;
     int num_threads;
 #ifdef OPENMP
     #pragma omp parallel
@@ -371,222 +919,566 @@ int starsh_blrm__dmml_mpi_tlr(STARSH_blrm *matrix, int nrhs, double alpha,
 #else
     num_threads = 1;
 #endif
-    if(M->onfly == 0)
-    {
-        STARSH_MALLOC(temp_D, num_threads*nrhs*maxrank);
-    }
-    else
+    if(nrhs > S->dist_nrhs || num_threads > S->dist_num_threads)
     {
-        STARSH_MALLOC(temp_D, num_threads*maxnb*maxnb);
+        if(nrhs < S->dist_nrhs)
+            nrhs = S->dist_nrhs;
+        if(num_threads < S->dist_num_threads)
+            num_threads = S->dist_num_threads;
+        free(S->dist_X);
+        free(S->dist_Y);
+        free(S->dist_D);
+        free(S->dist_request);
+        free(S->dist_done);
+        STARSH_int len_row = S->dist_offset_row[nb_row];
+        STARSH_int len_col = S->dist_offset_col[nb_col];
+        // Block rows of input and block columns of output are needed only
+        // for transposed tiles of symmetric matrix
+        size_t X_size = len_col, Y_size = len_row;
+        if(F->symm == 'S')
+        {
+            X_size += len_row;
+            Y_size += len_col;
+        }
+        int maxrank = 0, maxrow = 0, maxcol = 0;
+        for(STARSH_int lbi = 0; lbi < F->nblocks_far_local; lbi++)
+            if(maxrank < M->far_rank[lbi])
+                maxrank = M->far_rank[lbi];
+        for(k = 0; k < F->nbrows; k++)
+            if(maxrow < R->size[k])
+                maxrow = R->size[k];
+        for(k = 0; k < F->nbcols; k++)
+            if(maxcol < C->size[k])
+                maxcol = C->size[k];
+        S->dist_D_size = nrhs*(size_t)maxrank;
+        if(M->onfly == 1 && S->dist_D_size < maxrow*(size_t)maxcol)
+            S->dist_D_size = maxrow*(size_t)maxcol;
+        S->dist_Y_size = nrhs*Y_size;
+        STARSH_MALLOC(S->dist_X, nrhs*X_size+1);
+        STARSH_MALLOC(S->dist_Y, num_threads*S->dist_Y_size+1);
+        STARSH_MALLOC(S->dist_D, num_threads*S->dist_D_size+1);
+        // Broadcasts of block columns of input go first, followed by
+        // receives and sends of input within row of grid
+        STARSH_MALLOC(S->dist_request, nb_row+nb_col+2*nb_in+1);
+        STARSH_MALLOC(S->dist_done, nb_in+1);
+        S->dist_nrhs = nrhs;
+        S->dist_num_threads = num_threads;
     }
-    int ldout = (F->nbrows+grid_ny-1-grid_y)/grid_ny*maxnb;
-    //STARSH_WARNING("MPI=%d ldA=%d ldB=%d", mpi_rank, ld_temp_A, ldout);
-    STARSH_MALLOC(temp_B, num_threads*(size_t)nrhs*(size_t)ldout);
-    // Setting temp_B=beta*B for master thread of root node and B=0 otherwise
-    #pragma omp parallel
-    {
+    *plan = S;
+    return STARSH_SUCCESS;
+}
+
+static int dmml_mpi_dist_any(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb)
+//! Multiply blr-matrix by distributed dense matrix for any distribution.
+/*! Used by @ref starsh_blrm__dmml_mpi_dist(), if tiles are not distributed
+ * by 2D block cycling. Local rows of `B` are gathered on all nodes, local
+ * tiles are multiplied as in @ref starsh_blrm__dmml_mpi() and contributions
+ * to `C` are reduced and scattered to nodes, that store corresponding rows.
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_problem *P = F->problem;
+    STARSH_int nrows = P->shape[0];
+    STARSH_int ncols = P->shape[P->ndim-1];
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_cluster *C = F->col_cluster;
+    int mpi_size, mpi_rank, num_threads, r, info;
+    STARSH_int k;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
 #ifdef OPENMP
-        double *out = temp_B+omp_get_thread_num()*nrhs*ldout;
+    #pragma omp parallel
+    #pragma omp master
+    num_threads = omp_get_num_threads();
 #else
-        double *out = temp_B;
+    num_threads = 1;
 #endif
-        for(size_t j = 0; j < nrhs*(size_t)ldout; j++)
-            out[j] = 0.;
+    // Local rows of node `r` are packed one after another with leading
+    // dimension `size_col[r]` (or `size_row[r]`)
+    int *size_col, *count_col, *displ_col, *size_row, *count_row, *displ_row;
+    int *pos;
+    STARSH_MALLOC(size_col, 7*mpi_size);
+    count_col = size_col+mpi_size;
+    displ_col = count_col+mpi_size;
+    size_row = displ_col+mpi_size;
+    count_row = size_row+mpi_size;
+    displ_row = count_row+mpi_size;
+    pos = displ_row+mpi_size;
+    for(r = 0; r < mpi_size; r++)
+    {
+        size_col[r] = 0;
+        size_row[r] = 0;
     }
-    if(beta != 0. && mpi_leadingy != MPI_COMM_NULL)
+    for(k = 0; k < C->nblocks; k++)
+        size_col[k%mpi_size] += C->size[k];
+    for(k = 0; k < R->nblocks; k++)
+        size_row[k%mpi_size] += R->size[k];
+    displ_col[0] = 0;
+    displ_row[0] = 0;
+    for(r = 0; r < mpi_size; r++)
     {
-        for(STARSH_int i = 0; i < F->nbrows/grid_ny; i++)
+        count_col[r] = size_col[r]*nrhs;
+        count_row[r] = size_row[r]*nrhs;
+        if(r > 0)
         {
-            double *src = B+i*maxnb*grid_ny;
-            double *recv = temp_B+i*maxnb;
-            for(int j = 0; j < nrhs; j++)
-                MPI_Scatter(src+j*(size_t)ldb, maxnb, MPI_DOUBLE,
-                        recv+j*(size_t)ldout, maxnb, MPI_DOUBLE, 0,
-                        mpi_leadingy);
+            displ_col[r] = displ_col[r-1]+count_col[r-1];
+            displ_row[r] = displ_row[r-1]+count_row[r-1];
         }
-        #pragma omp parallel for schedule(static)
-        for(int i = 0; i < ldout; i++)
-            for(int j = 0; j < nrhs; j++)
-                temp_B[j*(size_t)ldb+i] *= beta;
     }
-    //if(mpi_rank == 0)
-    //    STARSH_WARNING("MORE DATA DISTRIBUTED");
-    // Simple cycle over all far-field admissible blocks
+    double *X_pack, *X, *Y_pack, *Y;
+    STARSH_MALLOC(X_pack, nrhs*(size_t)ncols);
+    STARSH_MALLOC(X, nrhs*(size_t)ncols);
+    STARSH_MALLOC(Y_pack, nrhs*(size_t)nrows);
+    STARSH_MALLOC(Y, num_threads*(size_t)nrhs*nrows);
+    // Gather input on all nodes and unpack it into order of clusters
+    for(int j = 0; j < nrhs; j++)
+        cblas_dcopy(size_col[mpi_rank], A+j*(size_t)lda, 1,
+                X_pack+displ_col[mpi_rank]+j*(size_t)size_col[mpi_rank], 1);
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DOUBLE, X_pack, count_col, displ_col,
+            MPI_DOUBLE, MPI_COMM_WORLD);
+    for(r = 0; r < mpi_size; r++)
+        pos[r] = 0;
+    for(k = 0; k < C->nblocks; k++)
+    {
+        r = k%mpi_size;
+        for(int j = 0; j < nrhs; j++)
+            cblas_dcopy(C->size[k], X_pack+displ_col[r]+pos[r]
+                    +j*(size_t)size_col[r], 1, X+j*(size_t)ncols+C->start[k],
+                    1);
+        pos[r] += C->size[k];
+    }
+    #pragma omp parallel for schedule(static)
+    for(size_t i = 0; i < num_threads*(size_t)nrhs*nrows; i++)
+        Y[i] = 0.;
+    info = dmml_mpi_local(M, nrhs, alpha, X, ncols, Y, nrows, num_threads);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Pack result by nodes and reduce it to nodes, that store it
+    for(r = 0; r < mpi_size; r++)
+        pos[r] = 0;
+    for(k = 0; k < R->nblocks; k++)
+    {
+        r = k%mpi_size;
+        for(int j = 0; j < nrhs; j++)
+            cblas_dcopy(R->size[k], Y+j*(size_t)nrows+R->start[k], 1,
+                    Y_pack+displ_row[r]+pos[r]+j*(size_t)size_row[r], 1);
+        pos[r] += R->size[k];
+    }
+    MPI_Reduce_scatter(Y_pack, X, count_row, MPI_DOUBLE, MPI_SUM,
+            MPI_COMM_WORLD);
+    int size = size_row[mpi_rank];
+    for(int j = 0; j < nrhs; j++)
+        for(int i = 0; i < size; i++)
+        {
+            if(beta == 0.)
+                B[j*(size_t)ldb+i] = X[j*(size_t)size+i];
+            else
+                B[j*(size_t)ldb+i] = beta*B[j*(size_t)ldb+i]
+                    +X[j*(size_t)size+i];
+        }
+    free(X_pack);
+    free(X);
+    free(Y_pack);
+    free(Y);
+    free(size_col);
+    return STARSH_SUCCESS;
+}
+
+static void dmml_mpi_dist_tiles(STARSH_blrm *matrix, int nrhs,
+        double alpha, STARSH_int *tile, STARSH_int ntiles, char part)
+//! Multiply given local tiles by distributed dense matrix.
+/*! Tiles are given by local indexes as in dmml_mpi_tiles_group(). If `part`
+ * is 'N', tiles are multiplied by block columns of input. If `part` is 'T',
+ * transposed off-diagonal tiles of symmetric matrix are multiplied by block
+ * rows of input. Off-diagonal near-field tiles of symmetric matrix, that are
+ * computed on fly, are skipped in both cases and multiplied both ways at
+ * once only if `part` is 'B', so that they are computed only once. Input,
+ * output and temporary buffers of OpenMP threads are taken from cached plan
+ * of starsh_blrm__dmml_mpi_dist().
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_kernel *kernel = F->problem->kernel;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_cluster *C = F->col_cluster;
+    void *RD = R->data, *CD = C->data;
+    STARSH_int nblocks_far_local = F->nblocks_far_local;
+    struct starsh_dmml_mpi_plan *S = M->mpi_plan;
+    int grid_nx = S->grid_nx, grid_ny = S->grid_ny;
+    STARSH_int nb_row = (F->nbrows+grid_ny-1-S->grid_y)/grid_ny;
+    STARSH_int nb_col = (F->nbcols+grid_nx-1-S->grid_x)/grid_nx;
+    STARSH_int *offset_row = S->dist_offset_row;
+    STARSH_int *offset_col = S->dist_offset_col;
+    STARSH_int len_row = offset_row[nb_row], len_col = offset_col[nb_col];
+    size_t Y_size = S->dist_Y_size, D_size = S->dist_D_size;
+    double *X_col = S->dist_X, *X_row = X_col+nrhs*(size_t)len_col;
     #pragma omp parallel for schedule(dynamic, 1)
-    for(lbi = 0; lbi < nblocks_far_local; lbi++)
+    for(STARSH_int t = 0; t < ntiles; t++)
     {
-        STARSH_int bi = F->block_far_local[lbi];
-        // Get indexes of corresponding block row and block column
-        STARSH_int i = F->block_far[2*bi];
-        STARSH_int j = F->block_far[2*bi+1];
-        // Get sizes and rank
+        STARSH_int lbi = tile[t], i, j;
+        int far = lbi < nblocks_far_local;
+        if(far)
+        {
+            STARSH_int bi = F->block_far_local[lbi];
+            i = F->block_far[2*bi];
+            j = F->block_far[2*bi+1];
+        }
+        else
+        {
+            lbi -= nblocks_far_local;
+            STARSH_int bi = F->block_near_local[lbi];
+            i = F->block_near[2*bi];
+            j = F->block_near[2*bi+1];
+        }
         int nrows = R->size[i];
         int ncols = C->size[j];
-        int rank = M->far_rank[lbi];
-        if(rank == 0)
+        // Whether tile has transposed counterpart and whether it is both
+        // near-field and computed on fly
+        int symm = i != j && F->symm == 'S';
+        int onfly = !far && M->onfly == 1;
+        int direct = part == 'B' ? onfly && symm :
+            part == 'N' && !(onfly && symm);
+        int transposed = part == 'B' ? onfly && symm :
+            part == 'T' && symm && !onfly;
+        if(!direct && !transposed)
             continue;
-        // Get pointers to data buffers
-        double *U = M->far_U[lbi]->data, *V = M->far_V[lbi]->data;
-        int info = 0;
 #ifdef OPENMP
-        double *D = temp_D+omp_get_thread_num()*(size_t)nrhs*(size_t)maxrank;
-        double *out = temp_B+omp_get_thread_num()*(size_t)nrhs*(size_t)ldout;
+        double *D = S->dist_D+omp_get_thread_num()*D_size;
+        double *out = S->dist_Y+omp_get_thread_num()*Y_size;
 #else
-        double *D = temp_D;
-        double *out = temp_B;
+        double *D = S->dist_D;
+        double *out = S->dist_Y;
 #endif
-        // Multiply low-rank matrix in U*V^T format by a dense matrix
-        //cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-        //        ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
-        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-                ncols, 1.0, V, ncols, temp_A+(j/grid_nx)*maxnb, ld_temp_A, 0.0,
-                D, rank);
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs,
-                rank, alpha, U, nrows, D, rank, 1.0, out+i/grid_ny*maxnb,
-                ldout);
-    }
-    //STARSH_WARNING("NODE %d DONE WITH FAR", mpi_rank);
-    if(M->onfly == 1)
-        // Simple cycle over all near-field blocks
-        #pragma omp parallel for schedule(dynamic, 1)
-        for(lbi = 0; lbi < nblocks_near_local; lbi++)
+        double *x = X_col+nrhs*(size_t)offset_col[j/grid_nx];
+        double *y = out+nrhs*(size_t)offset_row[i/grid_ny];
+        double *x_symm = X_row+nrhs*(size_t)offset_row[i/grid_ny];
+        double *y_symm = out+nrhs*(size_t)(len_row+offset_col[j/grid_nx]);
+        if(far)
         {
-            STARSH_int bi = F->block_near_local[lbi];
-            // Get indexes and sizes of corresponding block row and column
-            STARSH_int i = F->block_near[2*bi];
-            STARSH_int j = F->block_near[2*bi+1];
-            int nrows = R->size[i];
-            int ncols = C->size[j];
-            int info = 0;
-#ifdef OPENMP
-            double *D = temp_D+omp_get_thread_num()*(size_t)maxnb*
-                    (size_t)maxnb;
-            double *out = temp_B+omp_get_thread_num()*(size_t)nrhs*
-                    (size_t)ldout;
-#else
-            double *D = temp_D;
-            double *out = temp_B;
-#endif
-            // Fill temporary buffer with elements of corresponding block
-            kernel(nrows, ncols, R->pivot+R->start[i],
-                    C->pivot+C->start[j], RD, CD, D, nrows);
-            // Multiply 2 dense matrices
-            //cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
-            //        nrhs, ncols, alpha, D, nrows, A+C->start[j], lda, 1.0,
-            //        out+R->start[i], ldout);
-            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
-                    nrhs, ncols, alpha, D, nrows,
-                    temp_A+(j/grid_nx)*(size_t)maxnb, ld_temp_A, 1.0,
-                    out+i/grid_ny*(size_t)maxnb, ldout);
+            int rank = M->far_rank[lbi];
+            if(rank == 0)
+                continue;
+            // Get pointers to data buffers
+            double *U = M->far_U[lbi]->data, *V = M->far_V[lbi]->data;
+            if(direct)
+            {
+                // Multiply low-rank matrix in U*V^T format by a dense matrix
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, ncols, 1.0, V, ncols, x, ncols, 0.0, D, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                        nrhs, rank, alpha, U, nrows, D, rank, 1.0, y, nrows);
+            }
+            if(transposed)
+            {
+                // Multiply low-rank matrix in V*U^T format by a dense matrix
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, nrows, 1.0, U, nrows, x_symm, nrows, 0.0, D,
+                        rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
+                        nrhs, rank, alpha, V, ncols, D, rank, 1.0, y_symm,
+                        ncols);
+            }
         }
-    else
-        // Simple cycle over all near-field blocks
-        #pragma omp parallel for schedule(dynamic, 1)
-        for(lbi = 0; lbi < nblocks_near_local; lbi++)
+        else
         {
-            STARSH_int bi = F->block_near_local[lbi];
-            // Get indexes and sizes of corresponding block row and column
-            STARSH_int i = F->block_near[2*bi];
-            STARSH_int j = F->block_near[2*bi+1];
-            int nrows = R->size[i];
-            int ncols = C->size[j];
-            // Get pointers to data buffers
-            double *D = M->near_D[lbi]->data;
-#ifdef OPENMP
-            double *out = temp_B+omp_get_thread_num()*(size_t)nrhs*
-                    (size_t)ldout;
-#else
-            double *out = temp_B;
-#endif
+            // Fill temporary buffer with elements of corresponding block,
+            // if it is not stored
+            if(onfly)
+                kernel(nrows, ncols, R->pivot+R->start[i],
+                        C->pivot+C->start[j], RD, CD, D, nrows);
+            else
+                D = M->near_D[lbi]->data;
             // Multiply 2 dense matrices
-            //cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
-            //        nrhs, ncols, alpha, D, nrows, A+C->start[j], lda, 1.0,
-            //        out+R->start[i], ldout);
-            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
-                    nrhs, ncols, alpha, D, nrows,
-                    temp_A+(j/grid_nx)*(size_t)maxnb, ld_temp_A, 1.0,
-                    out+i/grid_ny*(size_t)maxnb, ldout);
+            if(direct)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                        nrhs, ncols, alpha, D, nrows, x, ncols, 1.0, y,
+                        nrows);
+            if(transposed)
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, ncols,
+                        nrhs, nrows, alpha, D, nrows, x_symm, nrows, 1.0,
+                        y_symm, ncols);
         }
-    // Reduce result to temp_B, corresponding to master openmp thread
-    #pragma omp parallel for schedule(static)
-    for(int i = 0; i < ldout; i++)
-        for(int j = 0; j < nrhs; j++)
-            for(int k = 1; k < num_threads; k++)
-                temp_B[j*(size_t)ldout+i] +=
-                        temp_B[(k*(size_t)nrhs+j)*ldout+i];
-    //STARSH_WARNING("NODE %d DONE WITH OMP REDUCTION", mpi_rank);
-    MPI_Barrier(MPI_COMM_WORLD);
-    // Since I keep result only on root node, following code is commented
-    //for(int i = 0; i < nrhs; i++)
-    //    MPI_Allreduce(temp_B+i*ldout, B+i*ldb, ldout, MPI_DOUBLE, MPI_SUM,
-    //            MPI_COMM_WORLD);
-    //for(int i = 0; i < nrhs; i++)
-    //    MPI_Reduce(temp_B+i*ldout, B+i*ldb, ldout, MPI_DOUBLE, MPI_SUM, 0,
-    //            MPI_COMM_WORLD);
-    double *final_B = NULL;
-    if(mpi_leadingy != MPI_COMM_NULL)
+    }
+}
+
+int starsh_blrm__dmml_mpi_dist(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb)
+//! Multiply blr-matrix by distributed dense matrix on MPI nodes.
+/*! Performs `C=alpha*A*B+beta*C` with @ref STARSH_blrm `A` and dense matrices
+ * `B` and `C`. All the integer types are int, since they are used in BLAS
+ * calls. Block-wise low-rank matrix `A` is in TLR format, distributed by
+ * @ref starsh_blrf_new_tlr_mpi(). Unlike @ref starsh_blrm__dmml_mpi_tlr(),
+ * dense matrices are not stored on root node, but distributed among all
+ * nodes as described in @ref starsh_blrf_get_vector_size_mpi(): `B` in
+ * layout of columns and `C` in layout of rows. Each block of `B` is first
+ * sent within its row of process grid to the node in the corresponding
+ * column (broadcasted to the entire row for symmetric matrix) and then
+ * broadcasted within that column. Tiles are multiplied as soon as the
+ * needed blocks of `B` arrive. Each block of `C` is reduced within
+ * corresponding row (and column) of process grid, so no node sends or
+ * receives entire dense matrix. If tiles are not distributed by 2D block
+ * cycling (see @ref
+ * starsh_set_mpi_dist()), `B` is gathered on all nodes and `C` is reduced
+ * and scattered among nodes instead, so layout of dense matrices does not
+ * depend on distribution of tiles.
+ *
+ * @param[in] matrix: Pointer to @ref STARSH_blrm object.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] alpha: Scalar mutliplier.
+ * @param[in] A: Local rows of dense matrix, right havd side.
+ * @param[in] lda: Leading dimension of `A`.
+ * @param[in] beta: Scalar multiplier.
+ * @param[in] B: Local rows of resulting dense matrix.
+ * @param[in] ldb: Leading dimension of B.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    // Shorcuts to information about clusters
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_cluster *C = F->col_cluster;
+    STARSH_int k, t;
+    char symm = F->symm;
+    struct starsh_dmml_mpi_plan *S;
+    int info = dmml_mpi_plan(M, &S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(S->cyclic == 0)
+        return dmml_mpi_dist_any(M, nrhs, alpha, A, lda, beta, B, ldb);
+    info = dmml_mpi_dist_plan(M, nrhs, &S);
+    if(info != STARSH_SUCCESS)
+        return info;
+    int grid_nx = S->grid_nx, grid_ny = S->grid_ny;
+    int grid_x = S->grid_x, grid_y = S->grid_y;
+    STARSH_int nb_row = (F->nbrows+grid_ny-1-grid_y)/grid_ny;
+    STARSH_int nb_col = (F->nbcols+grid_nx-1-grid_x)/grid_nx;
+    STARSH_int nb_in = (F->nbcols+grid_ny-1-grid_y)/grid_ny;
+    STARSH_int *offset_row = S->dist_offset_row;
+    STARSH_int *offset_col = S->dist_offset_col;
+    STARSH_int len_row = offset_row[nb_row], len_col = offset_col[nb_col];
+    int num_threads = S->dist_num_threads;
+    size_t Y_size = S->dist_Y_size;
+    double *X_col = S->dist_X, *X_row = X_col+nrhs*(size_t)len_col;
+    double *Y = S->dist_Y;
+    // Broadcasts of block columns go first, followed by receives and sends
+    // of blocks within row of grid
+    MPI_Request *request = S->dist_request;
+    MPI_Request *request_in = request+nb_col, *request_send = request_in+nb_in;
+    int *done = S->dist_done;
+    int nrequests = 0;
+    size_t local = 0;
+    // Block `k` of input is stored in row `k%grid_ny` of grid, so it is first
+    // sent within this row to the node in column `k%grid_nx`. In symmetric
+    // case the entire row needs it, so it is simply broadcasted.
+    for(k = grid_y, t = 0; k < F->nbcols; k += grid_ny, t++)
     {
-        STARSH_MALLOC(final_B, nrhs*(size_t)ldout);
-        #pragma omp parallel for schedule(static)
-        for(size_t i = 0; i < nrhs*(size_t)ldout; i++)
-            final_B[i] = 0.0;
+        int size = C->size[k];
+        int owner = t%grid_nx, dest = k%grid_nx;
+        double *X = symm == 'S' ? X_row+nrhs*(size_t)offset_row[t] :
+            X_col+nrhs*(size_t)offset_col[k/grid_nx];
+        double *local_A = A+local;
+        request_in[t] = MPI_REQUEST_NULL;
+        request_send[t] = MPI_REQUEST_NULL;
+        done[t] = 0;
+        if(owner == grid_x)
+            local += size;
+        if(symm == 'S' || (owner == grid_x && dest == grid_x))
+        {
+            if(owner == grid_x)
+                for(int j = 0; j < nrhs; j++)
+                    cblas_dcopy(size, local_A+j*(size_t)lda, 1,
+                            X+j*(size_t)size, 1);
+            if(symm == 'S')
+                MPI_Ibcast(X, nrhs*size, MPI_DOUBLE, owner, S->splity,
+                        request_in+t);
+            else
+                done[t] = 1;
+        }
+        else if(dest == grid_x)
+            MPI_Irecv(X, nrhs*size, MPI_DOUBLE, owner, 0, S->splity,
+                    request_in+t);
+        else if(owner == grid_x)
+        {
+            // Block is sent directly from input with its leading dimension
+            MPI_Datatype block_type;
+            MPI_Type_vector(nrhs, size, lda, MPI_DOUBLE, &block_type);
+            MPI_Type_commit(&block_type);
+            MPI_Isend(local_A, 1, block_type, dest, 0, S->splity,
+                    request_send+t);
+            MPI_Type_free(&block_type);
+        }
     }
-    MPI_Reduce(temp_B, final_B, nrhs*(size_t)ldout, MPI_DOUBLE, MPI_SUM, 0,
-            mpi_splity);
-    //STARSH_WARNING("REDUCE(%d): %f", mpi_rank, temp_B[0]);
-    //if(mpi_splity_rank == 0)
-    //    STARSH_WARNING("RESULT(%d): %f", mpi_rank, final_B[0]);
-    if(mpi_leadingy != MPI_COMM_NULL)
+    for(t = 0; t < nb_col; t++)
+        request[t] = MPI_REQUEST_NULL;
+    // Zero output buffers of all threads while input is being sent
+    #pragma omp parallel for schedule(static)
+    for(size_t i = 0; i < num_threads*Y_size; i++)
+        Y[i] = 0.;
+    // Then block columns of input are broadcasted within columns of grid by
+    // nodes, that received them, in the same order on all nodes of a column.
+    // Tiles of each block column (and of each block row in symmetric case)
+    // are multiplied as soon as it arrives.
+    STARSH_int nposted = 0, ndone_col = 0, ndone_row = 0;
+    while(ndone_col < nb_col || (symm == 'S' && ndone_row < nb_in))
     {
-        for(STARSH_int i = 0; i < F->nbrows/grid_ny; i++)
+        for(; nposted < nb_col; nposted++)
         {
-            double *src = final_B+i*(size_t)maxnb;
-            double *recv = B+i*(size_t)maxnb*(size_t)grid_ny;
-            for(int j = 0; j < nrhs; j++)
-                MPI_Gather(src+j*(size_t)ldout, maxnb, MPI_DOUBLE,
-                        recv+j*(size_t)ldb, maxnb, MPI_DOUBLE, 0,
-                        mpi_leadingy);
+            k = grid_x+nposted*grid_nx;
+            int size = C->size[k];
+            double *X = X_col+nrhs*(size_t)offset_col[nposted];
+            if(k%grid_ny == grid_y)
+            {
+                if(done[k/grid_ny] == 0)
+                    break;
+                if(symm == 'S')
+                    cblas_dcopy(nrhs*size, X_row+nrhs*(size_t)offset_row[
+                            k/grid_ny], 1, X, 1);
+            }
+            MPI_Ibcast(X, nrhs*size, MPI_DOUBLE, k%grid_ny, S->splitx,
+                    request+nposted);
         }
-        STARSH_int i = F->nbrows/grid_ny;
-        int remain = F->nbrows-i*grid_ny;
-        if(remain > 0)
+        int index;
+        MPI_Waitany(nb_col+nb_in, request, &index, MPI_STATUS_IGNORE);
+        if(index == MPI_UNDEFINED)
+            break;
+        if(index < nb_col)
         {
-            double *src = final_B+i*(size_t)maxnb;
-            double *recv = B+i*(size_t)maxnb*(size_t)grid_ny;
-            if(mpi_rank == 0)
+            dmml_mpi_dist_tiles(M, nrhs, alpha,
+                    S->tiles_col+S->tiles_col_start[index],
+                    S->tiles_col_start[index+1]-S->tiles_col_start[index],
+                    'N');
+            ndone_col++;
+        }
+        else
+        {
+            t = index-nb_col;
+            done[t] = 1;
+            if(symm == 'S')
             {
-                int recvcounts[grid_ny], displs[grid_ny];
-                for(int j = 0; j < remain; j++)
-                    recvcounts[j] = maxnb;
-                for(int j = remain; j < grid_ny; j++)
-                    recvcounts[j] = 0;
-                displs[0] = 0;
-                for(int j = 1; j < grid_ny; j++)
-                    displs[j] = displs[j-1]+recvcounts[j-1];
-                for(int j = 0; j < nrhs; j++)
-                    MPI_Gatherv(src+j*(size_t)ldout, maxnb, MPI_DOUBLE,
-                            recv+j*(size_t)ldb, recvcounts, displs, MPI_DOUBLE,
-                            0, mpi_leadingy);
+                dmml_mpi_dist_tiles(M, nrhs, alpha,
+                        S->tiles_row+S->tiles_row_start[t],
+                        S->tiles_row_start[t+1]-S->tiles_row_start[t], 'T');
+                ndone_row++;
             }
+        }
+    }
+    if(symm == 'S' && M->onfly == 1)
+        dmml_mpi_dist_tiles(M, nrhs, alpha, S->tiles_col,
+                S->tiles_col_start[nb_col], 'B');
+    MPI_Waitall(nb_in, request_send, MPI_STATUSES_IGNORE);
+    // Reduce result to output buffer of master OpenMP thread
+    #pragma omp parallel for schedule(static)
+    for(size_t i = 0; i < Y_size; i++)
+        for(int l = 1; l < num_threads; l++)
+            Y[i] += Y[l*Y_size+i];
+    // In symmetric case block columns of output are reduced within columns
+    // of process grid to the nodes in row `k%grid_ny`, that add them to
+    // block rows of output
+    if(symm == 'S')
+    {
+        nrequests = 0;
+        for(k = grid_x, t = 0; k < F->nbcols; k += grid_nx, t++)
+        {
+            int size = C->size[k];
+            double *y = Y+nrhs*(size_t)(len_row+offset_col[t]);
+            if(k%grid_ny == grid_y)
+                MPI_Ireduce(MPI_IN_PLACE, y, nrhs*size, MPI_DOUBLE, MPI_SUM,
+                        grid_y, S->splitx, request+nrequests++);
             else
+                MPI_Ireduce(y, NULL, nrhs*size, MPI_DOUBLE, MPI_SUM,
+                        k%grid_ny, S->splitx, request+nrequests++);
+        }
+        MPI_Waitall(nrequests, request, MPI_STATUSES_IGNORE);
+        for(k = grid_x, t = 0; k < F->nbcols; k += grid_nx, t++)
+            if(k%grid_ny == grid_y)
+                cblas_daxpy(nrhs*C->size[k], 1.0,
+                        Y+nrhs*(size_t)(len_row+offset_col[t]), 1,
+                        Y+nrhs*(size_t)offset_row[k/grid_ny], 1);
+    }
+    // Reduce block rows of output within rows of process grid to the nodes,
+    // that store them
+    nrequests = 0;
+    for(k = grid_y, t = 0; k < F->nbrows; k += grid_ny, t++)
+    {
+        int size = R->size[k];
+        double *y = Y+nrhs*(size_t)offset_row[t];
+        if(t%grid_nx == grid_x)
+            MPI_Ireduce(MPI_IN_PLACE, y, nrhs*size, MPI_DOUBLE, MPI_SUM,
+                    grid_x, S->splity, request+nrequests++);
+        else
+            MPI_Ireduce(y, NULL, nrhs*size, MPI_DOUBLE, MPI_SUM, t%grid_nx,
+                    S->splity, request+nrequests++);
+    }
+    MPI_Waitall(nrequests, request, MPI_STATUSES_IGNORE);
+    // Update local rows of output
+    local = 0;
+    for(k = grid_y, t = 0; k < F->nbrows; k += grid_ny, t++)
+    {
+        if(t%grid_nx != grid_x)
+            continue;
+        int size = R->size[k];
+        double *y = Y+nrhs*(size_t)offset_row[t];
+        for(int j = 0; j < nrhs; j++)
+        {
+            double *out = B+j*(size_t)ldb+local;
+            for(int i = 0; i < size; i++)
             {
-                int sendcount = 0;
-                if(grid_y < remain)
-                    sendcount = maxnb;
-                for(int j = 0; j < nrhs; j++)
-                    MPI_Gatherv(src+j*(size_t)ldout, sendcount, MPI_DOUBLE,
-                            NULL, NULL, NULL, MPI_DOUBLE, 0, mpi_leadingy);
+                if(beta == 0.)
+                    out[i] = y[j*(size_t)size+i];
+                else
+                    out[i] = beta*out[i]+y[j*(size_t)size+i];
             }
         }
-        MPI_Comm_free(&mpi_leadingy);
-        free(final_B);
+        local += size;
     }
-    if(mpi_leadingx != MPI_COMM_NULL)
-        MPI_Comm_free(&mpi_leadingx);
-    MPI_Comm_free(&mpi_splitx);
-    MPI_Comm_free(&mpi_splity);
-    free(temp_A);
-    free(temp_B);
-    free(temp_D);
     return STARSH_SUCCESS;
 }
+
+void starsh_blrm__dmml_mpi_tlr_free(STARSH_blrm *matrix)
+//! Free communicators and buffers of MPI multiplication of TLR matrix.
+/*! Releases plan, cached by @ref starsh_blrm__dmml_mpi_tlr() and @ref
+ * starsh_blrm__dmml_mpi_dist(). Called by @ref starsh_blrm_free_mpi(), so
+ * there is no need to call it directly, unless MPI is finalized before
+ * matrix is freed.
+ *
+ * @param[in,out] matrix: Pointer to @ref STARSH_blrm object.
+ * @ingroup blrm
+ * */
+{
+    struct starsh_dmml_mpi_plan *S = matrix->mpi_plan;
+    if(S == NULL)
+        return;
+    if(S->leadingx != MPI_COMM_NULL)
+        MPI_Comm_free(&S->leadingx);
+    if(S->leadingy != MPI_COMM_NULL)
+        MPI_Comm_free(&S->leadingy);
+    MPI_Comm_free(&S->splitx);
+    MPI_Comm_free(&S->splity);
+    free(S->counts_x);
+    free(S->displs_x);
+    free(S->counts_y);
+    free(S->displs_y);
+    free(S->temp_A);
+    free(S->temp_B);
+    free(S->temp_D);
+    free(S->final_B);
+    free(S->request);
+    free(S->tiles_col_start);
+    free(S->tiles_col);
+    free(S->tiles_row_start);
+    free(S->tiles_row);
+    free(S->dist_offset_row);
+    free(S->dist_offset_col);
+    free(S->dist_X);
+    free(S->dist_Y);
+    free(S->dist_D);
+    free(S->dist_request);
+    free(S->dist_done);
+    free(S);
+    matrix->mpi_plan = NULL;
+}
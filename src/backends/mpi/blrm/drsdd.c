@@ -41,16 +41,13 @@ int starsh_blrm__drsdd_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
     STARSH_problem *P = F->problem;
     STARSH_kernel *kernel = P->kernel;
     STARSH_int nblocks_far = F->nblocks_far;
-    STARSH_int nblocks_near = F->nblocks_near;
     STARSH_int nblocks_far_local = F->nblocks_far_local;
-    STARSH_int nblocks_near_local = F->nblocks_near_local;
     // Shortcuts to information about clusters
     STARSH_cluster *RC = F->row_cluster;
     STARSH_cluster *CC = F->col_cluster;
     void *RD = RC->data, *CD = CC->data;
     // Following values default to given block low-rank format F, but they are
     // changed when there are false far-field blocks.
-    STARSH_int new_nblocks_far = F->nblocks_far;
     STARSH_int new_nblocks_near = F->nblocks_near;
     STARSH_int new_nblocks_far_local = F->nblocks_far_local;
     STARSH_int new_nblocks_near_local = F->nblocks_near_local;
@@ -63,9 +60,19 @@ int starsh_blrm__drsdd_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
     int *far_rank = NULL;
     double *alloc_U = NULL, *alloc_V = NULL, *alloc_D = NULL;
     size_t offset_U = 0, offset_V = 0, offset_D = 0;
-    STARSH_int lbi, lbj, bi, bj = 0;
+    STARSH_int lbi;
     double drsdd_time = 0, kernel_time = 0;
     const int oversample = starsh_params.oversample;
+    const int poweriter = starsh_params.poweriter;
+    // Absolute tolerance of each far-field block for the entire matrix. Blocks
+    // with smaller norm are negligible and they are dropped.
+    double abstol = 0.;
+    if(nblocks_far > 0)
+    {
+        int info = starsh_blrm__dtol_mpi(F, tol, &abstol);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
     // Init buffers to store low-rank factors of far-field blocks if needed
     if(nblocks_far > 0)
     {
@@ -146,9 +153,21 @@ int starsh_blrm__drsdd_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
 #ifdef OPENMP
         double time1 = omp_get_wtime();
 #endif
-        starsh_dense_dlrrsdd(nrows, ncols, D, nrows, far_U[lbi]->data, nrows,
-                far_V[lbi]->data, ncols, far_rank+lbi, maxrank, oversample,
-                tol, work, lwork, iwork);
+        // Blocks with small norm are negligible and they get rank 0
+        double tile_norm = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows,
+                ncols, D, nrows, NULL);
+        if(tile_norm <= abstol)
+            far_rank[lbi] = 0;
+        else
+        {
+            // Relative tolerance of a block, if tolerance is global
+            double tile_tol = tol;
+            if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+                tile_tol = abstol/tile_norm;
+            starsh_dense_dlrrsdd(nrows, ncols, D, nrows, far_U[lbi]->data,
+                    nrows, far_V[lbi]->data, ncols, far_rank+lbi, maxrank,
+                    oversample, poweriter, tile_tol, work, lwork, iwork);
+        }
 #ifdef OPENMP
         double time2 = omp_get_wtime();
         #pragma omp critical
@@ -162,130 +181,18 @@ int starsh_blrm__drsdd_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
         free(work);
         free(iwork);
     }
-    // Get number of false far-field blocks
-    STARSH_int nblocks_false_far_local = 0;
-    STARSH_int *false_far_local = NULL;
-    for(lbi = 0; lbi < nblocks_far_local; lbi++)
-        if(far_rank[lbi] == -1)
-            nblocks_false_far_local++;
-    if(nblocks_false_far_local > 0)
-    {
-        // IMPORTANT: `false_far` and `false_far_local` must be in
-        // ascending order for later code to work normally
-        STARSH_MALLOC(false_far_local, nblocks_false_far_local);
-        lbj = 0;
-        for(lbi = 0; lbi < nblocks_far_local; lbi++)
-            if(far_rank[lbi] == -1)
-                false_far_local[lbj++] = block_far_local[lbi];
-    }
-    // Sync list of all false far-field blocks
-    STARSH_int nblocks_false_far = 0;
-    int int_nblocks_false_far_local = nblocks_false_far_local;
-    int *mpi_recvcount, *mpi_offset;
-    int mpi_size, mpi_rank;
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    // Turn false far-field blocks into near-field blocks and drop
+    // negligible far-field blocks with a single update of format
+    info = starsh_blrf_update_far_mpi(F, far_rank, far_U, far_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    new_nblocks_far_local = F->nblocks_far_local;
+    new_nblocks_near = F->nblocks_near;
+    new_nblocks_near_local = F->nblocks_near_local;
+    block_near = F->block_near;
+    block_near_local = F->block_near_local;
+    int mpi_rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    STARSH_MALLOC(mpi_recvcount, mpi_size);
-    STARSH_MALLOC(mpi_offset, mpi_size);
-    MPI_Allgather(&int_nblocks_false_far_local, 1, MPI_INT, mpi_recvcount,
-            1, MPI_INT, MPI_COMM_WORLD);
-    for(bi = 0; bi < mpi_size; bi++)
-        nblocks_false_far += mpi_recvcount[bi];
-    mpi_offset[0] = 0;
-    for(bi = 1; bi < mpi_size; bi++)
-        mpi_offset[bi] = mpi_offset[bi-1]+mpi_recvcount[bi-1];
-    STARSH_int *false_far = NULL;
-    if(nblocks_false_far > 0)
-        STARSH_MALLOC(false_far, nblocks_false_far);
-    MPI_Allgatherv(false_far_local, nblocks_false_far_local, my_MPI_SIZE_T,
-            false_far, mpi_recvcount, mpi_offset, my_MPI_SIZE_T,
-            MPI_COMM_WORLD);
-    free(mpi_recvcount);
-    free(mpi_offset);
-    // Make false_far be in ascending order
-    qsort(false_far, nblocks_false_far, sizeof(*false_far), cmp_size_t);
-    if(nblocks_false_far > 0)
-    {
-        // Update list of near-field blocks
-        new_nblocks_near = nblocks_near+nblocks_false_far;
-        new_nblocks_near_local = nblocks_near_local+nblocks_false_far_local;
-        STARSH_MALLOC(block_near, 2*new_nblocks_near);
-        if(new_nblocks_near_local > 0)
-            STARSH_MALLOC(block_near_local, new_nblocks_near_local);
-        // At first get all near-field blocks, assumed to be dense
-        #pragma omp parallel for schedule(static)
-        for(bi = 0; bi < 2*nblocks_near; bi++)
-            block_near[bi] = F->block_near[bi];
-        #pragma omp parallel for schedule(static)
-        for(lbi = 0; lbi < nblocks_near_local; lbi++)
-            block_near_local[lbi] = F->block_near_local[lbi];
-        // Add false far-field blocks
-        #pragma omp parallel for schedule(static)
-        for(bi = 0; bi < nblocks_false_far; bi++)
-        {
-            STARSH_int bj = false_far[bi];
-            block_near[2*(bi+nblocks_near)] = F->block_far[2*bj];
-            block_near[2*(bi+nblocks_near)+1] = F->block_far[2*bj+1];
-        }
-        bi = 0;
-        for(lbi = 0; lbi < nblocks_false_far_local; lbi++)
-        {
-            lbj = false_far_local[lbi];
-            while(bi < nblocks_false_far && false_far[bi] < lbj)
-                bi++;
-            block_near_local[nblocks_near_local+lbi] = nblocks_near+bi;
-        }
-        // Update list of far-field blocks
-        new_nblocks_far = nblocks_far-nblocks_false_far;
-        new_nblocks_far_local = nblocks_far_local-nblocks_false_far_local;
-        if(new_nblocks_far > 0)
-        {
-            STARSH_MALLOC(block_far, 2*new_nblocks_far);
-            if(new_nblocks_far_local > 0)
-                STARSH_MALLOC(block_far_local, new_nblocks_far_local);
-            bj = 0;
-            lbi = 0;
-            lbj = 0;
-            for(bi = 0; bi < nblocks_far; bi++)
-            {
-                // `false_far` must be in ascending order for this to work
-                if(bj < nblocks_false_far && false_far[bj] == bi)
-                {
-                    if(nblocks_false_far_local > lbj &&
-                            false_far_local[lbj] == bi)
-                    {
-                        lbi++;
-                        lbj++;
-                    }
-                    bj++;
-                }
-                else
-                {
-                    block_far[2*(bi-bj)] = F->block_far[2*bi];
-                    block_far[2*(bi-bj)+1] = F->block_far[2*bi+1];
-                    if(nblocks_far_local > lbi &&
-                            F->block_far_local[lbi] == bi)
-                    {
-                        block_far_local[lbi-lbj] = bi-bj;
-                        lbi++;
-                    }
-                }
-            }
-        }
-        // Update format by creating new format
-        STARSH_blrf *F2;
-        info = starsh_blrf_new_from_coo_mpi(&F2, P, F->symm, RC, CC,
-                new_nblocks_far, block_far, new_nblocks_far_local,
-                block_far_local, new_nblocks_near, block_near,
-                new_nblocks_near_local, block_near_local, F->type);
-        // Swap internal data of formats and free unnecessary data
-        STARSH_blrf tmp_blrf = *F;
-        *F = *F2;
-        *F2 = tmp_blrf;
-        if(mpi_rank == 0)
-            STARSH_WARNING("`F` was modified due to false far-field blocks");
-        starsh_blrf_free(F2);
-    }
     // Compute near-field blocks if needed
     if(onfly == 0 && new_nblocks_near > 0)
     {
@@ -338,31 +245,13 @@ int starsh_blrm__drsdd_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
 #endif
         }
     }
-    // Change sizes of far_rank, far_U and far_V if there were false
-    // far-field blocks
-    lbj = 0;
-    for(lbi = 0; lbi < nblocks_far_local; lbi++)
-    {
-        if(far_rank[lbi] == -1)
-            lbj++;
-        else
-        {
-            int shape_U[2] = {far_U[lbi]->shape[0], far_rank[lbi]};
-            int shape_V[2] = {far_V[lbi]->shape[0], far_rank[lbi]};
-            array_from_buffer(far_U+lbi-lbj, 2, shape_U, 'd', 'F',
-                    far_U[lbi]->data);
-            array_from_buffer(far_V+lbi-lbj, 2, shape_V, 'd', 'F',
-                    far_V[lbi]->data);
-            far_rank[lbi-lbj] = far_rank[lbi];
-        }
-    }
-    if(nblocks_false_far_local > 0 && new_nblocks_far_local > 0)
-    {
-        STARSH_REALLOC(far_rank, new_nblocks_far_local);
-        STARSH_REALLOC(far_U, new_nblocks_far_local);
-        STARSH_REALLOC(far_V, new_nblocks_far_local);
-    }
-    // If all far-field blocks are false, then dealloc buffers
+    // Store only actual ranks of low-rank factors of remaining far-field
+    // blocks
+    info = starsh_blrm_pack_far(new_nblocks_far_local, far_rank, far_U, far_V,
+            (void **)&alloc_U, (void **)&alloc_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // If all local far-field blocks were removed, then dealloc buffers
     if(new_nblocks_far_local == 0 && nblocks_far_local > 0)
     {
         block_far = NULL;
@@ -377,11 +266,6 @@ int starsh_blrm__drsdd_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
         free(alloc_V);
         alloc_V = NULL;
     }
-    // Dealloc list of false far-field blocks if it is not empty
-    if(nblocks_false_far > 0)
-        free(false_far);
-    if(nblocks_false_far_local > 0)
-        free(false_far_local);
     // Finish with creating instance of Block Low-Rank Matrix with given
     // buffers
 #ifdef OPENMP
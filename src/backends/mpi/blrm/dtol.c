@@ -0,0 +1,87 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/mpi/blrm/dtol.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-mpi.h"
+
+int starsh_blrm__dtol_mpi(STARSH_blrf *format, double tol, double *abstol)
+//! Absolute tolerance of each far-field tile for given global tolerance.
+/*! MPI version of starsh_blrm__dtol(). Each MPI node samples only its local
+ * tiles and the result is gathered on all nodes.
+ *
+ * @param[in] format: Block low-rank format.
+ * @param[in] tol: Relative error tolerance for the entire matrix.
+ * @param[out] abstol: Absolute error tolerance for each far-field tile.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_int nblocks_far_local = F->nblocks_far_local;
+    STARSH_int nblocks_near_local = F->nblocks_near_local;
+    STARSH_int lbi, *block_far, *block_near;
+    double value[3];
+    int info = STARSH_SUCCESS;
+    *abstol = 0.;
+    // Get coordinates of local far-field and near-field blocks
+    STARSH_MALLOC(block_far, 2*(nblocks_far_local+nblocks_near_local)+1);
+    block_near = block_far+2*nblocks_far_local;
+    for(lbi = 0; lbi < nblocks_far_local; lbi++)
+    {
+        STARSH_int bi = F->block_far_local[lbi];
+        block_far[2*lbi] = F->block_far[2*bi];
+        block_far[2*lbi+1] = F->block_far[2*bi+1];
+    }
+    for(lbi = 0; lbi < nblocks_near_local; lbi++)
+    {
+        STARSH_int bi = F->block_near_local[lbi];
+        block_near[2*lbi] = F->block_near[2*bi];
+        block_near[2*lbi+1] = F->block_near[2*bi+1];
+    }
+    double norm = 0., nfar = 0.;
+    #pragma omp parallel reduction(+:norm,nfar)
+    {
+        int tid = 0, nthreads = 1;
+#ifdef OPENMP
+        tid = omp_get_thread_num();
+        nthreads = omp_get_num_threads();
+#endif
+        double norm_far, norm_near, nnear;
+        int tinfo = starsh_blrm__dnorm_sample(F, nblocks_far_local,
+                block_far, tid, nthreads, &norm_far, &nfar);
+        if(tinfo == STARSH_SUCCESS)
+            tinfo = starsh_blrm__dnorm_sample(F, nblocks_near_local,
+                    block_near, tid, nthreads, &norm_near, &nnear);
+        if(tinfo != STARSH_SUCCESS)
+        {
+            #pragma omp atomic write
+            info = tinfo;
+        }
+        else
+            norm += norm_far+norm_near;
+    }
+    free(block_far);
+    // All nodes take part in reduction and learn about failure of any node
+    value[0] = norm;
+    value[1] = nfar;
+    value[2] = info != STARSH_SUCCESS;
+    MPI_Allreduce(MPI_IN_PLACE, value, 3, MPI_DOUBLE, MPI_SUM,
+            MPI_COMM_WORLD);
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(value[2] > 0)
+        return STARSH_UNKNOWN_ERROR;
+    if(value[1] > 0)
+        *abstol = tol*sqrt(value[0]/value[1]);
+    return STARSH_SUCCESS;
+}
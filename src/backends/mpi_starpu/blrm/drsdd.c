@@ -31,16 +31,13 @@ int starsh_blrm__drsdd_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
     STARSH_problem *P = F->problem;
     STARSH_kernel *kernel = P->kernel;
     STARSH_int nblocks_far = F->nblocks_far;
-    STARSH_int nblocks_near = F->nblocks_near;
     STARSH_int nblocks_far_local = F->nblocks_far_local;
-    STARSH_int nblocks_near_local = F->nblocks_near_local;
     // Shortcuts to information about clusters
     STARSH_cluster *RC = F->row_cluster;
     STARSH_cluster *CC = F->col_cluster;
     void *RD = RC->data, *CD = CC->data;
     // Following values default to given block low-rank format F, but they are
     // changed when there are false far-field blocks.
-    STARSH_int new_nblocks_far = F->nblocks_far;
     STARSH_int new_nblocks_near = F->nblocks_near;
     STARSH_int new_nblocks_far_local = F->nblocks_far_local;
     STARSH_int new_nblocks_near_local = F->nblocks_near_local;
@@ -53,28 +50,49 @@ int starsh_blrm__drsdd_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
     int *far_rank = NULL;
     double *alloc_U = NULL, *alloc_V = NULL, *alloc_D = NULL;
     size_t offset_U = 0, offset_V = 0, offset_D = 0;
-    STARSH_int lbi, lbj, bi, bj = 0;
+    STARSH_int lbi;
     struct starpu_codelet codelet =
     {
         .cpu_funcs = {starsh_dense_dlrrsdd_starpu},
-        .nbuffers = 6,
-        .modes = {STARPU_R, STARPU_W, STARPU_W, STARPU_W, STARPU_SCRATCH,
-            STARPU_SCRATCH}
+        .nbuffers = 7,
+        .modes = {STARPU_R, STARPU_W, STARPU_W, STARPU_W, STARPU_RW,
+            STARPU_SCRATCH, STARPU_SCRATCH},
+        .model = &starsh_dense_dlrrsdd_starpu_model
     };
     struct starpu_codelet codelet2 =
     {
         .cpu_funcs = {starsh_dense_kernel_starpu},
         .nbuffers = 2,
-        .modes = {STARPU_R, STARPU_W}
+        .modes = {STARPU_R, STARPU_W},
+        .model = &starsh_dense_kernel_starpu_model
     };
-    STARSH_int bi_value[nblocks_far_local];
-    starpu_data_handle_t bi_handle[nblocks_far_local];
-    starpu_data_handle_t rank_handle[nblocks_far_local];
-    starpu_data_handle_t U_handle[nblocks_far_local];
-    starpu_data_handle_t V_handle[nblocks_far_local];
-    starpu_data_handle_t work_handle[nblocks_far_local];
-    starpu_data_handle_t iwork_handle[nblocks_far_local];
+    struct starpu_codelet codelet_far =
+    {
+        .cpu_funcs = {starsh_dense_kernel_far_starpu},
+        .nbuffers = 2,
+        .modes = {STARPU_R, STARPU_W},
+        .model = &starsh_dense_kernel_far_starpu_model
+    };
+    // Tiles are submitted in windows of at most `window` tiles. Factors and
+    // dense tiles of a window are registered as a single vector, partitioned
+    // into tiles, so that number of registered handles does not depend on
+    // number of tiles.
+    const STARSH_int window = 1024;
+    STARSH_int *bi_value = NULL;
+    starpu_data_handle_t U_handle[2], V_handle[2];
+    starpu_data_handle_t work_handle, iwork_handle;
+    int lwork_max = 0, liwork_max = 0;
     const int oversample = starsh_params.oversample;
+    const int poweriter = starsh_params.poweriter;
+    // Absolute tolerance of each far-field block for the entire matrix. Blocks
+    // with smaller norm are negligible and they are dropped.
+    double abstol = 0.;
+    if(nblocks_far > 0)
+    {
+        int info = starsh_blrm__dtol_mpi(F, tol, &abstol);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
     // Init buffers to store low-rank factors of far-field blocks if needed
     if(nblocks_far_local > 0)
     {
@@ -113,7 +131,7 @@ int starsh_blrm__drsdd_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
             int lwork = ncols, lwork_sdd = (4*mn2+7)*mn2;
             if(lwork_sdd > lwork)
                 lwork = lwork_sdd;
-            lwork += nrows*ncols+mn2*(2*ncols+nrows+mn2+1);
+            lwork += mn2*(2*ncols+nrows+mn2+1);
             int liwork = 8*mn2;
             int shape_U[] = {nrows, maxrank};
             int shape_V[] = {ncols, maxrank};
@@ -122,173 +140,129 @@ int starsh_blrm__drsdd_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
             offset_V += ncols*maxrank;
             array_from_buffer(far_U+lbi, 2, shape_U, 'd', 'F', U);
             array_from_buffer(far_V+lbi, 2, shape_V, 'd', 'F', V);
-            bi_value[lbi] = bi;
-            starpu_variable_data_register(bi_handle+lbi, STARPU_MAIN_RAM,
-                    (uintptr_t)(bi_value+lbi), sizeof(*bi_value));
-            starpu_variable_data_register(rank_handle+lbi, STARPU_MAIN_RAM,
-                    (uintptr_t)(far_rank+lbi), sizeof(*far_rank));
-            starpu_vector_data_register(U_handle+lbi, STARPU_MAIN_RAM,
-                    (uintptr_t)(far_U[lbi]->data), nrows*maxrank, sizeof(*U));
-            starpu_vector_data_register(V_handle+lbi, STARPU_MAIN_RAM,
-                    (uintptr_t)(far_V[lbi]->data), ncols*maxrank, sizeof(*V));
-            starpu_vector_data_register(work_handle+lbi, -1, 0, lwork,
-                    sizeof(*U));
-            starpu_vector_data_register(iwork_handle+lbi, -1, 0, liwork,
-                    sizeof(int));
+            if(lwork > lwork_max)
+                lwork_max = lwork;
+            if(liwork > liwork_max)
+                liwork_max = liwork;
         }
         offset_U = 0;
         offset_V = 0;
+        STARSH_MALLOC(bi_value, nblocks_far_local);
+        // Temporary buffers are shared by all tiles
+        starpu_vector_data_register(&work_handle, -1, 0, lwork_max,
+                sizeof(*alloc_U));
+        starpu_vector_data_register(&iwork_handle, -1, 0, liwork_max,
+                sizeof(int));
     }
     // Work variables
     int info;
-    // Simple cycle over all far-field admissible blocks
-    for(lbi = 0; lbi < nblocks_far_local; lbi++)
+    int k = 0;
+    STARSH_int w0, w1;
+    // Cycle over windows of far-field admissible blocks
+    for(w0 = 0; w0 < nblocks_far_local; w0 = w1)
     {
-        starpu_task_insert(&codelet, STARPU_VALUE, &F, sizeof(F),
-                STARPU_VALUE, &maxrank, sizeof(maxrank),
-                STARPU_VALUE, &oversample, sizeof(oversample),
-                STARPU_VALUE, &tol, sizeof(tol),
-                STARPU_R, bi_handle[lbi], STARPU_W, rank_handle[lbi],
-                STARPU_W, U_handle[lbi], STARPU_W, V_handle[lbi],
-                STARPU_SCRATCH, work_handle[lbi],
-                STARPU_SCRATCH, iwork_handle[lbi],
-                0);
-        starpu_data_unregister_submit(bi_handle[lbi]);
-        starpu_data_unregister_submit(rank_handle[lbi]);
-        starpu_data_unregister_submit(U_handle[lbi]);
-        starpu_data_unregister_submit(V_handle[lbi]);
-        starpu_data_unregister_submit(work_handle[lbi]);
-        starpu_data_unregister_submit(iwork_handle[lbi]);
-    }
-    starpu_task_wait_for_all();
-    // Get number of false far-field blocks
-    STARSH_int nblocks_false_far_local = 0;
-    STARSH_int *false_far_local = NULL;
-    for(lbi = 0; lbi < nblocks_far_local; lbi++)
-        if(far_rank[lbi] == -1)
-            nblocks_false_far_local++;
-    if(nblocks_false_far_local > 0)
-    {
-        // IMPORTANT: `false_far` and `false_far_local` must be in
-        // ascending order for later code to work normally
-        STARSH_MALLOC(false_far_local, nblocks_false_far_local);
-        lbj = 0;
-        for(lbi = 0; lbi < nblocks_far_local; lbi++)
-            if(far_rank[lbi] == -1)
-                false_far_local[lbj++] = block_far_local[lbi];
-    }
-    // Sync list of all false far-field blocks
-    STARSH_int nblocks_false_far = 0;
-    int int_nblocks_false_far_local = nblocks_false_far_local;
-    int *mpi_recvcount, *mpi_offset;
-    int mpi_size, mpi_rank;
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    STARSH_MALLOC(mpi_recvcount, mpi_size);
-    STARSH_MALLOC(mpi_offset, mpi_size);
-    MPI_Allgather(&int_nblocks_false_far_local, 1, MPI_INT, mpi_recvcount,
-            1, MPI_INT, MPI_COMM_WORLD);
-    for(bi = 0; bi < mpi_size; bi++)
-        nblocks_false_far += mpi_recvcount[bi];
-    mpi_offset[0] = 0;
-    for(bi = 1; bi < mpi_size; bi++)
-        mpi_offset[bi] = mpi_offset[bi-1]+mpi_recvcount[bi-1];
-    STARSH_int *false_far = NULL;
-    if(nblocks_false_far > 0)
-        STARSH_MALLOC(false_far, nblocks_false_far);
-    MPI_Allgatherv(false_far_local, nblocks_false_far_local, my_MPI_SIZE_T,
-            false_far, mpi_recvcount, mpi_offset, my_MPI_SIZE_T,
-            MPI_COMM_WORLD);
-    free(mpi_recvcount);
-    free(mpi_offset);
-    // Make false_far be in ascending order
-    qsort(false_far, nblocks_false_far, sizeof(*false_far), cmp_size_t);
-    if(nblocks_false_far > 0)
-    {
-        // Update list of near-field blocks
-        new_nblocks_near = nblocks_near+nblocks_false_far;
-        new_nblocks_near_local = nblocks_near_local+nblocks_false_far_local;
-        STARSH_MALLOC(block_near, 2*new_nblocks_near);
-        if(new_nblocks_near_local > 0)
-            STARSH_MALLOC(block_near_local, new_nblocks_near_local);
-        // At first get all near-field blocks, assumed to be dense
-        for(bi = 0; bi < 2*nblocks_near; bi++)
-            block_near[bi] = F->block_near[bi];
-        for(lbi = 0; lbi < nblocks_near_local; lbi++)
-            block_near_local[lbi] = F->block_near_local[lbi];
-        // Add false far-field blocks
-        for(bi = 0; bi < nblocks_false_far; bi++)
+        // Get window, that fits into a single vector
+        size_t slice_U = 0, slice_V = 0;
+        for(w1 = w0; w1 < nblocks_far_local && w1-w0 < window; w1++)
         {
-            STARSH_int bj = false_far[bi];
-            block_near[2*(bi+nblocks_near)] = F->block_far[2*bj];
-            block_near[2*(bi+nblocks_near)+1] = F->block_far[2*bj+1];
+            if(w1 > w0 && (slice_U+far_U[w1]->size > UINT32_MAX ||
+                        slice_V+far_V[w1]->size > UINT32_MAX))
+                break;
+            slice_U += far_U[w1]->size;
+            slice_V += far_V[w1]->size;
         }
-        bi = 0;
-        for(lbi = 0; lbi < nblocks_false_far_local; lbi++)
+        struct starpu_data_filter U_filter =
+        {
+            .filter_func = starsh_dense_tile_filter_starpu,
+            .nchildren = w1-w0,
+            .filter_arg_ptr = far_U+w0
+        };
+        struct starpu_data_filter V_filter =
+        {
+            .filter_func = starsh_dense_tile_filter_starpu,
+            .nchildren = w1-w0,
+            .filter_arg_ptr = far_V+w0
+        };
+        starpu_vector_data_register(U_handle+k, STARPU_MAIN_RAM,
+                (uintptr_t)(far_U[w0]->data), slice_U, sizeof(*alloc_U));
+        starpu_vector_data_register(V_handle+k, STARPU_MAIN_RAM,
+                (uintptr_t)(far_V[w0]->data), slice_V, sizeof(*alloc_V));
+        starpu_data_partition(U_handle[k], &U_filter);
+        starpu_data_partition(V_handle[k], &V_filter);
+        for(lbi = w0; lbi < w1; lbi++)
         {
-            lbj = false_far_local[lbi];
-            while(bi < nblocks_false_far && false_far[bi] < lbj)
-                bi++;
-            block_near_local[nblocks_near_local+lbi] = nblocks_near+bi;
+            starpu_data_handle_t bi_handle, rank_handle, D_handle;
+            bi_value[lbi] = block_far_local[lbi];
+            starpu_variable_data_register(&bi_handle, STARPU_MAIN_RAM,
+                    (uintptr_t)(bi_value+lbi), sizeof(*bi_value));
+            starpu_variable_data_register(&rank_handle, STARPU_MAIN_RAM,
+                    (uintptr_t)(far_rank+lbi), sizeof(*far_rank));
+            // Elements of a tile are stored in a temporary buffer
+            starpu_vector_data_register(&D_handle, -1, 0,
+                    far_U[lbi]->shape[0]*(size_t)far_V[lbi]->shape[0],
+                    sizeof(*alloc_U));
+            starpu_task_insert(&codelet_far, STARPU_VALUE, &F, sizeof(F),
+                    STARPU_PRIORITY, STARPU_DEFAULT_PRIO,
+                    STARPU_R, bi_handle, STARPU_W, D_handle, 0);
+            // Compression is prioritized over generation, so that generated
+            // tiles do not pile up in memory
+            starpu_task_insert(&codelet,
+                    STARPU_PRIORITY, STARPU_DEFAULT_PRIO+1,
+                    STARPU_VALUE, &F, sizeof(F),
+                    STARPU_VALUE, &maxrank, sizeof(maxrank),
+                    STARPU_VALUE, &oversample, sizeof(oversample),
+                    STARPU_VALUE, &poweriter, sizeof(poweriter),
+                    STARPU_VALUE, &tol, sizeof(tol),
+                    STARPU_VALUE, &abstol, sizeof(abstol),
+                    STARPU_R, bi_handle, STARPU_W, rank_handle,
+                    STARPU_W, starpu_data_get_child(U_handle[k], lbi-w0),
+                    STARPU_W, starpu_data_get_child(V_handle[k], lbi-w0),
+                    STARPU_RW, D_handle, STARPU_SCRATCH, work_handle,
+                    STARPU_SCRATCH, iwork_handle,
+                    0);
+            starpu_data_unregister_submit(bi_handle);
+            starpu_data_unregister_submit(rank_handle);
+            starpu_data_unregister_submit(D_handle);
         }
-        // Update list of far-field blocks
-        new_nblocks_far = nblocks_far-nblocks_false_far;
-        new_nblocks_far_local = nblocks_far_local-nblocks_false_far_local;
-        if(new_nblocks_far > 0)
+        // Gather previous window, while tasks of current window are executed
+        k = 1-k;
+        if(w0 > 0)
         {
-            STARSH_MALLOC(block_far, 2*new_nblocks_far);
-            if(new_nblocks_far_local > 0)
-                STARSH_MALLOC(block_far_local, new_nblocks_far_local);
-            bj = 0;
-            lbi = 0;
-            lbj = 0;
-            for(bi = 0; bi < nblocks_far; bi++)
-            {
-                // `false_far` must be in ascending order for this to work
-                if(bj < nblocks_false_far && false_far[bj] == bi)
-                {
-                    if(nblocks_false_far_local > lbj &&
-                            false_far_local[lbj] == bi)
-                    {
-                        lbi++;
-                        lbj++;
-                    }
-                    bj++;
-                }
-                else
-                {
-                    block_far[2*(bi-bj)] = F->block_far[2*bi];
-                    block_far[2*(bi-bj)+1] = F->block_far[2*bi+1];
-                    if(nblocks_far_local > lbi &&
-                            F->block_far_local[lbi] == bi)
-                    {
-                        block_far_local[lbi-lbj] = bi-bj;
-                        lbi++;
-                    }
-                }
-            }
+            starpu_data_unpartition(U_handle[k], STARPU_MAIN_RAM);
+            starpu_data_unpartition(V_handle[k], STARPU_MAIN_RAM);
+            starpu_data_unregister(U_handle[k]);
+            starpu_data_unregister(V_handle[k]);
         }
-        // Update format by creating new format
-        STARSH_blrf *F2;
-        info = starsh_blrf_new_from_coo_mpi(&F2, P, F->symm, RC, CC,
-                new_nblocks_far, block_far, new_nblocks_far_local,
-                block_far_local, new_nblocks_near, block_near,
-                new_nblocks_near_local, block_near_local, F->type);
-        // Swap internal data of formats and free unnecessary data
-        STARSH_blrf tmp_blrf = *F;
-        *F = *F2;
-        *F2 = tmp_blrf;
-        if(mpi_rank == 0)
-            STARSH_WARNING("`F` was modified due to false far-field blocks");
-        starsh_blrf_free(F2);
     }
+    if(nblocks_far_local > 0)
+    {
+        k = 1-k;
+        starpu_data_unpartition(U_handle[k], STARPU_MAIN_RAM);
+        starpu_data_unpartition(V_handle[k], STARPU_MAIN_RAM);
+        starpu_data_unregister(U_handle[k]);
+        starpu_data_unregister(V_handle[k]);
+        starpu_data_unregister_submit(work_handle);
+        starpu_data_unregister_submit(iwork_handle);
+    }
+    starpu_task_wait_for_all();
+    free(bi_value);
+    // Turn false far-field blocks into near-field blocks and drop
+    // negligible far-field blocks with a single update of format
+    info = starsh_blrf_update_far_mpi(F, far_rank, far_U, far_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    new_nblocks_far_local = F->nblocks_far_local;
+    new_nblocks_near = F->nblocks_near;
+    new_nblocks_near_local = F->nblocks_near_local;
+    block_near = F->block_near;
+    block_near_local = F->block_near_local;
     // Compute near-field blocks if needed
     if(onfly == 0 && new_nblocks_near > 0)
     {
-        STARSH_int nbi_value[new_nblocks_near_local];
-        starpu_data_handle_t D_handle[new_nblocks_near_local];
-        starpu_data_handle_t nbi_handle[new_nblocks_near_local];
+        STARSH_int *nbi_value;
+        starpu_data_handle_t D_handle[2];
         STARSH_MALLOC(near_D, new_nblocks_near_local);
+        STARSH_MALLOC(nbi_value, new_nblocks_near_local);
         size_t size_D = 0;
         // Simple cycle over all near-field blocks
         for(lbi = 0; lbi < new_nblocks_near_local; lbi++)
@@ -319,49 +293,72 @@ int starsh_blrm__drsdd_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
             D = alloc_D+offset_D;
             offset_D += nrows*ncols;
             array_from_buffer(near_D+lbi, 2, shape, 'd', 'F', D);
-            nbi_value[lbi] = bi;
-            starpu_variable_data_register(nbi_handle+lbi, STARPU_MAIN_RAM,
-                    (uintptr_t)(nbi_value+lbi), sizeof(*nbi_value));
-            starpu_vector_data_register(D_handle+lbi, STARPU_MAIN_RAM,
-                    (uintptr_t)(near_D[lbi]->data),
-                    (size_t)nrows*(size_t)ncols, sizeof(*D));
         }
-        for(lbi = 0; lbi < new_nblocks_near_local; lbi++)
+        k = 0;
+        // Cycle over windows of near-field blocks
+        for(w0 = 0; w0 < new_nblocks_near_local; w0 = w1)
         {
-            starpu_task_insert(&codelet2, STARPU_VALUE, &F, sizeof(F),
-                    STARPU_R, nbi_handle[lbi], STARPU_W, D_handle[lbi],
-                    0);
-            starpu_data_unregister_submit(nbi_handle[lbi]);
-            starpu_data_unregister_submit(D_handle[lbi]);
+            // Get window, that fits into a single vector
+            size_t slice_D = 0;
+            for(w1 = w0; w1 < new_nblocks_near_local && w1-w0 < window; w1++)
+            {
+                if(w1 > w0 && slice_D+near_D[w1]->size > UINT32_MAX)
+                    break;
+                slice_D += near_D[w1]->size;
+            }
+            struct starpu_data_filter D_filter =
+            {
+                .filter_func = starsh_dense_tile_filter_starpu,
+                .nchildren = w1-w0,
+                .filter_arg_ptr = near_D+w0
+            };
+            starpu_vector_data_register(D_handle+k, STARPU_MAIN_RAM,
+                    (uintptr_t)(near_D[w0]->data), slice_D,
+                    sizeof(*alloc_D));
+            starpu_data_partition(D_handle[k], &D_filter);
+            for(lbi = w0; lbi < w1; lbi++)
+            {
+                starpu_data_handle_t nbi_handle;
+                nbi_value[lbi] = block_near_local[lbi];
+                // Diagonal tiles are on the critical path of factorizations
+                int prio = STARPU_DEFAULT_PRIO;
+                if(block_near[2*nbi_value[lbi]] ==
+                        block_near[2*nbi_value[lbi]+1])
+                    prio = STARPU_MAX_PRIO;
+                starpu_variable_data_register(&nbi_handle, STARPU_MAIN_RAM,
+                        (uintptr_t)(nbi_value+lbi), sizeof(*nbi_value));
+                starpu_task_insert(&codelet2, STARPU_VALUE, &F, sizeof(F),
+                        STARPU_PRIORITY, prio,
+                        STARPU_R, nbi_handle,
+                        STARPU_W, starpu_data_get_child(D_handle[k], lbi-w0),
+                        0);
+                starpu_data_unregister_submit(nbi_handle);
+            }
+            // Gather previous window, while tasks of current window are
+            // executed
+            k = 1-k;
+            if(w0 > 0)
+            {
+                starpu_data_unpartition(D_handle[k], STARPU_MAIN_RAM);
+                starpu_data_unregister(D_handle[k]);
+            }
         }
-        // Wait in this scope, because all handles are not visible outside
-        starpu_task_wait_for_all();
-    }
-    // Change sizes of far_rank, far_U and far_V if there were false
-    // far-field blocks
-    lbj = 0;
-    for(lbi = 0; lbi < nblocks_far_local; lbi++)
-    {
-        if(far_rank[lbi] == -1)
-            lbj++;
-        else
+        if(new_nblocks_near_local > 0)
         {
-            int shape_U[2] = {far_U[lbi]->shape[0], far_rank[lbi]};
-            int shape_V[2] = {far_V[lbi]->shape[0], far_rank[lbi]};
-            array_from_buffer(far_U+lbi-lbj, 2, shape_U, 'd', 'F',
-                    far_U[lbi]->data);
-            array_from_buffer(far_V+lbi-lbj, 2, shape_V, 'd', 'F',
-                    far_V[lbi]->data);
-            far_rank[lbi-lbj] = far_rank[lbi];
+            k = 1-k;
+            starpu_data_unpartition(D_handle[k], STARPU_MAIN_RAM);
+            starpu_data_unregister(D_handle[k]);
         }
+        starpu_task_wait_for_all();
+        free(nbi_value);
     }
-    if(nblocks_false_far_local > 0 && new_nblocks_far_local > 0)
-    {
-        STARSH_REALLOC(far_rank, new_nblocks_far_local);
-        STARSH_REALLOC(far_U, new_nblocks_far_local);
-        STARSH_REALLOC(far_V, new_nblocks_far_local);
-    }
-    // If all far-field blocks are false, then dealloc buffers
+    // Store only actual ranks of low-rank factors of remaining far-field
+    // blocks
+    info = starsh_blrm_pack_far(new_nblocks_far_local, far_rank, far_U, far_V,
+            (void **)&alloc_U, (void **)&alloc_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // If all local far-field blocks were removed, then dealloc buffers
     if(new_nblocks_far_local == 0 && nblocks_far_local > 0)
     {
         block_far = NULL;
@@ -376,11 +373,6 @@ int starsh_blrm__drsdd_mpi_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
         free(alloc_V);
         alloc_V = NULL;
     }
-    // Dealloc list of false far-field blocks if it is not empty
-    if(nblocks_false_far > 0)
-        free(false_far);
-    if(nblocks_false_far_local > 0)
-        free(false_far_local);
     // Finish with creating instance of Block Low-Rank Matrix with given
     // buffers
     return starsh_blrm_new_mpi(matrix, F, far_rank, far_U, far_V, onfly,
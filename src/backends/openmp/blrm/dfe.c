@@ -56,8 +56,6 @@ double starsh_blrm__dfe_omp(STARSH_blrm *matrix)
         STARSH_int j = F->block_far[2*bi+1];
         int nrows = R->size[i];
         int ncols = C->size[j];
-        // Rank of a block
-        int rank = M->far_rank[bi];
         // Temporary array for more precise dnrm2
         double *D, D_norm[ncols];
         size_t D_size = (size_t)nrows*(size_t)ncols;
@@ -71,9 +69,25 @@ double starsh_blrm__dfe_omp(STARSH_blrm *matrix)
         double tmpnorm = cblas_dnrm2(ncols, D_norm, 1);
         far_block_norm[bi] = tmpnorm;
         // Get difference of initial and approximated block
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
-                rank, -1., U[bi]->data, nrows, V[bi]->data, ncols, 1.,
-                D, nrows);
+        if(M->uniform == 0)
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
+                    M->far_rank[bi], -1., U[bi]->data, nrows, V[bi]->data,
+                    ncols, 1., D, nrows);
+        else if(M->far_S[bi]->shape[0] > 0 && M->far_S[bi]->shape[1] > 0)
+        {
+            // Approximation is a product of shared bases and coupling matrix
+            int rank_U = M->far_S[bi]->shape[0];
+            int rank_V = M->far_S[bi]->shape[1];
+            double *tmp;
+            STARSH_PMALLOC(tmp, (size_t)nrows*rank_V, info);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    rank_V, rank_U, 1., M->row_U[i]->data, nrows,
+                    M->far_S[bi]->data, rank_U, 0., tmp, nrows);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
+                    rank_V, -1., tmp, nrows, M->col_V[j]->data, ncols, 1.,
+                    D, nrows);
+            free(tmp);
+        }
         // Compute Frobenius norm of the latter
         for(size_t k = 0; k < ncols; k++)
             D_norm[k] = cblas_dnrm2(nrows, D+k*nrows, 1);
@@ -140,9 +154,32 @@ double starsh_blrm__dfe_omp(STARSH_blrm *matrix)
     if(info != 0)
         return -1; // Need to rework this, since returned value is double,
                     // not error code
+    // Blocks, dropped as numerical zeros, add to both error and norm
+    STARSH_int nblocks_drop, *block_drop;
+    double drop_norm2 = 0;
+    if(starsh_blrf_get_dropped(F, &nblocks_drop, &block_drop)
+            != STARSH_SUCCESS)
+        return -1;
+    if(nblocks_drop > 0)
+    {
+        #pragma omp parallel reduction(+:drop_norm2)
+        {
+            double tmp = 0;
+            if(starsh_blrm__dnorm_dropped(F, nblocks_drop, block_drop,
+                        omp_get_thread_num(), omp_get_num_threads(), &tmp)
+                    != STARSH_SUCCESS)
+                info = STARSH_MALLOC_ERROR;
+            drop_norm2 += tmp;
+        }
+        free(block_drop);
+        if(info != 0)
+            return -1;
+    }
     // Get difference of initial and approximated matrices
     double diff = cblas_dnrm2(nblocks_far, far_block_diff, 1);
     // Get norm of initial matrix
     double norm = cblas_dnrm2(nblocks, block_norm, 1);
+    diff = sqrt(diff*diff+drop_norm2);
+    norm = sqrt(norm*norm+drop_norm2);
     return diff/norm;
 }
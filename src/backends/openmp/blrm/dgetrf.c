@@ -0,0 +1,194 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/openmp/blrm/dgetrf.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dgetrf_omp(STARSH_blrm **factor, int *ipiv,
+        STARSH_blrm *matrix, int maxrank, double tol)
+//! TLR LU factorization of a square matrix.
+/*! OpenMP version of starsh_blrm__dgetrf(). Each operation on a tile is an
+ * OpenMP task, and dependencies between tasks are set by tiles of factor,
+ * that are read or updated, so operations of different steps of
+ * factorization overlap.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[out] ipiv: Array of pivot indices or NULL.
+ * @param[in] matrix: TLR matrix.
+ * @param[in] maxrank: Maximum possible rank of tiles of factor.
+ * @param[in] tol: Relative error tolerance for tiles of factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dgetrf(), starsh_blrm__dgetrs_omp().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L;
+    int info = starsh_blrm__dfactor_init(&L, matrix, 'N', maxrank, tol);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows, nlimited = 0;
+    // Dummy array to set dependencies between tasks, element `i*nb+j`
+    // corresponds to tile in block row `i` and block column `j`
+    char *dep;
+    STARSH_MALLOC(dep, nb*nb);
+    #pragma omp parallel
+    #pragma omp master
+    for(STARSH_int k = 0; k < nb; k++)
+    {
+        STARSH_int kk = k*nb+k;
+        int nk = R->size[k];
+        double *Dkk = L->near_D[k]->data;
+        int *ipivk = ipiv == NULL ? NULL : ipiv+R->start[k];
+        // Factorize diagonal tile
+        #pragma omp task depend(inout: dep[kk])
+        {
+            int tinfo;
+            #pragma omp atomic read
+            tinfo = info;
+            if(tinfo == 0 && starsh_dense_dgetrf(nk, Dkk, nk, ipivk) != 0)
+            {
+                STARSH_ERROR("Diagonal tile %zu is singular", (size_t)k);
+                #pragma omp atomic write
+                info = STARSH_SINGULAR_MATRIX;
+            }
+        }
+        // Apply row interchanges to all tiles of current block row and solve
+        // for tiles to the right of diagonal one
+        for(STARSH_int j = 0; j < nb; j++)
+        {
+            if(j == k)
+                continue;
+            STARSH_int bkj = k*(nb-1)+(j < k ? j : j-1);
+            #pragma omp task depend(in: dep[kk]) depend(inout: dep[k*nb+j])
+            {
+                int tinfo, rank = L->far_rank[bkj];
+                #pragma omp atomic read
+                tinfo = info;
+                if(tinfo == 0 && rank > 0)
+                {
+                    if(ipivk != NULL)
+                        LAPACKE_dlaswp_work(LAPACK_COL_MAJOR, rank,
+                                L->far_U[bkj]->data, nk, 1, nk, ipivk, 1);
+                    if(j > k)
+                        cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                                CblasNoTrans, CblasUnit, nk, rank, 1.0, Dkk,
+                                nk, L->far_U[bkj]->data, nk);
+                }
+            }
+        }
+        // Solve for tiles below diagonal one
+        for(STARSH_int i = k+1; i < nb; i++)
+        {
+            STARSH_int bik = i*(nb-1)+k;
+            #pragma omp task depend(in: dep[kk]) depend(inout: dep[i*nb+k])
+            {
+                int tinfo;
+                #pragma omp atomic read
+                tinfo = info;
+                if(tinfo == 0 && L->far_rank[bik] > 0)
+                    cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper,
+                            CblasTrans, CblasNonUnit, nk, L->far_rank[bik],
+                            1.0, Dkk, nk, L->far_V[bik]->data, nk);
+            }
+        }
+        // Update trailing submatrix
+        for(STARSH_int i = k+1; i < nb; i++)
+        {
+            STARSH_int bik = i*(nb-1)+k;
+            int ni = R->size[i];
+            for(STARSH_int j = k+1; j < nb; j++)
+            {
+                STARSH_int bkj = k*(nb-1)+j-1;
+                STARSH_int bij = i*(nb-1)+(j < i ? j : j-1);
+                int nj = R->size[j];
+                #pragma omp task depend(in: dep[i*nb+k], dep[k*nb+j]) \
+                        depend(inout: dep[i*nb+j])
+                {
+                    int tinfo, rank1 = L->far_rank[bik];
+                    int rank2 = L->far_rank[bkj], *iwork;
+                    double *work;
+                    #pragma omp atomic read
+                    tinfo = info;
+                    if(tinfo == 0 && rank1 > 0 && rank2 > 0 && i == j)
+                    {
+                        STARSH_PMALLOC(work, (size_t)(rank1+ni)*rank2,
+                                tinfo);
+                        if(tinfo == 0)
+                        {
+                            starsh_dense_dlrgemmd(ni, ni, nk, rank1,
+                                    L->far_U[bik]->data, ni,
+                                    L->far_V[bik]->data, nk, rank2,
+                                    L->far_V[bkj]->data, ni,
+                                    L->far_U[bkj]->data, nk,
+                                    L->near_D[i]->data, ni, work);
+                            free(work);
+                        }
+                        else
+                        {
+                            #pragma omp atomic write
+                            info = tinfo;
+                        }
+                    }
+                    else if(tinfo == 0 && rank1 > 0 && rank2 > 0)
+                    {
+                        int r = L->far_rank[bij];
+                        int mx = ni > nj ? ni : nj;
+                        r += rank1 < rank2 ? rank1 : rank2;
+                        int lwork = rank1*rank2+mx*r+(ni+nj+9*r+11)*r;
+                        STARSH_PMALLOC(work, lwork, tinfo);
+                        STARSH_PMALLOC(iwork, 8*r, tinfo);
+                        if(tinfo == 0)
+                        {
+                            int limited = starsh_dense_dlrgemm(ni, nj, nk,
+                                    rank1, L->far_U[bik]->data, ni,
+                                    L->far_V[bik]->data, nk, rank2,
+                                    L->far_V[bkj]->data, nj,
+                                    L->far_U[bkj]->data, nk,
+                                    L->far_U[bij]->data, ni,
+                                    L->far_V[bij]->data, nj,
+                                    L->far_rank+bij, L->far_U[bij]->shape[1],
+                                    tol, work, lwork, iwork);
+                            #pragma omp atomic update
+                            nlimited += limited;
+                            free(work);
+                            free(iwork);
+                        }
+                        else
+                        {
+                            #pragma omp atomic write
+                            info = tinfo;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    free(dep);
+    if(info != STARSH_SUCCESS)
+    {
+        starsh_blrm_free(L);
+        starsh_blrf_free(F);
+        return info;
+    }
+    if(nlimited > 0)
+    {
+        STARSH_WARNING("Rank of %zu updated tiles was truncated to maxrank=%d",
+                (size_t)nlimited, maxrank);
+    }
+    info = starsh_blrm__dfactor_finalize(L);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *factor = L;
+    return STARSH_SUCCESS;
+}
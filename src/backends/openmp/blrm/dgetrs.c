@@ -0,0 +1,110 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/openmp/blrm/dgetrs.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dgetrs_omp(STARSH_blrm *factor, int *ipiv, int nrhs,
+        double *B, int ldb)
+//! Solve system with TLR LU factorization.
+/*! OpenMP version of starsh_blrm__dgetrs(). After solution for a block row is
+ * found, all other block rows are updated by it in parallel.
+ *
+ * @param[in] factor: TLR LU factor.
+ * @param[in] ipiv: Pivot indices, returned by starsh_blrm__dgetrf_omp(), or
+ *      NULL if factorization was computed without pivoting.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in,out] B: Right hand side as input, solution as output.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L = factor;
+    if(L == NULL)
+    {
+        STARSH_ERROR("Invalid value of `factor`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int k;
+    int info = 0;
+    // Apply row interchanges inside diagonal tiles
+    if(ipiv != NULL)
+    {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(STARSH_int i = 0; i < nb; i++)
+            LAPACKE_dlaswp_work(LAPACK_COL_MAJOR, nrhs, B+R->start[i], ldb, 1,
+                    R->size[i], ipiv+R->start[i], 1);
+    }
+    // Forward substitution
+    for(k = 0; k < nb; k++)
+    {
+        int nk = R->size[k];
+        double *Bk = B+R->start[k];
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans,
+                CblasUnit, nk, nrhs, 1.0, L->near_D[k]->data, nk, Bk, ldb);
+        // Update block rows below current one
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(STARSH_int j = k+1; j < nb; j++)
+        {
+            STARSH_int bi = j*(nb-1)+k;
+            int nj = R->size[j], rank = L->far_rank[bi];
+            double *tmp;
+            if(rank == 0)
+                continue;
+            STARSH_PMALLOC(tmp, (size_t)nrhs*rank, info);
+            if(tmp == NULL)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    nk, 1.0, L->far_V[bi]->data, nk, Bk, ldb, 0.0, tmp, rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nj, nrhs,
+                    rank, -1.0, L->far_U[bi]->data, nj, tmp, rank, 1.0,
+                    B+R->start[j], ldb);
+            free(tmp);
+        }
+        if(info != 0)
+            return info;
+    }
+    // Backward substitution
+    for(k = nb-1; k >= 0; k--)
+    {
+        int nk = R->size[k];
+        double *Bk = B+R->start[k];
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans,
+                CblasNonUnit, nk, nrhs, 1.0, L->near_D[k]->data, nk, Bk, ldb);
+        // Update block rows above current one
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(STARSH_int j = 0; j < k; j++)
+        {
+            STARSH_int bi = j*(nb-1)+k-1;
+            int nj = R->size[j], rank = L->far_rank[bi];
+            double *tmp;
+            if(rank == 0)
+                continue;
+            STARSH_PMALLOC(tmp, (size_t)nrhs*rank, info);
+            if(tmp == NULL)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    nk, 1.0, L->far_V[bi]->data, nk, Bk, ldb, 0.0, tmp, rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nj, nrhs,
+                    rank, -1.0, L->far_U[bi]->data, nj, tmp, rank, 1.0,
+                    B+R->start[j], ldb);
+            free(tmp);
+        }
+        if(info != 0)
+            return info;
+    }
+    return STARSH_SUCCESS;
+}
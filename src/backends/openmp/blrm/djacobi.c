@@ -0,0 +1,121 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/openmp/blrm/djacobi.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__djacobi_omp(STARSH_blrm **factor, STARSH_blrm *matrix)
+//! Block-Jacobi preconditioner of a symmetric positive definite matrix.
+/*! OpenMP version of starsh_blrm__djacobi(). Diagonal tiles are factorized
+ * in parallel.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] matrix: Symmetric positive definite TLR matrix.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__djacobi(), starsh_itersolvers__dpcg_omp().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *M = matrix;
+    if(factor == NULL)
+    {
+        STARSH_ERROR("Invalid value of `factor`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(M == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = M->format;
+    STARSH_problem *P = F->problem;
+    if(F->type != STARSH_TLR || P->ndim != 2 || P->dtype != 'd')
+    {
+        STARSH_ERROR("Only TLR matrices of double precision are supported");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows, bi, k;
+    STARSH_int *block_near;
+    Array **near_D;
+    char *near;
+    int info = 0;
+    // Find which diagonal tiles are near-field blocks
+    STARSH_MALLOC(near, nb);
+    for(k = 0; k < nb; k++)
+        near[k] = 0;
+    for(bi = 0; bi < F->nblocks_near; bi++)
+        if(F->block_near[2*bi] == F->block_near[2*bi+1])
+            near[F->block_near[2*bi]] = 1;
+    STARSH_MALLOC(block_near, 2*nb);
+    STARSH_MALLOC(near_D, nb);
+    for(k = 0; k < nb; k++)
+    {
+        int n = R->size[k], shape[2] = {n, n};
+        double *L;
+        block_near[2*k] = k;
+        block_near[2*k+1] = k;
+        STARSH_MALLOC(L, (size_t)n*n);
+        array_from_buffer(near_D+k, 2, shape, 'd', 'F', L);
+    }
+    // Factorize diagonal tiles in parallel
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(k = 0; k < nb; k++)
+    {
+        int n = R->size[k], shape[2], rank, tinfo;
+        void *U, *V, *D;
+        double *L = near_D[k]->data;
+        tinfo = starsh_blrm_get_block(M, k, k, shape, &rank, &U, &V, &D);
+        if(tinfo != STARSH_SUCCESS)
+        {
+            #pragma omp atomic write
+            info = tinfo;
+            continue;
+        }
+        if(D != NULL)
+        {
+            LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', n, n, D, n, L, n);
+            if(near[k] == 0 || M->onfly == 1)
+                free(D);
+        }
+        else
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, n, n, rank,
+                    1.0, U, n, V, n, 0.0, L, n);
+        if(LAPACKE_dpotrf_work(LAPACK_COL_MAJOR, 'L', n, L, n) != 0)
+        {
+            STARSH_ERROR("Diagonal tile %zu is not positive definite",
+                    (size_t)k);
+            #pragma omp atomic write
+            info = STARSH_NOT_POSITIVE_DEFINITE;
+            continue;
+        }
+        if(n > 1)
+            LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'U', n-1, n-1, 0.0, 0.0,
+                    L+n, n);
+    }
+    free(near);
+    if(info != STARSH_SUCCESS)
+    {
+        for(k = 0; k < nb; k++)
+            array_free(near_D[k]);
+        free(near_D);
+        free(block_near);
+        return info;
+    }
+    STARSH_blrf *F2;
+    info = starsh_blrf_new_from_coo(&F2, P, 'N', R, R, 0, NULL, nb,
+            block_near, STARSH_TLR);
+    if(info != STARSH_SUCCESS)
+        return info;
+    return starsh_blrm_new(factor, F2, NULL, NULL, NULL, 0, near_D, NULL,
+            NULL, NULL, '2');
+}
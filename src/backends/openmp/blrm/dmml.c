@@ -46,7 +46,10 @@ int starsh_blrm__dmml_omp(STARSH_blrm *matrix, int nrhs, double alpha,
     STARSH_int nblocks_far = F->nblocks_far;
     STARSH_int nblocks_near = F->nblocks_near, bi;
     char symm = F->symm;
-    int maxrank = 100;
+    int maxrank = 0;
+    for(bi = 0; M->uniform == 0 && bi < nblocks_far; bi++)
+        if(maxrank < M->far_rank[bi])
+            maxrank = M->far_rank[bi];
     int maxnb = nrows/F->nbrows;
     // Setting B = beta*B
     if(beta == 0.)
@@ -66,7 +69,7 @@ int starsh_blrm__dmml_omp(STARSH_blrm *matrix, int nrhs, double alpha,
     num_threads = omp_get_num_threads();
     if(M->onfly == 0)
     {
-        STARSH_MALLOC(temp_D, num_threads*nrhs*maxrank);
+        STARSH_MALLOC(temp_D, num_threads*nrhs*maxrank+1);
     }
     else
     {
@@ -80,36 +83,151 @@ int starsh_blrm__dmml_omp(STARSH_blrm *matrix, int nrhs, double alpha,
             out[j] = 0.;
     }
     int ldout = nrows;
-    // Simple cycle over all far-field admissible blocks
-    #pragma omp parallel for schedule(dynamic, 1)
-    for(bi = 0; bi < nblocks_far; bi++)
+    if(M->uniform == 1)
     {
-        // Get indexes of corresponding block row and block column
-        STARSH_int i = F->block_far[2*bi];
-        STARSH_int j = F->block_far[2*bi+1];
-        // Get sizes and rank
-        int nrows = R->size[i];
-        int ncols = C->size[j];
-        int rank = M->far_rank[bi];
-        // Get pointers to data buffers
-        double *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
-        int info = 0;
-        double *D = temp_D+omp_get_thread_num()*nrhs*maxrank;
-        double *out = temp_B+omp_get_thread_num()*nrhs*ldout;
-        // Multiply low-rank matrix in U*V^T format by a dense matrix
-        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-                ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs,
-                rank, alpha, U, nrows, D, rank, 1.0, out+R->start[i], ldout);
-        if(i != j && symm == 'S')
+        // Far-field blocks share bases of block rows and block columns. At
+        // first project right hand side onto bases of block columns, then
+        // multiply projections by coupling matrices and finally expand
+        // results by bases of block rows.
+        STARSH_int nbrows = F->nbrows, nbcols = F->nbcols;
+        size_t *offset_X, *offset_Y, size_X = 0, size_Y = 0;
+        double *X, *Y;
+        STARSH_MALLOC(offset_X, nbcols);
+        STARSH_MALLOC(offset_Y, nbrows);
+        for(bi = 0; bi < nbcols; bi++)
         {
-            // Multiply low-rank matrix in V*U^T format by a dense matrix
-            // U and V are simply swapped in case of symmetric block
+            offset_X[bi] = size_X;
+            size_X += (size_t)nrhs*M->col_rank[bi];
+        }
+        for(bi = 0; bi < nbrows; bi++)
+        {
+            offset_Y[bi] = size_Y;
+            size_Y += (size_t)nrhs*M->row_rank[bi];
+        }
+        STARSH_MALLOC(X, size_X+1);
+        STARSH_MALLOC(Y, size_Y+1);
+        // Symmetric format stores only block rows of far-field blocks, so get
+        // far-field blocks of each block column in compressed format
+        STARSH_int *bcol_start = NULL, *bcol = NULL;
+        if(symm == 'S')
+        {
+            STARSH_MALLOC(bcol_start, nbcols+1);
+            STARSH_MALLOC(bcol, nblocks_far+1);
+            for(bi = 0; bi <= nbcols; bi++)
+                bcol_start[bi] = 0;
+            for(bi = 0; bi < nblocks_far; bi++)
+                bcol_start[F->block_far[2*bi+1]+1]++;
+            for(bi = 0; bi < nbcols; bi++)
+                bcol_start[bi+1] += bcol_start[bi];
+            for(bi = 0; bi < nblocks_far; bi++)
+                bcol[bcol_start[F->block_far[2*bi+1]]++] = bi;
+            for(bi = nbcols; bi > 0; bi--)
+                bcol_start[bi] = bcol_start[bi-1];
+            bcol_start[0] = 0;
+        }
+        // Project right hand side onto bases of block columns
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(bi = 0; bi < nbcols; bi++)
+        {
+            int ncols = C->size[bi];
+            int rank = M->col_rank[bi];
+            if(rank == 0)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    ncols, 1.0, M->col_V[bi]->data, ncols, A+C->start[bi],
+                    lda, 0.0, X+offset_X[bi], rank);
+        }
+        // Multiply projections by coupling matrices and expand results by
+        // bases of block rows. Each thread works on its own block row.
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(bi = 0; bi < nbrows; bi++)
+        {
+            int nrows = R->size[bi];
+            int rank_U = M->row_rank[bi];
+            double *out = Y+offset_Y[bi];
+            if(rank_U == 0)
+                continue;
+            for(size_t k = 0; k < (size_t)nrhs*rank_U; k++)
+                out[k] = 0.;
+            // Far-field blocks in a given block row
+            for(STARSH_int k = F->brow_far_start[bi];
+                    k < F->brow_far_start[bi+1]; k++)
+            {
+                STARSH_int bj = F->brow_far[k];
+                STARSH_int j = F->block_far[2*bj+1];
+                // Coupling matrix uses only leading vectors of bases
+                int rank_S = M->far_S[bj]->shape[0];
+                int rank_V = M->far_S[bj]->shape[1];
+                if(rank_S == 0 || rank_V == 0)
+                    continue;
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, rank_S,
+                        nrhs, rank_V, 1.0, M->far_S[bj]->data, rank_S,
+                        X+offset_X[j], M->col_rank[j], 1.0, out, rank_U);
+            }
+            // Transposed far-field blocks in a given block column, since
+            // block rows and block columns share bases in symmetric case
+            if(symm == 'S')
+                for(STARSH_int k = bcol_start[bi]; k < bcol_start[bi+1]; k++)
+                {
+                    STARSH_int bj = bcol[k];
+                    STARSH_int i = F->block_far[2*bj];
+                    int rank_V = M->far_S[bj]->shape[0];
+                    int rank_S = M->far_S[bj]->shape[1];
+                    if(i == bi || rank_S == 0 || rank_V == 0)
+                        continue;
+                    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans,
+                            rank_S, nrhs, rank_V, 1.0, M->far_S[bj]->data,
+                            rank_V, X+offset_X[i], M->row_rank[i], 1.0, out,
+                            rank_U);
+                }
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    nrhs, rank_U, alpha, M->row_U[bi]->data, nrows, out,
+                    rank_U, 1.0, B+R->start[bi], ldb);
+        }
+        free(offset_X);
+        free(offset_Y);
+        free(X);
+        free(Y);
+        free(bcol_start);
+        free(bcol);
+    }
+    else
+    {
+        // Simple cycle over all far-field admissible blocks
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(bi = 0; bi < nblocks_far; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = F->block_far[2*bi];
+            STARSH_int j = F->block_far[2*bi+1];
+            // Get sizes and rank
+            int nrows = R->size[i];
+            int ncols = C->size[j];
+            int rank = M->far_rank[bi];
+            if(rank == 0)
+                continue;
+            // Get pointers to data buffers
+            double *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
+            int info = 0;
+            double *D = temp_D+omp_get_thread_num()*nrhs*maxrank;
+            double *out = temp_B+omp_get_thread_num()*nrhs*ldout;
+            // Multiply low-rank matrix in U*V^T format by a dense matrix
             cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-                    nrows, 1.0, U, nrows, A+R->start[i], lda, 0.0, D, rank);
-            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
-                    nrhs, rank, alpha, V, ncols, D, rank, 1.0,
-                    out+C->start[j], ldout);
+                    ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    nrhs, rank, alpha, U, nrows, D, rank, 1.0,
+                    out+R->start[i], ldout);
+            if(i != j && symm == 'S')
+            {
+                // Multiply low-rank matrix in V*U^T format by a dense matrix
+                // U and V are simply swapped in case of symmetric block
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, nrows, 1.0, U, nrows, A+R->start[i], lda, 0.0,
+                        D, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
+                        nrhs, rank, alpha, V, ncols, D, rank, 1.0,
+                        out+C->start[j], ldout);
+            }
         }
     }
     if(M->onfly == 1)
@@ -0,0 +1,180 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/openmp/blrm/dpotrf.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dpotrf_omp(STARSH_blrm **factor, STARSH_blrm *matrix,
+        int maxrank, double tol)
+//! TLR Cholesky factorization of a symmetric positive definite matrix.
+/*! OpenMP version of starsh_blrm__dpotrf(). Each operation on a tile is an
+ * OpenMP task, and dependencies between tasks are set by tiles of factor,
+ * that are read or updated, so operations of different steps of
+ * factorization overlap.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] matrix: Symmetric positive definite TLR matrix.
+ * @param[in] maxrank: Maximum possible rank of tiles of factor.
+ * @param[in] tol: Relative error tolerance for tiles of factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dpotrf(), starsh_blrm__dpotrs_omp().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L;
+    int info = starsh_blrm__dfactor_init(&L, matrix, 'L', maxrank, tol);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows, nlimited = 0;
+    // Dummy array to set dependencies between tasks, element
+    // `i*(i+1)/2+j` corresponds to tile in block row `i` and block column `j`
+    char *dep;
+    STARSH_MALLOC(dep, nb*(nb+1)/2);
+    #pragma omp parallel
+    #pragma omp master
+    for(STARSH_int k = 0; k < nb; k++)
+    {
+        STARSH_int kk = k*(k+1)/2+k;
+        int nk = R->size[k];
+        double *Lkk = L->near_D[k]->data;
+        // Factorize diagonal tile and zero its upper triangle
+        #pragma omp task depend(inout: dep[kk])
+        {
+            int tinfo;
+            #pragma omp atomic read
+            tinfo = info;
+            if(tinfo == 0)
+            {
+                tinfo = LAPACKE_dpotrf_work(LAPACK_COL_MAJOR, 'L', nk, Lkk,
+                        nk);
+                if(tinfo != 0)
+                {
+                    STARSH_ERROR("Diagonal tile %zu is not positive "
+                            "definite", (size_t)k);
+                    #pragma omp atomic write
+                    info = STARSH_NOT_POSITIVE_DEFINITE;
+                }
+                else if(nk > 1)
+                    LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'U', nk-1, nk-1,
+                            0.0, 0.0, Lkk+nk, nk);
+            }
+        }
+        // Solve for tiles of current block column
+        for(STARSH_int i = k+1; i < nb; i++)
+        {
+            STARSH_int bi = i*(i-1)/2+k;
+            #pragma omp task depend(in: dep[kk]) depend(inout: dep[bi+i])
+            {
+                int tinfo;
+                #pragma omp atomic read
+                tinfo = info;
+                if(tinfo == 0 && L->far_rank[bi] > 0)
+                    cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                            CblasNoTrans, CblasNonUnit, nk, L->far_rank[bi],
+                            1.0, Lkk, nk, L->far_V[bi]->data, nk);
+            }
+        }
+        // Update trailing submatrix
+        for(STARSH_int i = k+1; i < nb; i++)
+        {
+            STARSH_int bi = i*(i-1)/2+k;
+            int ni = R->size[i];
+            #pragma omp task depend(in: dep[bi+i]) \
+                    depend(inout: dep[i*(i+1)/2+i])
+            {
+                int tinfo = 0, rank = L->far_rank[bi];
+                double *work;
+                #pragma omp atomic read
+                tinfo = info;
+                if(tinfo == 0 && rank > 0)
+                {
+                    STARSH_PMALLOC(work, (size_t)(rank+ni)*rank, tinfo);
+                    if(tinfo == 0)
+                    {
+                        starsh_dense_dlrsyrk(ni, nk, rank, L->far_U[bi]->data,
+                                ni, L->far_V[bi]->data, nk,
+                                L->near_D[i]->data, ni, work);
+                        free(work);
+                    }
+                    else
+                    {
+                        #pragma omp atomic write
+                        info = tinfo;
+                    }
+                }
+            }
+            for(STARSH_int j = k+1; j < i; j++)
+            {
+                STARSH_int bj = j*(j-1)/2+k, bij = i*(i-1)/2+j;
+                int nj = R->size[j];
+                #pragma omp task depend(in: dep[bi+i], dep[bj+j]) \
+                        depend(inout: dep[bij+i])
+                {
+                    int tinfo, rank1 = L->far_rank[bi];
+                    int rank2 = L->far_rank[bj], *iwork;
+                    int r = L->far_rank[bij];
+                    int mx = ni > nj ? ni : nj;
+                    double *work;
+                    #pragma omp atomic read
+                    tinfo = info;
+                    r += rank1 < rank2 ? rank1 : rank2;
+                    int lwork = rank1*rank2+mx*r+(ni+nj+9*r+11)*r;
+                    if(tinfo == 0 && rank1 > 0 && rank2 > 0)
+                    {
+                        STARSH_PMALLOC(work, lwork, tinfo);
+                        STARSH_PMALLOC(iwork, 8*r, tinfo);
+                        if(tinfo == 0)
+                        {
+                            int limited = starsh_dense_dlrgemm(ni, nj, nk,
+                                    rank1, L->far_U[bi]->data, ni,
+                                    L->far_V[bi]->data, nk, rank2,
+                                    L->far_U[bj]->data, nj,
+                                    L->far_V[bj]->data, nk,
+                                    L->far_U[bij]->data, ni,
+                                    L->far_V[bij]->data, nj,
+                                    L->far_rank+bij, L->far_U[bij]->shape[1],
+                                    tol, work, lwork, iwork);
+                            #pragma omp atomic update
+                            nlimited += limited;
+                            free(work);
+                            free(iwork);
+                        }
+                        else
+                        {
+                            #pragma omp atomic write
+                            info = tinfo;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    free(dep);
+    if(info != STARSH_SUCCESS)
+    {
+        starsh_blrm_free(L);
+        starsh_blrf_free(F);
+        return info;
+    }
+    if(nlimited > 0)
+    {
+        STARSH_WARNING("Rank of %zu updated tiles was truncated to maxrank=%d",
+                (size_t)nlimited, maxrank);
+    }
+    info = starsh_blrm__dfactor_finalize(L);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *factor = L;
+    return STARSH_SUCCESS;
+}
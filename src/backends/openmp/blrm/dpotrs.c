@@ -0,0 +1,147 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/openmp/blrm/dpotrs.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dtrsm_omp(STARSH_blrm *factor, char trans, int nrhs,
+        double *B, int ldb)
+//! Solve system with lower triangular TLR matrix.
+/*! OpenMP version of starsh_blrm__dtrsm(). After solution for a block row is
+ * found, all other block rows are updated by it in parallel.
+ *
+ * @param[in] factor: TLR Cholesky factor.
+ * @param[in] trans: 'N' for `L` or 'T' for transposed `L`.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in,out] B: Right hand side as input, solution as output.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L = factor;
+    if(L == NULL)
+    {
+        STARSH_ERROR("Invalid value of `factor`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(trans != 'N' && trans != 'T')
+    {
+        STARSH_ERROR("Invalid value of `trans`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int i, k;
+    int info = 0;
+    if(F->nblocks_far == 0)
+    {
+        // Factor is block diagonal, e.g. block-Jacobi preconditioner, so
+        // diagonal tiles are independent
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(k = 0; k < nb; k++)
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                    trans == 'N' ? CblasNoTrans : CblasTrans, CblasNonUnit,
+                    R->size[k], nrhs, 1.0, L->near_D[k]->data, R->size[k],
+                    B+R->start[k], ldb);
+        return STARSH_SUCCESS;
+    }
+    for(i = 0; i < nb; i++)
+    {
+        k = trans == 'N' ? i : nb-1-i;
+        int nk = R->size[k];
+        double *Bk = B+R->start[k];
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                trans == 'N' ? CblasNoTrans : CblasTrans, CblasNonUnit, nk,
+                nrhs, 1.0, L->near_D[k]->data, nk, Bk, ldb);
+        if(trans == 'N')
+        {
+            // Update block rows below current one
+            #pragma omp parallel for schedule(dynamic, 1)
+            for(STARSH_int j = k+1; j < nb; j++)
+            {
+                STARSH_int bi = j*(j-1)/2+k;
+                int nj = R->size[j], rank = L->far_rank[bi];
+                double *tmp;
+                if(rank == 0)
+                    continue;
+                STARSH_PMALLOC(tmp, (size_t)nrhs*rank, info);
+                if(tmp == NULL)
+                    continue;
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, nk, 1.0, L->far_V[bi]->data, nk, Bk, ldb, 0.0,
+                        tmp, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nj,
+                        nrhs, rank, -1.0, L->far_U[bi]->data, nj, tmp, rank,
+                        1.0, B+R->start[j], ldb);
+                free(tmp);
+            }
+        }
+        else
+        {
+            // Update block rows above current one
+            #pragma omp parallel for schedule(dynamic, 1)
+            for(STARSH_int j = 0; j < k; j++)
+            {
+                STARSH_int bi = k*(k-1)/2+j;
+                int nj = R->size[j], rank = L->far_rank[bi];
+                double *tmp;
+                if(rank == 0)
+                    continue;
+                STARSH_PMALLOC(tmp, (size_t)nrhs*rank, info);
+                if(tmp == NULL)
+                    continue;
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, nk, 1.0, L->far_U[bi]->data, nk, Bk, ldb, 0.0,
+                        tmp, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nj,
+                        nrhs, rank, -1.0, L->far_V[bi]->data, nj, tmp, rank,
+                        1.0, B+R->start[j], ldb);
+                free(tmp);
+            }
+        }
+        if(info != 0)
+            return info;
+    }
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrm__dpotrs_omp(STARSH_blrm *factor, int nrhs, double *B,
+        int ldb)
+//! Solve system with TLR Cholesky factorization.
+/*! OpenMP version of starsh_blrm__dpotrs().
+ *
+ * @param[in] factor: TLR Cholesky factor.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in,out] B: Right hand side as input, solution as output.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L = factor;
+    if(L != NULL && L->format->nblocks_far == 0)
+    {
+        // Factor is block diagonal, so solve for each diagonal tile at once
+        STARSH_cluster *R = L->format->row_cluster;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for(STARSH_int k = 0; k < L->format->nbrows; k++)
+            LAPACKE_dpotrs_work(LAPACK_COL_MAJOR, 'L', R->size[k], nrhs,
+                    L->near_D[k]->data, R->size[k], B+R->start[k], ldb);
+        return STARSH_SUCCESS;
+    }
+    int info = starsh_blrm__dtrsm_omp(factor, 'N', nrhs, B, ldb);
+    if(info != STARSH_SUCCESS)
+        return info;
+    return starsh_blrm__dtrsm_omp(factor, 'T', nrhs, B, ldb);
+}
@@ -46,6 +46,15 @@ int starsh_blrm__dsdd_omp(STARSH_blrm **matrix, STARSH_blrf *format,
     double *alloc_U = NULL, *alloc_V = NULL, *alloc_D = NULL;
     size_t offset_U = 0, offset_V = 0, offset_D = 0;
     STARSH_int bi, bj = 0;
+    // Absolute tolerance of each far-field block for the entire matrix. Blocks
+    // with smaller norm are negligible and they are dropped.
+    double abstol = 0.;
+    if(nblocks_far > 0)
+    {
+        int info = starsh_blrm__dtol_omp(F, tol, &abstol);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
     // Init buffers to store low-rank factors of far-field blocks if needed
     if(nblocks_far > 0)
     {
@@ -110,9 +119,21 @@ int starsh_blrm__dsdd_omp(STARSH_blrm **matrix, STARSH_blrf *format,
         // Compute elements of a block
         kernel(nrows, ncols, RC->pivot+RC->start[i], CC->pivot+CC->start[j],
                 RD, CD, D, nrows);
-        starsh_dense_dlrsdd(nrows, ncols, D, nrows, far_U[bi]->data, nrows,
-                far_V[bi]->data, ncols, far_rank+bi, maxrank, tol, work, lwork,
-                iwork);
+        // Blocks with small norm are negligible and they get rank 0
+        double tile_norm = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows,
+                ncols, D, nrows, NULL);
+        if(tile_norm <= abstol)
+            far_rank[bi] = 0;
+        else
+        {
+            // Relative tolerance of a block, if tolerance is global
+            double tile_tol = tol;
+            if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+                tile_tol = abstol/tile_norm;
+            starsh_dense_dlrsdd(nrows, ncols, D, nrows, far_U[bi]->data, nrows,
+                    far_V[bi]->data, ncols, far_rank+bi, maxrank, tile_tol,
+                    work, lwork, iwork);
+        }
         // Free temporary arrays
         free(D);
         free(work);
@@ -248,8 +269,6 @@ int starsh_blrm__dsdd_omp(STARSH_blrm **matrix, STARSH_blrf *format,
         STARSH_REALLOC(far_rank, new_nblocks_far);
         STARSH_REALLOC(far_U, new_nblocks_far);
         STARSH_REALLOC(far_V, new_nblocks_far);
-        //STARSH_REALLOC(alloc_U, offset_U);
-        //STARSH_REALLOC(alloc_V, offset_V);
     }
     // If all far-field blocks are false, then dealloc buffers
     if(new_nblocks_far == 0 && nblocks_far > 0)
@@ -269,6 +288,15 @@ int starsh_blrm__dsdd_omp(STARSH_blrm **matrix, STARSH_blrf *format,
     // Dealloc list of false far-field blocks if it is not empty
     if(nblocks_false_far > 0)
         free(false_far);
+    // Drop negligible far-field blocks, approximated with rank 0
+    info = starsh_blrf_drop_far(F, far_rank, far_U, far_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Store only actual ranks of low-rank factors
+    info = starsh_blrm_pack_far(F->nblocks_far, far_rank, far_U, far_V,
+            (void **)&alloc_U, (void **)&alloc_V);
+    if(info != STARSH_SUCCESS)
+        return info;
     // Finish with creating instance of Block Low-Rank Matrix with given
     // buffers
     return starsh_blrm_new(matrix, F, far_rank, far_U, far_V, onfly, near_D,
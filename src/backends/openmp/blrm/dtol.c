@@ -0,0 +1,54 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/openmp/blrm/dtol.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dtol_omp(STARSH_blrf *format, double tol, double *abstol)
+//! Absolute tolerance of each far-field tile for given global tolerance.
+/*! OpenMP version of starsh_blrm__dtol().
+ *
+ * @param[in] format: Block low-rank format.
+ * @param[in] tol: Relative error tolerance for the entire matrix.
+ * @param[out] abstol: Absolute error tolerance for each far-field tile.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    double norm = 0., nfar = 0.;
+    int info = STARSH_SUCCESS;
+    *abstol = 0.;
+    // Each thread samples its own tiles, so only reduction is needed
+    #pragma omp parallel reduction(+:norm,nfar)
+    {
+        int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        double norm_far, norm_near, nnear;
+        int tinfo = starsh_blrm__dnorm_sample(F, F->nblocks_far,
+                F->block_far, tid, nthreads, &norm_far, &nfar);
+        if(tinfo == STARSH_SUCCESS)
+            tinfo = starsh_blrm__dnorm_sample(F, F->nblocks_near,
+                    F->block_near, tid, nthreads, &norm_near, &nnear);
+        if(tinfo != STARSH_SUCCESS)
+        {
+            #pragma omp atomic write
+            info = tinfo;
+        }
+        else
+            norm += norm_far+norm_near;
+    }
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(nfar > 0)
+        *abstol = tol*sqrt(norm/nfar);
+    return STARSH_SUCCESS;
+}
@@ -36,11 +36,36 @@ int starsh_blrm__dca(STARSH_blrm *matrix, Array *A)
     {
         STARSH_int i = F->block_far[2*bi];
         STARSH_int j = F->block_far[2*bi+1];
-        double *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
         double *B = data+RC->start[i]+CC->start[j]*(size_t)lda;
-        int nrows = RC->size[i], ncols = CC->size[j], rank = M->far_rank[bi];
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
-                rank, 1.0, U, nrows, V, ncols, 0.0, B, lda);
+        int nrows = RC->size[i], ncols = CC->size[j];
+        if(M->uniform == 0)
+        {
+            double *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
+            int rank = M->far_rank[bi];
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
+                    rank, 1.0, U, nrows, V, ncols, 0.0, B, lda);
+        }
+        else
+        {
+            // Approximation is a product of shared bases and coupling matrix
+            int rank_U = M->far_S[bi]->shape[0];
+            int rank_V = M->far_S[bi]->shape[1];
+            double *tmp;
+            STARSH_MALLOC(tmp, (size_t)nrows*rank_V+1);
+            for(int k = 0; k < ncols; k++)
+                for(int l = 0; l < nrows; l++)
+                    B[k*(size_t)lda+l] = 0.0;
+            if(rank_U > 0 && rank_V > 0)
+            {
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                        rank_V, rank_U, 1.0, M->row_U[i]->data, nrows,
+                        M->far_S[bi]->data, rank_U, 0.0, tmp, nrows);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows,
+                        ncols, rank_V, 1.0, tmp, nrows, M->col_V[j]->data,
+                        ncols, 0.0, B, lda);
+            }
+            free(tmp);
+        }
         if(F->symm == 'S' && i != j)
         {
             double *B2 = data+CC->start[j]+RC->start[i]*(size_t)lda;
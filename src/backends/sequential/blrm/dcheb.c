@@ -0,0 +1,551 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dcheb.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-particles.h"
+
+int starsh_blrm__dcheb(STARSH_blrm **matrix, STARSH_blrf *format, int maxrank,
+        double tol, int onfly)
+//! Approximate each tile by Chebyshev interpolation of a kernel.
+/*! Works only for kernels of N-body applications (see
+ * starsh_application_particles()), whose physical data starts with
+ * @ref STARSH_particles object, and returns @ref STARSH_WRONG_PARAMETER for
+ * other problems. Each cluster gets tensor Chebyshev nodes of its bounding
+ * box, and each far-field tile is approximated by values of kernel on
+ * intersection of nodes of its block row and block column, so that only
+ * `order`\f$^{2 ndim}\f$ elements of each far-field tile are computed. Number
+ * of nodes `order` in each dimension is the smallest one, such that
+ * `order`\f$^{ndim}\f$ is not less than `maxrank`+`oversample`. Interpolation
+ * is then recompressed by SVD of a small matrix to reach required tolerance.
+ * Error of each approximation is checked on a few rows of a tile, and tiles of
+ * close clusters, that are not interpolated accurately enough, are
+ * approximated by randomized SVD, as in starsh_blrm__drsdd(). Physical data is
+ * temporarily replaced by nodes of clusters, so problem must not be used
+ * concurrently.
+ *
+ * @param[out] matrix: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] format: Block low-rank format.
+ * @param[in] maxrank: Maximum possible rank.
+ * @param[in] tol: Relative error tolerance.
+ * @param[in] onfly: Whether not to store dense blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_problem *P = F->problem;
+    STARSH_kernel *kernel = P->kernel;
+    STARSH_int nblocks_far = F->nblocks_far;
+    STARSH_int nblocks_near = F->nblocks_near;
+    // Shortcuts to information about clusters
+    STARSH_cluster *RC = F->row_cluster;
+    STARSH_cluster *CC = F->col_cluster;
+    void *RD = RC->data, *CD = CC->data;
+    STARSH_particles *RP = RD, *CP = CD;
+    // Following values default to given block low-rank format F, but they are
+    // changed when there are false far-field blocks.
+    STARSH_int new_nblocks_far = nblocks_far;
+    STARSH_int new_nblocks_near = nblocks_near;
+    STARSH_int *block_far = F->block_far;
+    STARSH_int *block_near = F->block_near;
+    // Places to store low-rank factors, dense blocks and ranks
+    Array **far_U = NULL, **far_V = NULL, **near_D = NULL;
+    int *far_rank = NULL;
+    double *alloc_U = NULL, *alloc_V = NULL, *alloc_D = NULL;
+    size_t offset_U = 0, offset_V = 0, offset_D = 0;
+    STARSH_int bi, bj = 0;
+    int k;
+    const int oversample = starsh_params.oversample;
+    const int poweriter = starsh_params.poweriter;
+    if(!starsh_application_particles(kernel))
+    {
+        STARSH_ERROR("kernel is not a kernel of N-body application");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(RP->ndim < 1 || RP->count != RC->ndata || CP->ndim != RP->ndim ||
+            CP->count != CC->ndata)
+    {
+        STARSH_ERROR("physical data is not a set of particles");
+        return STARSH_WRONG_PARAMETER;
+    }
+    // Number of Chebyshev nodes in each dimension and for each cluster
+    int ndim = RP->ndim, order = 1, nnodes = 1;
+    while(nnodes < maxrank+oversample)
+    {
+        order++;
+        nnodes = 1;
+        for(k = 0; k < ndim; k++)
+            nnodes *= order;
+    }
+    // Absolute tolerance of each far-field block for the entire matrix. Blocks
+    // with smaller norm are negligible and they are dropped.
+    double abstol = 0.;
+    if(nblocks_far > 0)
+    {
+        int info = starsh_blrm__dtol(F, tol, &abstol);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
+    // Init buffers to store low-rank factors of far-field blocks if needed
+    if(nblocks_far > 0)
+    {
+        STARSH_MALLOC(far_U, nblocks_far);
+        STARSH_MALLOC(far_V, nblocks_far);
+        STARSH_MALLOC(far_rank, nblocks_far);
+        size_t size_U = 0, size_V = 0;
+        // Simple cycle over all far-field blocks
+        for(bi = 0; bi < nblocks_far; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = block_far[2*bi];
+            STARSH_int j = block_far[2*bi+1];
+            // Get corresponding sizes and minimum of them
+            size_U += RC->size[i];
+            size_V += CC->size[j];
+        }
+        size_U *= maxrank;
+        size_V *= maxrank;
+        STARSH_MALLOC(alloc_U, size_U);
+        STARSH_MALLOC(alloc_V, size_V);
+        for(bi = 0; bi < nblocks_far; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = block_far[2*bi];
+            STARSH_int j = block_far[2*bi+1];
+            // Get corresponding sizes and minimum of them
+            size_t nrows = RC->size[i], ncols = CC->size[j];
+            int shape_U[] = {nrows, maxrank};
+            int shape_V[] = {ncols, maxrank};
+            double *U = alloc_U+offset_U, *V = alloc_V+offset_V;
+            offset_U += nrows*maxrank;
+            offset_V += ncols*maxrank;
+            array_from_buffer(far_U+bi, 2, shape_U, 'd', 'F', U);
+            array_from_buffer(far_V+bi, 2, shape_V, 'd', 'F', V);
+        }
+        offset_U = 0;
+        offset_V = 0;
+    }
+    // Work variables
+    int info;
+    // Interpolation bases of clusters. Nodes of row clusters go first in
+    // `row_node`. Nodes of column clusters follow them if row and column data
+    // are the same, otherwise they are in `col_node`.
+    STARSH_int nrow_bases = RC->nblocks, ncol_bases = CC->nblocks;
+    STARSH_int row_nnodes = nrow_bases*nnodes, col_nnodes = 0;
+    STARSH_int col_offset = 0;
+    if(CC != RC && CD == RD)
+    {
+        col_offset = row_nnodes;
+        row_nnodes += ncol_bases*nnodes;
+    }
+    else if(CD != RD)
+        col_nnodes = ncol_bases*nnodes;
+    double *row_node = NULL, *col_node = NULL;
+    double **row_Q = NULL, **row_R = NULL, **col_Q = NULL, **col_R = NULL;
+    STARSH_int *node_index = NULL;
+    if(nblocks_far > 0)
+    {
+        STARSH_int nbases = nrow_bases, maxnnodes = row_nnodes;
+        if(CC != RC)
+            nbases += ncol_bases;
+        if(col_nnodes > maxnnodes)
+            maxnnodes = col_nnodes;
+        STARSH_MALLOC(row_node, (size_t)ndim*row_nnodes);
+        if(col_nnodes > 0)
+            STARSH_MALLOC(col_node, (size_t)ndim*col_nnodes);
+        STARSH_MALLOC(node_index, maxnnodes);
+        for(bi = 0; bi < maxnnodes; bi++)
+            node_index[bi] = bi;
+        STARSH_MALLOC(row_Q, 2*nbases);
+        row_R = row_Q+nbases;
+        col_Q = row_Q;
+        col_R = row_R;
+        if(CC != RC)
+        {
+            col_Q = row_Q+nrow_bases;
+            col_R = row_R+nrow_bases;
+        }
+        int lwork = nnodes*(66+ndim);
+        double *work;
+        STARSH_MALLOC(work, lwork);
+        for(bi = 0; bi < nbases; bi++)
+        {
+            STARSH_cluster *C = RC;
+            STARSH_particles *CPt = RP;
+            double *node = row_node;
+            STARSH_int ldnode = row_nnodes, c = bi;
+            if(bi >= nrow_bases)
+            {
+                C = CC;
+                CPt = CP;
+                c = bi-nrow_bases;
+                if(CD == RD)
+                    node += col_offset;
+                else
+                {
+                    node = col_node;
+                    ldnode = col_nnodes;
+                }
+            }
+            int nrows = C->size[c];
+            int mn = nrows < nnodes ? nrows : nnodes;
+            STARSH_MALLOC(row_Q[bi], (size_t)nrows*nnodes);
+            STARSH_MALLOC(row_R[bi], (size_t)mn*nnodes);
+            starsh_dense_dchebqr(nrows, ndim, order, CPt->count, CPt->point,
+                    C->pivot+C->start[c], node+c*nnodes, ldnode, row_Q[bi],
+                    row_R[bi], work, lwork);
+        }
+        free(work);
+    }
+    // Replace physical data by nodes of clusters
+    STARSH_particles row_particles = *RP, col_particles = *CP;
+    RP->count = row_nnodes;
+    RP->point = row_node;
+    if(CD != RD)
+    {
+        CP->count = col_nnodes;
+        CP->point = col_node;
+    }
+    // Simple cycle over all far-field admissible blocks
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        // Get indexes of corresponding block row and block column
+        STARSH_int i = block_far[2*bi];
+        STARSH_int j = block_far[2*bi+1];
+        // Get corresponding sizes and minimum of them
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        int mn = nrows < ncols ? nrows : ncols;
+        int mi = nrows < nnodes ? nrows : nnodes;
+        int mj = ncols < nnodes ? ncols : nnodes;
+        int mij = mi < mj ? mi : mj;
+        // Get size of temporary arrays
+        int lwork = (size_t)nnodes*(nnodes+mi)+(size_t)mi*mj+mij*(mi+mj+1)+
+                (4*mij+7)*mij;
+        int liwork = 8*mij;
+        double *C, *T, *M, *svd_U, *svd_S, *svd_V, *svd_work, *work;
+        int *iwork;
+        // Allocate temporary arrays
+        STARSH_MALLOC(iwork, liwork);
+        STARSH_MALLOC(work, lwork);
+        C = work;
+        T = C+(size_t)nnodes*nnodes;
+        M = T+(size_t)mi*nnodes;
+        svd_U = M+(size_t)mi*mj;
+        svd_S = svd_U+(size_t)mi*mij;
+        svd_V = svd_S+mij;
+        svd_work = svd_V+(size_t)mij*mj;
+        // Compute kernel on nodes and project it onto interpolation bases
+        kernel(nnodes, nnodes, node_index+i*nnodes,
+                node_index+col_offset+j*nnodes, RD, CD, C, nnodes);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, mi, nnodes,
+                nnodes, 1.0, row_R[i], mi, C, nnodes, 0.0, T, mi);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, mi, mj, nnodes,
+                1.0, T, mi, col_R[j], mj, 0.0, M, mi);
+        info = LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'S', mi, mj, M, mi,
+                svd_S, svd_U, mi, svd_V, mij, svd_work, (4*mij+7)*mij, iwork);
+        // Blocks with small norm are negligible and they get rank 0
+        double tile_norm = cblas_dnrm2(mij, svd_S, 1);
+        if(info != 0)
+        {
+            STARSH_WARNING("LAPACKE_dgesdd_work info=%d", info);
+            far_rank[bi] = -1;
+        }
+        else if(tile_norm <= abstol)
+            far_rank[bi] = 0;
+        else
+        {
+            // Relative tolerance of a block, if tolerance is global
+            double tile_tol = tol;
+            if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+                tile_tol = abstol/tile_norm;
+            int rank = starsh_dense_dsvfr(mij, svd_S, tile_tol);
+            // If all singular values are required, then interpolation is not
+            // accurate enough and tile is considered false far-field
+            if(rank < mn/2 && rank <= maxrank && rank < mij)
+            {
+                for(k = 0; k < rank; k++)
+                    cblas_dscal(mj, svd_S[k], svd_V+k, mij);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                        rank, mi, 1.0, row_Q[i], nrows, svd_U, mi, 0.0,
+                        far_U[bi]->data, nrows);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, ncols,
+                        rank, mj, 1.0, col_Q[j], ncols, svd_V, mij, 0.0,
+                        far_V[bi]->data, ncols);
+                far_rank[bi] = rank;
+            }
+            else
+                far_rank[bi] = -1;
+        }
+        // Free temporary arrays
+        free(work);
+        free(iwork);
+    }
+    // Restore physical data
+    *RP = row_particles;
+    *CP = col_particles;
+    if(nblocks_far > 0)
+    {
+        for(bi = 0; bi < nrow_bases; bi++)
+        {
+            free(row_Q[bi]);
+            free(row_R[bi]);
+        }
+        if(CC != RC)
+            for(bi = 0; bi < ncol_bases; bi++)
+            {
+                free(col_Q[bi]);
+                free(col_R[bi]);
+            }
+        free(row_Q);
+        free(row_node);
+        free(col_node);
+        free(node_index);
+    }
+    // Interpolation is not accurate for close clusters, so error of each
+    // approximation is checked on a few equally spaced rows of a tile
+    const int maxsamples = 8;
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        if(far_rank[bi] <= 0)
+            continue;
+        STARSH_int i = block_far[2*bi];
+        STARSH_int j = block_far[2*bi+1];
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        int rank = far_rank[bi];
+        int nsamples = nrows < maxsamples ? nrows : maxsamples;
+        STARSH_int irow[maxsamples];
+        int isample[maxsamples];
+        double *D, *U = far_U[bi]->data, *V = far_V[bi]->data;
+        STARSH_MALLOC(D, (size_t)nsamples*ncols);
+        for(k = 0; k < nsamples; k++)
+        {
+            isample[k] = k*nrows/nsamples;
+            irow[k] = RC->pivot[RC->start[i]+isample[k]];
+        }
+        kernel(nsamples, ncols, irow, CC->pivot+CC->start[j], RD, CD, D,
+                nsamples);
+        double sample_norm = cblas_dnrm2((size_t)nsamples*ncols, D, 1);
+        for(k = 0; k < nsamples; k++)
+            cblas_dgemv(CblasColMajor, CblasNoTrans, ncols, rank, -1.0, V,
+                    ncols, U+isample[k], nrows, 1.0, D+k, nsamples);
+        double sample_err = cblas_dnrm2((size_t)nsamples*ncols, D, 1);
+        double sample_tol = tol*sample_norm;
+        if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+            sample_tol = abstol*sqrt((double)nsamples/nrows);
+        if(sample_err > sample_tol)
+            far_rank[bi] = -1;
+        free(D);
+    }
+    // Tiles, that are not interpolated accurately enough, are approximated
+    // by randomized SVD, as in starsh_blrm__drsdd()
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        if(far_rank[bi] != -1)
+            continue;
+        STARSH_int i = block_far[2*bi];
+        STARSH_int j = block_far[2*bi+1];
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        int mn = nrows < ncols ? nrows : ncols;
+        int mn2 = maxrank+oversample;
+        if(mn2 > mn)
+            mn2 = mn;
+        int lwork = ncols, lwork_sdd = (4*mn2+7)*mn2;
+        if(lwork_sdd > lwork)
+            lwork = lwork_sdd;
+        lwork += (size_t)mn2*(2*ncols+nrows+mn2+1);
+        int liwork = 8*mn2;
+        double *D, *work;
+        int *iwork;
+        STARSH_MALLOC(D, (size_t)nrows*(size_t)ncols);
+        STARSH_MALLOC(work, lwork);
+        STARSH_MALLOC(iwork, liwork);
+        kernel(nrows, ncols, RC->pivot+RC->start[i], CC->pivot+CC->start[j],
+                RD, CD, D, nrows);
+        double tile_norm = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows,
+                ncols, D, nrows, NULL);
+        if(tile_norm <= abstol)
+            far_rank[bi] = 0;
+        else
+        {
+            double tile_tol = tol;
+            if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+                tile_tol = abstol/tile_norm;
+            starsh_dense_dlrrsdd(nrows, ncols, D, nrows, far_U[bi]->data,
+                    nrows, far_V[bi]->data, ncols, far_rank+bi, maxrank,
+                    oversample, poweriter, tile_tol, work, lwork, iwork);
+        }
+        free(D);
+        free(work);
+        free(iwork);
+    }
+    // Get number of false far-field blocks
+    STARSH_int nblocks_false_far = 0;
+    STARSH_int *false_far = NULL;
+    for(bi = 0; bi < nblocks_far; bi++)
+        if(far_rank[bi] == -1)
+            nblocks_false_far++;
+    if(nblocks_false_far > 0)
+    {
+        // IMPORTANT: `false_far` must to be in ascending order for later code
+        // to work normally
+        STARSH_MALLOC(false_far, nblocks_false_far);
+        bj = 0;
+        for(bi = 0; bi < nblocks_far; bi++)
+            if(far_rank[bi] == -1)
+                false_far[bj++] = bi;
+    }
+    // Update lists of far-field and near-field blocks using previously
+    // generated list of false far-field blocks
+    if(nblocks_false_far > 0)
+    {
+        // Update list of near-field blocks
+        new_nblocks_near = nblocks_near+nblocks_false_far;
+        STARSH_MALLOC(block_near, 2*new_nblocks_near);
+        // At first get all near-field blocks, assumed to be dense
+        for(bi = 0; bi < 2*nblocks_near; bi++)
+            block_near[bi] = F->block_near[bi];
+        // Add false far-field blocks
+        for(bi = 0; bi < nblocks_false_far; bi++)
+        {
+            STARSH_int bj = false_far[bi];
+            block_near[2*(bi+nblocks_near)] = F->block_far[2*bj];
+            block_near[2*(bi+nblocks_near)+1] = F->block_far[2*bj+1];
+        }
+        // Update list of far-field blocks
+        new_nblocks_far = nblocks_far-nblocks_false_far;
+        if(new_nblocks_far > 0)
+        {
+            STARSH_MALLOC(block_far, 2*new_nblocks_far);
+            bj = 0;
+            for(bi = 0; bi < nblocks_far; bi++)
+            {
+                // `false_far` must be in ascending order for this to work
+                if(bj < nblocks_false_far && false_far[bj] == bi)
+                {
+                    bj++;
+                }
+                else
+                {
+                    block_far[2*(bi-bj)] = F->block_far[2*bi];
+                    block_far[2*(bi-bj)+1] = F->block_far[2*bi+1];
+                }
+            }
+        }
+        // Update format by creating new format
+        STARSH_blrf *F2;
+        info = starsh_blrf_new_from_coo(&F2, P, F->symm, RC, CC,
+                new_nblocks_far, block_far, new_nblocks_near, block_near,
+                F->type);
+        if(info != STARSH_SUCCESS)
+            return info;
+        // Swap internal data of formats and free unnecessary data
+        STARSH_blrf tmp_blrf = *F;
+        *F = *F2;
+        *F2 = tmp_blrf;
+        STARSH_WARNING("`F` was modified due to false far-field blocks");
+        starsh_blrf_free(F2);
+    }
+    // Compute near-field blocks if needed
+    if(onfly == 0 && new_nblocks_near > 0)
+    {
+        STARSH_MALLOC(near_D, new_nblocks_near);
+        size_t size_D = 0;
+        // Simple cycle over all near-field blocks
+        for(bi = 0; bi < new_nblocks_near; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = block_near[2*bi];
+            STARSH_int j = block_near[2*bi+1];
+            // Get corresponding sizes and minimum of them
+            size_t nrows = RC->size[i];
+            size_t ncols = CC->size[j];
+            // Update size_D
+            size_D += nrows*ncols;
+        }
+        STARSH_MALLOC(alloc_D, size_D);
+        // For each near-field block compute its elements
+        for(bi = 0; bi < new_nblocks_near; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = block_near[2*bi];
+            STARSH_int j = block_near[2*bi+1];
+            // Get corresponding sizes and minimum of them
+            int nrows = RC->size[i];
+            int ncols = CC->size[j];
+            int shape[2] = {nrows, ncols};
+            double *D = alloc_D+offset_D;
+            array_from_buffer(near_D+bi, 2, shape, 'd', 'F', D);
+            offset_D += near_D[bi]->size;
+            kernel(nrows, ncols, RC->pivot+RC->start[i],
+                    CC->pivot+CC->start[j], RD, CD, D, nrows);
+        }
+    }
+    // Change sizes of far_rank, far_U and far_V if there were false
+    // far-field blocks
+    if(nblocks_false_far > 0 && new_nblocks_far > 0)
+    {
+        bj = 0;
+        for(bi = 0; bi < nblocks_far; bi++)
+        {
+            if(far_rank[bi] == -1)
+                bj++;
+            else
+            {
+                int shape_U[2] = {far_U[bi]->shape[0], far_rank[bi]};
+                int shape_V[2] = {far_V[bi]->shape[0], far_rank[bi]};
+                array_from_buffer(far_U+bi-bj, 2, shape_U, 'd', 'F',
+                        far_U[bi]->data);
+                array_from_buffer(far_V+bi-bj, 2, shape_V, 'd', 'F',
+                        far_V[bi]->data);
+                far_rank[bi-bj] = far_rank[bi];
+            }
+        }
+        STARSH_REALLOC(far_rank, new_nblocks_far);
+        STARSH_REALLOC(far_U, new_nblocks_far);
+        STARSH_REALLOC(far_V, new_nblocks_far);
+    }
+    // If all far-field blocks are false, then dealloc buffers
+    if(new_nblocks_far == 0 && nblocks_far > 0)
+    {
+        block_far = NULL;
+        free(far_rank);
+        far_rank = NULL;
+        free(far_U);
+        far_U = NULL;
+        free(far_V);
+        far_V = NULL;
+        free(alloc_U);
+        alloc_U = NULL;
+        free(alloc_V);
+        alloc_V = NULL;
+    }
+    // Dealloc list of false far-field blocks if it is not empty
+    if(nblocks_false_far > 0)
+        free(false_far);
+    // Drop negligible far-field blocks, approximated with rank 0
+    info = starsh_blrf_drop_far(F, far_rank, far_U, far_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Store only actual ranks of low-rank factors
+    info = starsh_blrm_pack_far(F->nblocks_far, far_rank, far_U, far_V,
+            (void **)&alloc_U, (void **)&alloc_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Finish with creating instance of Block Low-Rank Matrix with given
+    // buffers
+    return starsh_blrm_new(matrix, F, far_rank, far_U, far_V, onfly, near_D,
+            alloc_U, alloc_V, alloc_D, '1');
+}
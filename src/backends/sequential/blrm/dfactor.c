@@ -0,0 +1,415 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dfactor.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+static int dfactor_compress(int nrows, int ncols, double *D, int ldD,
+        double *U, double *V, int *rank, int maxrank, double tol)
+//! Compress dense tile, truncating its rank to `maxrank`.
+/*! Unlike starsh_dense_dlrsdd(), rank is always truncated to `maxrank`, as
+ * tiles of factor can not be stored in dense format.
+ * */
+{
+    int mn = nrows < ncols ? nrows : ncols;
+    int mx = nrows > ncols ? nrows : ncols;
+    int lwork = (4*mn+7)*mn+mx, i;
+    double *A, *svd_U, *svd_S, *svd_V, *work;
+    int *iwork;
+    STARSH_MALLOC(A, (size_t)nrows*ncols+(size_t)(nrows+ncols+1)*mn+lwork);
+    STARSH_MALLOC(iwork, 8*mn);
+    svd_U = A+(size_t)nrows*ncols;
+    svd_S = svd_U+(size_t)nrows*mn;
+    svd_V = svd_S+mn;
+    work = svd_V+(size_t)ncols*mn;
+    LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', nrows, ncols, D, ldD, A,
+            nrows);
+    LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'S', nrows, ncols, A, nrows, svd_S,
+            svd_U, nrows, svd_V, mn, work, lwork, iwork);
+    *rank = starsh_dense_dsvfr(mn, svd_S, tol);
+    if(*rank > maxrank)
+        *rank = maxrank;
+    for(i = 0; i < *rank; i++)
+    {
+        cblas_dcopy(nrows, svd_U+(size_t)i*nrows, 1, U+(size_t)i*nrows, 1);
+        cblas_dcopy(ncols, svd_V+i, mn, V+(size_t)i*ncols, 1);
+        cblas_dscal(ncols, svd_S[i], V+(size_t)i*ncols, 1);
+    }
+    free(A);
+    free(iwork);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrm__dfactor_init(STARSH_blrm **factor, STARSH_blrm *matrix,
+        char uplo, int maxrank, double tol)
+//! Init TLR factor of a matrix by its tiles.
+/*! Creates new @ref STARSH_blrf object with the same clusterization as
+ * `matrix` and new @ref STARSH_blrm object on top of it. Diagonal tiles are
+ * dense near-field blocks, all other tiles are far-field blocks. If `uplo`
+ * is 'L', then only tiles below diagonal are stored, tile in block row `i`
+ * and block column `j<i` is the far-field block `i*(i-1)/2+j` and `matrix`
+ * must be symmetric. If `uplo` is 'N', then all tiles are stored, tile in
+ * block row `i` and block column `j!=i` is the far-field block
+ * `i*(nb-1)+j` if `j<i` and `i*(nb-1)+j-1` if `j>i`, where `nb` is the
+ * number of block rows. Low-rank factors of each far-field block are
+ * allocated with `min(maxrank,nrows,ncols)` columns, so that updates during
+ * factorization do not require reallocation. Tiles, that are missing in
+ * `matrix`, are zero. Tiles with rank, exceeding `maxrank`, are truncated.
+ * Input `matrix` is not modified. Result must be processed by
+ * starsh_blrm__dfactor_finalize() after factorization.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] matrix: TLR matrix.
+ * @param[in] uplo: 'L' for lower triangular factor or 'N' for all tiles.
+ * @param[in] maxrank: Maximum possible rank of tiles of factor.
+ * @param[in] tol: Relative error tolerance for tiles of factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dfactor_finalize().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *M = matrix;
+    if(factor == NULL)
+    {
+        STARSH_ERROR("Invalid value of `factor`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(M == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(uplo != 'L' && uplo != 'N')
+    {
+        STARSH_ERROR("Invalid value of `uplo`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(maxrank <= 0)
+    {
+        STARSH_ERROR("Invalid value of `maxrank`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = M->format;
+    if(F->type != STARSH_TLR || (uplo == 'L' && F->symm != 'S'))
+    {
+        STARSH_ERROR("Only %sTLR matrices are supported",
+                uplo == 'L' ? "symmetric " : "");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_problem *P = F->problem;
+    if(P->ndim != 2 || P->dtype != 'd')
+    {
+        STARSH_ERROR("Only scalar kernels of double precision are "
+                "supported");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_cluster *R = F->row_cluster, *C = F->col_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int bi, i, j, k, nlimited = 0;
+    if(F->nbcols != nb)
+    {
+        STARSH_ERROR("Number of block rows and block columns must be equal");
+        return STARSH_WRONG_PARAMETER;
+    }
+    for(k = 0; k < nb; k++)
+        if(R->size[k] != C->size[k])
+        {
+            STARSH_ERROR("Diagonal tiles must be square");
+            return STARSH_WRONG_PARAMETER;
+        }
+    STARSH_int nblocks_far = uplo == 'L' ? nb*(nb-1)/2 : nb*(nb-1);
+    STARSH_int nblocks_near = nb;
+    STARSH_int *block_far = NULL, *block_near = NULL, *lookup = NULL;
+    STARSH_blrf *F2 = NULL;
+    int *far_rank = NULL;
+    Array **far_U = NULL, **far_V = NULL, **near_D = NULL;
+    int info = STARSH_SUCCESS;
+    // Find which tiles are present in matrix, tiles of symmetric matrix are
+    // referred by their position in lower triangle
+    STARSH_PMALLOC(lookup, nb*nb, info);
+    if(info != STARSH_SUCCESS)
+        goto cleanup;
+    for(bi = 0; bi < nb*nb; bi++)
+        lookup[bi] = 0;
+    for(bi = 0; bi < F->nblocks_far; bi++)
+    {
+        i = F->block_far[2*bi];
+        j = F->block_far[2*bi+1];
+        lookup[F->symm == 'S' && i < j ? j*nb+i : i*nb+j] = 1;
+    }
+    for(bi = 0; bi < F->nblocks_near; bi++)
+    {
+        i = F->block_near[2*bi];
+        j = F->block_near[2*bi+1];
+        lookup[F->symm == 'S' && i < j ? j*nb+i : i*nb+j] = 2;
+    }
+    // Format of factor
+    if(nblocks_far > 0)
+    {
+        STARSH_PMALLOC(block_far, 2*nblocks_far, info);
+    }
+    STARSH_PMALLOC(block_near, 2*nblocks_near, info);
+    if(info != STARSH_SUCCESS)
+        goto cleanup;
+    k = 0;
+    for(i = 0; i < nb; i++)
+    {
+        for(j = 0; j < (uplo == 'L' ? i : nb); j++)
+        {
+            if(i == j)
+                continue;
+            block_far[2*k] = i;
+            block_far[2*k+1] = j;
+            k++;
+        }
+        block_near[2*i] = i;
+        block_near[2*i+1] = i;
+    }
+    info = starsh_blrf_new_from_coo(&F2, P, 'N', R, C, nblocks_far,
+            block_far, nblocks_near, block_near, STARSH_TLR);
+    if(info != STARSH_SUCCESS)
+    {
+        F2 = NULL;
+        goto cleanup;
+    }
+    // Allocate tiles of factor
+    if(nblocks_far > 0)
+    {
+        STARSH_PMALLOC(far_rank, nblocks_far, info);
+        STARSH_PMALLOC(far_U, nblocks_far, info);
+        STARSH_PMALLOC(far_V, nblocks_far, info);
+    }
+    STARSH_PMALLOC(near_D, nblocks_near, info);
+    // Tiles are allocated one by one, so that cleanup knows which of them
+    // exist
+    for(bi = 0; far_U != NULL && far_V != NULL && bi < nblocks_far; bi++)
+    {
+        far_U[bi] = NULL;
+        far_V[bi] = NULL;
+    }
+    for(bi = 0; near_D != NULL && bi < nblocks_near; bi++)
+        near_D[bi] = NULL;
+    if(info != STARSH_SUCCESS)
+        goto cleanup;
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        i = block_far[2*bi];
+        j = block_far[2*bi+1];
+        int nrows = R->size[i], ncols = C->size[j];
+        int mn = nrows < ncols ? nrows : ncols;
+        int cap = maxrank < mn ? maxrank : mn;
+        int shape[2] = {nrows, cap};
+        double *U, *V;
+        STARSH_PMALLOC(U, (size_t)nrows*cap, info);
+        if(info != STARSH_SUCCESS)
+            goto cleanup;
+        info = array_from_buffer(far_U+bi, 2, shape, 'd', 'F', U);
+        if(info != STARSH_SUCCESS)
+        {
+            free(U);
+            goto cleanup;
+        }
+        STARSH_PMALLOC(V, (size_t)ncols*cap, info);
+        if(info != STARSH_SUCCESS)
+            goto cleanup;
+        shape[0] = ncols;
+        info = array_from_buffer(far_V+bi, 2, shape, 'd', 'F', V);
+        if(info != STARSH_SUCCESS)
+        {
+            free(V);
+            goto cleanup;
+        }
+        far_rank[bi] = 0;
+        // Symmetric matrix stores only lower triangle, so upper tiles are
+        // transposed lower tiles
+        STARSH_int ti = i, tj = j;
+        if(F->symm == 'S' && i < j)
+        {
+            ti = j;
+            tj = i;
+            U = far_V[bi]->data;
+            V = far_U[bi]->data;
+            nrows = R->size[ti];
+            ncols = C->size[tj];
+        }
+        if(lookup[ti*nb+tj] == 0)
+            continue;
+        int tile_shape[2], tile_rank;
+        void *tile_U, *tile_V, *tile_D;
+        info = starsh_blrm_get_block(M, ti, tj, tile_shape, &tile_rank,
+                &tile_U, &tile_V, &tile_D);
+        if(info != STARSH_SUCCESS)
+            goto cleanup;
+        if(tile_D != NULL)
+        {
+            // Tile is dense, either near-field or restored out of shared
+            // bases
+            info = dfactor_compress(nrows, ncols, tile_D, nrows, U, V,
+                    far_rank+bi, cap, tol);
+            if(lookup[ti*nb+tj] == 2 ? M->onfly == 1 : M->uniform == 1)
+                free(tile_D);
+            if(info != STARSH_SUCCESS)
+                goto cleanup;
+            if(far_rank[bi] == cap && cap < mn)
+                nlimited++;
+        }
+        else if(tile_rank <= cap)
+        {
+            far_rank[bi] = tile_rank;
+            LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', nrows, tile_rank,
+                    tile_U, nrows, U, nrows);
+            LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', ncols, tile_rank,
+                    tile_V, ncols, V, ncols);
+        }
+        else
+        {
+            // Recompress low-rank tile with smaller maximum rank
+            int r = tile_rank;
+            int lwork = (nrows+ncols+9*r+11)*r, *iwork;
+            double *work;
+            STARSH_PMALLOC(work, lwork, info);
+            STARSH_PMALLOC(iwork, 8*r, info);
+            if(info == STARSH_SUCCESS)
+            {
+                starsh_dense_dlradd(nrows, ncols, tile_rank, 1.0, tile_U,
+                        nrows, tile_V, ncols, U, nrows, V, ncols,
+                        far_rank+bi, cap, tol, work, lwork, iwork);
+                nlimited++;
+            }
+            free(work);
+            free(iwork);
+            if(info != STARSH_SUCCESS)
+                goto cleanup;
+        }
+    }
+    for(bi = 0; bi < nblocks_near; bi++)
+    {
+        int n = R->size[bi];
+        int shape[2] = {n, n};
+        double *D;
+        STARSH_PMALLOC(D, (size_t)n*n, info);
+        if(info != STARSH_SUCCESS)
+            goto cleanup;
+        info = array_from_buffer(near_D+bi, 2, shape, 'd', 'F', D);
+        if(info != STARSH_SUCCESS)
+        {
+            free(D);
+            goto cleanup;
+        }
+        if(lookup[bi*nb+bi] == 0)
+        {
+            LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'A', n, n, 0.0, 0.0, D, n);
+            continue;
+        }
+        int tile_shape[2], tile_rank;
+        void *tile_U, *tile_V, *tile_D;
+        info = starsh_blrm_get_block(M, bi, bi, tile_shape, &tile_rank,
+                &tile_U, &tile_V, &tile_D);
+        if(info != STARSH_SUCCESS)
+            goto cleanup;
+        if(tile_D != NULL)
+        {
+            LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', n, n, tile_D, n, D, n);
+            if(lookup[bi*nb+bi] == 2 ? M->onfly == 1 : M->uniform == 1)
+                free(tile_D);
+        }
+        else if(tile_rank > 0)
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, n, n,
+                    tile_rank, 1.0, tile_U, n, tile_V, n, 0.0, D, n);
+        else
+            LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'A', n, n, 0.0, 0.0, D, n);
+    }
+cleanup:
+    free(lookup);
+    if(info != STARSH_SUCCESS)
+    {
+        // Tiles, that were not allocated, are NULL
+        for(bi = 0; far_U != NULL && far_V != NULL && bi < nblocks_far; bi++)
+        {
+            array_free(far_U[bi]);
+            array_free(far_V[bi]);
+        }
+        for(bi = 0; near_D != NULL && bi < nblocks_near; bi++)
+            array_free(near_D[bi]);
+        free(far_rank);
+        free(far_U);
+        free(far_V);
+        free(near_D);
+        // Format owns lists of blocks
+        if(F2 != NULL)
+            starsh_blrf_free(F2);
+        else
+        {
+            free(block_far);
+            free(block_near);
+        }
+        return info;
+    }
+    if(nlimited > 0)
+    {
+        STARSH_WARNING("Rank of %zu tiles was truncated to maxrank=%d",
+                (size_t)nlimited, maxrank);
+    }
+    return starsh_blrm_new(factor, F2, far_rank, far_U, far_V, 0, near_D,
+            NULL, NULL, NULL, '2');
+}
+
+int starsh_blrm__dfactor_finalize(STARSH_blrm *factor)
+//! Shrink low-rank factors of TLR factor to their actual ranks.
+/*! Low-rank factors of far-field blocks are allocated by
+ * starsh_blrm__dfactor_init() with maximum possible number of columns. This
+ * function reallocates them in accordance with their final ranks and updates
+ * memory footprint of `factor`.
+ *
+ * @param[in,out] factor: TLR factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dfactor_init().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L = factor;
+    STARSH_blrf *F = L->format;
+    STARSH_int bi;
+    size_t size = sizeof(*L), data_size = 0;
+    size += F->nblocks_far*(sizeof(*L->far_rank)+sizeof(*L->far_U)
+            +sizeof(*L->far_V));
+    size += F->nblocks_near*sizeof(*L->near_D);
+    for(bi = 0; bi < F->nblocks_far; bi++)
+    {
+        int rank = L->far_rank[bi];
+        if(rank < L->far_U[bi]->shape[1])
+        {
+            int shape[2] = {L->far_U[bi]->shape[0], rank};
+            double *U = L->far_U[bi]->data, *V = L->far_V[bi]->data;
+            // Keep at least one element to avoid realloc() of zero size
+            STARSH_REALLOC(U, (size_t)shape[0]*rank+1);
+            L->far_U[bi]->data = NULL;
+            array_free(L->far_U[bi]);
+            array_from_buffer(L->far_U+bi, 2, shape, 'd', 'F', U);
+            shape[0] = L->far_V[bi]->shape[0];
+            STARSH_REALLOC(V, (size_t)shape[0]*rank+1);
+            L->far_V[bi]->data = NULL;
+            array_free(L->far_V[bi]);
+            array_from_buffer(L->far_V+bi, 2, shape, 'd', 'F', V);
+        }
+        size += L->far_U[bi]->nbytes+L->far_V[bi]->nbytes;
+        data_size += L->far_U[bi]->data_nbytes+L->far_V[bi]->data_nbytes;
+    }
+    for(bi = 0; bi < F->nblocks_near; bi++)
+    {
+        size += L->near_D[bi]->nbytes;
+        data_size += L->near_D[bi]->data_nbytes;
+    }
+    L->nbytes = size;
+    L->data_nbytes = data_size;
+    return STARSH_SUCCESS;
+}
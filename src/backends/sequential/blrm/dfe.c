@@ -52,8 +52,6 @@ double starsh_blrm__dfe(STARSH_blrm *matrix)
         STARSH_int j = F->block_far[2*bi+1];
         int nrows = R->size[i];
         int ncols = C->size[j];
-        // Rank of a block
-        int rank = M->far_rank[bi];
         // Temporary array for more precise dnrm2
         double *D, D_norm[ncols];
         size_t D_size = (size_t)nrows*(size_t)ncols;
@@ -67,9 +65,25 @@ double starsh_blrm__dfe(STARSH_blrm *matrix)
         double tmpnorm = cblas_dnrm2(ncols, D_norm, 1);
         far_block_norm[bi] = tmpnorm;
         // Get difference of initial and approximated block
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
-                rank, -1., U[bi]->data, nrows, V[bi]->data, ncols, 1.,
-                D, nrows);
+        if(M->uniform == 0)
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
+                    M->far_rank[bi], -1., U[bi]->data, nrows, V[bi]->data,
+                    ncols, 1., D, nrows);
+        else if(M->far_S[bi]->shape[0] > 0 && M->far_S[bi]->shape[1] > 0)
+        {
+            // Approximation is a product of shared bases and coupling matrix
+            int rank_U = M->far_S[bi]->shape[0];
+            int rank_V = M->far_S[bi]->shape[1];
+            double *tmp;
+            STARSH_MALLOC(tmp, (size_t)nrows*rank_V);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    rank_V, rank_U, 1., M->row_U[i]->data, nrows,
+                    M->far_S[bi]->data, rank_U, 0., tmp, nrows);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
+                    rank_V, -1., tmp, nrows, M->col_V[j]->data, ncols, 1.,
+                    D, nrows);
+            free(tmp);
+        }
         // Compute Frobenius norm of the latter
         for(STARSH_int k = 0; k < ncols; k++)
             D_norm[k] = cblas_dnrm2(nrows, D+k*(size_t)nrows, 1);
@@ -126,9 +140,73 @@ double starsh_blrm__dfe(STARSH_blrm *matrix)
                 // Multiply by square root of 2 ub symmetric case
                 near_block_norm[bi] *= sqrt2;
         }
+    // Blocks, dropped as numerical zeros, add to both error and norm
+    STARSH_int nblocks_drop, *block_drop;
+    double drop_norm2 = 0;
+    if(starsh_blrf_get_dropped(F, &nblocks_drop, &block_drop)
+            != STARSH_SUCCESS)
+        return -1;
+    if(nblocks_drop > 0)
+    {
+        int info = starsh_blrm__dnorm_dropped(F, nblocks_drop, block_drop, 0,
+                1, &drop_norm2);
+        free(block_drop);
+        if(info != STARSH_SUCCESS)
+            return -1;
+    }
     // Get difference of initial and approximated matrices
     double diff = cblas_dnrm2(nblocks_far, far_block_diff, 1);
     // Get norm of initial matrix
     double norm = cblas_dnrm2(nblocks, block_norm, 1);
+    diff = sqrt(diff*diff+drop_norm2);
+    norm = sqrt(norm*norm+drop_norm2);
     return diff/norm;
 }
+
+int starsh_blrm__dnorm_dropped(STARSH_blrf *format, STARSH_int nblocks,
+        STARSH_int *block, STARSH_int start, STARSH_int step, double *norm2)
+//! Squared Frobenius norm of blocks, dropped from a format.
+/*! Blocks, removed by @ref starsh_blrf_drop_far(), are not stored, so their
+ * elements are computed again by the kernel. Only blocks `start`,
+ * `start+step`, `start+2*step` and so on of a given list are processed,
+ * which allows to split work among threads or MPI processes. In symmetric
+ * case off-diagonal blocks are counted twice.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] nblocks: Number of dropped blocks.
+ * @param[in] block: Coordinates of dropped blocks, as returned by @ref
+ *      starsh_blrf_get_dropped().
+ * @param[in] start: First block to process.
+ * @param[in] step: Step between processed blocks.
+ * @param[out] norm2: Sum of squared Frobenius norms of processed blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_problem *P = F->problem;
+    STARSH_cluster *R = F->row_cluster, *C = F->col_cluster;
+    STARSH_int bi;
+    double result = 0;
+    for(bi = start; bi < nblocks; bi += step)
+    {
+        STARSH_int i = block[2*bi];
+        STARSH_int j = block[2*bi+1];
+        int nrows = R->size[i];
+        int ncols = C->size[j];
+        double *D, D_norm[ncols];
+        STARSH_MALLOC(D, (size_t)nrows*(size_t)ncols);
+        P->kernel(nrows, ncols, R->pivot+R->start[i], C->pivot+C->start[j],
+                R->data, C->data, D, nrows);
+        for(STARSH_int k = 0; k < ncols; k++)
+            D_norm[k] = cblas_dnrm2(nrows, D+k*(size_t)nrows, 1);
+        free(D);
+        double tmpnorm = cblas_dnrm2(ncols, D_norm, 1);
+        tmpnorm *= tmpnorm;
+        if(i != j && F->symm == 'S')
+            tmpnorm *= 2;
+        result += tmpnorm;
+    }
+    *norm2 = result;
+    return STARSH_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dgetrf.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dgetrf(STARSH_blrm **factor, int *ipiv, STARSH_blrm *matrix,
+        int maxrank, double tol)
+//! TLR LU factorization of a square matrix.
+/*! Computes TLR matrix, containing unit lower triangular factor `L` and upper
+ * triangular factor `U`, such that `P*A=L*U`, where `A` is a given TLR
+ * matrix and `P` is a block diagonal permutation matrix. There is no
+ * pivoting across tiles, rows are only permuted inside diagonal tiles with
+ * the help of partial pivoting of LAPACK dgetrf. If `ipiv` is NULL, then
+ * no pivoting is performed at all and `P` is identity. Factorization is
+ * right-looking: after LU factorization of a diagonal tile, tiles to the
+ * right of it and below it are updated by triangular solves, and all tiles
+ * of trailing submatrix are updated by low-rank products. Updated low-rank
+ * tiles are recompressed in the same way as in starsh_blrm__dpotrf().
+ *
+ * Factor is stored in a new @ref STARSH_blrm object with its own @ref
+ * STARSH_blrf object, see starsh_blrm__dfactor_init() with `uplo='N'` for
+ * its layout. Diagonal tiles store both `L` and `U` in LAPACK format, tiles
+ * below diagonal belong to `L` and tiles above diagonal belong to `U`.
+ * Input `matrix` can be symmetric or non-symmetric, but its row and column
+ * clusterizations must produce square diagonal tiles. Input `matrix` is not
+ * modified. Both `factor` and `factor->format` must be freed by user.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[out] ipiv: Array of pivot indices or NULL. It has as many elements,
+ *      as there are rows in `matrix`. Pivots of each diagonal tile are
+ *      stored in place of its rows and start from 1 inside the tile.
+ * @param[in] matrix: TLR matrix.
+ * @param[in] maxrank: Maximum possible rank of tiles of factor.
+ * @param[in] tol: Relative error tolerance for tiles of factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dgetrs().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L;
+    int info = starsh_blrm__dfactor_init(&L, matrix, 'N', maxrank, tol);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int i, j, k, nlimited = 0;
+    // Get maximum size of tiles and maximum rank to allocate workspace
+    int maxsize = 0, maxr;
+    for(k = 0; k < nb; k++)
+        if(R->size[k] > maxsize)
+            maxsize = R->size[k];
+    maxr = maxrank < maxsize ? maxrank : maxsize;
+    int lwork = (2*maxsize+18*maxr+11)*2*maxr+maxr*(maxr+maxsize);
+    int *iwork;
+    double *work;
+    STARSH_MALLOC(work, lwork);
+    STARSH_MALLOC(iwork, 16*maxr);
+    for(k = 0; k < nb; k++)
+    {
+        int nk = R->size[k];
+        double *Dkk = L->near_D[k]->data;
+        int *ipivk = ipiv == NULL ? NULL : ipiv+R->start[k];
+        // Factorize diagonal tile
+        info = starsh_dense_dgetrf(nk, Dkk, nk, ipivk);
+        if(info != 0)
+        {
+            STARSH_ERROR("Diagonal tile %zu is singular", (size_t)k);
+            free(work);
+            free(iwork);
+            starsh_blrm_free(L);
+            starsh_blrf_free(F);
+            return STARSH_SINGULAR_MATRIX;
+        }
+        // Apply row interchanges to all tiles of current block row and solve
+        // for tiles to the right of diagonal one
+        for(j = 0; j < nb; j++)
+        {
+            if(j == k)
+                continue;
+            STARSH_int bkj = k*(nb-1)+(j < k ? j : j-1);
+            int rank = L->far_rank[bkj];
+            if(rank == 0)
+                continue;
+            if(ipivk != NULL)
+                LAPACKE_dlaswp_work(LAPACK_COL_MAJOR, rank,
+                        L->far_U[bkj]->data, nk, 1, nk, ipivk, 1);
+            if(j > k)
+                cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                        CblasNoTrans, CblasUnit, nk, rank, 1.0, Dkk, nk,
+                        L->far_U[bkj]->data, nk);
+        }
+        // Solve for tiles below diagonal one
+        for(i = k+1; i < nb; i++)
+        {
+            STARSH_int bik = i*(nb-1)+k;
+            if(L->far_rank[bik] > 0)
+                cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper, CblasTrans,
+                        CblasNonUnit, nk, L->far_rank[bik], 1.0, Dkk, nk,
+                        L->far_V[bik]->data, nk);
+        }
+        // Update trailing submatrix
+        for(i = k+1; i < nb; i++)
+        {
+            STARSH_int bik = i*(nb-1)+k;
+            int ni = R->size[i];
+            if(L->far_rank[bik] == 0)
+                continue;
+            for(j = k+1; j < nb; j++)
+            {
+                STARSH_int bkj = k*(nb-1)+j-1;
+                int nj = R->size[j];
+                if(i == j)
+                {
+                    starsh_dense_dlrgemmd(ni, ni, nk, L->far_rank[bik],
+                            L->far_U[bik]->data, ni, L->far_V[bik]->data, nk,
+                            L->far_rank[bkj], L->far_V[bkj]->data, ni,
+                            L->far_U[bkj]->data, nk, L->near_D[i]->data, ni,
+                            work);
+                    continue;
+                }
+                STARSH_int bij = i*(nb-1)+(j < i ? j : j-1);
+                nlimited += starsh_dense_dlrgemm(ni, nj, nk,
+                        L->far_rank[bik], L->far_U[bik]->data, ni,
+                        L->far_V[bik]->data, nk, L->far_rank[bkj],
+                        L->far_V[bkj]->data, nj, L->far_U[bkj]->data, nk,
+                        L->far_U[bij]->data, ni, L->far_V[bij]->data, nj,
+                        L->far_rank+bij, L->far_U[bij]->shape[1], tol, work,
+                        lwork, iwork);
+            }
+        }
+    }
+    free(work);
+    free(iwork);
+    if(nlimited > 0)
+    {
+        STARSH_WARNING("Rank of %zu updated tiles was truncated to maxrank=%d",
+                (size_t)nlimited, maxrank);
+    }
+    info = starsh_blrm__dfactor_finalize(L);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *factor = L;
+    return STARSH_SUCCESS;
+}
@@ -0,0 +1,103 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dgetrs.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dgetrs(STARSH_blrm *factor, int *ipiv, int nrhs, double *B,
+        int ldb)
+//! Solve system with TLR LU factorization.
+/*! Solves `A*X=B`, where `P*A=L*U` is computed by starsh_blrm__dgetrf().
+ * Rows of `B` are permuted inside each diagonal tile, then systems with unit
+ * lower triangular `L` and upper triangular `U` are solved by forward and
+ * backward substitutions. Solution overwrites `B`. Rows of `B` are ordered
+ * in the same way as in starsh_blrm__dmml().
+ *
+ * @param[in] factor: TLR LU factor.
+ * @param[in] ipiv: Pivot indices, returned by starsh_blrm__dgetrf(), or
+ *      NULL if factorization was computed without pivoting.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in,out] B: Right hand side as input, solution as output.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L = factor;
+    if(L == NULL)
+    {
+        STARSH_ERROR("Invalid value of `factor`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int i, k, bi;
+    int maxrank = 0;
+    double *tmp;
+    for(bi = 0; bi < F->nblocks_far; bi++)
+        if(L->far_rank[bi] > maxrank)
+            maxrank = L->far_rank[bi];
+    STARSH_MALLOC(tmp, (size_t)nrhs*maxrank+1);
+    // Apply row interchanges inside diagonal tiles before any update, since
+    // far-field tiles of `L` are already permuted by starsh_blrm__dgetrf()
+    if(ipiv != NULL)
+        for(k = 0; k < nb; k++)
+            LAPACKE_dlaswp_work(LAPACK_COL_MAJOR, nrhs, B+R->start[k], ldb, 1,
+                    R->size[k], ipiv+R->start[k], 1);
+    // Forward substitution
+    for(k = 0; k < nb; k++)
+    {
+        int nk = R->size[k];
+        double *Bk = B+R->start[k];
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans,
+                CblasUnit, nk, nrhs, 1.0, L->near_D[k]->data, nk, Bk, ldb);
+        for(i = k+1; i < nb; i++)
+        {
+            int ni = R->size[i];
+            bi = i*(nb-1)+k;
+            int rank = L->far_rank[bi];
+            if(rank == 0)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    nk, 1.0, L->far_V[bi]->data, nk, Bk, ldb, 0.0, tmp,
+                    rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ni, nrhs,
+                    rank, -1.0, L->far_U[bi]->data, ni, tmp, rank, 1.0,
+                    B+R->start[i], ldb);
+        }
+    }
+    // Backward substitution
+    for(k = nb-1; k >= 0; k--)
+    {
+        int nk = R->size[k];
+        double *Bk = B+R->start[k];
+        for(i = k+1; i < nb; i++)
+        {
+            int ni = R->size[i];
+            bi = k*(nb-1)+i-1;
+            int rank = L->far_rank[bi];
+            if(rank == 0)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    ni, 1.0, L->far_V[bi]->data, ni, B+R->start[i], ldb, 0.0,
+                    tmp, rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nk, nrhs,
+                    rank, -1.0, L->far_U[bi]->data, nk, tmp, rank, 1.0, Bk,
+                    ldb);
+        }
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper, CblasNoTrans,
+                CblasNonUnit, nk, nrhs, 1.0, L->near_D[k]->data, nk, Bk, ldb);
+    }
+    free(tmp);
+    return STARSH_SUCCESS;
+}
@@ -56,36 +56,116 @@ int starsh_blrm__dmml(STARSH_blrm *matrix, int nrhs, double alpha, double *A,
         for(size_t i = 0; i < nrhs; i++)
             for(size_t j = 0; j < nrows; j++)
                 B[i*ldb+j] *= beta;
-    // Simple cycle over all far-field admissible blocks
-    for(bi = 0; bi < nblocks_far; bi++)
+    if(M->uniform == 1)
     {
-        // Get indexes of corresponding block row and block column
-        STARSH_int i = F->block_far[2*bi];
-        STARSH_int j = F->block_far[2*bi+1];
-        // Get sizes and rank in int type due to BLAS calls
-        int nrows = R->size[i];
-        int ncols = C->size[j];
-        int rank = M->far_rank[bi];
-        // Get pointers to data buffers
-        double *D, *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
-        // Allocate temporary buffer
-        STARSH_MALLOC(D, nrhs*(size_t)rank);
-        // Multiply low-rank matrix in U*V^T format by a dense matrix
-        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-                ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
-        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs,
-                rank, alpha, U, nrows, D, rank, 1.0, B+R->start[i], ldb);
-        if(i != j && symm == 'S')
+        // Far-field blocks share bases of block rows and block columns. At
+        // first project right hand side onto bases of block columns, then
+        // multiply projections by coupling matrices and finally expand
+        // results by bases of block rows.
+        STARSH_int nbrows = F->nbrows, nbcols = F->nbcols;
+        size_t *offset_X, *offset_Y, size_X = 0, size_Y = 0;
+        double *X, *Y;
+        STARSH_MALLOC(offset_X, nbcols);
+        STARSH_MALLOC(offset_Y, nbrows);
+        for(bi = 0; bi < nbcols; bi++)
         {
-            // Multiply low-rank matrix in V*U^T format by a dense matrix
-            // U and V are simply swapped in case of symmetric block
+            offset_X[bi] = size_X;
+            size_X += (size_t)nrhs*M->col_rank[bi];
+        }
+        for(bi = 0; bi < nbrows; bi++)
+        {
+            offset_Y[bi] = size_Y;
+            size_Y += (size_t)nrhs*M->row_rank[bi];
+        }
+        STARSH_MALLOC(X, size_X+1);
+        STARSH_MALLOC(Y, size_Y+1);
+        for(size_t k = 0; k < size_Y; k++)
+            Y[k] = 0.;
+        // Project right hand side onto bases of block columns
+        for(bi = 0; bi < nbcols; bi++)
+        {
+            int ncols = C->size[bi];
+            int rank = M->col_rank[bi];
+            if(rank == 0)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
+                    ncols, 1.0, M->col_V[bi]->data, ncols, A+C->start[bi],
+                    lda, 0.0, X+offset_X[bi], rank);
+        }
+        // Multiply projections by coupling matrices
+        for(bi = 0; bi < nblocks_far; bi++)
+        {
+            STARSH_int i = F->block_far[2*bi];
+            STARSH_int j = F->block_far[2*bi+1];
+            // Coupling matrix uses only leading vectors of bases
+            int rank_U = M->far_S[bi]->shape[0];
+            int rank_V = M->far_S[bi]->shape[1];
+            double *S = M->far_S[bi]->data;
+            if(rank_U == 0 || rank_V == 0)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, rank_U,
+                    nrhs, rank_V, 1.0, S, rank_U, X+offset_X[j],
+                    M->col_rank[j], 1.0, Y+offset_Y[i], M->row_rank[i]);
+            if(i != j && symm == 'S')
+            {
+                // Block rows and block columns share bases in symmetric case
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank_V,
+                        nrhs, rank_U, 1.0, S, rank_U, X+offset_X[i],
+                        M->row_rank[i], 1.0, Y+offset_Y[j], M->col_rank[j]);
+            }
+        }
+        // Expand results by bases of block rows
+        for(bi = 0; bi < nbrows; bi++)
+        {
+            int nrows = R->size[bi];
+            int rank = M->row_rank[bi];
+            if(rank == 0)
+                continue;
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    nrhs, rank, alpha, M->row_U[bi]->data, nrows,
+                    Y+offset_Y[bi], rank, 1.0, B+R->start[bi], ldb);
+        }
+        free(offset_X);
+        free(offset_Y);
+        free(X);
+        free(Y);
+    }
+    else
+    {
+        // Simple cycle over all far-field admissible blocks
+        for(bi = 0; bi < nblocks_far; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = F->block_far[2*bi];
+            STARSH_int j = F->block_far[2*bi+1];
+            // Get sizes and rank in int type due to BLAS calls
+            int nrows = R->size[i];
+            int ncols = C->size[j];
+            int rank = M->far_rank[bi];
+            if(rank == 0)
+                continue;
+            // Get pointers to data buffers
+            double *D, *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
+            // Allocate temporary buffer
+            STARSH_MALLOC(D, nrhs*(size_t)rank);
+            // Multiply low-rank matrix in U*V^T format by a dense matrix
             cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-                    nrows, 1.0, U, nrows, A+R->start[i], lda, 0.0, D, rank);
-            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
-                    nrhs, rank, alpha, V, ncols, D, rank, 1.0,
-                    B+C->start[j], ldb);
+                    ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs,
+                    rank, alpha, U, nrows, D, rank, 1.0, B+R->start[i], ldb);
+            if(i != j && symm == 'S')
+            {
+                // Multiply low-rank matrix in V*U^T format by a dense matrix
+                // U and V are simply swapped in case of symmetric block
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, nrows, 1.0, U, nrows, A+R->start[i], lda, 0.0,
+                        D, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
+                        nrhs, rank, alpha, V, ncols, D, rank, 1.0,
+                        B+C->start[j], ldb);
+            }
+            free(D);
         }
-        free(D);
     }
     if(M->onfly == 1)
         // Simple cycle over all near-field blocks
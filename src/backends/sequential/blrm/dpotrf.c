@@ -0,0 +1,118 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dpotrf.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dpotrf(STARSH_blrm **factor, STARSH_blrm *matrix,
+        int maxrank, double tol)
+//! TLR Cholesky factorization of a symmetric positive definite matrix.
+/*! Computes lower triangular TLR matrix `L`, such that `A=L*L^T`, where `A` is
+ * a given symmetric TLR matrix. Factorization is right-looking: after
+ * Cholesky factorization of a diagonal tile, tiles below it are updated by
+ * triangular solve, and all tiles of trailing submatrix are updated by
+ * low-rank products. Updated low-rank tiles are recompressed with the help of
+ * QR factorizations of concatenated factors and GESDD (see
+ * starsh_dense_dlradd()). Input `matrix` is not modified, so it can be used
+ * later, e.g. for iterative refinement. Factor is a new @ref STARSH_blrm
+ * object with its own @ref STARSH_blrf object, both must be freed by user:
+ * starsh_blrm_free() and then starsh_blrf_free() for `factor->format`.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] matrix: Symmetric positive definite TLR matrix.
+ * @param[in] maxrank: Maximum possible rank of tiles of factor.
+ * @param[in] tol: Relative error tolerance for tiles of factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dpotrs().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L;
+    int info = starsh_blrm__dfactor_init(&L, matrix, 'L', maxrank, tol);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int i, j, k, nlimited = 0;
+    // Get maximum size of tiles and maximum rank to allocate workspace
+    int maxsize = 0, maxr;
+    for(k = 0; k < nb; k++)
+        if(R->size[k] > maxsize)
+            maxsize = R->size[k];
+    maxr = maxrank < maxsize ? maxrank : maxsize;
+    int lwork = (2*maxsize+18*maxr+11)*2*maxr+maxr*(maxr+maxsize);
+    int *iwork;
+    double *work;
+    STARSH_MALLOC(work, lwork);
+    STARSH_MALLOC(iwork, 16*maxr);
+    for(k = 0; k < nb; k++)
+    {
+        int nk = R->size[k];
+        double *Lkk = L->near_D[k]->data;
+        // Factorize diagonal tile and zero its upper triangle
+        info = LAPACKE_dpotrf_work(LAPACK_COL_MAJOR, 'L', nk, Lkk, nk);
+        if(info != 0)
+        {
+            STARSH_ERROR("Diagonal tile %zu is not positive definite",
+                    (size_t)k);
+            free(work);
+            free(iwork);
+            starsh_blrm_free(L);
+            starsh_blrf_free(F);
+            return STARSH_NOT_POSITIVE_DEFINITE;
+        }
+        if(nk > 1)
+            LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'U', nk-1, nk-1, 0.0, 0.0,
+                    Lkk+nk, nk);
+        // Solve for tiles of current block column
+        for(i = k+1; i < nb; i++)
+        {
+            STARSH_int bi = i*(i-1)/2+k;
+            if(L->far_rank[bi] > 0)
+                cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                        CblasNoTrans, CblasNonUnit, nk, L->far_rank[bi], 1.0,
+                        Lkk, nk, L->far_V[bi]->data, nk);
+        }
+        // Update trailing submatrix
+        for(i = k+1; i < nb; i++)
+        {
+            STARSH_int bi = i*(i-1)/2+k;
+            int ni = R->size[i];
+            starsh_dense_dlrsyrk(ni, nk, L->far_rank[bi], L->far_U[bi]->data,
+                    ni, L->far_V[bi]->data, nk, L->near_D[i]->data, ni, work);
+            for(j = k+1; j < i; j++)
+            {
+                STARSH_int bj = j*(j-1)/2+k, bij = i*(i-1)/2+j;
+                int nj = R->size[j];
+                nlimited += starsh_dense_dlrgemm(ni, nj, nk, L->far_rank[bi],
+                        L->far_U[bi]->data, ni, L->far_V[bi]->data, nk,
+                        L->far_rank[bj], L->far_U[bj]->data, nj,
+                        L->far_V[bj]->data, nk, L->far_U[bij]->data, ni,
+                        L->far_V[bij]->data, nj, L->far_rank+bij,
+                        L->far_U[bij]->shape[1], tol, work, lwork, iwork);
+            }
+        }
+    }
+    free(work);
+    free(iwork);
+    if(nlimited > 0)
+    {
+        STARSH_WARNING("Rank of %zu updated tiles was truncated to maxrank=%d",
+                (size_t)nlimited, maxrank);
+    }
+    info = starsh_blrm__dfactor_finalize(L);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *factor = L;
+    return STARSH_SUCCESS;
+}
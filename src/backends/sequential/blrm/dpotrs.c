@@ -0,0 +1,137 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dpotrs.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dtrsm(STARSH_blrm *factor, char trans, int nrhs, double *B,
+        int ldb)
+//! Solve system with lower triangular TLR matrix.
+/*! Solves `L*X=B` if `trans` is 'N' or `L^T*X=B` if `trans` is 'T', where
+ * `L` is a TLR Cholesky factor, computed by starsh_blrm__dpotrf(). Solution
+ * overwrites `B`. Rows of `B` are ordered in the same way as in
+ * starsh_blrm__dmml().
+ *
+ * @param[in] factor: TLR Cholesky factor.
+ * @param[in] trans: 'N' for `L` or 'T' for transposed `L`.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in,out] B: Right hand side as input, solution as output.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L = factor;
+    if(L == NULL)
+    {
+        STARSH_ERROR("Invalid value of `factor`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(trans != 'N' && trans != 'T')
+    {
+        STARSH_ERROR("Invalid value of `trans`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows;
+    STARSH_int i, k, bi;
+    int maxrank = 0;
+    double *tmp;
+    for(bi = 0; bi < F->nblocks_far; bi++)
+        if(L->far_rank[bi] > maxrank)
+            maxrank = L->far_rank[bi];
+    if(F->nblocks_far == 0)
+    {
+        // Factor is block diagonal, e.g. block-Jacobi preconditioner
+        for(k = 0; k < nb; k++)
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower,
+                    trans == 'N' ? CblasNoTrans : CblasTrans, CblasNonUnit,
+                    R->size[k], nrhs, 1.0, L->near_D[k]->data, R->size[k],
+                    B+R->start[k], ldb);
+        return STARSH_SUCCESS;
+    }
+    STARSH_MALLOC(tmp, (size_t)nrhs*maxrank+1);
+    if(trans == 'N')
+    {
+        // Forward substitution
+        for(k = 0; k < nb; k++)
+        {
+            int nk = R->size[k];
+            double *Bk = B+R->start[k];
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans,
+                    CblasNonUnit, nk, nrhs, 1.0, L->near_D[k]->data, nk, Bk,
+                    ldb);
+            for(i = k+1; i < nb; i++)
+            {
+                int ni = R->size[i];
+                bi = i*(i-1)/2+k;
+                int rank = L->far_rank[bi];
+                if(rank == 0)
+                    continue;
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, nk, 1.0, L->far_V[bi]->data, nk, Bk, ldb, 0.0,
+                        tmp, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ni,
+                        nrhs, rank, -1.0, L->far_U[bi]->data, ni, tmp, rank,
+                        1.0, B+R->start[i], ldb);
+            }
+        }
+    }
+    else
+    {
+        // Backward substitution
+        for(k = nb-1; k >= 0; k--)
+        {
+            int nk = R->size[k];
+            double *Bk = B+R->start[k];
+            for(i = k+1; i < nb; i++)
+            {
+                int ni = R->size[i];
+                bi = i*(i-1)/2+k;
+                int rank = L->far_rank[bi];
+                if(rank == 0)
+                    continue;
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank,
+                        nrhs, ni, 1.0, L->far_U[bi]->data, ni, B+R->start[i],
+                        ldb, 0.0, tmp, rank);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nk,
+                        nrhs, rank, -1.0, L->far_V[bi]->data, nk, tmp, rank,
+                        1.0, Bk, ldb);
+            }
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasTrans,
+                    CblasNonUnit, nk, nrhs, 1.0, L->near_D[k]->data, nk, Bk,
+                    ldb);
+        }
+    }
+    free(tmp);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrm__dpotrs(STARSH_blrm *factor, int nrhs, double *B, int ldb)
+//! Solve system with TLR Cholesky factorization.
+/*! Solves `A*X=B`, where `A=L*L^T` and `L` is computed by
+ * starsh_blrm__dpotrf(). Solution overwrites `B`.
+ *
+ * @param[in] factor: TLR Cholesky factor.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in,out] B: Right hand side as input, solution as output.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup factor
+ * */
+{
+    int info = starsh_blrm__dtrsm(factor, 'N', nrhs, B, ldb);
+    if(info != STARSH_SUCCESS)
+        return info;
+    return starsh_blrm__dtrsm(factor, 'T', nrhs, B, ldb);
+}
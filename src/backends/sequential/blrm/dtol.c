@@ -0,0 +1,120 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dtol.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dtol(STARSH_blrf *format, double tol, double *abstol)
+//! Absolute tolerance of each far-field tile for given global tolerance.
+/*! Estimates Frobenius norm of the entire matrix by a few equally spaced rows
+ * of each tile with starsh_blrm__dnorm_sample() and distributes error budget
+ * `tol`*\f$ \|A\|_F \f$ uniformly among far-field tiles. If each far-field
+ * tile is approximated with absolute error in Frobenius norm, not exceeding
+ * `abstol`, then relative error of the entire approximation does not exceed
+ * `tol`.
+ *
+ * @param[in] format: Block low-rank format.
+ * @param[in] tol: Relative error tolerance for the entire matrix.
+ * @param[out] abstol: Absolute error tolerance for each far-field tile.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    double norm_far, norm_near, nfar, nnear;
+    int info;
+    *abstol = 0.;
+    info = starsh_blrm__dnorm_sample(F, F->nblocks_far, F->block_far, 0, 1,
+            &norm_far, &nfar);
+    if(info != STARSH_SUCCESS)
+        return info;
+    info = starsh_blrm__dnorm_sample(F, F->nblocks_near, F->block_near, 0, 1,
+            &norm_near, &nnear);
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(nfar > 0)
+        *abstol = tol*sqrt((norm_far+norm_near)/nfar);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrm__dnorm_sample(STARSH_blrf *format, STARSH_int nblocks,
+        STARSH_int *block, STARSH_int start, STARSH_int step, double *norm2,
+        double *count)
+//! Estimate squared Frobenius norm of blocks by a few of their rows.
+/*! Each block is sampled by at most 8 equally spaced rows, and squared norm
+ * of the sample is scaled by ratio of numbers of all and sampled rows. Only
+ * blocks `start`, `start+step`, `start+2*step` and so on of a given list are
+ * processed, which allows to split work among threads or MPI processes. In
+ * symmetric case off-diagonal blocks are counted twice.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] nblocks: Number of blocks in the list.
+ * @param[in] block: Coordinates of blocks.
+ * @param[in] start: First block to process.
+ * @param[in] step: Step between processed blocks.
+ * @param[out] norm2: Estimated sum of squared Frobenius norms of processed
+ *      blocks.
+ * @param[out] count: Number of blocks of the matrix, represented by processed
+ *      blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_problem *P = F->problem;
+    STARSH_kernel *kernel = P->kernel;
+    // Shortcuts to information about clusters
+    STARSH_cluster *RC = F->row_cluster;
+    STARSH_cluster *CC = F->col_cluster;
+    void *RD = RC->data, *CD = CC->data;
+    // Maximum number of sampled rows of each block
+    const int maxsamples = 8;
+    STARSH_int bi, k, irow[maxsamples];
+    double *D, norm = 0., nsampled = 0.;
+    *norm2 = 0.;
+    *count = 0.;
+    if(start >= nblocks)
+        return STARSH_SUCCESS;
+    STARSH_int maxncols = 0;
+    for(k = 0; k < CC->nblocks; k++)
+        if(CC->size[k] > maxncols)
+            maxncols = CC->size[k];
+    STARSH_MALLOC(D, (size_t)maxsamples*(size_t)maxncols);
+    for(bi = start; bi < nblocks; bi += step)
+    {
+        STARSH_int i = block[2*bi];
+        STARSH_int j = block[2*bi+1];
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        int nsamples = nrows < maxsamples ? nrows : maxsamples;
+        // Get equally spaced rows of a block
+        for(k = 0; k < nsamples; k++)
+            irow[k] = RC->pivot[RC->start[i]+k*nrows/nsamples];
+        kernel(nsamples, ncols, irow, CC->pivot+CC->start[j], RD, CD, D,
+                nsamples);
+        double tmp = cblas_dnrm2(nsamples*ncols, D, 1);
+        tmp *= tmp*nrows/nsamples;
+        // Each off-diagonal block is stored once in symmetric case
+        if(i != j && F->symm == 'S')
+        {
+            tmp *= 2;
+            nsampled += 2;
+        }
+        else
+            nsampled += 1;
+        norm += tmp;
+    }
+    free(D);
+    *norm2 = norm;
+    *count = nsampled;
+    return STARSH_SUCCESS;
+}
@@ -0,0 +1,526 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/blrm/dursdd.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_blrm__dursdd(STARSH_blrm **matrix, STARSH_blrf *format,
+        int maxrank, double tol, int onfly)
+//! Approximate far-field tiles with shared bases of block rows and columns.
+/*! Candidate basis of each block row (block column) is computed by
+ * randomized SVD of all far-field tiles of the block row (block column),
+ * concatenated together. Each tile is scaled by its Frobenius norm, so that
+ * small tiles are captured as well as large ones. Tiles on the main block
+ * diagonal are usually not low-rank, so they do not take part in candidate
+ * bases. Then each far-field tile is projected onto candidate bases and it
+ * takes as few leading vectors of each basis, as needed to keep its relative
+ * error below `tol`/\f$ \sqrt{2} \f$ on each side, so that error of the tile
+ * is below `tol`. The tile is stored only as a small coupling matrix between
+ * the leading vectors of both bases, and each basis keeps as many vectors, as
+ * its tiles need. Tiles, that can not be approximated by `maxrank` candidate
+ * vectors, become near-field tiles, and negligible tiles are dropped. If
+ * shared bases with coupling matrices take no less memory, than per-tile
+ * low-rank factors, matrix is approximated by starsh_blrm__drsdd() instead.
+ *
+ * @param[out] matrix: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] format: Block low-rank format.
+ * @param[in] maxrank: Maximum possible rank of a basis.
+ * @param[in] tol: Relative error tolerance of each far-field tile.
+ * @param[in] onfly: Whether not to store dense blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_problem *P = F->problem;
+    STARSH_kernel *kernel = P->kernel;
+    STARSH_int nblocks_far = F->nblocks_far;
+    STARSH_int nblocks_near = F->nblocks_near;
+    STARSH_int nbrows = F->nbrows, nbcols = F->nbcols;
+    // Shortcuts to information about clusters
+    STARSH_cluster *RC = F->row_cluster;
+    STARSH_cluster *CC = F->col_cluster;
+    void *RD = RC->data, *CD = CC->data;
+    char symm = F->symm;
+    // Block rows and block columns share bases in symmetric case
+    STARSH_int nbases = symm == 'S' ? nbrows : nbrows+nbcols;
+    // Following values default to given block low-rank format F, but they are
+    // changed when there are false far-field blocks.
+    STARSH_int new_nblocks_far = nblocks_far;
+    STARSH_int new_nblocks_near = nblocks_near;
+    STARSH_int *block_far = F->block_far;
+    STARSH_int *block_near = F->block_near;
+    // Places to store bases, coupling matrices, dense blocks and ranks
+    Array **row_U = NULL, **col_V = NULL, **far_S = NULL, **near_D = NULL;
+    int *row_rank = NULL, *col_rank = NULL;
+    double *alloc_U = NULL, *alloc_V = NULL, *alloc_S = NULL, *alloc_D = NULL;
+    size_t offset_U = 0, offset_V = 0, offset_S = 0, offset_D = 0;
+    STARSH_int bi, bj = 0;
+    const int oversample = starsh_params.oversample;
+    // Number of random vectors to sample each block row and block column
+    int nsamples = maxrank+oversample;
+    // Absolute tolerance of each far-field block for the entire matrix. Blocks
+    // with smaller norm are negligible and they are dropped.
+    double abstol = 0.;
+    int info;
+    if(nblocks_far > 0)
+    {
+        info = starsh_blrm__dtol(F, tol, &abstol);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
+    // Size and offset of random and sampled matrices of each basis. Bases of
+    // block columns are stored after bases of block rows.
+    size_t *basis_offset, size_samples = 0;
+    int *basis_size, *basis_nvec, *basis_rank;
+    STARSH_MALLOC(basis_offset, nbases);
+    STARSH_MALLOC(basis_size, nbases);
+    STARSH_MALLOC(basis_nvec, nbases);
+    STARSH_MALLOC(basis_rank, nbases);
+    for(bi = 0; bi < nbases; bi++)
+    {
+        if(bi < nbrows)
+            basis_size[bi] = RC->size[bi];
+        else
+            basis_size[bi] = CC->size[bi-nbrows];
+        basis_offset[bi] = size_samples;
+        basis_rank[bi] = 0;
+        size_samples += (size_t)basis_size[bi]*nsamples;
+    }
+    // Generate random matrices and set sampled matrices to zero
+    double *omega, *sample;
+    int iseed[4] = {0, 0, 0, 1};
+    STARSH_MALLOC(omega, size_samples);
+    STARSH_MALLOC(sample, size_samples);
+    LAPACKE_dlarnv_work(3, iseed, size_samples, omega);
+    for(size_t k = 0; k < size_samples; k++)
+        sample[k] = 0.;
+    // Tiles on the main block diagonal are usually not low-rank, so they do
+    // not take part in computing bases
+    int check_diag = RC == CC;
+    // Frobenius norms of far-field tiles
+    double *tile_norm;
+    STARSH_MALLOC(tile_norm, nblocks_far+1);
+    // Sample block rows and block columns with far-field tiles
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        // Get indexes of corresponding block row and block column
+        STARSH_int i = block_far[2*bi];
+        STARSH_int j = block_far[2*bi+1];
+        // Get corresponding bases of block row and block column
+        STARSH_int ib = i;
+        STARSH_int jb = symm == 'S' ? j : j+nbrows;
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        double *D;
+        STARSH_MALLOC(D, (size_t)nrows*(size_t)ncols);
+        kernel(nrows, ncols, RC->pivot+RC->start[i],
+                CC->pivot+CC->start[j], RD, CD, D, nrows);
+        double norm = cblas_dnrm2((size_t)nrows*(size_t)ncols, D, 1);
+        tile_norm[bi] = norm;
+        if(norm > abstol && !(check_diag && i == j))
+        {
+            // Sample block row by a normalized tile and block column by
+            // normalized transposed tile
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                    nsamples, ncols, 1.0/norm, D, nrows,
+                    omega+basis_offset[jb], ncols, 1.0,
+                    sample+basis_offset[ib], nrows);
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, ncols,
+                    nsamples, nrows, 1.0/norm, D, nrows,
+                    omega+basis_offset[ib], nrows, 1.0,
+                    sample+basis_offset[jb], ncols);
+        }
+        free(D);
+    }
+    free(omega);
+    // Compute candidate orthonormal bases by SVD of sampled matrices. Bases
+    // overwrite corresponding sampled matrices and their vectors are sorted
+    // by importance.
+    for(bi = 0; bi < nbases; bi++)
+    {
+        int nrows = basis_size[bi];
+        int mn = nrows < nsamples ? nrows : nsamples;
+        int lwork = (4*mn+7)*mn, liwork = 8*mn;
+        double *Y = sample+basis_offset[bi], *svd_U, *svd_S, *svd_V, *work;
+        int *iwork;
+        STARSH_MALLOC(svd_U, (size_t)nrows*mn);
+        STARSH_MALLOC(svd_S, mn);
+        STARSH_MALLOC(svd_V, (size_t)mn*nsamples);
+        STARSH_MALLOC(work, lwork);
+        STARSH_MALLOC(iwork, liwork);
+        info = LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'S', nrows, nsamples, Y,
+                nrows, svd_S, svd_U, nrows, svd_V, mn, work, lwork, iwork);
+        if(info != 0)
+        {
+            // Tiles of this basis become false far-field tiles
+            STARSH_WARNING("LAPACKE_dgesdd_work info=%d", info);
+            basis_nvec[bi] = 0;
+        }
+        else
+        {
+            basis_nvec[bi] = mn < maxrank ? mn : maxrank;
+            cblas_dcopy((size_t)nrows*basis_nvec[bi], svd_U, 1, Y, 1);
+        }
+        free(svd_U);
+        free(svd_S);
+        free(svd_V);
+        free(work);
+        free(iwork);
+    }
+    // Get number of leading vectors of both bases, needed by each far-field
+    // tile, and its coupling matrix. Tiles, that can not be approximated by
+    // candidate bases, are false far-field tiles (rank -1), while negligible
+    // tiles are dropped (rank -2).
+    int *tile_rank;
+    double **tile_S;
+    STARSH_MALLOC(tile_rank, 2*nblocks_far+1);
+    STARSH_MALLOC(tile_S, nblocks_far+1);
+    // Size of shared bases with coupling matrices and size of per-tile
+    // low-rank factors of the same tiles, estimated by singular values of
+    // their projections
+    size_t size_shared = 0, size_lr = 0;
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        // Get indexes of corresponding block row and block column
+        STARSH_int i = block_far[2*bi];
+        STARSH_int j = block_far[2*bi+1];
+        STARSH_int ib = i;
+        STARSH_int jb = symm == 'S' ? j : j+nbrows;
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        int nvec_U = basis_nvec[ib], nvec_V = basis_nvec[jb];
+        double *U = sample+basis_offset[ib], *V = sample+basis_offset[jb];
+        int mn = nvec_U < nvec_V ? nvec_U : nvec_V;
+        int mx = nvec_U+nvec_V-mn;
+        int lwork = 3*mn+(mx > 7*mn ? mx : 7*mn);
+        double *D, *DV, *S, *R, *svd_S, *work;
+        int *iwork;
+        tile_S[bi] = NULL;
+        tile_rank[2*bi] = -1;
+        tile_rank[2*bi+1] = -1;
+        double norm = tile_norm[bi];
+        if(norm <= abstol)
+        {
+            tile_rank[2*bi] = -2;
+            tile_rank[2*bi+1] = -2;
+            continue;
+        }
+        if(nvec_U == 0 || nvec_V == 0)
+        {
+            // Tile is dense in both cases
+            size_shared += (size_t)nrows*(size_t)ncols;
+            size_lr += (size_t)nrows*(size_t)ncols;
+            continue;
+        }
+        STARSH_MALLOC(D, (size_t)nrows*(size_t)ncols);
+        STARSH_MALLOC(DV, (size_t)nrows*nvec_V+1);
+        STARSH_MALLOC(S, (size_t)nvec_U*ncols+1);
+        STARSH_MALLOC(R, (size_t)nrows*(size_t)ncols);
+        STARSH_MALLOC(svd_S, mn);
+        STARSH_MALLOC(work, lwork);
+        STARSH_MALLOC(iwork, 8*mn);
+        kernel(nrows, ncols, RC->pivot+RC->start[i], CC->pivot+CC->start[j],
+                RD, CD, D, nrows);
+        // Relative tolerance of a block, if tolerance is global
+        double tile_tol = tol;
+        if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+            tile_tol = abstol/norm;
+        // Squared error of a tile is split equally between bases of its block
+        // row and block column
+        double budget = tile_tol*tile_tol*norm*norm/2;
+        // Squared error of projection of a tile onto leading vectors of a
+        // basis is squared error of projection onto all candidate vectors,
+        // computed directly to avoid cancellation, plus squared norm of
+        // projection onto the rest of vectors
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, nvec_U, ncols,
+                nrows, 1.0, U, nrows, D, nrows, 0.0, S, nvec_U);
+        cblas_dcopy((size_t)nrows*(size_t)ncols, D, 1, R, 1);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, ncols,
+                nvec_U, -1.0, U, nrows, S, nvec_U, 1.0, R, nrows);
+        double err_U = cblas_dnrm2((size_t)nrows*(size_t)ncols, R, 1);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                nvec_V, ncols, 1.0, D, nrows, V, ncols, 0.0, DV, nrows);
+        cblas_dcopy((size_t)nrows*(size_t)ncols, D, 1, R, 1);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols,
+                nvec_V, -1.0, DV, nrows, V, ncols, 1.0, R, nrows);
+        double err_V = cblas_dnrm2((size_t)nrows*(size_t)ncols, R, 1);
+        err_U *= err_U;
+        err_V *= err_V;
+        if(err_U <= budget && err_V <= budget)
+        {
+            int rank_U, rank_V;
+            for(rank_U = nvec_U; rank_U > 0; rank_U--)
+            {
+                double tmp = cblas_dnrm2(ncols, S+rank_U-1, nvec_U);
+                if(err_U+tmp*tmp > budget)
+                    break;
+                err_U += tmp*tmp;
+            }
+            for(rank_V = nvec_V; rank_V > 0; rank_V--)
+            {
+                double tmp = cblas_dnrm2(nrows, DV+(rank_V-1)*(size_t)nrows,
+                        1);
+                if(err_V+tmp*tmp > budget)
+                    break;
+                err_V += tmp*tmp;
+            }
+            // Coupling matrix is projection of `D*V` onto leading vectors
+            STARSH_MALLOC(tile_S[bi], (size_t)rank_U*rank_V+1);
+            if(rank_U > 0 && rank_V > 0)
+                cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank_U,
+                        rank_V, nrows, 1.0, U, nrows, DV, nrows, 0.0,
+                        tile_S[bi], rank_U);
+            tile_rank[2*bi] = rank_U;
+            tile_rank[2*bi+1] = rank_V;
+            size_shared += (size_t)rank_U*rank_V;
+            // Rank of projection of a tile onto all candidate vectors is
+            // rank of its per-tile approximation
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, nvec_U,
+                    nvec_V, nrows, 1.0, U, nrows, DV, nrows, 0.0, R, nvec_U);
+            info = LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'N', nvec_U, nvec_V,
+                    R, nvec_U, svd_S, NULL, 1, NULL, 1, work, lwork, iwork);
+            int rank = info == 0 ? starsh_dense_dsvfr(mn, svd_S, tile_tol) :
+                mn;
+            size_lr += (size_t)rank*(nrows+ncols);
+        }
+        else
+        {
+            // False far-field tile is dense, while its per-tile factors may
+            // be of rank up to `maxrank`
+            size_t size_D = (size_t)nrows*(size_t)ncols;
+            size_t size_max = (size_t)maxrank*(size_t)(nrows+ncols);
+            size_shared += size_D;
+            size_lr += size_max < size_D ? size_max : size_D;
+        }
+        free(D);
+        free(DV);
+        free(S);
+        free(R);
+        free(svd_S);
+        free(work);
+        free(iwork);
+    }
+    // Each basis keeps as many vectors, as its tiles need
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        STARSH_int ib = block_far[2*bi];
+        STARSH_int jb = block_far[2*bi+1];
+        if(symm == 'N')
+            jb += nbrows;
+        if(basis_rank[ib] < tile_rank[2*bi])
+            basis_rank[ib] = tile_rank[2*bi];
+        if(basis_rank[jb] < tile_rank[2*bi+1])
+            basis_rank[jb] = tile_rank[2*bi+1];
+    }
+    // Shared bases are useless, if together with coupling matrices they take
+    // more memory, than per-tile low-rank factors
+    for(bi = 0; bi < nbases; bi++)
+        size_shared += (size_t)basis_size[bi]*basis_rank[bi];
+    free(tile_norm);
+    if(size_shared >= size_lr && size_lr > 0)
+    {
+        for(bi = 0; bi < nblocks_far; bi++)
+            free(tile_S[bi]);
+        free(tile_S);
+        free(tile_rank);
+        free(sample);
+        free(basis_offset);
+        free(basis_size);
+        free(basis_nvec);
+        free(basis_rank);
+        STARSH_WARNING("Shared bases take more memory, than per-tile "
+                "factors, so each tile is approximated separately");
+        return starsh_blrm__drsdd(matrix, F, maxrank, tol, onfly);
+    }
+    // Get false far-field blocks and negligible blocks
+    STARSH_int nblocks_false_far = 0, nblocks_dropped = 0;
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        if(tile_rank[2*bi] == -1)
+            nblocks_false_far++;
+        else if(tile_rank[2*bi] == -2)
+            nblocks_dropped++;
+    }
+    // Update lists of far-field and near-field blocks using previously
+    // generated list of false far-field blocks. Negligible blocks are not
+    // added to any of lists.
+    if(nblocks_false_far > 0 || nblocks_dropped > 0)
+    {
+        // Update list of near-field blocks
+        new_nblocks_near = nblocks_near+nblocks_false_far;
+        block_near = NULL;
+        if(new_nblocks_near > 0)
+        {
+            STARSH_MALLOC(block_near, 2*new_nblocks_near);
+        }
+        // At first get all near-field blocks, assumed to be dense
+        for(bi = 0; bi < 2*nblocks_near; bi++)
+            block_near[bi] = F->block_near[bi];
+        // Add false far-field blocks
+        bj = nblocks_near;
+        for(bi = 0; bi < nblocks_far; bi++)
+            if(tile_rank[2*bi] == -1)
+            {
+                block_near[2*bj] = F->block_far[2*bi];
+                block_near[2*bj+1] = F->block_far[2*bi+1];
+                bj++;
+            }
+        // Update list of far-field blocks
+        new_nblocks_far = nblocks_far-nblocks_false_far-nblocks_dropped;
+        block_far = NULL;
+        if(new_nblocks_far > 0)
+        {
+            STARSH_MALLOC(block_far, 2*new_nblocks_far);
+            bj = 0;
+            for(bi = 0; bi < nblocks_far; bi++)
+                if(tile_rank[2*bi] >= 0)
+                {
+                    block_far[2*bj] = F->block_far[2*bi];
+                    block_far[2*bj+1] = F->block_far[2*bi+1];
+                    bj++;
+                }
+        }
+        // Update format by creating new format
+        STARSH_blrf *F2;
+        info = starsh_blrf_new_from_coo(&F2, P, F->symm, RC, CC,
+                new_nblocks_far, block_far, new_nblocks_near, block_near,
+                F->type);
+        if(info != STARSH_SUCCESS)
+            return info;
+        // Swap internal data of formats and free unnecessary data
+        STARSH_blrf tmp_blrf = *F;
+        *F = *F2;
+        *F2 = tmp_blrf;
+        STARSH_WARNING("`F` was modified due to false far-field and "
+                "negligible blocks");
+        starsh_blrf_free(F2);
+    }
+    // Store bases of block rows and block columns
+    STARSH_MALLOC(row_rank, nbrows);
+    STARSH_MALLOC(row_U, nbrows);
+    if(symm == 'S')
+    {
+        col_rank = row_rank;
+        col_V = row_U;
+    }
+    else
+    {
+        STARSH_MALLOC(col_rank, nbcols);
+        STARSH_MALLOC(col_V, nbcols);
+    }
+    size_t size_U = 0, size_V = 0;
+    for(bi = 0; bi < nbases; bi++)
+    {
+        if(bi < nbrows)
+            size_U += (size_t)basis_size[bi]*basis_rank[bi];
+        else
+            size_V += (size_t)basis_size[bi]*basis_rank[bi];
+    }
+    // Avoid zero-sized buffers, since NULL buffer means error
+    STARSH_MALLOC(alloc_U, size_U+1);
+    if(symm == 'N')
+    {
+        STARSH_MALLOC(alloc_V, size_V+1);
+    }
+    for(bi = 0; bi < nbases; bi++)
+    {
+        int shape[2] = {basis_size[bi], basis_rank[bi]};
+        size_t size = (size_t)basis_size[bi]*basis_rank[bi];
+        double *Y = sample+basis_offset[bi];
+        if(bi < nbrows)
+        {
+            row_rank[bi] = basis_rank[bi];
+            array_from_buffer(row_U+bi, 2, shape, 'd', 'F',
+                    alloc_U+offset_U);
+            cblas_dcopy(size, Y, 1, alloc_U+offset_U, 1);
+            offset_U += size;
+        }
+        else
+        {
+            col_rank[bi-nbrows] = basis_rank[bi];
+            array_from_buffer(col_V+bi-nbrows, 2, shape, 'd', 'F',
+                    alloc_V+offset_V);
+            cblas_dcopy(size, Y, 1, alloc_V+offset_V, 1);
+            offset_V += size;
+        }
+    }
+    free(sample);
+    free(basis_offset);
+    free(basis_size);
+    free(basis_nvec);
+    free(basis_rank);
+    // Pack coupling matrices of far-field blocks into a single buffer
+    if(new_nblocks_far > 0)
+    {
+        STARSH_MALLOC(far_S, new_nblocks_far);
+        size_t size_S = 0;
+        for(bi = 0; bi < nblocks_far; bi++)
+            if(tile_rank[2*bi] >= 0)
+                size_S += (size_t)tile_rank[2*bi]*tile_rank[2*bi+1];
+        STARSH_MALLOC(alloc_S, size_S+1);
+    }
+    bj = 0;
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        if(tile_rank[2*bi] < 0)
+            continue;
+        int shape[2] = {tile_rank[2*bi], tile_rank[2*bi+1]};
+        size_t size = (size_t)shape[0]*shape[1];
+        array_from_buffer(far_S+bj, 2, shape, 'd', 'F', alloc_S+offset_S);
+        cblas_dcopy(size, tile_S[bi], 1, alloc_S+offset_S, 1);
+        offset_S += size;
+        free(tile_S[bi]);
+        bj++;
+    }
+    free(tile_rank);
+    free(tile_S);
+    // Compute near-field blocks if needed
+    if(onfly == 0 && new_nblocks_near > 0)
+    {
+        STARSH_MALLOC(near_D, new_nblocks_near);
+        size_t size_D = 0;
+        // Simple cycle over all near-field blocks
+        for(bi = 0; bi < new_nblocks_near; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = block_near[2*bi];
+            STARSH_int j = block_near[2*bi+1];
+            // Get corresponding sizes and minimum of them
+            size_t nrows = RC->size[i];
+            size_t ncols = CC->size[j];
+            // Update size_D
+            size_D += nrows*ncols;
+        }
+        STARSH_MALLOC(alloc_D, size_D);
+        // For each near-field block compute its elements
+        for(bi = 0; bi < new_nblocks_near; bi++)
+        {
+            // Get indexes of corresponding block row and block column
+            STARSH_int i = block_near[2*bi];
+            STARSH_int j = block_near[2*bi+1];
+            // Get corresponding sizes and minimum of them
+            int nrows = RC->size[i];
+            int ncols = CC->size[j];
+            int shape[2] = {nrows, ncols};
+            double *D = alloc_D+offset_D;
+            array_from_buffer(near_D+bi, 2, shape, 'd', 'F', D);
+            offset_D += near_D[bi]->size;
+            kernel(nrows, ncols, RC->pivot+RC->start[i],
+                    CC->pivot+CC->start[j], RD, CD, D, nrows);
+        }
+    }
+    // Finish with creating instance of Block Low-Rank Matrix with given
+    // buffers
+    return starsh_blrm_new_uniform(matrix, F, row_rank, row_U, col_rank,
+            col_V, far_S, onfly, near_D, alloc_U, alloc_V, alloc_S, alloc_D);
+}
@@ -0,0 +1,131 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/dense/dcheb.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+void starsh_dense_dchebqr(int nrows, int ndim, int order, STARSH_int count,
+        double *point, STARSH_int *index, double *node, STARSH_int ldnode,
+        double *Q, double *R, double *work, int lwork)
+//! Orthogonalized tensor Chebyshev interpolation basis of a set of points.
+/*! Puts `order` Chebyshev nodes of the first kind on each side of a bounding
+ * box of given points and computes matrix `S` of values of corresponding
+ * `order`\f$^{ndim}\f$ tensor Lagrange polynomials at given points. Then
+ * computes QR factorization `S=QR`. Matrix `Q` is `nrows` by `mn` and matrix
+ * `R` is `mn` by `order`\f$^{ndim}\f$, where `mn` is a minimum of `nrows` and
+ * `order`\f$^{ndim}\f$. This function calls LAPACK and BLAS routines, so
+ * integer types are int instead of @ref STARSH_int.
+ *
+ * @param[in] nrows: Number of points.
+ * @param[in] ndim: Dimensionality of space.
+ * @param[in] order: Number of Chebyshev nodes in each dimension.
+ * @param[in] count: Leading dimension of `point`.
+ * @param[in] point: Coordinates of all points, `k`-th coordinate of `i`-th
+ *      point is `point[k*count+i]`.
+ * @param[in] index: Indexes of `nrows` points.
+ * @param[out] node: Coordinates of interpolation nodes, `k`-th coordinate of
+ *      `i`-th node is written to `node[k*ldnode+i]`.
+ * @param[in] ldnode: Leading dimension of `node`.
+ * @param[out] Q: Pointer to `nrows` by `order`\f$^{ndim}\f$ buffer, that
+ *      gets orthogonal factor in its first `mn` columns.
+ * @param[out] R: Pointer to triangular factor with leading dimension `mn`.
+ * @param[in] work: Working array.
+ * @param[in] lwork: Size of `work` array. At least
+ *      `mn`+`ndim`*`order`+`order`\f$^{ndim}\f$.
+ * */
+{
+    int nnodes = 1;
+    int i, k, l, q;
+    for(k = 0; k < ndim; k++)
+        nnodes *= order;
+    int mn = nrows < nnodes ? nrows : nnodes;
+    double *tau = work, *L = tau+mn, *qr_work = L+ndim*order;
+    int qr_lwork = lwork-mn-ndim*order;
+    const double pi = acos(-1.);
+    double center[ndim], halfwidth[ndim];
+    // Get bounding box of points
+    for(k = 0; k < ndim; k++)
+    {
+        double *x = point+k*count;
+        double a = x[index[0]], b = a;
+        for(i = 1; i < nrows; i++)
+        {
+            double tmp = x[index[i]];
+            if(tmp < a)
+                a = tmp;
+            else if(tmp > b)
+                b = tmp;
+        }
+        center[k] = 0.5*(a+b);
+        halfwidth[k] = 0.5*(b-a);
+        // Any box works for coinciding coordinates
+        if(halfwidth[k] == 0.)
+            halfwidth[k] = 1.;
+    }
+    // Tensor nodes with the first coordinate changing fastest
+    for(q = 0; q < nnodes; q++)
+    {
+        int tmp = q;
+        for(k = 0; k < ndim; k++)
+        {
+            double t = cos(pi*(2*(tmp%order)+1)/(2*order));
+            node[k*ldnode+q] = center[k]+halfwidth[k]*t;
+            tmp /= order;
+        }
+    }
+    // Lagrange polynomial of k-th node at point x of [-1,1] is equal to
+    // 1/order + 2/order sum_l T_l(t_k) T_l(x), where T_l is Chebyshev
+    // polynomial of l-th degree
+    for(i = 0; i < nrows; i++)
+    {
+        for(k = 0; k < ndim; k++)
+        {
+            double x = (point[k*count+index[i]]-center[k])/halfwidth[k];
+            double *Lk = L+k*order;
+            for(q = 0; q < order; q++)
+            {
+                double t = cos(pi*(2*q+1)/(2*order));
+                double T0 = 1., T1 = x, Tt0 = 1., Tt1 = t;
+                double sum = 0.5;
+                for(l = 1; l < order; l++)
+                {
+                    sum += T1*Tt1;
+                    double tmp = 2*x*T1-T0;
+                    T0 = T1;
+                    T1 = tmp;
+                    tmp = 2*t*Tt1-Tt0;
+                    Tt0 = Tt1;
+                    Tt1 = tmp;
+                }
+                Lk[q] = 2*sum/order;
+            }
+        }
+        for(q = 0; q < nnodes; q++)
+        {
+            int tmp = q;
+            double value = 1.;
+            for(k = 0; k < ndim; k++)
+            {
+                value *= L[k*order+tmp%order];
+                tmp /= order;
+            }
+            Q[q*(size_t)nrows+i] = value;
+        }
+    }
+    // Get QR factorization of interpolation matrix
+    LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, nrows, nnodes, Q, nrows, tau,
+            qr_work, qr_lwork);
+    LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'L', mn, nnodes, 0., 0., R, mn);
+    LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'U', mn, nnodes, Q, nrows, R, mn);
+    LAPACKE_dorgqr_work(LAPACK_COL_MAJOR, nrows, mn, mn, Q, nrows, tau,
+            qr_work, qr_lwork);
+}
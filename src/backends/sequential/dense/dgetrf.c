@@ -0,0 +1,46 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/dense/dgetrf.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_dense_dgetrf(int n, double *D, int ldD, int *ipiv)
+//! LU factorization of a dense square matrix.
+/*! If `ipiv` is not NULL, then partial pivoting is performed by
+ * LAPACKE_dgetrf_work(), otherwise factorization is performed without any
+ * pivoting. Unit lower triangular factor `L` and upper triangular factor `U`
+ * overwrite `D`.
+ *
+ * @param[in] n: Order of matrix.
+ * @param[in,out] D: Dense matrix.
+ * @param[in] ldD: Leading dimension of `D`.
+ * @param[out] ipiv: Array of `n` pivot indices (starting from 1) or NULL.
+ * @return 0 on success or index (starting from 1) of zero pivot.
+ * @ingroup lrdense
+ * */
+{
+    int i;
+    if(ipiv != NULL)
+        return LAPACKE_dgetrf_work(LAPACK_COL_MAJOR, n, n, D, ldD, ipiv);
+    for(i = 0; i < n; i++)
+    {
+        double *Dii = D+(size_t)i*ldD+i;
+        if(*Dii == 0.0)
+            return i+1;
+        if(i == n-1)
+            break;
+        cblas_dscal(n-i-1, 1.0/(*Dii), Dii+1, 1);
+        cblas_dger(CblasColMajor, n-i-1, n-i-1, -1.0, Dii+1, 1, Dii+ldD, ldD,
+                Dii+ldD+1, ldD);
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/sequential/dense/dlrupd.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+int starsh_dense_dlradd(int nrows, int ncols, int rank2, double alpha,
+        double *U2, int ldU2, double *V2, int ldV2, double *U, int ldU,
+        double *V, int ldV, int *rank, int maxrank, double tol, double *work,
+        int lwork, int *iwork)
+//! Recompressed sum of two low-rank double precision matrices.
+/*! Approximates `U*V^T+alpha*U2*V2^T` and writes result into `U`, `V` and
+ * `rank`. Concatenated factors are orthogonalized by QR factorizations and
+ * product of triangular factors is compressed by GESDD, so rank is chosen by
+ * starsh_dense_dsvfr() in the same way as in starsh_dense_dlrsdd(). This
+ * function calls LAPACK and BLAS routines, so integer types are int instead
+ * of @ref STARSH_int.
+ *
+ * @param[in] nrows: Number of rows of a matrix.
+ * @param[in] ncols: Number of columns of a matrix.
+ * @param[in] rank2: Rank of the second summand.
+ * @param[in] alpha: Scalar multiplier of the second summand.
+ * @param[in] U2: Low-rank factor `U` of the second summand.
+ * @param[in] ldU2: Leading dimension of `U2`.
+ * @param[in] V2: Low-rank factor `V` of the second summand.
+ * @param[in] ldV2: Leading dimension of `V2`.
+ * @param[in,out] U: Low-rank factor `U` of the first summand and result.
+ * @param[in] ldU: Leading dimension of `U`.
+ * @param[in,out] V: Low-rank factor `V` of the first summand and result.
+ * @param[in] ldV: Leading dimension of `V`.
+ * @param[in,out] rank: Address of rank of the first summand and result.
+ * @param[in] maxrank: Maximum possible rank of result.
+ * @param[in] tol: Relative error for approximation.
+ * @param[in] work: Working array.
+ * @param[in] lwork: Size of `work` array. At least `(nrows+ncols+9*r+11)*r`,
+ *      where `r` is `*rank+rank2`.
+ * @param[in] iwork: Temporary integer array of at least `8*r` elements.
+ * @return 1 if rank of result was limited by `maxrank` and 0 otherwise.
+ * @ingroup lrdense
+ * */
+{
+    int r1 = *rank, r = r1+rank2;
+    int ku = nrows < r ? nrows : r, kv = ncols < r ? ncols : r;
+    int mn = ku < kv ? ku : kv;
+    int i, j, new_rank, limited = 0;
+    if(rank2 == 0)
+        return 0;
+    double *QU = work, *QV = QU+(size_t)nrows*r, *tau_U = QV+(size_t)ncols*r;
+    double *tau_V = tau_U+r, *RU = tau_V+r, *RV = RU+(size_t)ku*r;
+    double *S = RV+(size_t)kv*r, *svd_U = S+(size_t)ku*kv;
+    double *svd_S = svd_U+(size_t)ku*mn, *svd_V = svd_S+mn;
+    double *tmp_work = svd_V+(size_t)mn*kv;
+    int tmp_lwork = lwork-(tmp_work-work);
+    // Concatenate factors of both summands
+    LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', nrows, r1, U, ldU, QU, nrows);
+    LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', nrows, rank2, U2, ldU2,
+            QU+(size_t)nrows*r1, nrows);
+    if(alpha != 1.0)
+        for(i = r1; i < r; i++)
+            cblas_dscal(nrows, alpha, QU+(size_t)nrows*i, 1);
+    LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', ncols, r1, V, ldV, QV, ncols);
+    LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', ncols, rank2, V2, ldV2,
+            QV+(size_t)ncols*r1, ncols);
+    // Orthogonalize concatenated factors
+    LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, nrows, r, QU, nrows, tau_U,
+            tmp_work, tmp_lwork);
+    LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, ncols, r, QV, ncols, tau_V,
+            tmp_work, tmp_lwork);
+    // Get product of upper trapezoidal factors
+    for(i = 0; i < r; i++)
+    {
+        for(j = 0; j < ku; j++)
+            RU[i*(size_t)ku+j] = j <= i ? QU[i*(size_t)nrows+j] : 0.0;
+        for(j = 0; j < kv; j++)
+            RV[i*(size_t)kv+j] = j <= i ? QV[i*(size_t)ncols+j] : 0.0;
+    }
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, ku, kv, r, 1.0, RU,
+            ku, RV, kv, 0.0, S, ku);
+    // Compress product with the help of SVD
+    LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'S', ku, kv, S, ku, svd_S, svd_U,
+            ku, svd_V, mn, tmp_work, tmp_lwork, iwork);
+    new_rank = starsh_dense_dsvfr(mn, svd_S, tol);
+    if(new_rank > maxrank)
+    {
+        new_rank = maxrank;
+        limited = 1;
+    }
+    // Multiply orthogonal factors by singular vectors
+    LAPACKE_dorgqr_work(LAPACK_COL_MAJOR, nrows, ku, ku, QU, nrows, tau_U,
+            tmp_work, tmp_lwork);
+    LAPACKE_dorgqr_work(LAPACK_COL_MAJOR, ncols, kv, kv, QV, ncols, tau_V,
+            tmp_work, tmp_lwork);
+    for(i = 0; i < new_rank; i++)
+        cblas_dscal(kv, svd_S[i], svd_V+i, mn);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, new_rank,
+            ku, 1.0, QU, nrows, svd_U, ku, 0.0, U, ldU);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, ncols, new_rank, kv,
+            1.0, QV, ncols, svd_V, mn, 0.0, V, ldV);
+    *rank = new_rank;
+    return limited;
+}
+
+int starsh_dense_dlrgemm(int nrows, int ncols, int nk, int rank1,
+        double *U1, int ldU1, double *V1, int ldV1, int rank2, double *U2,
+        int ldU2, double *V2, int ldV2, double *U, int ldU, double *V,
+        int ldV, int *rank, int maxrank, double tol, double *work, int lwork,
+        int *iwork)
+//! Subtract product of two low-rank matrices from a low-rank matrix.
+/*! Approximates `U*V^T-U1*V1^T*V2*U2^T` and writes result into `U`, `V` and
+ * `rank`. This is an update of a tile of a TLR Cholesky factorization, where
+ * `U1*V1^T` and `U2*V2^T` are tiles of the same block column of the factor.
+ * Product is formed with the smallest possible rank and then added with the
+ * help of starsh_dense_dlradd().
+ *
+ * @param[in] nrows: Number of rows of `U` and `U1`.
+ * @param[in] ncols: Number of rows of `V` and `U2`.
+ * @param[in] nk: Number of rows of `V1` and `V2`.
+ * @param[in] rank1: Rank of `U1*V1^T`.
+ * @param[in] U1: Low-rank factor `U` of the first multiplier.
+ * @param[in] ldU1: Leading dimension of `U1`.
+ * @param[in] V1: Low-rank factor `V` of the first multiplier.
+ * @param[in] ldV1: Leading dimension of `V1`.
+ * @param[in] rank2: Rank of `U2*V2^T`.
+ * @param[in] U2: Low-rank factor `U` of the second multiplier.
+ * @param[in] ldU2: Leading dimension of `U2`.
+ * @param[in] V2: Low-rank factor `V` of the second multiplier.
+ * @param[in] ldV2: Leading dimension of `V2`.
+ * @param[in,out] U: Low-rank factor `U` of updated matrix.
+ * @param[in] ldU: Leading dimension of `U`.
+ * @param[in,out] V: Low-rank factor `V` of updated matrix.
+ * @param[in] ldV: Leading dimension of `V`.
+ * @param[in,out] rank: Address of rank of updated matrix.
+ * @param[in] maxrank: Maximum possible rank of result.
+ * @param[in] tol: Relative error for approximation.
+ * @param[in] work: Working array.
+ * @param[in] lwork: Size of `work` array. At least
+ *      `rank1*rank2+max(nrows,ncols)*k+(nrows+ncols+9*r+11)*r`, where `k`
+ *      is a minimum of `rank1` and `rank2` and `r` is `*rank+k`.
+ * @param[in] iwork: Temporary integer array of at least `8*r` elements.
+ * @return 1 if rank of result was limited by `maxrank` and 0 otherwise.
+ * @ingroup lrdense
+ * */
+{
+    int k = rank1 < rank2 ? rank1 : rank2;
+    if(k == 0)
+        return 0;
+    int mx = nrows > ncols ? nrows : ncols;
+    double *W = work, *T = W+(size_t)rank1*rank2;
+    double *tmp_work = T+(size_t)mx*k;
+    int tmp_lwork = lwork-(tmp_work-work);
+    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank1, rank2, nk,
+            1.0, V1, ldV1, V2, ldV2, 0.0, W, rank1);
+    if(rank2 <= rank1)
+    {
+        // Product is (U1*W)*U2^T
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, rank2,
+                rank1, 1.0, U1, ldU1, W, rank1, 0.0, T, nrows);
+        return starsh_dense_dlradd(nrows, ncols, k, -1.0, T, nrows, U2, ldU2,
+                U, ldU, V, ldV, rank, maxrank, tol, tmp_work, tmp_lwork,
+                iwork);
+    }
+    // Product is U1*(U2*W^T)^T
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, ncols, rank1, rank2,
+            1.0, U2, ldU2, W, rank1, 0.0, T, ncols);
+    return starsh_dense_dlradd(nrows, ncols, k, -1.0, U1, ldU1, T, ncols, U,
+            ldU, V, ldV, rank, maxrank, tol, tmp_work, tmp_lwork, iwork);
+}
+
+void starsh_dense_dlrsyrk(int nrows, int ncols, int rank, double *U, int ldU,
+        double *V, int ldV, double *D, int ldD, double *work)
+//! Subtract low-rank matrix, multiplied by its transpose, from dense matrix.
+/*! Computes `D=D-U*V^T*V*U^T`. This is an update of a diagonal tile of a TLR
+ * Cholesky factorization by a low-rank tile `U*V^T` of the factor. Both
+ * triangles of `D` are updated.
+ *
+ * @param[in] nrows: Number of rows of `U` and order of `D`.
+ * @param[in] ncols: Number of rows of `V`.
+ * @param[in] rank: Rank of `U*V^T`.
+ * @param[in] U: Low-rank factor `U`.
+ * @param[in] ldU: Leading dimension of `U`.
+ * @param[in] V: Low-rank factor `V`.
+ * @param[in] ldV: Leading dimension of `V`.
+ * @param[in,out] D: Dense matrix.
+ * @param[in] ldD: Leading dimension of `D`.
+ * @param[in] work: Working array of at least `(rank+nrows)*rank` elements.
+ * @ingroup lrdense
+ * */
+{
+    if(rank == 0)
+        return;
+    double *W = work, *T = W+(size_t)rank*rank;
+    cblas_dsyrk(CblasColMajor, CblasUpper, CblasTrans, rank, ncols, 1.0, V,
+            ldV, 0.0, W, rank);
+    cblas_dsymm(CblasColMajor, CblasRight, CblasUpper, nrows, rank, 1.0, W,
+            rank, U, ldU, 0.0, T, nrows);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, nrows, rank,
+            -1.0, T, nrows, U, ldU, 1.0, D, ldD);
+}
+
+void starsh_dense_dlrgemmd(int nrows, int ncols, int nk, int rank1,
+        double *U1, int ldU1, double *V1, int ldV1, int rank2, double *U2,
+        int ldU2, double *V2, int ldV2, double *D, int ldD, double *work)
+//! Subtract product of two low-rank matrices from dense matrix.
+/*! Computes `D=D-U1*V1^T*V2*U2^T`. This is an update of a dense diagonal
+ * tile of a TLR LU factorization by tile `U1*V1^T` of lower factor and tile
+ * `U2*V2^T` of upper factor, which is stored transposed.
+ *
+ * @param[in] nrows: Number of rows of `U1` and `D`.
+ * @param[in] ncols: Number of rows of `U2` and columns of `D`.
+ * @param[in] nk: Number of rows of `V1` and `V2`.
+ * @param[in] rank1: Rank of `U1*V1^T`.
+ * @param[in] U1: Low-rank factor `U1`.
+ * @param[in] ldU1: Leading dimension of `U1`.
+ * @param[in] V1: Low-rank factor `V1`.
+ * @param[in] ldV1: Leading dimension of `V1`.
+ * @param[in] rank2: Rank of `U2*V2^T`.
+ * @param[in] U2: Low-rank factor `U2`.
+ * @param[in] ldU2: Leading dimension of `U2`.
+ * @param[in] V2: Low-rank factor `V2`.
+ * @param[in] ldV2: Leading dimension of `V2`.
+ * @param[in,out] D: Dense matrix.
+ * @param[in] ldD: Leading dimension of `D`.
+ * @param[in] work: Working array of at least `(rank1+nrows)*rank2`
+ *      elements.
+ * @ingroup lrdense
+ * */
+{
+    if(rank1 == 0 || rank2 == 0)
+        return;
+    double *W = work, *T = W+(size_t)rank1*rank2;
+    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank1, rank2, nk,
+            1.0, V1, ldV1, V2, ldV2, 0.0, W, rank1);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, rank2,
+            rank1, 1.0, U1, ldU1, W, rank1, 0.0, T, nrows);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows, ncols, rank2,
+            -1.0, T, nrows, U2, ldU2, 1.0, D, ldD);
+}
@@ -13,13 +13,46 @@
 #include "common.h"
 #include "starsh.h"
 
+static double dlrrsdd_residual(int nrows, int ncols, int k, double *D,
+        int ldD, double *Q, int ldQ, double *X, int ldX, double *work)
+//! Frobenius norm of residual `D-Q*X` of projection onto basis `Q`.
+/*! Residual is computed explicitly by blocks of `k` rows, where `k` is the
+ * number of columns of `Q`, so `work` must hold `k*ncols` elements. Norm of
+ * residual is not computed as \f$ \|D\|_F^2 - \|Q^T D\|_F^2 \f$, since
+ * this difference loses all digits, if relative residual is below square
+ * root of machine precision.
+ * */
+{
+    int i, nb;
+    double norm = 0., tmp;
+    for(i = 0; i < nrows; i += k)
+    {
+        nb = nrows-i < k ? nrows-i : k;
+        LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', nb, ncols, D+i, ldD, work,
+                nb);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nb, ncols, k,
+                -1.0, Q+i, ldQ, X, ldX, 1.0, work, nb);
+        tmp = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nb, ncols, work, nb,
+                NULL);
+        norm += tmp*tmp;
+    }
+    return sqrt(norm);
+}
+
 void starsh_dense_dlrrsdd(int nrows, int ncols, double *D, int ldD, double *U,
         int ldU, double *V, int ldV, int *rank, int maxrank, int oversample,
-        double tol, double *work, int lwork, int *iwork)
+        int poweriter, double tol, double *work, int lwork, int *iwork)
 //! Randomized SVD approximation of a dense double precision matrix.
 /*! This function calls LAPACK and BLAS routines, so integer types are int
  * instead of @ref STARSH_int.
  *
+ * If `poweriter` is positive, basis of the sampled range is refined by up to
+ * `poweriter` steps of subspace iteration, each followed by
+ * re-orthogonalization. Before each step the residual of the projection
+ * onto current basis is computed explicitly, which costs as much as a single
+ * multiplication by `D`, and iterations stop as soon as it is below the
+ * tolerance.
+ *
  * @param[in] nrows: Number of rows of a matrix.
  * @param[in] ncols: Number of columns of a matrix.
  * @param[in,out] D: Pointer to dense matrix.
@@ -31,6 +64,7 @@ void starsh_dense_dlrrsdd(int nrows, int ncols, double *D, int ldD, double *U,
  * @param[out] rank: Address of rank variable.
  * @param[in] maxrank: Maximum possible rank.
  * @param[in] oversample: Size of oversampling subset.
+ * @param[in] poweriter: Maximum number of power iterations.
  * @param[in] tol: Relative error for approximation.
  * @param[in] work: Working array.
  * @param[in] lwork: Size of `work` array.
@@ -40,6 +74,7 @@ void starsh_dense_dlrrsdd(int nrows, int ncols, double *D, int ldD, double *U,
     int mn = nrows < ncols ? nrows : ncols;
     int mn2 = maxrank+oversample;
     int i;
+    double normD = 0., normR;
     if(mn2 > mn)
         mn2 = mn;
     //size_t svdqr_lwork = (4*mn2+7)*mn2;
@@ -68,6 +103,32 @@ void starsh_dense_dlrrsdd(int nrows, int ncols, double *D, int ldD, double *U,
     // Multiply Q by initial matrix
     cblas_dgemm(CblasColMajor, CblasConjTrans, CblasNoTrans, mn2, ncols,
             nrows, 1.0, Q, nrows, D, ldD, 0.0, X, mn2);
+    // Refine basis Q by power iterations
+    if(poweriter > 0)
+        normD = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows, ncols, D,
+                ldD, NULL);
+    for(i = 0; i < poweriter; i++)
+    {
+        // Stop if projection onto Q is already accurate enough
+        normR = dlrrsdd_residual(nrows, ncols, mn2, D, ldD, Q, nrows, X, mn2,
+                svd_V);
+        if(normR <= 0.5*tol*normD)
+            break;
+        // Orthogonalize rows of X=Q^T*D
+        LAPACKE_dgelqf_work(LAPACK_COL_MAJOR, mn2, ncols, X, mn2, tau,
+                svdqr_work, svdqr_lwork);
+        LAPACKE_dorglq_work(LAPACK_COL_MAJOR, mn2, ncols, mn2, X, mn2, tau,
+                svdqr_work, svdqr_lwork);
+        // Get new basis Q from D*X^T
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasConjTrans, nrows, mn2,
+                ncols, 1.0, D, ldD, X, mn2, 0.0, Q, nrows);
+        LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, nrows, mn2, Q, nrows, tau,
+                svdqr_work, svdqr_lwork);
+        LAPACKE_dorgqr_work(LAPACK_COL_MAJOR, nrows, mn2, mn2, Q, nrows, tau,
+                svdqr_work, svdqr_lwork);
+        cblas_dgemm(CblasColMajor, CblasConjTrans, CblasNoTrans, mn2, ncols,
+                nrows, 1.0, Q, nrows, D, ldD, 0.0, X, mn2);
+    }
     // Get SVD of result to reduce rank
     int info = LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'S', mn2, ncols, X, mn2,
             svd_S, svd_U, mn2, svd_V, mn2, svdqr_work, svdqr_lwork, iwork);
@@ -91,3 +152,110 @@ void starsh_dense_dlrrsdd(int nrows, int ncols, double *D, int ldD, double *U,
     // to be low-rank. Let denote such a block as false far-field block
         *rank = -1;
 }
+
+void starsh_dense_dlrrsdd_sketch(int nrows, int ncols, double *D, int ldD,
+        double *U, int ldU, double *V, int ldV, int *rank, int maxrank,
+        int nsketch, double *S, int ldS, int oversample, double tol,
+        double *work, int lwork, int *iwork)
+//! Randomized SVD of a dense matrix with a given sketching matrix.
+/*! Columns of `S` are used as the first `nsketch` columns of sketching
+ * matrix, followed by `oversample` random columns. If `S` is the factor `V`
+ * of previous approximation of a slightly different matrix, for example,
+ * after a change of parameters of a kernel, range of `D*S` is already close
+ * to range of `D`, so a single pass without power iterations is enough.
+ * Accuracy of the pass is checked by explicit residual of the projection of
+ * `D` onto the sampled range, and `rank` is set to -1 if the sketch did not
+ * capture range of `D`, so that caller can fall back to
+ * starsh_dense_dlrrsdd(). `S` is read before `V` is written, so they may
+ * share the same memory. Size of `work` is the same as for
+ * starsh_dense_dlrrsdd() with the same `maxrank`, if `nsketch` is not larger
+ * than `maxrank`.
+ *
+ * @param[in] nrows: Number of rows of a matrix.
+ * @param[in] ncols: Number of columns of a matrix.
+ * @param[in] D: Pointer to dense matrix.
+ * @param[in] ldD: leading dimensions of `D`.
+ * @param[out] U: Pointer to low-rank factor `U`.
+ * @param[in] ldU: leading dimensions of `U`.
+ * @param[out] V: Pointer to low-rank factor `V`.
+ * @param[in] ldV: leading dimensions of `V`.
+ * @param[out] rank: Address of rank variable.
+ * @param[in] maxrank: Maximum possible rank.
+ * @param[in] nsketch: Number of columns of `S`.
+ * @param[in] S: Sketching matrix of size `ncols` by `nsketch`.
+ * @param[in] ldS: leading dimensions of `S`.
+ * @param[in] oversample: Number of additional random columns of sketch.
+ * @param[in] tol: Relative error for approximation.
+ * @param[in] work: Working array.
+ * @param[in] lwork: Size of `work` array.
+ * @param[in] iwork: Temporary integer array.
+ * */
+{
+    int mn = nrows < ncols ? nrows : ncols;
+    int mn2 = nsketch+oversample;
+    int i;
+    double normD, normR;
+    if(mn2 > mn)
+        mn2 = mn;
+    if(nsketch > mn2)
+        nsketch = mn2;
+    double *X, *Q, *tau, *svd_U, *svd_S, *svd_V, *svdqr_work;
+    X = work;
+    Q = X+(size_t)ncols*mn2;
+    svd_U = Q+(size_t)nrows*mn2;
+    svd_S = svd_U+(size_t)mn2*mn2;
+    tau = svd_S;
+    svd_V = svd_S+mn2;
+    svdqr_work = svd_V+ncols*mn2;
+    int svdqr_lwork = lwork-(size_t)mn2*(2*ncols+nrows+mn2+1);
+    int iseed[4] = {0, 0, 0, 1};
+    // Sketching matrix is given columns followed by random columns
+    for(i = 0; i < nsketch; i++)
+        cblas_dcopy(ncols, S+(size_t)ldS*i, 1, X+(size_t)ncols*i, 1);
+    if(mn2 > nsketch)
+        LAPACKE_dlarnv_work(3, iseed, (size_t)ncols*(mn2-nsketch),
+                X+(size_t)ncols*nsketch);
+    // Multiply by sketching matrix
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, mn2,
+            ncols, 1.0, D, ldD, X, ncols, 0.0, Q, nrows);
+    // Get Q factor of QR factorization
+    LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, nrows, mn2, Q, nrows, tau,
+            svdqr_work, svdqr_lwork);
+    LAPACKE_dorgqr_work(LAPACK_COL_MAJOR, nrows, mn2, mn2, Q, nrows, tau,
+            svdqr_work, svdqr_lwork);
+    // Multiply Q by initial matrix
+    cblas_dgemm(CblasColMajor, CblasConjTrans, CblasNoTrans, mn2, ncols,
+            nrows, 1.0, Q, nrows, D, ldD, 0.0, X, mn2);
+    // Check if projection onto Q is accurate enough, with the same threshold
+    // as for power iterations in starsh_dense_dlrrsdd()
+    normD = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows, ncols, D, ldD,
+            NULL);
+    normR = dlrrsdd_residual(nrows, ncols, mn2, D, ldD, Q, nrows, X, mn2,
+            svd_V);
+    if(normR > 0.5*tol*normD)
+    {
+        *rank = -1;
+        return;
+    }
+    // Get SVD of result to reduce rank
+    int info = LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'S', mn2, ncols, X, mn2,
+            svd_S, svd_U, mn2, svd_V, mn2, svdqr_work, svdqr_lwork, iwork);
+    if(info != 0)
+    {
+        STARSH_WARNING("LAPACKE_dgesdd_work info=%d", info);
+    }
+    // Get rank, corresponding to given error tolerance
+    *rank = starsh_dense_dsvfr(mn2, svd_S, tol);
+    if(info == 0 && *rank <= maxrank)
+    {
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, *rank,
+                mn2, 1.0, Q, nrows, svd_U, mn2, 0.0, U, ldU);
+        for(i = 0; i < *rank; i++)
+        {
+            cblas_dcopy(ncols, svd_V+i, mn2, V+i*(size_t)ldV, 1);
+            cblas_dscal(ncols, svd_S[i], V+i*(size_t)ldV, 1);
+        }
+    }
+    else
+        *rank = -1;
+}
@@ -5,28 +5,24 @@
  *             University of Science and Technology (KAUST)
  *
  * @file src/backends/starpu/blrm/dmml.c
- *
- * @cond
- * This command in pair with endcond will prevent file from being documented.
- *
  * @version 1.3.0
  * @author Aleksandr Mikhalev
  * @date 2017-11-07
  * */
 
-#include "starsh.h"
 #include "common.h"
+#include "starsh.h"
 #include "starsh-starpu.h"
 
-// Compilation of this file should file because it is intended to fail
-// This fail is commented due to bug
-
-//int starsh_blrm__dmml_starpu(STARSH_blrm *matrix, int nrhs, double alpha,
-//        double *A, int lda, double beta, double *B, int ldb)
+int starsh_blrm__dmml_starpu(STARSH_blrm *matrix, int nrhs, double alpha,
+        double *A, int lda, double beta, double *B, int ldb)
 //! Multiply blr-matrix by dense matrix.
 /*! Performs `C=alpha*A*B+beta*C` with @ref STARSH_blrm `A` and dense matrices
  * `B` and `C`. All the integer types are int, since they are used in BLAS
- * calls.
+ * calls. Dense matrices are registered once and partitioned by clusters, and
+ * each tile contributes to its block row of `C` in `STARPU_REDUX` mode, so
+ * that tiles of the same block row are multiplied concurrently. StarPU must
+ * be initialized before calling this function.
  *
  * @param[in] matrix: Pointer to @ref STARSH_blrm object.
  * @param[in] nrhs: Number of right hand sides.
@@ -43,20 +39,20 @@
     STARSH_blrm *M = matrix;
     STARSH_blrf *F = M->format;
     STARSH_problem *P = F->problem;
-    STARSH_kernel *kernel = P->kernel;
     STARSH_int nrows = P->shape[0];
     STARSH_int ncols = P->shape[P->ndim-1];
     // Shorcuts to information about clusters
     STARSH_cluster *R = F->row_cluster;
     STARSH_cluster *C = F->col_cluster;
-    void *RD = R->data, *CD = C->data;
     // Number of far-field and near-field blocks
     STARSH_int nblocks_far = F->nblocks_far;
     STARSH_int nblocks_near = F->nblocks_near;
     STARSH_int bi;
     int T = CblasTrans, N = CblasNoTrans;
-    double one = 1.0, zero = 0.0;
     char symm = F->symm;
+    // Shared bases are not produced by StarPU approximations
+    if(M->uniform == 1)
+        return starsh_blrm__dmml(matrix, nrhs, alpha, A, lda, beta, B, ldb);
     // Setting B = beta*B
     if(beta == 0.)
         for(size_t i = 0; i < nrhs; i++)
@@ -66,306 +62,189 @@
         for(size_t i = 0; i < nrhs; i++)
             for(size_t j = 0; j < nrows; j++)
                 B[i*ldb+j] *= beta;
-    starpu_data_handle_t U_handle[nblocks_far], V_handle[nblocks_far];
-    starpu_data_handle_t A_handle[nblocks_far], B_handle[nblocks_far];
-    starpu_data_handle_t work_handle[nblocks_far];
-    starpu_data_handle_t A2_handle[nblocks_far], B2_handle[nblocks_far];
-    starpu_data_handle_t work2_handle[nblocks_far];
-    struct starpu_codelet codelet =
+    struct starpu_codelet codelet_lrmm =
+    {
+        .cpu_funcs = {starsh_dense_dlrmm_starpu},
+        .nbuffers = 5,
+        .modes = {STARPU_R, STARPU_R, STARPU_R, STARPU_REDUX, STARPU_SCRATCH},
+        .model = &starsh_dense_dlrmm_starpu_model
+    };
+    struct starpu_codelet codelet_mm =
     {
-        .cpu_funcs = {starsh_dense_dgemm_starpu},
+        .cpu_funcs = {starsh_dense_dmm_starpu},
         .nbuffers = 3,
-        .modes = {STARPU_R, STARPU_R, STARPU_RW}
+        .modes = {STARPU_R, STARPU_R, STARPU_REDUX},
+        .model = &starsh_dense_dmm_starpu_model
     };
     struct starpu_codelet codelet_kernel =
     {
         .cpu_funcs = {starsh_dense_kernel_starpu},
         .nbuffers = 2,
-        .modes = {STARPU_R, STARPU_W}
+        .modes = {STARPU_R, STARPU_W},
+        .model = &starsh_dense_kernel_starpu_model
     };
-    struct starpu_codelet fake_codelet =
+    struct starpu_codelet codelet_zero =
     {
-        .cpu_funcs = {starsh_dense_fake_init_starpu},
+        .cpu_funcs = {starsh_dense_dzero_starpu},
         .nbuffers = 1,
-        .modes = {STARPU_W}
+        .modes = {STARPU_W},
+        .model = &starsh_dense_dzero_starpu_model
+    };
+    struct starpu_codelet codelet_add =
+    {
+        .cpu_funcs = {starsh_dense_dadd_starpu},
+        .nbuffers = 2,
+        .modes = {STARPU_RW, STARPU_R},
+        .model = &starsh_dense_dadd_starpu_model
+    };
+    // Register dense matrices and partition them by clusters, so that each
+    // block row and block column has its own handle
+    starpu_data_handle_t A_handle, B_handle;
+    starpu_matrix_data_register(&A_handle, STARPU_MAIN_RAM, (uintptr_t)A, lda,
+            ncols, nrhs, sizeof(*A));
+    starpu_matrix_data_register(&B_handle, STARPU_MAIN_RAM, (uintptr_t)B, ldb,
+            nrows, nrhs, sizeof(*B));
+    struct starpu_data_filter A_filter =
+    {
+        .filter_func = starsh_dense_filter_starpu,
+        .nchildren = C->nblocks,
+        .filter_arg_ptr = C
     };
+    struct starpu_data_filter B_filter =
+    {
+        .filter_func = starsh_dense_filter_starpu,
+        .nchildren = R->nblocks,
+        .filter_arg_ptr = R
+    };
+    starpu_data_partition(A_handle, &A_filter);
+    starpu_data_partition(B_handle, &B_filter);
+    for(bi = 0; bi < R->nblocks; bi++)
+        starpu_data_set_reduction_methods(starpu_data_get_child(B_handle, bi),
+                &codelet_add, &codelet_zero);
+    // Scratch buffer for product of a tile and a block column of A
+    int maxrank = 0;
+    for(bi = 0; bi < nblocks_far; bi++)
+        if(M->far_rank[bi] > maxrank)
+            maxrank = M->far_rank[bi];
+    starpu_data_handle_t work_handle = NULL;
+    if(maxrank > 0)
+        starpu_vector_data_register(&work_handle, -1, 0,
+                (size_t)nrhs*maxrank, sizeof(*A));
+    // Handles of low-rank factors and dense tiles
+    starpu_data_handle_t *U_handle = NULL, *V_handle = NULL;
+    starpu_data_handle_t *D_handle = NULL, *bi_handle = NULL;
+    STARSH_int *bi_value = NULL;
+    if(nblocks_far > 0)
+    {
+        STARSH_MALLOC(U_handle, nblocks_far);
+        STARSH_MALLOC(V_handle, nblocks_far);
+    }
+    if(nblocks_near > 0)
+    {
+        STARSH_MALLOC(D_handle, nblocks_near);
+        if(M->onfly == 1)
+        {
+            STARSH_MALLOC(bi_handle, nblocks_near);
+            STARSH_MALLOC(bi_value, nblocks_near);
+        }
+    }
     // Simple cycle over all far-field admissible blocks
     for(bi = 0; bi < nblocks_far; bi++)
     {
         // Get indexes of corresponding block row and block column
         STARSH_int i = F->block_far[2*bi];
         STARSH_int j = F->block_far[2*bi+1];
-        // Get sizes and rank in int type due to BLAS calls
-        int nrows = R->size[i];
-        int ncols = C->size[j];
         int rank = M->far_rank[bi];
+        // Negligible tiles do not contribute
+        if(rank == 0)
+            continue;
         // Get pointers to data buffers
         double *U = M->far_U[bi]->data, *V = M->far_V[bi]->data;
         // Register data
         starpu_vector_data_register(U_handle+bi, STARPU_MAIN_RAM,
-                (uintptr_t)U, nrows*(size_t)rank, sizeof(*U));
+                (uintptr_t)U, R->size[i]*(size_t)rank, sizeof(*U));
         starpu_vector_data_register(V_handle+bi, STARPU_MAIN_RAM,
-                (uintptr_t)V, ncols*(size_t)rank, sizeof(*V));
-        starpu_vector_data_register(work_handle+bi, -1, 0, (size_t)nrhs*rank,
-                sizeof(*U));
-        starpu_vector_data_register(B_handle+bi, STARPU_MAIN_RAM,
-                (uintptr_t)(B+R->start[i]),
-                nrhs*(size_t)ldb-R->start[i], sizeof(*B));
-        starpu_vector_data_register(A_handle+bi, STARPU_MAIN_RAM,
-                (uintptr_t)(A+C->start[j]),
-                nrhs*(size_t)lda-C->start[j], sizeof(*A));
-        // fake task to make workhandle initialized
-        starpu_task_insert(&fake_codelet, STARPU_W, work_handle[bi], 0);
+                (uintptr_t)V, C->size[j]*(size_t)rank, sizeof(*V));
         // Multiply low-rank matrix in U*V^T format by a dense matrix
-        starpu_task_insert(&codelet, STARPU_VALUE, &T, sizeof(T),
-                STARPU_VALUE, &N, sizeof(N),
-                STARPU_VALUE, &rank, sizeof(rank),
-                STARPU_VALUE, &nrhs, sizeof(nrhs),
-                STARPU_VALUE, &ncols, sizeof(ncols),
-                STARPU_VALUE, &one, sizeof(one),
-                STARPU_R, V_handle[bi],
-                STARPU_VALUE, &ncols, sizeof(ncols),
-                STARPU_R, A_handle[bi],
-                STARPU_VALUE, &lda, sizeof(lda),
-                STARPU_VALUE, &zero, sizeof(zero),
-                STARPU_RW, work_handle[bi],
-                STARPU_VALUE, &rank, sizeof(rank),
-                0);
-        //cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-        //        ncols, 1.0, V, ncols, A+C->start[j], lda, 0.0, D, rank);
-        starpu_task_insert(&codelet, STARPU_VALUE, &N, sizeof(N),
-                STARPU_VALUE, &N, sizeof(N),
-                STARPU_VALUE, &nrows, sizeof(nrows),
-                STARPU_VALUE, &nrhs, sizeof(nrhs),
-                STARPU_VALUE, &rank, sizeof(rank),
-                STARPU_VALUE, &alpha, sizeof(alpha),
-                STARPU_R, U_handle[bi],
-                STARPU_VALUE, &nrows, sizeof(nrows),
-                STARPU_R, work_handle[bi],
-                STARPU_VALUE, &rank, sizeof(rank),
-                STARPU_VALUE, &one, sizeof(one),
-                STARPU_RW, B_handle[bi],
-                STARPU_VALUE, &ldb, sizeof(ldb),
-                0);
-        //cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs,
-        //        rank, alpha, U, nrows, D, rank, 1.0, B+R->start[i], ldb);
-        starpu_data_unregister_submit(work_handle[bi]);
+        starpu_task_insert(&codelet_lrmm, STARPU_VALUE, &alpha, sizeof(alpha),
+                STARPU_R, U_handle[bi], STARPU_R, V_handle[bi],
+                STARPU_R, starpu_data_get_child(A_handle, j),
+                STARPU_REDUX, starpu_data_get_child(B_handle, i),
+                STARPU_SCRATCH, work_handle, 0);
         if(i != j && symm == 'S')
         {
             // Multiply low-rank matrix in V*U^T format by a dense matrix
             // U and V are simply swapped in case of symmetric block
-            starpu_vector_data_register(B2_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(B+C->start[j]),
-                    nrhs*(size_t)ldb-C->start[j], sizeof(*B));
-            starpu_vector_data_register(A2_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(A+R->start[i]),
-                    nrhs*(size_t)lda-R->start[i], sizeof(*A));
-            starpu_vector_data_register(work2_handle+bi, -1, 0,
-                    (size_t)nrhs*rank, sizeof(*U));
-            // fake task to make workhandle initialized
-            starpu_task_insert(&fake_codelet, STARPU_W, work2_handle[bi], 0);
-            starpu_task_insert(&codelet, STARPU_VALUE, &T, sizeof(T),
-                    STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &rank, sizeof(rank),
-                    STARPU_VALUE, &nrhs, sizeof(nrhs),
-                    STARPU_VALUE, &nrows, sizeof(nrows),
-                    STARPU_VALUE, &one, sizeof(one),
-                    STARPU_R, U_handle[bi],
-                    STARPU_VALUE, &nrows, sizeof(nrows),
-                    STARPU_R, A2_handle[bi],
-                    STARPU_VALUE, &lda, sizeof(lda),
-                    STARPU_VALUE, &zero, sizeof(zero),
-                    STARPU_RW, work2_handle[bi],
-                    STARPU_VALUE, &rank, sizeof(rank),
-                    0);
-            //cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs,
-            //        nrows, 1.0, U, nrows, A+R->start[i], lda, 0.0, D, rank);
-            starpu_task_insert(&codelet, STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &ncols, sizeof(ncols),
-                    STARPU_VALUE, &nrhs, sizeof(nrhs),
-                    STARPU_VALUE, &rank, sizeof(rank),
+            starpu_task_insert(&codelet_lrmm,
                     STARPU_VALUE, &alpha, sizeof(alpha),
-                    STARPU_R, V_handle[bi],
-                    STARPU_VALUE, &ncols, sizeof(ncols),
-                    STARPU_R, work2_handle[bi],
-                    STARPU_VALUE, &rank, sizeof(rank),
-                    STARPU_VALUE, &one, sizeof(one),
-                    STARPU_RW, B2_handle[bi],
-                    STARPU_VALUE, &ldb, sizeof(ldb),
-                    0);
-            //cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, ncols,
-            //        nrhs, rank, alpha, V, ncols, D, rank, 1.0,
-            //        B+C->start[j], ldb);
-            starpu_data_unregister_submit(A2_handle[bi]);
-            starpu_data_unregister_submit(B2_handle[bi]);
-            starpu_data_unregister_submit(work2_handle[bi]);
+                    STARPU_R, V_handle[bi], STARPU_R, U_handle[bi],
+                    STARPU_R, starpu_data_get_child(A_handle, i),
+                    STARPU_REDUX, starpu_data_get_child(B_handle, j),
+                    STARPU_SCRATCH, work_handle, 0);
         }
         starpu_data_unregister_submit(U_handle[bi]);
         starpu_data_unregister_submit(V_handle[bi]);
-        starpu_data_unregister_submit(A_handle[bi]);
-        starpu_data_unregister_submit(B_handle[bi]);
     }
-    starpu_task_wait_for_all();
-    starpu_data_handle_t A3_handle[nblocks_near], B3_handle[nblocks_near];
-    starpu_data_handle_t work3_handle[nblocks_near];
-    starpu_data_handle_t A4_handle[nblocks_near], B4_handle[nblocks_near];
-    starpu_data_handle_t work4_handle[nblocks_near];
-    starpu_data_handle_t bi_handle[nblocks_near];
-    STARSH_int bi_value[nblocks_near];
-    if(M->onfly == 1)
-        // Simple cycle over all near-field blocks
-        for(bi = 0; bi < nblocks_near; bi++)
+    // Simple cycle over all near-field blocks
+    for(bi = 0; bi < nblocks_near; bi++)
+    {
+        // Get indexes and sizes of corresponding block row and column
+        STARSH_int i = F->block_near[2*bi];
+        STARSH_int j = F->block_near[2*bi+1];
+        size_t tile_size = R->size[i]*(size_t)C->size[j];
+        // Dense tiles are the most expensive ones, so they go first
+        int prio = STARPU_DEFAULT_PRIO+1;
+        if(i == j)
+            prio = STARPU_MAX_PRIO;
+        if(M->onfly == 1)
         {
-            // Get indexes and sizes of corresponding block row and column
-            STARSH_int i = F->block_near[2*bi];
-            STARSH_int j = F->block_near[2*bi+1];
-            // Get sizes in int type due to BLAS calls
-            int nrows = R->size[i];
-            int ncols = C->size[j];
-            // Register data
+            // Fill temporary buffer with elements of corresponding block
             bi_value[bi] = bi;
             starpu_variable_data_register(bi_handle+bi, STARPU_MAIN_RAM,
                     (uintptr_t)(bi_value+bi), sizeof(*bi_value));
-            starpu_vector_data_register(work3_handle+bi, -1, 0,
-                    (size_t)nrows*ncols, sizeof(*A));
-            starpu_vector_data_register(B3_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(B+R->start[i]),
-                    nrhs*(size_t)ldb-R->start[i], sizeof(*B));
-            starpu_vector_data_register(A3_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(A+C->start[j]),
-                    nrhs*(size_t)lda-C->start[j], sizeof(*A));
-            // Fill temporary buffer with elements of corresponding block
+            starpu_vector_data_register(D_handle+bi, -1, 0, tile_size,
+                    sizeof(*A));
             starpu_task_insert(&codelet_kernel, STARPU_VALUE, &F, sizeof(F),
-                    STARPU_R, bi_handle[bi], STARPU_W, work3_handle[bi], 0);
+                    STARPU_PRIORITY, prio, STARPU_R, bi_handle[bi],
+                    STARPU_W, D_handle[bi], 0);
             starpu_data_unregister_submit(bi_handle[bi]);
-            //kernel(nrows, ncols, R->pivot+R->start[i], C->pivot+C->start[j],
-            //        RD, CD, D, nrows);
-            // Multiply 2 dense matrices
-            starpu_task_insert(&codelet, STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &nrows, sizeof(nrows),
-                    STARPU_VALUE, &nrhs, sizeof(nrhs),
-                    STARPU_VALUE, &ncols, sizeof(ncols),
-                    STARPU_VALUE, &alpha, sizeof(alpha),
-                    STARPU_R, work3_handle[bi],
-                    STARPU_VALUE, &nrows, sizeof(nrows),
-                    STARPU_R, A3_handle[bi],
-                    STARPU_VALUE, &lda, sizeof(lda),
-                    STARPU_VALUE, &one, sizeof(one),
-                    STARPU_RW, B3_handle[bi],
-                    STARPU_VALUE, &ldb, sizeof(ldb),
-                    0);
-            //cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
-            //        nrhs, ncols, alpha, D, nrows, A+C->start[j], lda, 1.0,
-            //        B+R->start[i], ldb);
-            if(i != j && symm == 'S')
-            {
-                // Repeat in case of symmetric matrix
-                starpu_vector_data_register(B4_handle+bi, STARPU_MAIN_RAM,
-                        (uintptr_t)(B+C->start[j]),
-                        nrhs*(size_t)ldb-C->start[j], sizeof(*B));
-                starpu_vector_data_register(A4_handle+bi, STARPU_MAIN_RAM,
-                        (uintptr_t)(A+R->start[i]),
-                        nrhs*(size_t)lda-R->start[i], sizeof(*A));
-                starpu_task_insert(&codelet, STARPU_VALUE, &T, sizeof(T),
-                        STARPU_VALUE, &N, sizeof(N),
-                        STARPU_VALUE, &ncols, sizeof(ncols),
-                        STARPU_VALUE, &nrhs, sizeof(nrhs),
-                        STARPU_VALUE, &nrows, sizeof(nrows),
-                        STARPU_VALUE, &alpha, sizeof(alpha),
-                        STARPU_R, work3_handle[bi],
-                        STARPU_VALUE, &nrows, sizeof(nrows),
-                        STARPU_R, A4_handle[bi],
-                        STARPU_VALUE, &lda, sizeof(lda),
-                        STARPU_VALUE, &one, sizeof(one),
-                        STARPU_RW, B4_handle[bi],
-                        STARPU_VALUE, &ldb, sizeof(ldb),
-                        0);
-                //cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans,
-                //        ncols, nrhs, nrows, alpha, D, nrows, A+R->start[i],
-                //        lda, 1.0, B+C->start[j], ldb);
-                starpu_data_unregister_submit(A4_handle[bi]);
-                starpu_data_unregister_submit(B4_handle[bi]);
-            }
-            starpu_data_unregister_submit(A3_handle[bi]);
-            starpu_data_unregister_submit(B3_handle[bi]);
-            starpu_data_unregister_submit(work3_handle[bi]);
         }
-    if(M->onfly == 0)
-        // Simple cycle over all near-field blocks
-        for(bi = 0; bi < nblocks_near; bi++)
+        else
         {
-            // Get indexes and sizes of corresponding block row and column
-            STARSH_int i = F->block_near[2*bi];
-            STARSH_int j = F->block_near[2*bi+1];
-            // Get sizes in int type due to BLAS calls
-            int nrows = R->size[i];
-            int ncols = C->size[j];
-            // Get pointers to data buffers
             double *D = M->near_D[bi]->data;
-            // Register data
-            starpu_vector_data_register(work3_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)D, (size_t)nrows*ncols, sizeof(*D));
-            starpu_vector_data_register(B3_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(B+R->start[i]),
-                    nrhs*(size_t)ldb-R->start[i], sizeof(*B));
-            starpu_vector_data_register(A3_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(A+C->start[j]),
-                    nrhs*(size_t)lda-C->start[j], sizeof(*A));
-            // Multiply 2 dense matrices
-            starpu_task_insert(&codelet, STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &N, sizeof(N),
-                    STARPU_VALUE, &nrows, sizeof(nrows),
-                    STARPU_VALUE, &nrhs, sizeof(nrhs),
-                    STARPU_VALUE, &ncols, sizeof(ncols),
+            starpu_vector_data_register(D_handle+bi, STARPU_MAIN_RAM,
+                    (uintptr_t)D, tile_size, sizeof(*D));
+        }
+        // Multiply 2 dense matrices
+        starpu_task_insert(&codelet_mm, STARPU_VALUE, &N, sizeof(N),
+                STARPU_VALUE, &alpha, sizeof(alpha), STARPU_PRIORITY, prio,
+                STARPU_R, D_handle[bi],
+                STARPU_R, starpu_data_get_child(A_handle, j),
+                STARPU_REDUX, starpu_data_get_child(B_handle, i), 0);
+        if(i != j && symm == 'S')
+        {
+            // Repeat in case of symmetric matrix
+            starpu_task_insert(&codelet_mm, STARPU_VALUE, &T, sizeof(T),
                     STARPU_VALUE, &alpha, sizeof(alpha),
-                    STARPU_R, work3_handle[bi],
-                    STARPU_VALUE, &nrows, sizeof(nrows),
-                    STARPU_R, A3_handle[bi],
-                    STARPU_VALUE, &lda, sizeof(lda),
-                    STARPU_VALUE, &one, sizeof(one),
-                    STARPU_RW, B3_handle[bi],
-                    STARPU_VALUE, &ldb, sizeof(ldb),
-                    0);
-            //cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
-            //        nrhs, ncols, alpha, D, nrows, A+C->start[j], lda, 1.0,
-            //        B+R->start[i], ldb);
-            if(i != j && symm == 'S')
-            {
-                // Repeat in case of symmetric matrix
-                starpu_vector_data_register(B4_handle+bi, STARPU_MAIN_RAM,
-                        (uintptr_t)(B+C->start[j]),
-                        nrhs*(size_t)ldb-C->start[j], sizeof(*B));
-                starpu_vector_data_register(A4_handle+bi, STARPU_MAIN_RAM,
-                        (uintptr_t)(A+R->start[i]),
-                        nrhs*(size_t)lda-R->start[i], sizeof(*A));
-                starpu_task_insert(&codelet, STARPU_VALUE, &T, sizeof(T),
-                        STARPU_VALUE, &N, sizeof(N),
-                        STARPU_VALUE, &ncols, sizeof(ncols),
-                        STARPU_VALUE, &nrhs, sizeof(nrhs),
-                        STARPU_VALUE, &nrows, sizeof(nrows),
-                        STARPU_VALUE, &alpha, sizeof(alpha),
-                        STARPU_R, work3_handle[bi],
-                        STARPU_VALUE, &nrows, sizeof(nrows),
-                        STARPU_R, A4_handle[bi],
-                        STARPU_VALUE, &lda, sizeof(lda),
-                        STARPU_VALUE, &one, sizeof(one),
-                        STARPU_RW, B4_handle[bi],
-                        STARPU_VALUE, &ldb, sizeof(ldb),
-                        0);
-                //cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans,
-                //        ncols, nrhs, nrows, alpha, D, nrows, A+R->start[i],
-                //        lda, 1.0, B+C->start[j], ldb);
-                starpu_data_unregister_submit(A4_handle[bi]);
-                starpu_data_unregister_submit(B4_handle[bi]);
-            }
-            starpu_data_unregister_submit(A3_handle[bi]);
-            starpu_data_unregister_submit(B3_handle[bi]);
-            starpu_data_unregister_submit(work3_handle[bi]);
+                    STARPU_PRIORITY, prio, STARPU_R, D_handle[bi],
+                    STARPU_R, starpu_data_get_child(A_handle, i),
+                    STARPU_REDUX, starpu_data_get_child(B_handle, j), 0);
         }
+        starpu_data_unregister_submit(D_handle[bi]);
+    }
+    if(work_handle != NULL)
+        starpu_data_unregister_submit(work_handle);
+    // Gathering of partitioned data waits for all the tasks and reduces
+    // contributions to each block row of B
+    starpu_data_unpartition(A_handle, STARPU_MAIN_RAM);
+    starpu_data_unpartition(B_handle, STARPU_MAIN_RAM);
+    starpu_data_unregister(A_handle);
+    starpu_data_unregister(B_handle);
     starpu_task_wait_for_all();
-    return 0;
+    free(U_handle);
+    free(V_handle);
+    free(D_handle);
+    free(bi_handle);
+    free(bi_value);
+    return STARSH_SUCCESS;
 }
-
-//! @endcond
@@ -0,0 +1,196 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/blrm/dpotrf.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+int starsh_blrm__dpotrf_starpu(STARSH_blrm **factor, STARSH_blrm *matrix,
+        int maxrank, double tol)
+//! TLR Cholesky factorization of a symmetric positive definite matrix.
+/*! StarPU version of starsh_blrm__dpotrf(). Each operation on a tile is a
+ * StarPU task. Factors `U` and `V` of low-rank tiles and dense diagonal
+ * tiles are registered as StarPU data, so dependencies between tasks are
+ * inferred by StarPU. Ranks of tiles are passed to tasks by pointers, as
+ * they are read and written only by tasks, accessing corresponding factors.
+ *
+ * @param[out] factor: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] matrix: Symmetric positive definite TLR matrix.
+ * @param[in] maxrank: Maximum possible rank of tiles of factor.
+ * @param[in] tol: Relative error tolerance for tiles of factor.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm__dpotrf(), starsh_blrm__dpotrs().
+ * @ingroup factor
+ * */
+{
+    STARSH_blrm *L;
+    int info = starsh_blrm__dfactor_init(&L, matrix, 'L', maxrank, tol);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_blrf *F = L->format;
+    STARSH_cluster *R = F->row_cluster;
+    STARSH_int nb = F->nbrows, nblocks_far = F->nblocks_far;
+    STARSH_int bi, k, nlimited = 0;
+    int *info_ptr = &info;
+    struct starpu_codelet codelet_potrf =
+    {
+        .cpu_funcs = {starsh_dense_dpotrf_starpu},
+        .nbuffers = 1,
+        .modes = {STARPU_RW},
+        .model = &starsh_dense_dpotrf_starpu_model
+    };
+    struct starpu_codelet codelet_trsm =
+    {
+        .cpu_funcs = {starsh_dense_dlrtrsm_starpu},
+        .nbuffers = 2,
+        .modes = {STARPU_R, STARPU_RW},
+        .model = &starsh_dense_dlrtrsm_starpu_model
+    };
+    struct starpu_codelet codelet_syrk =
+    {
+        .cpu_funcs = {starsh_dense_dlrsyrk_starpu},
+        .nbuffers = 4,
+        .modes = {STARPU_R, STARPU_R, STARPU_RW, STARPU_SCRATCH},
+        .model = &starsh_dense_dlrsyrk_starpu_model
+    };
+    struct starpu_codelet codelet_gemm =
+    {
+        .cpu_funcs = {starsh_dense_dlrgemm_starpu},
+        .nbuffers = 7,
+        .modes = {STARPU_R, STARPU_R, STARPU_R, STARPU_R, STARPU_RW,
+            STARPU_RW, STARPU_SCRATCH},
+        .model = &starsh_dense_dlrgemm_starpu_model
+    };
+    // Get maximum size of tiles and maximum rank to allocate workspace
+    int maxsize = 0, maxr;
+    for(k = 0; k < nb; k++)
+        if(R->size[k] > maxsize)
+            maxsize = R->size[k];
+    maxr = maxrank < maxsize ? maxrank : maxsize;
+    int lwork = (2*maxsize+18*maxr+11)*2*maxr+maxr*(maxr+maxsize);
+    // Integer workspace is placed into the same scratch buffer
+    int liwork = 8*maxr;
+    starpu_data_handle_t *U_handle, *V_handle, *D_handle, work_handle;
+    char *limited;
+    STARSH_MALLOC(U_handle, nblocks_far+1);
+    STARSH_MALLOC(V_handle, nblocks_far+1);
+    STARSH_MALLOC(D_handle, nb);
+    STARSH_MALLOC(limited, nblocks_far+1);
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        limited[bi] = 0;
+        starpu_vector_data_register(U_handle+bi, STARPU_MAIN_RAM,
+                (uintptr_t)L->far_U[bi]->data, L->far_U[bi]->size,
+                sizeof(double));
+        starpu_vector_data_register(V_handle+bi, STARPU_MAIN_RAM,
+                (uintptr_t)L->far_V[bi]->data, L->far_V[bi]->size,
+                sizeof(double));
+    }
+    for(k = 0; k < nb; k++)
+        starpu_vector_data_register(D_handle+k, STARPU_MAIN_RAM,
+                (uintptr_t)L->near_D[k]->data, L->near_D[k]->size,
+                sizeof(double));
+    starpu_vector_data_register(&work_handle, -1, 0, lwork+liwork,
+            sizeof(double));
+    for(k = 0; k < nb; k++)
+    {
+        STARSH_int i, j;
+        int nk = R->size[k];
+        // Factorize diagonal tile
+        starpu_task_insert(&codelet_potrf,
+                STARPU_PRIORITY, STARPU_DEFAULT_PRIO+2,
+                STARPU_VALUE, &nk, sizeof(nk),
+                STARPU_VALUE, &info_ptr, sizeof(info_ptr),
+                STARPU_RW, D_handle[k], 0);
+        // Solve for tiles of current block column
+        for(i = k+1; i < nb; i++)
+        {
+            int *rank = L->far_rank+i*(i-1)/2+k;
+            starpu_task_insert(&codelet_trsm,
+                    STARPU_PRIORITY, STARPU_DEFAULT_PRIO+1,
+                    STARPU_VALUE, &nk, sizeof(nk),
+                    STARPU_VALUE, &rank, sizeof(rank),
+                    STARPU_VALUE, &info_ptr, sizeof(info_ptr),
+                    STARPU_R, D_handle[k],
+                    STARPU_RW, V_handle[i*(i-1)/2+k], 0);
+        }
+        // Update trailing submatrix
+        for(i = k+1; i < nb; i++)
+        {
+            STARSH_int bik = i*(i-1)/2+k;
+            int ni = R->size[i];
+            int *rank1 = L->far_rank+bik;
+            starpu_task_insert(&codelet_syrk,
+                    STARPU_PRIORITY, STARPU_DEFAULT_PRIO,
+                    STARPU_VALUE, &ni, sizeof(ni),
+                    STARPU_VALUE, &nk, sizeof(nk),
+                    STARPU_VALUE, &rank1, sizeof(rank1),
+                    STARPU_VALUE, &info_ptr, sizeof(info_ptr),
+                    STARPU_R, U_handle[bik], STARPU_R, V_handle[bik],
+                    STARPU_RW, D_handle[i], STARPU_SCRATCH, work_handle, 0);
+            for(j = k+1; j < i; j++)
+            {
+                STARSH_int bjk = j*(j-1)/2+k, bij = i*(i-1)/2+j;
+                int nj = R->size[j], cap = L->far_U[bij]->shape[1];
+                int *rank2 = L->far_rank+bjk, *rank = L->far_rank+bij;
+                char *limited_ptr = limited+bij;
+                starpu_task_insert(&codelet_gemm,
+                        STARPU_PRIORITY, STARPU_DEFAULT_PRIO,
+                        STARPU_VALUE, &ni, sizeof(ni),
+                        STARPU_VALUE, &nj, sizeof(nj),
+                        STARPU_VALUE, &nk, sizeof(nk),
+                        STARPU_VALUE, &rank1, sizeof(rank1),
+                        STARPU_VALUE, &rank2, sizeof(rank2),
+                        STARPU_VALUE, &rank, sizeof(rank),
+                        STARPU_VALUE, &cap, sizeof(cap),
+                        STARPU_VALUE, &tol, sizeof(tol),
+                        STARPU_VALUE, &liwork, sizeof(liwork),
+                        STARPU_VALUE, &info_ptr, sizeof(info_ptr),
+                        STARPU_VALUE, &limited_ptr, sizeof(limited_ptr),
+                        STARPU_R, U_handle[bik], STARPU_R, V_handle[bik],
+                        STARPU_R, U_handle[bjk], STARPU_R, V_handle[bjk],
+                        STARPU_RW, U_handle[bij], STARPU_RW, V_handle[bij],
+                        STARPU_SCRATCH, work_handle, 0);
+            }
+        }
+    }
+    starpu_task_wait_for_all();
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        starpu_data_unregister(U_handle[bi]);
+        starpu_data_unregister(V_handle[bi]);
+        nlimited += limited[bi];
+    }
+    for(k = 0; k < nb; k++)
+        starpu_data_unregister(D_handle[k]);
+    starpu_data_unregister(work_handle);
+    free(U_handle);
+    free(V_handle);
+    free(D_handle);
+    free(limited);
+    if(info != STARSH_SUCCESS)
+    {
+        starsh_blrm_free(L);
+        starsh_blrf_free(F);
+        return info;
+    }
+    if(nlimited > 0)
+    {
+        STARSH_WARNING("Rank of %zu updated tiles was truncated to maxrank=%d",
+                (size_t)nlimited, maxrank);
+    }
+    info = starsh_blrm__dfactor_finalize(L);
+    if(info != STARSH_SUCCESS)
+        return info;
+    *factor = L;
+    return STARSH_SUCCESS;
+}
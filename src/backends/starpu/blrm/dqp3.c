@@ -52,20 +52,43 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
     struct starpu_codelet codelet =
     {
         .cpu_funcs = {starsh_dense_dlrqp3_starpu},
-        .nbuffers = 6,
-        .modes = {STARPU_R, STARPU_W, STARPU_W, STARPU_W, STARPU_SCRATCH,
-            STARPU_SCRATCH}
+        .nbuffers = 7,
+        .modes = {STARPU_R, STARPU_W, STARPU_W, STARPU_W, STARPU_RW,
+            STARPU_SCRATCH, STARPU_SCRATCH},
+        .model = &starsh_dense_dlrqp3_starpu_model
     };
     struct starpu_codelet codelet2 =
     {
         .cpu_funcs = {starsh_dense_kernel_starpu},
         .nbuffers = 2,
-        .modes = {STARPU_R, STARPU_W}
+        .modes = {STARPU_R, STARPU_W},
+        .model = &starsh_dense_kernel_starpu_model
     };
-    STARSH_int bi_value[nblocks_far];
-    starpu_data_handle_t bi_handle[nblocks_far], rank_handle[nblocks_far];
-    starpu_data_handle_t U_handle[nblocks_far], V_handle[nblocks_far];
-    starpu_data_handle_t work_handle[nblocks_far], iwork_handle[nblocks_far];
+    struct starpu_codelet codelet_far =
+    {
+        .cpu_funcs = {starsh_dense_kernel_far_starpu},
+        .nbuffers = 2,
+        .modes = {STARPU_R, STARPU_W},
+        .model = &starsh_dense_kernel_far_starpu_model
+    };
+    // Tiles are submitted in windows of at most `window` tiles. Factors and
+    // dense tiles of a window are registered as a single vector, partitioned
+    // into tiles, so that number of registered handles does not depend on
+    // number of tiles.
+    const STARSH_int window = 1024;
+    STARSH_int *bi_value = NULL;
+    starpu_data_handle_t U_handle[2], V_handle[2];
+    starpu_data_handle_t work_handle, iwork_handle;
+    int lwork_max = 0, liwork_max = 0;
+    // Absolute tolerance of each far-field block for the entire matrix. Blocks
+    // with smaller norm are negligible and they are dropped.
+    double abstol = 0.;
+    if(nblocks_far > 0)
+    {
+        int info = starsh_blrm__dtol(F, tol, &abstol);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
     // Init buffers to store low-rank factors of far-field blocks if needed
     if(nblocks_far > 0)
     {
@@ -102,7 +125,7 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
             int lwork = 3*ncols+1, lwork_sdd = (4*mn2+7)*mn2;
             if(lwork_sdd > lwork)
                 lwork = lwork_sdd;
-            lwork += nrows*ncols+mn2*(2*ncols+mn2+1)+mn;
+            lwork += mn2*(2*ncols+mn2+1)+mn;
             int liwork = ncols, liwork_sdd = 8*mn2;
             if(liwork_sdd > liwork)
                 liwork = liwork_sdd;
@@ -113,45 +136,111 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
             offset_V += ncols*maxrank;
             array_from_buffer(far_U+bi, 2, shape_U, 'd', 'F', U);
             array_from_buffer(far_V+bi, 2, shape_V, 'd', 'F', V);
-            bi_value[bi] = bi;
-            starpu_variable_data_register(bi_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(bi_value+bi), sizeof(*bi_value));
-            starpu_variable_data_register(rank_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(far_rank+bi), sizeof(*far_rank));
-            starpu_vector_data_register(U_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(far_U[bi]->data), nrows*maxrank, sizeof(*U));
-            starpu_vector_data_register(V_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(far_V[bi]->data), ncols*maxrank, sizeof(*V));
-            starpu_vector_data_register(work_handle+bi, -1, 0, lwork,
-                    sizeof(*U));
-            starpu_vector_data_register(iwork_handle+bi, -1, 0, liwork,
-                    sizeof(int));
+            if(lwork > lwork_max)
+                lwork_max = lwork;
+            if(liwork > liwork_max)
+                liwork_max = liwork;
         }
         offset_U = 0;
         offset_V = 0;
+        STARSH_MALLOC(bi_value, nblocks_far);
+        // Temporary buffers are shared by all tiles
+        starpu_vector_data_register(&work_handle, -1, 0, lwork_max,
+                sizeof(*alloc_U));
+        starpu_vector_data_register(&iwork_handle, -1, 0, liwork_max,
+                sizeof(int));
     }
     // Work variables
     int info;
-    // Simple cycle over all far-field admissible blocks
-    for(bi = 0; bi < nblocks_far; bi++)
+    int k = 0;
+    STARSH_int w0, w1;
+    // Cycle over windows of far-field admissible blocks
+    for(w0 = 0; w0 < nblocks_far; w0 = w1)
+    {
+        // Get window, that fits into a single vector
+        size_t slice_U = 0, slice_V = 0;
+        for(w1 = w0; w1 < nblocks_far && w1-w0 < window; w1++)
+        {
+            if(w1 > w0 && (slice_U+far_U[w1]->size > UINT32_MAX ||
+                        slice_V+far_V[w1]->size > UINT32_MAX))
+                break;
+            slice_U += far_U[w1]->size;
+            slice_V += far_V[w1]->size;
+        }
+        struct starpu_data_filter U_filter =
+        {
+            .filter_func = starsh_dense_tile_filter_starpu,
+            .nchildren = w1-w0,
+            .filter_arg_ptr = far_U+w0
+        };
+        struct starpu_data_filter V_filter =
+        {
+            .filter_func = starsh_dense_tile_filter_starpu,
+            .nchildren = w1-w0,
+            .filter_arg_ptr = far_V+w0
+        };
+        starpu_vector_data_register(U_handle+k, STARPU_MAIN_RAM,
+                (uintptr_t)(far_U[w0]->data), slice_U, sizeof(*alloc_U));
+        starpu_vector_data_register(V_handle+k, STARPU_MAIN_RAM,
+                (uintptr_t)(far_V[w0]->data), slice_V, sizeof(*alloc_V));
+        starpu_data_partition(U_handle[k], &U_filter);
+        starpu_data_partition(V_handle[k], &V_filter);
+        for(bi = w0; bi < w1; bi++)
+        {
+            starpu_data_handle_t bi_handle, rank_handle, D_handle;
+            bi_value[bi] = bi;
+            starpu_variable_data_register(&bi_handle, STARPU_MAIN_RAM,
+                    (uintptr_t)(bi_value+bi), sizeof(*bi_value));
+            starpu_variable_data_register(&rank_handle, STARPU_MAIN_RAM,
+                    (uintptr_t)(far_rank+bi), sizeof(*far_rank));
+            // Elements of a tile are stored in a temporary buffer
+            starpu_vector_data_register(&D_handle, -1, 0,
+                    far_U[bi]->shape[0]*(size_t)far_V[bi]->shape[0],
+                    sizeof(*alloc_U));
+            starpu_task_insert(&codelet_far, STARPU_VALUE, &F, sizeof(F),
+                    STARPU_PRIORITY, STARPU_DEFAULT_PRIO,
+                    STARPU_R, bi_handle, STARPU_W, D_handle, 0);
+            // Compression is prioritized over generation, so that generated
+            // tiles do not pile up in memory
+            starpu_task_insert(&codelet,
+                    STARPU_PRIORITY, STARPU_DEFAULT_PRIO+1,
+                    STARPU_VALUE, &F, sizeof(F),
+                    STARPU_VALUE, &maxrank, sizeof(maxrank),
+                    STARPU_VALUE, &oversample, sizeof(oversample),
+                    STARPU_VALUE, &tol, sizeof(tol),
+                    STARPU_VALUE, &abstol, sizeof(abstol),
+                    STARPU_R, bi_handle, STARPU_W, rank_handle,
+                    STARPU_W, starpu_data_get_child(U_handle[k], bi-w0),
+                    STARPU_W, starpu_data_get_child(V_handle[k], bi-w0),
+                    STARPU_RW, D_handle, STARPU_SCRATCH, work_handle,
+                    STARPU_SCRATCH, iwork_handle,
+                    0);
+            starpu_data_unregister_submit(bi_handle);
+            starpu_data_unregister_submit(rank_handle);
+            starpu_data_unregister_submit(D_handle);
+        }
+        // Gather previous window, while tasks of current window are executed
+        k = 1-k;
+        if(w0 > 0)
+        {
+            starpu_data_unpartition(U_handle[k], STARPU_MAIN_RAM);
+            starpu_data_unpartition(V_handle[k], STARPU_MAIN_RAM);
+            starpu_data_unregister(U_handle[k]);
+            starpu_data_unregister(V_handle[k]);
+        }
+    }
+    if(nblocks_far > 0)
     {
-        starpu_task_insert(&codelet, STARPU_VALUE, &F, sizeof(F),
-                STARPU_VALUE, &maxrank, sizeof(maxrank),
-                STARPU_VALUE, &oversample, sizeof(oversample),
-                STARPU_VALUE, &tol, sizeof(tol),
-                STARPU_R, bi_handle[bi], STARPU_W, rank_handle[bi],
-                STARPU_W, U_handle[bi], STARPU_W, V_handle[bi],
-                STARPU_SCRATCH, work_handle[bi],
-                STARPU_SCRATCH, iwork_handle[bi],
-                0);
-        starpu_data_unregister_submit(bi_handle[bi]);
-        starpu_data_unregister_submit(rank_handle[bi]);
-        starpu_data_unregister_submit(U_handle[bi]);
-        starpu_data_unregister_submit(V_handle[bi]);
-        starpu_data_unregister_submit(work_handle[bi]);
-        starpu_data_unregister_submit(iwork_handle[bi]);
+        k = 1-k;
+        starpu_data_unpartition(U_handle[k], STARPU_MAIN_RAM);
+        starpu_data_unpartition(V_handle[k], STARPU_MAIN_RAM);
+        starpu_data_unregister(U_handle[k]);
+        starpu_data_unregister(V_handle[k]);
+        starpu_data_unregister_submit(work_handle);
+        starpu_data_unregister_submit(iwork_handle);
     }
     starpu_task_wait_for_all();
+    free(bi_value);
     // Get number of false far-field blocks
     STARSH_int nblocks_false_far = 0;
     STARSH_int *false_far = NULL;
@@ -220,10 +309,10 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
     // Compute near-field blocks if needed
     if(onfly == 0 && new_nblocks_near > 0)
     {
-        STARSH_int nbi_value[new_nblocks_near];
-        starpu_data_handle_t D_handle[new_nblocks_near];
-        starpu_data_handle_t nbi_handle[new_nblocks_near];
+        STARSH_int *nbi_value;
+        starpu_data_handle_t D_handle[2];
         STARSH_MALLOC(near_D, new_nblocks_near);
+        STARSH_MALLOC(nbi_value, new_nblocks_near);
         size_t size_D = 0;
         // Simple cycle over all near-field blocks
         for(bi = 0; bi < new_nblocks_near; bi++)
@@ -251,23 +340,64 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
             double *D = alloc_D+offset_D;
             array_from_buffer(near_D+bi, 2, shape, 'd', 'F', D);
             offset_D += near_D[bi]->size;
-            nbi_value[bi] = bi;
-            starpu_variable_data_register(nbi_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(nbi_value+bi), sizeof(*nbi_value));
-            starpu_vector_data_register(D_handle+bi, STARPU_MAIN_RAM,
-                    (uintptr_t)(near_D[bi]->data), (size_t)nrows*(size_t)ncols,
-                    sizeof(*D));
         }
-        for(bi = 0; bi < new_nblocks_near; bi++)
+        k = 0;
+        // Cycle over windows of near-field blocks
+        for(w0 = 0; w0 < new_nblocks_near; w0 = w1)
         {
-            starpu_task_insert(&codelet2, STARPU_VALUE, &F, sizeof(F),
-                    STARPU_R, nbi_handle[bi], STARPU_W, D_handle[bi],
-                    0);
-            starpu_data_unregister_submit(nbi_handle[bi]);
-            starpu_data_unregister_submit(D_handle[bi]);
+            // Get window, that fits into a single vector
+            size_t slice_D = 0;
+            for(w1 = w0; w1 < new_nblocks_near && w1-w0 < window; w1++)
+            {
+                if(w1 > w0 && slice_D+near_D[w1]->size > UINT32_MAX)
+                    break;
+                slice_D += near_D[w1]->size;
+            }
+            struct starpu_data_filter D_filter =
+            {
+                .filter_func = starsh_dense_tile_filter_starpu,
+                .nchildren = w1-w0,
+                .filter_arg_ptr = near_D+w0
+            };
+            starpu_vector_data_register(D_handle+k, STARPU_MAIN_RAM,
+                    (uintptr_t)(near_D[w0]->data), slice_D,
+                    sizeof(*alloc_D));
+            starpu_data_partition(D_handle[k], &D_filter);
+            for(bi = w0; bi < w1; bi++)
+            {
+                starpu_data_handle_t nbi_handle;
+                nbi_value[bi] = bi;
+                // Diagonal tiles are on the critical path of factorizations
+                int prio = STARPU_DEFAULT_PRIO;
+                if(block_near[2*nbi_value[bi]] ==
+                        block_near[2*nbi_value[bi]+1])
+                    prio = STARPU_MAX_PRIO;
+                starpu_variable_data_register(&nbi_handle, STARPU_MAIN_RAM,
+                        (uintptr_t)(nbi_value+bi), sizeof(*nbi_value));
+                starpu_task_insert(&codelet2, STARPU_VALUE, &F, sizeof(F),
+                        STARPU_PRIORITY, prio,
+                        STARPU_R, nbi_handle,
+                        STARPU_W, starpu_data_get_child(D_handle[k], bi-w0),
+                        0);
+                starpu_data_unregister_submit(nbi_handle);
+            }
+            // Gather previous window, while tasks of current window are
+            // executed
+            k = 1-k;
+            if(w0 > 0)
+            {
+                starpu_data_unpartition(D_handle[k], STARPU_MAIN_RAM);
+                starpu_data_unregister(D_handle[k]);
+            }
+        }
+        if(new_nblocks_near > 0)
+        {
+            k = 1-k;
+            starpu_data_unpartition(D_handle[k], STARPU_MAIN_RAM);
+            starpu_data_unregister(D_handle[k]);
         }
-        // Wait in this scope, because all handles are not visible outside
         starpu_task_wait_for_all();
+        free(nbi_value);
     }
     // Change sizes of far_rank, far_U and far_V if there were false
     // far-field blocks
@@ -288,8 +418,6 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
         STARSH_REALLOC(far_rank, new_nblocks_far);
         STARSH_REALLOC(far_U, new_nblocks_far);
         STARSH_REALLOC(far_V, new_nblocks_far);
-        //STARSH_REALLOC(alloc_U, offset_U);
-        //STARSH_REALLOC(alloc_V, offset_V);
     }
     // If all far-field blocks are false, then dealloc buffers
     if(new_nblocks_far == 0 && nblocks_far > 0)
@@ -309,6 +437,15 @@ int starsh_blrm__dqp3_starpu(STARSH_blrm **matrix, STARSH_blrf *format,
     // Dealloc list of false far-field blocks if it is not empty
     if(nblocks_false_far > 0)
         free(false_far);
+    // Drop negligible far-field blocks, approximated with rank 0
+    info = starsh_blrf_drop_far(F, far_rank, far_U, far_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Store only actual ranks of low-rank factors
+    info = starsh_blrm_pack_far(F->nblocks_far, far_rank, far_U, far_V,
+            (void **)&alloc_U, (void **)&alloc_V);
+    if(info != STARSH_SUCCESS)
+        return info;
     // Finish with creating instance of Block Low-Rank Matrix with given
     // buffers
     return starsh_blrm_new(matrix, F, far_rank, far_U, far_V, onfly, near_D,
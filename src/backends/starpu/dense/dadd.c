@@ -0,0 +1,38 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/dense/dadd.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+//! History-based performance model of @ref starsh_dense_dadd_starpu.
+struct starpu_perfmodel starsh_dense_dadd_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dadd_starpu"
+};
+
+void starsh_dense_dadd_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for sum of two matrices.
+/*! Computes \f$ A = A + B \f$. Used to reduce contributions to a handle in
+ * `STARPU_REDUX` mode.
+ * */
+{
+    double *A = (double *)STARPU_MATRIX_GET_PTR(buffer[0]);
+    double *B = (double *)STARPU_MATRIX_GET_PTR(buffer[1]);
+    int nrows = STARPU_MATRIX_GET_NX(buffer[0]);
+    int ncols = STARPU_MATRIX_GET_NY(buffer[0]);
+    int lda = STARPU_MATRIX_GET_LD(buffer[0]);
+    int ldb = STARPU_MATRIX_GET_LD(buffer[1]);
+    for(int j = 0; j < ncols; j++)
+        cblas_daxpy(nrows, 1.0, B+j*(size_t)ldb, 1, A+j*(size_t)lda, 1);
+}
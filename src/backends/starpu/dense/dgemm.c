@@ -14,6 +14,13 @@
 #include "starsh.h"
 #include "starsh-starpu.h"
 
+//! History-based performance model of @ref starsh_dense_dgemm_starpu.
+struct starpu_perfmodel starsh_dense_dgemm_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dgemm_starpu"
+};
+
 void starsh_dense_dgemm_starpu(void *buffer[], void *cl_arg)
 //! STARPU kernel for matrix kernel.
 {
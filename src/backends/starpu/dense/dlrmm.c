@@ -0,0 +1,48 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/dense/dlrmm.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+//! History-based performance model of @ref starsh_dense_dlrmm_starpu.
+struct starpu_perfmodel starsh_dense_dlrmm_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dlrmm_starpu"
+};
+
+void starsh_dense_dlrmm_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for multiplication of low-rank tile by dense matrix.
+/*! Computes \f$ B = B + \alpha U V^T A \f$, where `U` and `V` are vectors of
+ * low-rank factors and `A` and `B` are matrices. The last buffer is a scratch
+ * vector of at least `rank` by `nrhs` elements.
+ * */
+{
+    double alpha;
+    starpu_codelet_unpack_args(cl_arg, &alpha);
+    double *U = (double *)STARPU_VECTOR_GET_PTR(buffer[0]);
+    double *V = (double *)STARPU_VECTOR_GET_PTR(buffer[1]);
+    double *A = (double *)STARPU_MATRIX_GET_PTR(buffer[2]);
+    double *B = (double *)STARPU_MATRIX_GET_PTR(buffer[3]);
+    double *work = (double *)STARPU_VECTOR_GET_PTR(buffer[4]);
+    int nrows = STARPU_MATRIX_GET_NX(buffer[3]);
+    int ncols = STARPU_MATRIX_GET_NX(buffer[2]);
+    int nrhs = STARPU_MATRIX_GET_NY(buffer[2]);
+    int lda = STARPU_MATRIX_GET_LD(buffer[2]);
+    int ldb = STARPU_MATRIX_GET_LD(buffer[3]);
+    int rank = STARPU_VECTOR_GET_NX(buffer[0])/nrows;
+    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, rank, nrhs, ncols,
+            1.0, V, ncols, A, lda, 0.0, work, rank);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows, nrhs, rank,
+            alpha, U, nrows, work, rank, 1.0, B, ldb);
+}
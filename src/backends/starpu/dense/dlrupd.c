@@ -0,0 +1,128 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/dense/dlrupd.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+//! History-based performance model of @ref starsh_dense_dpotrf_starpu.
+struct starpu_perfmodel starsh_dense_dpotrf_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dpotrf_starpu"
+};
+
+//! History-based performance model of @ref starsh_dense_dlrtrsm_starpu.
+struct starpu_perfmodel starsh_dense_dlrtrsm_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dlrtrsm_starpu"
+};
+
+//! History-based performance model of @ref starsh_dense_dlrsyrk_starpu.
+struct starpu_perfmodel starsh_dense_dlrsyrk_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dlrsyrk_starpu"
+};
+
+//! History-based performance model of @ref starsh_dense_dlrgemm_starpu.
+struct starpu_perfmodel starsh_dense_dlrgemm_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dlrgemm_starpu"
+};
+
+void starsh_dense_dpotrf_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for Cholesky factorization of a diagonal tile.
+/*! Upper triangle of the tile is set to zero. If the tile is not positive
+ * definite, `*info` is set to @ref STARSH_NOT_POSITIVE_DEFINITE and all the
+ * following tasks of factorization do nothing.
+ * */
+{
+    int n, *info;
+    starpu_codelet_unpack_args(cl_arg, &n, &info);
+    double *D = (double *)STARPU_VECTOR_GET_PTR(buffer[0]);
+    if(*info != 0)
+        return;
+    if(LAPACKE_dpotrf_work(LAPACK_COL_MAJOR, 'L', n, D, n) != 0)
+    {
+        STARSH_ERROR("Diagonal tile is not positive definite");
+        *info = STARSH_NOT_POSITIVE_DEFINITE;
+        return;
+    }
+    if(n > 1)
+        LAPACKE_dlaset_work(LAPACK_COL_MAJOR, 'U', n-1, n-1, 0.0, 0.0, D+n,
+                n);
+}
+
+void starsh_dense_dlrtrsm_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for triangular solve for a low-rank tile.
+/*! Factor `V` of a low-rank tile is multiplied by inverse of lower
+ * triangular diagonal tile. Rank is passed as a pointer, since it is updated
+ * by preceding tasks, that write into the same factor `V`.
+ * */
+{
+    int n, *rank, *info;
+    starpu_codelet_unpack_args(cl_arg, &n, &rank, &info);
+    double *D = (double *)STARPU_VECTOR_GET_PTR(buffer[0]);
+    double *V = (double *)STARPU_VECTOR_GET_PTR(buffer[1]);
+    if(*info != 0 || *rank == 0)
+        return;
+    cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans,
+            CblasNonUnit, n, *rank, 1.0, D, n, V, n);
+}
+
+void starsh_dense_dlrsyrk_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for update of a diagonal tile by a low-rank tile.
+{
+    int nrows, ncols, *rank, *info;
+    starpu_codelet_unpack_args(cl_arg, &nrows, &ncols, &rank, &info);
+    double *U = (double *)STARPU_VECTOR_GET_PTR(buffer[0]);
+    double *V = (double *)STARPU_VECTOR_GET_PTR(buffer[1]);
+    double *D = (double *)STARPU_VECTOR_GET_PTR(buffer[2]);
+    double *work = (double *)STARPU_VECTOR_GET_PTR(buffer[3]);
+    if(*info != 0)
+        return;
+    starsh_dense_dlrsyrk(nrows, ncols, *rank, U, nrows, V, ncols, D, nrows,
+            work);
+}
+
+void starsh_dense_dlrgemm_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for update of a low-rank tile by two low-rank tiles.
+/*! Integer workspace of starsh_dense_dlrgemm() is located in the tail of
+ * scratch buffer, so that the number of buffers of the task does not exceed
+ * default value of `STARPU_NMAXBUFS`. Element of `limited` is set, if rank
+ * of updated tile was truncated.
+ * */
+{
+    int nrows, ncols, nk, *rank1, *rank2, *rank, maxrank, liwork, *info;
+    double tol;
+    char *limited;
+    starpu_codelet_unpack_args(cl_arg, &nrows, &ncols, &nk, &rank1, &rank2,
+            &rank, &maxrank, &tol, &liwork, &info, &limited);
+    double *U1 = (double *)STARPU_VECTOR_GET_PTR(buffer[0]);
+    double *V1 = (double *)STARPU_VECTOR_GET_PTR(buffer[1]);
+    double *U2 = (double *)STARPU_VECTOR_GET_PTR(buffer[2]);
+    double *V2 = (double *)STARPU_VECTOR_GET_PTR(buffer[3]);
+    double *U = (double *)STARPU_VECTOR_GET_PTR(buffer[4]);
+    double *V = (double *)STARPU_VECTOR_GET_PTR(buffer[5]);
+    double *work = (double *)STARPU_VECTOR_GET_PTR(buffer[6]);
+    int lwork = STARPU_VECTOR_GET_NX(buffer[6])-liwork;
+    int *iwork = (int *)(work+lwork);
+    if(*info != 0)
+        return;
+    if(starsh_dense_dlrgemm(nrows, ncols, nk, *rank1, U1, nrows, V1, nk,
+                *rank2, U2, ncols, V2, nk, U, nrows, V, ncols, rank, maxrank,
+                tol, work, lwork, iwork) != 0)
+        *limited = 1;
+}
@@ -0,0 +1,45 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/dense/dmm.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+//! History-based performance model of @ref starsh_dense_dmm_starpu.
+struct starpu_perfmodel starsh_dense_dmm_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dmm_starpu"
+};
+
+void starsh_dense_dmm_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for multiplication of dense tile by dense matrix.
+/*! Computes \f$ B = B + \alpha D A \f$ or \f$ B = B + \alpha D^T A \f$,
+ * depending on value of `trans`, where `D` is a vector with elements of a
+ * tile and `A` and `B` are matrices.
+ * */
+{
+    int trans;
+    double alpha;
+    starpu_codelet_unpack_args(cl_arg, &trans, &alpha);
+    double *D = (double *)STARPU_VECTOR_GET_PTR(buffer[0]);
+    double *A = (double *)STARPU_MATRIX_GET_PTR(buffer[1]);
+    double *B = (double *)STARPU_MATRIX_GET_PTR(buffer[2]);
+    int nrows = STARPU_MATRIX_GET_NX(buffer[2]);
+    int ncols = STARPU_MATRIX_GET_NX(buffer[1]);
+    int nrhs = STARPU_MATRIX_GET_NY(buffer[1]);
+    int lda = STARPU_MATRIX_GET_LD(buffer[1]);
+    int ldb = STARPU_MATRIX_GET_LD(buffer[2]);
+    int ldd = trans == CblasNoTrans ? nrows : ncols;
+    cblas_dgemm(CblasColMajor, trans, CblasNoTrans, nrows, nrhs, ncols, alpha,
+            D, ldd, A, lda, 1.0, B, ldb);
+}
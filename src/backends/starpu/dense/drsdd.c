@@ -14,19 +14,28 @@
 #include "starsh.h"
 #include "starsh-starpu.h"
 
+//! History-based performance model of @ref starsh_dense_dlrrsdd_starpu.
+struct starpu_perfmodel starsh_dense_dlrrsdd_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dlrrsdd_starpu"
+};
+
 void starsh_dense_dlrrsdd_starpu(void *buffer[], void *cl_arg)
 //! STARPU kernel for 1-way randomized SVD on a tile.
+/*! Elements of the tile are computed by a preceding task of
+ * @ref starsh_dense_kernel_far_starpu and they are overwritten.
+ * */
 {
     STARSH_blrf *F;
     int maxrank;
     int oversample;
-    double tol;
-    starpu_codelet_unpack_args(cl_arg, &F, &maxrank, &oversample, &tol);
-    STARSH_problem *P = F->problem;
-    STARSH_kernel *kernel = P->kernel;
+    int poweriter;
+    double tol, abstol;
+    starpu_codelet_unpack_args(cl_arg, &F, &maxrank, &oversample, &poweriter,
+            &tol, &abstol);
     // Shortcuts to information about clusters
     STARSH_cluster *RC = F->row_cluster, *CC = F->col_cluster;
-    void *RD = RC->data, *CD = CC->data;
     STARSH_int bi = *(STARSH_int *)STARPU_VARIABLE_GET_PTR(buffer[0]);
     int *rank = (int *)STARPU_VARIABLE_GET_PTR(buffer[1]);
     double *U = (double *)STARPU_VECTOR_GET_PTR(buffer[2]);
@@ -36,11 +45,21 @@ void starsh_dense_dlrrsdd_starpu(void *buffer[], void *cl_arg)
     STARSH_int nrows = RC->size[i];
     STARSH_int ncols = CC->size[j];
     double *D = (double *)STARPU_VECTOR_GET_PTR(buffer[4]);
-    double *work = D+nrows*ncols;
-    int lwork = STARPU_VECTOR_GET_NX(buffer[4])-nrows*ncols;
-    int *iwork = (int *)STARPU_VECTOR_GET_PTR(buffer[5]);
-    kernel(nrows, ncols, RC->pivot+RC->start[i], CC->pivot+CC->start[j],
-            RD, CD, D, nrows);
-    starsh_dense_dlrrsdd(nrows, ncols, D, nrows, U, nrows, V, ncols, rank,
-            maxrank, oversample, tol, work, lwork, iwork);
+    double *work = (double *)STARPU_VECTOR_GET_PTR(buffer[5]);
+    int lwork = STARPU_VECTOR_GET_NX(buffer[5]);
+    int *iwork = (int *)STARPU_VECTOR_GET_PTR(buffer[6]);
+    // Blocks with small norm are negligible and they get rank 0
+    double tile_norm = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows,
+            ncols, D, nrows, NULL);
+    if(tile_norm <= abstol)
+        *rank = 0;
+    else
+    {
+        // Relative tolerance of a block, if tolerance is global
+        double tile_tol = tol;
+        if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+            tile_tol = abstol/tile_norm;
+        starsh_dense_dlrrsdd(nrows, ncols, D, nrows, U, nrows, V, ncols, rank,
+                maxrank, oversample, poweriter, tile_tol, work, lwork, iwork);
+    }
 }
@@ -0,0 +1,36 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/dense/dzero.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+//! History-based performance model of @ref starsh_dense_dzero_starpu.
+struct starpu_perfmodel starsh_dense_dzero_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_dzero_starpu"
+};
+
+void starsh_dense_dzero_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for setting all elements of a matrix to zero.
+/*! Used to initialize contributions to a handle in `STARPU_REDUX` mode.
+ * */
+{
+    double *A = (double *)STARPU_MATRIX_GET_PTR(buffer[0]);
+    size_t nrows = STARPU_MATRIX_GET_NX(buffer[0]);
+    size_t ncols = STARPU_MATRIX_GET_NY(buffer[0]);
+    size_t lda = STARPU_MATRIX_GET_LD(buffer[0]);
+    for(size_t j = 0; j < ncols; j++)
+        for(size_t i = 0; i < nrows; i++)
+            A[j*lda+i] = 0.;
+}
@@ -1,21 +0,0 @@
-/*! @copyright (c) 2017 King Abdullah University of Science and
- *                      Technology (KAUST). All rights reserved.
- *
- * STARS-H is a software package, provided by King Abdullah
- *             University of Science and Technology (KAUST)
- *
- * @file src/backends/starpu/dense/fake_init.c
- * @version 1.3.0
- * @author Aleksandr Mikhalev
- * @date 2017-11-07
- * */
-
-#include "common.h"
-#include "starsh.h"
-#include "starsh-starpu.h"
-
-void starsh_dense_fake_init_starpu(void *buffer[], void *cl_arg)
-//! STARPU kernel for matrix kernel.
-{
-}
-
@@ -0,0 +1,77 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/backends/starpu/dense/filter.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-starpu.h"
+
+void starsh_dense_filter_starpu(void *father_interface, void *child_interface,
+        struct starpu_data_filter *f, unsigned id, unsigned nchunks)
+//! STARPU filter, that splits rows of a matrix by clusters.
+/*! Field `filter_arg_ptr` of filter `f` must point to @ref STARSH_cluster
+ * object, and `nchildren` must be equal to number of its subclusters. Rows of
+ * `id`-th child are rows of the matrix from `start[id]` to
+ * `start[id]+size[id]-1`, so that children do not overlap.
+ * */
+{
+    struct starpu_matrix_interface *father = father_interface;
+    struct starpu_matrix_interface *child = child_interface;
+    STARSH_cluster *C = f->filter_arg_ptr;
+    size_t elemsize = father->elemsize;
+    size_t offset = C->start[id]*elemsize;
+    child->id = father->id;
+    child->nx = C->size[id];
+    child->ny = father->ny;
+    child->elemsize = elemsize;
+#ifdef STARPU_MATRIX_GET_ALLOCSIZE
+    child->allocsize = child->nx*child->ny*elemsize;
+#endif
+    // Pointers are set only if father is allocated on a memory node
+    if(father->dev_handle)
+    {
+        if(father->ptr)
+            child->ptr = father->ptr+offset;
+        child->ld = father->ld;
+        child->dev_handle = father->dev_handle;
+        child->offset = father->offset+offset;
+    }
+}
+
+void starsh_dense_tile_filter_starpu(void *father_interface,
+        void *child_interface, struct starpu_data_filter *f, unsigned id,
+        unsigned nchunks)
+//! STARPU filter, that splits a vector into consecutive tiles.
+/*! Field `filter_arg_ptr` of filter `f` must point to a list of `nchildren`
+ * arrays, that are stored one after another in a buffer of the father vector,
+ * starting from its beginning. `id`-th child is the buffer of `id`-th array.
+ * */
+{
+    struct starpu_vector_interface *father = father_interface;
+    struct starpu_vector_interface *child = child_interface;
+    Array **tile = f->filter_arg_ptr;
+    size_t elemsize = father->elemsize;
+    size_t offset = ((char *)tile[id]->data-(char *)tile[0]->data);
+    child->id = father->id;
+    child->nx = tile[id]->size;
+    child->elemsize = elemsize;
+#ifdef STARPU_VECTOR_GET_ALLOCSIZE
+    child->allocsize = child->nx*elemsize;
+#endif
+    // Pointers are set only if father is allocated on a memory node
+    if(father->dev_handle)
+    {
+        if(father->ptr)
+            child->ptr = father->ptr+offset;
+        child->dev_handle = father->dev_handle;
+        child->offset = father->offset+offset;
+    }
+}
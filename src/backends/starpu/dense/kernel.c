@@ -14,6 +14,13 @@
 #include "starsh.h"
 #include "starsh-starpu.h"
 
+//! History-based performance model of @ref starsh_dense_kernel_starpu.
+struct starpu_perfmodel starsh_dense_kernel_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_kernel_starpu"
+};
+
 void starsh_dense_kernel_starpu(void *buffer[], void *cl_arg)
 //! STARPU kernel for matrix kernel.
 {
@@ -34,3 +41,33 @@ void starsh_dense_kernel_starpu(void *buffer[], void *cl_arg)
             RD, CD, D, nrows);
 }
 
+
+//! History-based performance model of @ref starsh_dense_kernel_far_starpu.
+struct starpu_perfmodel starsh_dense_kernel_far_starpu_model =
+{
+    .type = STARPU_HISTORY_BASED,
+    .symbol = "starsh_dense_kernel_far_starpu"
+};
+
+void starsh_dense_kernel_far_starpu(void *buffer[], void *cl_arg)
+//! STARPU kernel for matrix kernel on a far-field tile.
+/*! Computes elements of a far-field tile, so that a separate task compresses
+ * them.
+ * */
+{
+    STARSH_blrf *F;
+    starpu_codelet_unpack_args(cl_arg, &F);
+    STARSH_problem *P = F->problem;
+    STARSH_kernel *kernel = P->kernel;
+    // Shortcuts to information about clusters
+    STARSH_cluster *RC = F->row_cluster, *CC = F->col_cluster;
+    void *RD = RC->data, *CD = CC->data;
+    STARSH_int bi = *(STARSH_int *)STARPU_VARIABLE_GET_PTR(buffer[0]);
+    STARSH_int i = F->block_far[2*bi];
+    STARSH_int j = F->block_far[2*bi+1];
+    STARSH_int nrows = RC->size[i];
+    STARSH_int ncols = CC->size[j];
+    double *D = (double *)STARPU_VECTOR_GET_PTR(buffer[1]);
+    kernel(nrows, ncols, RC->pivot+RC->start[i], CC->pivot+CC->start[j],
+            RD, CD, D, nrows);
+}
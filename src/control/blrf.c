@@ -84,6 +84,8 @@ int starsh_blrf_new(STARSH_blrf **format, STARSH_problem *problem, char symm,
     F->bcol_near = bcol_near;
     F->nblocks_near_local = nblocks_near_local;
     F->block_near_local = block_near_local;
+    F->grid_nrows = 1;
+    F->grid_ncols = 1;
     return STARSH_SUCCESS;
 }
 
@@ -285,6 +287,8 @@ int starsh_blrf_new_from_coo(STARSH_blrf **format, STARSH_problem *problem,
         F->bcol_near = F->brow_near;
     }
     F->type = type;
+    F->grid_nrows = 1;
+    F->grid_ncols = 1;
     return STARSH_SUCCESS;
 }
 
@@ -525,7 +529,329 @@ int starsh_blrf_get_block(STARSH_blrf *format, STARSH_int i, STARSH_int j,
     return info;
 }
 
+int starsh_blrf_drop_far(STARSH_blrf *format, int *far_rank, Array **far_U,
+        Array **far_V)
+//! Remove far-field blocks of zero rank from format.
+/*! Far-field blocks, approximated with rank 0, are numerical zeros. They are
+ * removed from list of far-field blocks and they are not added to list of
+ * near-field blocks, so all routines, working with a matrix in this format,
+ * simply skip them. Arrays `far_rank`, `far_U` and `far_V` are updated
+ * inplace to correspond to a new list of far-field blocks, while their
+ * sizes remain unchanged. If there are no such blocks, nothing is done.
+ *
+ * @param[in,out] format: Pointer to @ref STARSH_blrf object.
+ * @param[in,out] far_rank: Ranks of far-field blocks.
+ * @param[in,out] far_U: Low-rank factors `U` of far-field blocks.
+ * @param[in,out] far_V: Low-rank factors `V` of far-field blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_int nblocks_far = F->nblocks_far;
+    STARSH_int nblocks_near = F->nblocks_near;
+    STARSH_int new_nblocks_far = 0, bi, bj = 0;
+    STARSH_int *block_far = NULL, *block_near = NULL;
+    int info;
+    for(bi = 0; bi < nblocks_far; bi++)
+        if(far_rank[bi] > 0)
+            new_nblocks_far++;
+    if(new_nblocks_far == nblocks_far)
+        return STARSH_SUCCESS;
+    // Get new list of far-field blocks and update low-rank factors
+    if(new_nblocks_far > 0)
+        STARSH_MALLOC(block_far, 2*new_nblocks_far);
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        if(far_rank[bi] > 0)
+        {
+            block_far[2*bj] = F->block_far[2*bi];
+            block_far[2*bj+1] = F->block_far[2*bi+1];
+            far_rank[bj] = far_rank[bi];
+            far_U[bj] = far_U[bi];
+            far_V[bj] = far_V[bi];
+            bj++;
+        }
+        else
+        {
+            // Data of low-rank factors is not owned by arrays
+            far_U[bi]->data = NULL;
+            far_V[bi]->data = NULL;
+            array_free(far_U[bi]);
+            array_free(far_V[bi]);
+        }
+    }
+    // List of near-field blocks is the same
+    if(nblocks_near > 0)
+    {
+        STARSH_MALLOC(block_near, 2*nblocks_near);
+        for(bi = 0; bi < 2*nblocks_near; bi++)
+            block_near[bi] = F->block_near[bi];
+    }
+    // Update format by creating new format
+    STARSH_blrf *F2;
+    info = starsh_blrf_new_from_coo(&F2, F->problem, F->symm, F->row_cluster,
+            F->col_cluster, new_nblocks_far, block_far, nblocks_near,
+            block_near, F->type);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Swap internal data of formats and free unnecessary data
+    STARSH_blrf tmp_blrf = *F;
+    *F = *F2;
+    *F2 = tmp_blrf;
+    STARSH_WARNING("`F` was modified due to negligible far-field blocks");
+    starsh_blrf_free(F2);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrf_get_dropped(STARSH_blrf *format, STARSH_int *nblocks,
+        STARSH_int **block)
+//! Get list of blocks, removed by @ref starsh_blrf_drop_far().
+/*! Tile low-rank format covers every block by either far-field or
+ * near-field list. Blocks, that are absent in both lists, were dropped as
+ * numerical zeros and they are returned in the same coordinate form as
+ * `format->block_far`. For symmetric formats only lower triangle is
+ * checked. If there are no dropped blocks, `*nblocks` is set to 0 and
+ * `*block` to NULL. User have to free memory after usage.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[out] nblocks: Number of dropped blocks.
+ * @param[out] block: Coordinates of dropped blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_int nbrows = F->nbrows, nbcols = F->nbcols;
+    STARSH_int bi, bj, ndropped = 0;
+    char *covered;
+    *nblocks = 0;
+    *block = NULL;
+    STARSH_MALLOC(covered, (size_t)nbrows*(size_t)nbcols);
+    for(bi = 0; bi < nbrows*nbcols; bi++)
+        covered[bi] = 0;
+    for(bi = 0; bi < F->nblocks_far; bi++)
+        covered[F->block_far[2*bi]*nbcols+F->block_far[2*bi+1]] = 1;
+    for(bi = 0; bi < F->nblocks_near; bi++)
+        covered[F->block_near[2*bi]*nbcols+F->block_near[2*bi+1]] = 1;
+    for(bi = 0; bi < nbrows; bi++)
+    {
+        STARSH_int bj_end = F->symm == 'S' ? bi+1 : nbcols;
+        for(bj = 0; bj < bj_end; bj++)
+            if(covered[bi*nbcols+bj] == 0)
+                ndropped++;
+    }
+    if(ndropped == 0)
+    {
+        free(covered);
+        return STARSH_SUCCESS;
+    }
+    STARSH_int *list = malloc(2*ndropped*sizeof(*list));
+    if(list == NULL)
+    {
+        free(covered);
+        STARSH_ERROR("malloc failed");
+        return STARSH_MALLOC_ERROR;
+    }
+    ndropped = 0;
+    for(bi = 0; bi < nbrows; bi++)
+    {
+        STARSH_int bj_end = F->symm == 'S' ? bi+1 : nbcols;
+        for(bj = 0; bj < bj_end; bj++)
+            if(covered[bi*nbcols+bj] == 0)
+            {
+                list[2*ndropped] = bi;
+                list[2*ndropped+1] = bj;
+                ndropped++;
+            }
+    }
+    free(covered);
+    *nblocks = ndropped;
+    *block = list;
+    return STARSH_SUCCESS;
+}
+
 #ifdef MPI
+static int blrf_grid_mpi(int *grid_nrows, int *grid_ncols)
+//! Get shape of grid of MPI processes.
+/*! Shape is set by @ref starsh_set_mpi_grid(). Automatic choice is the most
+ * square grid, that has no more rows than columns.
+ * */
+{
+    int mpi_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    if(starsh_params.grid_nrows <= 0)
+    {
+        *grid_nrows = sqrt(mpi_size);
+        while(mpi_size % *grid_nrows != 0)
+            (*grid_nrows)--;
+        *grid_ncols = mpi_size / *grid_nrows;
+        return STARSH_SUCCESS;
+    }
+    *grid_nrows = starsh_params.grid_nrows;
+    *grid_ncols = starsh_params.grid_ncols;
+    if((*grid_nrows)*(*grid_ncols) != mpi_size)
+    {
+        STARSH_ERROR("Grid of MPI processes %dx%d does not match number of "
+                "MPI processes %d", *grid_nrows, *grid_ncols, mpi_size);
+        return STARSH_WRONG_PARAMETER;
+    }
+    return STARSH_SUCCESS;
+}
+
+//! Size of sample of rows and columns to estimate cost of a tile.
+#define BLRF_PROBE_SIZE 32
+//! Relative threshold of singular values of sample of a tile.
+#define BLRF_PROBE_TOL 1e-8
+
+static void blrf_cost_mpi(STARSH_problem *problem, STARSH_cluster *row_cluster,
+        STARSH_cluster *col_cluster, STARSH_int ntiles, STARSH_int *block,
+        double *cost)
+//! Estimate cost of approximation of tiles on MPI nodes.
+/*! Numerical rank `r` of a submatrix of evenly spaced rows and columns of an
+ * `m` by `n` tile is computed by SVD and cost of the tile is estimated as
+ * `m*n*(r+1)`, so that tiles, that are likely to be dense, are a few times
+ * more expensive. Each MPI node probes every `mpi_size`-th tile and
+ * estimations are summed up on all nodes.
+ * */
+{
+    STARSH_kernel *kernel = problem->kernel;
+    STARSH_cluster *R = row_cluster, *C = col_cluster;
+    STARSH_int bi;
+    int mpi_size, mpi_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    for(bi = 0; bi < ntiles; bi++)
+        cost[bi] = 0.;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(bi = mpi_rank; bi < ntiles; bi += mpi_size)
+    {
+        STARSH_int i = block[2*bi], j = block[2*bi+1];
+        STARSH_int irow[BLRF_PROBE_SIZE], icol[BLRF_PROBE_SIZE];
+        double D[BLRF_PROBE_SIZE*BLRF_PROBE_SIZE], sv[BLRF_PROBE_SIZE];
+        double work[10*BLRF_PROBE_SIZE];
+        int iwork[8*BLRF_PROBE_SIZE];
+        int nrows = R->size[i], ncols = C->size[j], k, rank = 0;
+        int p = BLRF_PROBE_SIZE;
+        if(p > nrows)
+            p = nrows;
+        if(p > ncols)
+            p = ncols;
+        for(k = 0; k < p; k++)
+        {
+            irow[k] = R->pivot[R->start[i]+k*(size_t)nrows/p];
+            icol[k] = C->pivot[C->start[j]+k*(size_t)ncols/p];
+        }
+        kernel(p, p, irow, icol, R->data, C->data, D, p);
+        LAPACKE_dgesdd_work(LAPACK_COL_MAJOR, 'N', p, p, D, p, sv, NULL, 1,
+                NULL, 1, work, 10*BLRF_PROBE_SIZE, iwork);
+        for(k = 0; k < p; k++)
+            if(sv[k] > BLRF_PROBE_TOL*sv[0])
+                rank++;
+        cost[bi] = nrows*(double)ncols*(rank+1);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, cost, ntiles, MPI_DOUBLE, MPI_SUM,
+            MPI_COMM_WORLD);
+}
+
+static STARSH_int blrf_hilbert_index(STARSH_int n, STARSH_int x,
+        STARSH_int y)
+//! Position of a cell on Hilbert curve, filling `n` by `n` square.
+/*! Size `n` must be a power of 2.
+ * */
+{
+    STARSH_int s, rx, ry, d = 0, tmp;
+    for(s = n/2; s > 0; s /= 2)
+    {
+        rx = (x & s) > 0;
+        ry = (y & s) > 0;
+        d += s*s*((3*rx)^ry);
+        // Rotate quadrant, so that curve in it starts and ends properly
+        if(ry == 0)
+        {
+            if(rx == 1)
+            {
+                x = n-1-x;
+                y = n-1-y;
+            }
+            tmp = x;
+            x = y;
+            y = tmp;
+        }
+    }
+    return d;
+}
+
+//! Tile with its position on Hilbert curve.
+struct blrf_hilbert_tile
+{
+    STARSH_int index, key;
+};
+
+static int blrf_hilbert_cmp(const void *a, const void *b)
+//! Compare tiles by their position on Hilbert curve.
+{
+    STARSH_int ka = ((const struct blrf_hilbert_tile *)a)->key;
+    STARSH_int kb = ((const struct blrf_hilbert_tile *)b)->key;
+    if(ka < kb)
+        return -1;
+    return ka > kb;
+}
+
+int starsh_blrf_partition_mpi(STARSH_int ntiles, STARSH_int *block,
+        double *cost, int *owner)
+//! Distribute tiles among MPI nodes by their cost.
+/*! Tiles are ordered along Hilbert curve over block rows and block columns
+ * and the curve is cut into as many contiguous pieces of approximately equal
+ * total cost, as there are MPI nodes. Close tiles share block rows and block
+ * columns, so each MPI node needs only a few blocks of a dense matrix to
+ * multiply its tiles. Result depends only on input, so all MPI nodes get the
+ * same distribution without any communication.
+ *
+ * @param[in] ntiles: Number of tiles.
+ * @param[in] block: Coordinates of tiles. `block[2*i]` is an index of block
+ *      row and `block[2*i+1]` is an index of block column of `i`-th tile.
+ * @param[in] cost: Nonnegative cost of each tile.
+ * @param[out] owner: MPI rank of each tile.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrf_new_tlr_mpi(), starsh_blrm_rebalance_mpi().
+ * @ingroup blrf
+ * */
+{
+    struct blrf_hilbert_tile *tile;
+    STARSH_int bi, n = 1;
+    double total = 0., prefix = 0.;
+    int mpi_size;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    for(bi = 0; bi < 2*ntiles; bi++)
+        while(block[bi] >= n)
+            n *= 2;
+    STARSH_MALLOC(tile, ntiles+1);
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        tile[bi].index = bi;
+        tile[bi].key = blrf_hilbert_index(n, block[2*bi], block[2*bi+1]);
+        total += cost[bi];
+    }
+    qsort(tile, ntiles, sizeof(*tile), blrf_hilbert_cmp);
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        double c = cost[tile[bi].index];
+        // Tile belongs to the piece, that contains its middle
+        int r;
+        if(total > 0.)
+            r = (prefix+0.5*c)/total*mpi_size;
+        else
+            r = bi*(double)mpi_size/ntiles;
+        if(r >= mpi_size)
+            r = mpi_size-1;
+        owner[tile[bi].index] = r;
+        prefix += c;
+    }
+    free(tile);
+    return STARSH_SUCCESS;
+}
+
 int starsh_blrf_new_from_coo_mpi(STARSH_blrf **format, STARSH_problem *problem,
         char symm, STARSH_cluster *row_cluster, STARSH_cluster *col_cluster,
         STARSH_int nblocks_far, STARSH_int *block_far,
@@ -563,10 +889,17 @@ int starsh_blrf_new_from_coo_mpi(STARSH_blrf **format, STARSH_problem *problem,
  * @ingroup blrf
  * */
 {
-    int info;
+    int info, grid_nrows, grid_ncols;
+    info = blrf_grid_mpi(&grid_nrows, &grid_ncols);
+    if(info != STARSH_SUCCESS)
+        return info;
     info = starsh_blrf_new_from_coo(format, problem, symm, row_cluster,
             col_cluster, nblocks_far, block_far, nblocks_near, block_near,
             type);
+    if(info != STARSH_SUCCESS)
+        return info;
+    (*format)->grid_nrows = grid_nrows;
+    (*format)->grid_ncols = grid_ncols;
     (*format)->nblocks_far_local = nblocks_far_local;
     (*format)->block_far_local = block_far_local;
     (*format)->nblocks_near_local = nblocks_near_local;
@@ -576,10 +909,14 @@ int starsh_blrf_new_from_coo_mpi(STARSH_blrf **format, STARSH_problem *problem,
 
 int starsh_blrf_new_tlr_mpi(STARSH_blrf **format, STARSH_problem *problem,
         char symm, STARSH_cluster *row_cluster, STARSH_cluster *col_cluster)
-//! TLR partitioning on MPI nodes with 2D block cycling distribution.
+//! TLR partitioning on MPI nodes.
 /*! Uses non-hierarchical clusterization of rows and columns to generate plain
  * division of problem into admissible far-field and near-field blocks, placed
- * over MPI nodes by 2D block cycling distribution.
+ * over MPI nodes by 2D block cycling distribution. Grid of MPI processes can
+ * be of any shape, set by @ref starsh_set_mpi_grid(). If distribution of
+ * tiles, set by @ref starsh_set_mpi_dist(), is `COST` or `REBALANCE`, cost of
+ * each tile is estimated by numerical rank of a small sample of its rows and
+ * columns and tiles are placed by @ref starsh_blrf_partition_mpi() instead.
  *
  * @param[out] format: Address of pointer to @ref STARSH_blrf object.
  * @param[in] problem: Pointer to @ref STARSH_problem object.
@@ -627,80 +964,461 @@ int starsh_blrf_new_tlr_mpi(STARSH_blrf **format, STARSH_problem *problem,
         return STARSH_WRONG_PARAMETER;
     }
     STARSH_int nbrows = row_cluster->nblocks, nbcols = col_cluster->nblocks;
-    STARSH_int i, j, *block_far;
-    STARSH_int k = 0, nblocks_far, nblocks_far_local, li = 0;
+    STARSH_int i, j, bi, *block_far;
+    STARSH_int k = 0, nblocks_far, nblocks_far_local = 0, li = 0;
     STARSH_int *block_far_local;
-    int mpi_rank, mpi_size;
+    int mpi_rank, grid_nx, grid_ny, *owner;
+    int info = blrf_grid_mpi(&grid_nx, &grid_ny);
+    if(info != STARSH_SUCCESS)
+        return info;
     MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
-    int grid_nx = sqrt(mpi_size), grid_ny = grid_nx, grid_x, grid_y;
-    if(grid_nx*grid_ny != mpi_size)
-        STARSH_ERROR("MPI SIZE MUST BE SQUARE OF INTEGER!");
-    grid_ny = mpi_size / grid_nx;
-    grid_x = mpi_rank % grid_nx;
-    grid_y = mpi_rank / grid_nx;
-    //STARSH_WARNING("MPI GRID=%d x %d, MPI RANK=%d, MPI COORD=(%d, %d)", grid_nx, grid_ny, mpi_rank, grid_x, grid_y);
     if(symm == 'N')
-    {
         nblocks_far = nbrows*nbcols;
-        STARSH_MALLOC(block_far, 2*nblocks_far);
-        //nblocks_far_local = (nblocks_far+mpi_size-1-mpi_rank)/mpi_size;
-        nblocks_far_local = ((nbrows+grid_nx-1-grid_x)/grid_nx)*
-                ((nbcols+grid_ny-1-grid_y)/grid_ny);
-        STARSH_MALLOC(block_far_local, nblocks_far_local);
-        for(i = 0; i < nbrows; i++)
-            for(j = 0; j < nbcols; j++)
+    else
+        nblocks_far = nbrows*(nbrows+1)/2;
+    STARSH_MALLOC(block_far, 2*nblocks_far);
+    STARSH_MALLOC(owner, nblocks_far);
+    for(i = 0; i < nbrows; i++)
+    {
+        STARSH_int ncols = nbcols;
+        if(symm == 'S')
+            ncols = i+1;
+        for(j = 0; j < ncols; j++)
+        {
+            block_far[2*k] = i;
+            block_far[2*k+1] = j;
+            // MPI node of rank `r` is in row `r%grid_nx` and column
+            // `r/grid_nx` of grid
+            owner[k] = (j%grid_ny)*grid_nx+i%grid_nx;
+            k++;
+        }
+    }
+    if(starsh_params.mpi_dist == STARSH_MPI_DIST_COST ||
+            starsh_params.mpi_dist == STARSH_MPI_DIST_REBALANCE)
+    {
+        double *cost;
+        STARSH_MALLOC(cost, nblocks_far);
+        blrf_cost_mpi(problem, row_cluster, col_cluster, nblocks_far,
+                block_far, cost);
+        info = starsh_blrf_partition_mpi(nblocks_far, block_far, cost, owner);
+        free(cost);
+        if(info != STARSH_SUCCESS)
+            return info;
+    }
+    for(bi = 0; bi < nblocks_far; bi++)
+        if(owner[bi] == mpi_rank)
+            nblocks_far_local++;
+    STARSH_MALLOC(block_far_local, nblocks_far_local+1);
+    for(bi = 0; bi < nblocks_far; bi++)
+        if(owner[bi] == mpi_rank)
+            block_far_local[li++] = bi;
+    free(owner);
+    return starsh_blrf_new_from_coo_mpi(format, problem, symm, row_cluster,
+            col_cluster, nblocks_far, block_far, nblocks_far_local,
+            block_far_local, 0, NULL, 0, NULL, STARSH_TLR);
+}
+
+int starsh_blrf_update_far_mpi(STARSH_blrf *format, int *far_rank,
+        Array **far_U, Array **far_V)
+//! Update lists of tiles after approximation of far-field tiles on MPI node.
+/*! Arrays `far_rank`, `far_U` and `far_V` correspond to local far-field
+ * tiles. Local far-field tiles of rank `-1` (false far-field tiles) become
+ * near-field tiles and local far-field tiles of rank 0 are dropped. Each MPI
+ * node encodes indexes of its changed tiles into a single compact list, so
+ * only one MPI_Allgatherv() is needed to share changes among all nodes, and
+ * format is rebuilt only once. If no tile changed on any node, format stays
+ * untouched. New near-field tiles are appended to the list of near-field
+ * tiles in ascending order. `far_rank`, `far_U` and `far_V` are compacted in
+ * place, but not reallocated. Low-rank factors of removed tiles are freed,
+ * except their data, which is assumed to be a part of a bigger buffer. Must
+ * be called by all MPI nodes.
+ *
+ * @param[in,out] format: Pointer to @ref STARSH_blrf object.
+ * @param[in,out] far_rank: Ranks of local far-field blocks.
+ * @param[in,out] far_U: Low-rank factors `U` of local far-field blocks.
+ * @param[in,out] far_V: Low-rank factors `V` of local far-field blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    STARSH_blrf *F = format;
+    STARSH_int nblocks_far = F->nblocks_far;
+    STARSH_int nblocks_near = F->nblocks_near;
+    STARSH_int nblocks_far_local = F->nblocks_far_local;
+    STARSH_int nblocks_near_local = F->nblocks_near_local;
+    STARSH_int nchanged = 0, nchanged_local = 0;
+    STARSH_int nfalse = 0, nfalse_local = 0;
+    STARSH_int new_nblocks_far, new_nblocks_far_local;
+    STARSH_int new_nblocks_near, new_nblocks_near_local;
+    STARSH_int *changed = NULL, *changed_local = NULL;
+    STARSH_int *block_far = NULL, *block_far_local = NULL;
+    STARSH_int *block_near = NULL, *block_near_local = NULL;
+    STARSH_int bi, bj, bk, lbi, lbj, lbk;
+    int info, mpi_size, mpi_rank, *mpi_recvcount, *mpi_offset;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    // Get local list of changed tiles. Index of a tile is multiplied by 2
+    // and lowest bit tells if it is a false far-field tile. List is in
+    // ascending order, since local far-field tiles are.
+    for(lbi = 0; lbi < nblocks_far_local; lbi++)
+        if(far_rank[lbi] <= 0)
+            nchanged_local++;
+    if(nchanged_local > 0)
+        STARSH_MALLOC(changed_local, nchanged_local);
+    lbj = 0;
+    for(lbi = 0; lbi < nblocks_far_local; lbi++)
+    {
+        if(far_rank[lbi] == -1)
+        {
+            changed_local[lbj++] = 2*F->block_far_local[lbi]+1;
+            nfalse_local++;
+        }
+        else if(far_rank[lbi] == 0)
+            changed_local[lbj++] = 2*F->block_far_local[lbi];
+    }
+    // Sync list of all changed tiles
+    int int_nchanged_local = nchanged_local;
+    STARSH_MALLOC(mpi_recvcount, mpi_size);
+    STARSH_MALLOC(mpi_offset, mpi_size);
+    MPI_Allgather(&int_nchanged_local, 1, MPI_INT, mpi_recvcount, 1, MPI_INT,
+            MPI_COMM_WORLD);
+    for(bi = 0; bi < mpi_size; bi++)
+        nchanged += mpi_recvcount[bi];
+    mpi_offset[0] = 0;
+    for(bi = 1; bi < mpi_size; bi++)
+        mpi_offset[bi] = mpi_offset[bi-1]+mpi_recvcount[bi-1];
+    if(nchanged > 0)
+        STARSH_MALLOC(changed, nchanged);
+    MPI_Allgatherv(changed_local, nchanged_local, my_MPI_SIZE_T, changed,
+            mpi_recvcount, mpi_offset, my_MPI_SIZE_T, MPI_COMM_WORLD);
+    free(mpi_recvcount);
+    free(mpi_offset);
+    free(changed_local);
+    if(nchanged == 0)
+        return STARSH_SUCCESS;
+    // Make `changed` be in ascending order
+    qsort(changed, nchanged, sizeof(*changed), cmp_size_t);
+    for(bi = 0; bi < nchanged; bi++)
+        nfalse += changed[bi] & 1;
+    // Allocate new lists of tiles
+    new_nblocks_far = nblocks_far-nchanged;
+    new_nblocks_far_local = nblocks_far_local-nchanged_local;
+    new_nblocks_near = nblocks_near+nfalse;
+    new_nblocks_near_local = nblocks_near_local+nfalse_local;
+    if(new_nblocks_far > 0)
+        STARSH_MALLOC(block_far, 2*new_nblocks_far);
+    if(new_nblocks_far_local > 0)
+        STARSH_MALLOC(block_far_local, new_nblocks_far_local);
+    if(new_nblocks_near > 0)
+        STARSH_MALLOC(block_near, 2*new_nblocks_near);
+    if(new_nblocks_near_local > 0)
+        STARSH_MALLOC(block_near_local, new_nblocks_near_local);
+    // Near-field tiles stay at their places
+    for(bi = 0; bi < 2*nblocks_near; bi++)
+        block_near[bi] = F->block_near[bi];
+    for(lbi = 0; lbi < nblocks_near_local; lbi++)
+        block_near_local[lbi] = F->block_near_local[lbi];
+    // Single pass over far-field tiles, `bj` counts changed tiles, `bk`
+    // counts false far-field tiles and `lbk` counts local ones
+    bj = 0;
+    bk = 0;
+    lbi = 0;
+    lbj = 0;
+    lbk = 0;
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        int is_local = lbi < nblocks_far_local &&
+                F->block_far_local[lbi] == bi;
+        // `changed` must be in ascending order for this to work
+        if(bj < nchanged && changed[bj]/2 == bi)
+        {
+            if(changed[bj] & 1)
             {
-                block_far[2*k] = i;
-                block_far[2*k+1] = j;
-                if(i % grid_nx == grid_x && j % grid_ny == grid_y)
-                //if(k % mpi_size == mpi_rank)
-                {
-                    block_far_local[li] = k;
-                    li++;
-                }
-                k++;
+                block_near[2*(nblocks_near+bk)] = F->block_far[2*bi];
+                block_near[2*(nblocks_near+bk)+1] = F->block_far[2*bi+1];
+                if(is_local)
+                    block_near_local[nblocks_near_local+lbk++] =
+                            nblocks_near+bk;
+                bk++;
             }
-        if(li != nblocks_far_local)
-            STARSH_ERROR("WRONG COUNT FOR LOCAL BLOCKS");
+            if(is_local)
+            {
+                // Data of low-rank factors is not owned by arrays
+                far_U[lbi]->data = NULL;
+                far_V[lbi]->data = NULL;
+                array_free(far_U[lbi]);
+                array_free(far_V[lbi]);
+                lbi++;
+            }
+            bj++;
+        }
+        else
+        {
+            block_far[2*(bi-bj)] = F->block_far[2*bi];
+            block_far[2*(bi-bj)+1] = F->block_far[2*bi+1];
+            if(is_local)
+            {
+                block_far_local[lbj] = bi-bj;
+                far_rank[lbj] = far_rank[lbi];
+                far_U[lbj] = far_U[lbi];
+                far_V[lbj] = far_V[lbi];
+                lbi++;
+                lbj++;
+            }
+        }
     }
+    free(changed);
+    // Update format by creating new format
+    STARSH_blrf *F2;
+    info = starsh_blrf_new_from_coo_mpi(&F2, F->problem, F->symm,
+            F->row_cluster, F->col_cluster, new_nblocks_far, block_far,
+            new_nblocks_far_local, block_far_local, new_nblocks_near,
+            block_near, new_nblocks_near_local, block_near_local, F->type);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Swap internal data of formats and free unnecessary data
+    STARSH_blrf tmp_blrf = *F;
+    *F = *F2;
+    *F2 = tmp_blrf;
+    if(mpi_rank == 0)
+    {
+        if(nfalse > 0)
+        {
+            STARSH_WARNING("`F` was modified due to false far-field blocks");
+        }
+        if(nchanged > nfalse)
+        {
+            STARSH_WARNING("`F` was modified due to negligible far-field "
+                    "blocks");
+        }
+    }
+    free(F2->block_far_local);
+    free(F2->block_near_local);
+    starsh_blrf_free(F2);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrf_drop_far_mpi(STARSH_blrf *format, int *far_rank,
+        Array **far_U, Array **far_V)
+//! Remove far-field blocks of zero rank from format on MPI node.
+/*! MPI version of starsh_blrf_drop_far(). Arrays `far_rank`, `far_U` and
+ * `far_V` correspond to local far-field blocks. Lists of blocks of zero rank
+ * are gathered on all MPI nodes, so this function must be called by all
+ * nodes. It is a special case of starsh_blrf_update_far_mpi() without false
+ * far-field blocks.
+ *
+ * @param[in,out] format: Pointer to @ref STARSH_blrf object.
+ * @param[in,out] far_rank: Ranks of local far-field blocks.
+ * @param[in,out] far_U: Low-rank factors `U` of local far-field blocks.
+ * @param[in,out] far_V: Low-rank factors `V` of local far-field blocks.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    return starsh_blrf_update_far_mpi(format, far_rank, far_U, far_V);
+}
+
+static int blrf_vector_layout_mpi(STARSH_blrf *format, char side,
+        STARSH_cluster **cluster, int *nnodes)
+//! Get cluster and number of nodes of distributed dense matrix.
+{
+    if(side == 'R')
+        *cluster = format->row_cluster;
+    else if(side == 'C')
+        *cluster = format->col_cluster;
     else
     {
-        nblocks_far = nbrows*(nbrows+1)/2;
-        STARSH_MALLOC(block_far, 2*nblocks_far);
-        nblocks_far_local = (nbrows+grid_nx-1-grid_x)/grid_nx-1;
-        nblocks_far_local = nblocks_far_local*(nblocks_far_local+1)/2;
-        if(grid_x >= grid_y)
+        STARSH_ERROR("Parameter `side` must be 'R' or 'C'");
+        return STARSH_WRONG_PARAMETER;
+    }
+    *nnodes = format->grid_ncols*format->grid_nrows;
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrf_get_vector_size_mpi(STARSH_blrf *format, char side,
+        STARSH_int *size)
+//! Get number of local rows of distributed dense matrix.
+/*! Dense matrices, distributed among MPI nodes to be multiplied by @ref
+ * starsh_blrm__dmml_mpi_dist(), are split into blocks by row cluster
+ * (`side='R'`) or column cluster (`side='C'`) of format. Block `k` is stored
+ * on the node of rank `k%P`, where `P` is number of nodes, i.e. in row
+ * `k%grid_nrows` of the process grid (see @ref STARSH_blrf::grid_nrows)
+ * together with tiles of `k`-th block row, and blocks of each row of the
+ * grid are given out cyclically to its columns, so that all nodes get
+ * their share of dense matrix. Local blocks are stored one after another
+ * in increasing order.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] side: 'R' for layout of rows and 'C' for layout of columns.
+ * @param[out] size: Number of local rows.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    STARSH_cluster *X;
+    int nnodes, mpi_rank;
+    int info = blrf_vector_layout_mpi(format, side, &X, &nnodes);
+    if(info != STARSH_SUCCESS)
+        return info;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    *size = 0;
+    for(STARSH_int k = mpi_rank; k < X->nblocks; k += nnodes)
+        *size += X->size[k];
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrf_scatter_vector_mpi(STARSH_blrf *format, char side, int nrhs,
+        double *A, int lda, double *A_local, int ld_local)
+//! Distribute dense matrix from root node among all MPI nodes.
+/*! Layout of distributed matrix is described in @ref
+ * starsh_blrf_get_vector_size_mpi(). Must be called by all MPI nodes.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] side: 'R' for layout of rows and 'C' for layout of columns.
+ * @param[in] nrhs: Number of columns of dense matrix.
+ * @param[in] A: Dense matrix on root node.
+ * @param[in] lda: Leading dimension of `A`.
+ * @param[out] A_local: Local rows of dense matrix.
+ * @param[in] ld_local: Leading dimension of `A_local`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    STARSH_cluster *X;
+    int nnodes, mpi_rank, mpi_size;
+    int info = blrf_vector_layout_mpi(format, side, &X, &nnodes);
+    if(info != STARSH_SUCCESS)
+        return info;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    STARSH_int local_size, k;
+    starsh_blrf_get_vector_size_mpi(format, side, &local_size);
+    int *sendcounts = NULL, *displs = NULL;
+    double *sendbuf = NULL, *recvbuf;
+    if(mpi_rank == 0)
+    {
+        // Pack local rows of each node one after another
+        STARSH_MALLOC(sendcounts, mpi_size);
+        STARSH_MALLOC(displs, mpi_size);
+        STARSH_MALLOC(sendbuf, (size_t)nrhs*X->ndata);
+        for(int i = 0; i < mpi_size; i++)
+            sendcounts[i] = 0;
+        for(k = 0; k < X->nblocks; k++)
+            sendcounts[k%nnodes] += X->size[k];
+        displs[0] = 0;
+        for(int i = 1; i < mpi_size; i++)
+            displs[i] = displs[i-1]+nrhs*sendcounts[i-1];
+        for(int i = 0; i < mpi_size; i++)
         {
-            nblocks_far_local += nbrows/grid_nx;
-            if(nbrows % grid_nx > grid_x && nbcols % grid_ny > grid_y)
-                nblocks_far_local += 1;
+            size_t offset = displs[i];
+            for(k = i; k < X->nblocks; k += nnodes)
+            {
+                for(int j = 0; j < nrhs; j++)
+                    memcpy(sendbuf+offset+j*(size_t)sendcounts[i],
+                            A+X->start[k]+j*(size_t)lda,
+                            X->size[k]*sizeof(*A));
+                offset += X->size[k];
+            }
+            sendcounts[i] *= nrhs;
         }
-        //nblocks_far_local = (nblocks_far+mpi_size-1-mpi_rank)/mpi_size;
-        //STARSH_WARNING("(%d, %d): LOCAL BLOCKS=%zu", grid_x, grid_y, nblocks_far_local);
-        STARSH_MALLOC(block_far_local, nblocks_far_local);
-        for(i = 0; i < nbrows; i++)
-            for(j = 0; j <= i; j++)
+    }
+    if(ld_local == local_size || local_size == 0)
+        recvbuf = A_local;
+    else
+    {
+        STARSH_MALLOC(recvbuf, nrhs*local_size);
+    }
+    MPI_Scatterv(sendbuf, sendcounts, displs, MPI_DOUBLE, recvbuf,
+            nrhs*local_size, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if(recvbuf != A_local)
+    {
+        for(int j = 0; j < nrhs; j++)
+            memcpy(A_local+j*(size_t)ld_local, recvbuf+j*local_size,
+                    local_size*sizeof(*A_local));
+        free(recvbuf);
+    }
+    free(sendcounts);
+    free(displs);
+    free(sendbuf);
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrf_gather_vector_mpi(STARSH_blrf *format, char side, int nrhs,
+        double *A_local, int ld_local, double *A, int lda)
+//! Collect distributed dense matrix on root node.
+/*! Inverse of @ref starsh_blrf_scatter_vector_mpi(). Must be called by all MPI
+ * nodes.
+ *
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] side: 'R' for layout of rows and 'C' for layout of columns.
+ * @param[in] nrhs: Number of columns of dense matrix.
+ * @param[in] A_local: Local rows of dense matrix.
+ * @param[in] ld_local: Leading dimension of `A_local`.
+ * @param[out] A: Dense matrix on root node.
+ * @param[in] lda: Leading dimension of `A`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrf
+ * */
+{
+    STARSH_cluster *X;
+    int nnodes, mpi_rank, mpi_size;
+    int info = blrf_vector_layout_mpi(format, side, &X, &nnodes);
+    if(info != STARSH_SUCCESS)
+        return info;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    STARSH_int local_size, k;
+    starsh_blrf_get_vector_size_mpi(format, side, &local_size);
+    int *recvcounts = NULL, *displs = NULL;
+    double *recvbuf = NULL, *sendbuf;
+    if(mpi_rank == 0)
+    {
+        STARSH_MALLOC(recvcounts, mpi_size);
+        STARSH_MALLOC(displs, mpi_size);
+        STARSH_MALLOC(recvbuf, (size_t)nrhs*X->ndata);
+        for(int i = 0; i < mpi_size; i++)
+            recvcounts[i] = 0;
+        for(k = 0; k < X->nblocks; k++)
+            recvcounts[k%nnodes] += X->size[k];
+        displs[0] = 0;
+        for(int i = 1; i < mpi_size; i++)
+            displs[i] = displs[i-1]+nrhs*recvcounts[i-1];
+        for(int i = 0; i < mpi_size; i++)
+            recvcounts[i] *= nrhs;
+    }
+    if(ld_local == local_size || local_size == 0)
+        sendbuf = A_local;
+    else
+    {
+        STARSH_MALLOC(sendbuf, nrhs*local_size);
+        for(int j = 0; j < nrhs; j++)
+            memcpy(sendbuf+j*local_size, A_local+j*(size_t)ld_local,
+                    local_size*sizeof(*A_local));
+    }
+    MPI_Gatherv(sendbuf, nrhs*local_size, MPI_DOUBLE, recvbuf, recvcounts,
+            displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if(sendbuf != A_local)
+        free(sendbuf);
+    if(mpi_rank == 0)
+    {
+        // Unpack local rows of each node
+        for(int i = 0; i < mpi_size; i++)
+        {
+            size_t offset = displs[i];
+            STARSH_int count = recvcounts[i]/nrhs;
+            for(k = i; k < X->nblocks; k += nnodes)
             {
-                block_far[2*k] = i;
-                block_far[2*k+1] = j;
-                if(i % grid_nx == grid_x && j % grid_ny == grid_y)
-                //if(k % mpi_size == mpi_rank)
-                {
-                    block_far_local[li] = k;
-                    li++;
-                    if(li > nblocks_far_local)
-                    {
-                        STARSH_ERROR("WRONG COUNG FOR LOCAL BLOCKS 2");
-                    }
-                }
-                k++;
+                for(int j = 0; j < nrhs; j++)
+                    memcpy(A+X->start[k]+j*(size_t)lda,
+                            recvbuf+offset+j*(size_t)count,
+                            X->size[k]*sizeof(*A));
+                offset += X->size[k];
             }
-        if(li != nblocks_far_local)
-            STARSH_ERROR("WRONG COUNT FOR LOCAL BLOCKS");
+        }
     }
-    return starsh_blrf_new_from_coo_mpi(format, problem, symm, row_cluster,
-            col_cluster, nblocks_far, block_far, nblocks_far_local,
-            block_far_local, 0, NULL, 0, NULL, STARSH_TLR);
+    free(recvcounts);
+    free(displs);
+    free(recvbuf);
+    return STARSH_SUCCESS;
 }
 #endif // MPI
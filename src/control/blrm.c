@@ -105,6 +105,14 @@ int starsh_blrm_new(STARSH_blrm **matrix, STARSH_blrf *format, int *far_rank,
     M->alloc_V = alloc_V;
     M->alloc_D = alloc_D;
     M->alloc_type = alloc_type;
+    M->uniform = 0;
+    M->row_rank = NULL;
+    M->row_U = NULL;
+    M->col_rank = NULL;
+    M->col_V = NULL;
+    M->far_S = NULL;
+    M->alloc_S = NULL;
+    M->mpi_plan = NULL;
     STARSH_int bi, data_size = 0, size = 0;
     size += sizeof(*M);
     size += F->nblocks_far*(sizeof(*far_rank)+sizeof(*far_U)+sizeof(*far_V));
@@ -127,6 +135,142 @@ int starsh_blrm_new(STARSH_blrm **matrix, STARSH_blrf *format, int *far_rank,
     return STARSH_SUCCESS;
 }
 
+int starsh_blrm_new_uniform(STARSH_blrm **matrix, STARSH_blrf *format,
+        int *row_rank, Array **row_U, int *col_rank, Array **col_V,
+        Array **far_S, int onfly, Array **near_D, void *alloc_U,
+        void *alloc_V, void *alloc_S, void *alloc_D)
+//! Init @ref STARSH_blrm object with shared bases of block rows and columns.
+/*! Far-field block `bi` in block row `i` and block column `j` is represented
+ * by `row_U[i]*far_S[bi]*transpose(col_V[j])`, where only leading columns of
+ * `row_U[i]` and `col_V[j]` are used, as many as rows and columns of
+ * `far_S[bi]`. For symmetric format `col_rank` and `col_V` must be equal to
+ * `row_rank` and `row_U` correspondingly, and `alloc_V` must be NULL. Type of
+ * memory allocation is `1`.
+ *
+ * @param[out] matrix: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] format: Pointer to @ref STARSH_blrf object.
+ * @param[in] row_rank: Array of ranks of bases of block rows.
+ * @param[in] row_U: Array of orthonormal bases of block rows.
+ * @param[in] col_rank: Array of ranks of bases of block columns.
+ * @param[in] col_V: Array of orthonormal bases of block columns.
+ * @param[in] far_S: Array of coupling matrices of far-field blocks.
+ * @param[in] onfly: Whether not to store dense blocks.
+ * @param[in] near_D: Array of dense near-field blocks.
+ * @param[in] alloc_U: Pointer to big buffer for all `row_U`.
+ * @param[in] alloc_V: Pointer to big buffer for all `col_V`.
+ * @param[in] alloc_S: Pointer to big buffer for all `far_S`.
+ * @param[in] alloc_D: Pointer to big buffer for all `near_D`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    if(matrix == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(format == NULL)
+    {
+        STARSH_ERROR("Invalid value of `format`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = format;
+    if(row_rank == NULL || row_U == NULL || alloc_U == NULL)
+    {
+        STARSH_ERROR("Invalid value of `row_rank`, `row_U` or `alloc_U`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(col_rank == NULL || col_V == NULL)
+    {
+        STARSH_ERROR("Invalid value of `col_rank` or `col_V`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(F->symm == 'S' && (col_rank != row_rank || col_V != row_U ||
+                alloc_V != NULL))
+    {
+        STARSH_ERROR("Symmetric format requires `col_rank`=`row_rank`, "
+                "`col_V`=`row_U` and `alloc_V`=NULL");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(F->symm == 'N' && alloc_V == NULL)
+    {
+        STARSH_ERROR("Invalid value of `alloc_V`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if((far_S == NULL || alloc_S == NULL) && F->nblocks_far > 0)
+    {
+        STARSH_ERROR("Invalid value of `far_S` or `alloc_S`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(onfly != 0 && onfly != 1)
+    {
+        STARSH_ERROR("Invalid value of `onfly`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if((near_D == NULL || alloc_D == NULL) && F->nblocks_near > 0 &&
+            onfly == 0)
+    {
+        STARSH_ERROR("Invalid value of `near_D` or `alloc_D`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrm *M;
+    STARSH_MALLOC(M, 1);
+    *matrix = M;
+    M->format = F;
+    M->far_rank = NULL;
+    M->far_U = NULL;
+    M->far_V = NULL;
+    M->onfly = onfly;
+    M->near_D = near_D;
+    M->alloc_U = alloc_U;
+    M->alloc_V = alloc_V;
+    M->alloc_D = alloc_D;
+    M->alloc_type = '1';
+    M->uniform = 1;
+    M->row_rank = row_rank;
+    M->row_U = row_U;
+    M->col_rank = col_rank;
+    M->col_V = col_V;
+    M->far_S = far_S;
+    M->alloc_S = alloc_S;
+    M->mpi_plan = NULL;
+    STARSH_int bi, data_size = 0, size = 0;
+    size += sizeof(*M);
+    size += F->nbrows*(sizeof(*row_rank)+sizeof(*row_U));
+    for(bi = 0; bi < F->nbrows; bi++)
+    {
+        size += row_U[bi]->nbytes;
+        data_size += row_U[bi]->data_nbytes;
+    }
+    if(F->symm == 'N')
+    {
+        size += F->nbcols*(sizeof(*col_rank)+sizeof(*col_V));
+        for(bi = 0; bi < F->nbcols; bi++)
+        {
+            size += col_V[bi]->nbytes;
+            data_size += col_V[bi]->data_nbytes;
+        }
+    }
+    size += F->nblocks_far*sizeof(*far_S);
+    for(bi = 0; bi < F->nblocks_far; bi++)
+    {
+        size += far_S[bi]->nbytes;
+        data_size += far_S[bi]->data_nbytes;
+    }
+    if(onfly == 0)
+    {
+        size += F->nblocks_near*sizeof(*near_D);
+        for(bi = 0; bi < F->nblocks_near; bi++)
+        {
+            size += near_D[bi]->nbytes;
+            data_size += near_D[bi]->data_nbytes;
+        }
+    }
+    M->nbytes = size;
+    M->data_nbytes = data_size;
+    return STARSH_SUCCESS;
+}
+
 void starsh_blrm_free(STARSH_blrm *matrix)
 //! Free memory of a non-nested block low-rank matrix.
 //! @ingroup blrm
@@ -137,7 +281,36 @@ void starsh_blrm_free(STARSH_blrm *matrix)
     STARSH_blrf *F = M->format;
     STARSH_int bi;
     int info;
-    if(F->nblocks_far > 0)
+    if(M->uniform == 1)
+    {
+        free(M->alloc_U);
+        free(M->alloc_V);
+        free(M->alloc_S);
+        for(bi = 0; bi < F->nbrows; bi++)
+        {
+            M->row_U[bi]->data = NULL;
+            array_free(M->row_U[bi]);
+        }
+        if(M->col_V != M->row_U)
+        {
+            for(bi = 0; bi < F->nbcols; bi++)
+            {
+                M->col_V[bi]->data = NULL;
+                array_free(M->col_V[bi]);
+            }
+            free(M->col_rank);
+            free(M->col_V);
+        }
+        for(bi = 0; bi < F->nblocks_far; bi++)
+        {
+            M->far_S[bi]->data = NULL;
+            array_free(M->far_S[bi]);
+        }
+        free(M->row_rank);
+        free(M->row_U);
+        free(M->far_S);
+    }
+    else if(F->nblocks_far > 0)
     {
         if(M->alloc_type == '1')
         {
@@ -186,6 +359,498 @@ void starsh_blrm_free(STARSH_blrm *matrix)
     free(M);
 }
 
+int starsh_blrm_pack_far(STARSH_int nblocks_far, int *far_rank,
+        Array **far_U, Array **far_V, void **alloc_U, void **alloc_V)
+//! Move low-rank factors of far-field blocks into buffers of exact size.
+/*! Approximation routines allocate big buffers `alloc_U` and `alloc_V` with
+ * `maxrank` columns for each far-field block. This function copies only
+ * `far_rank[bi]` leading columns of each factor into new big buffers,
+ * recreates arrays `far_U` and `far_V` with their actual shapes and frees
+ * old buffers. If there are no far-field blocks, both buffers are freed and
+ * set to NULL.
+ *
+ * @param[in] nblocks_far: Number of far-field blocks.
+ * @param[in] far_rank: Ranks of far-field blocks.
+ * @param[in,out] far_U: Low-rank factors `U` of far-field blocks.
+ * @param[in,out] far_V: Low-rank factors `V` of far-field blocks.
+ * @param[in,out] alloc_U: Big buffer for all `far_U`.
+ * @param[in,out] alloc_V: Big buffer for all `far_V`.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_int bi;
+    size_t size_U = 0, size_V = 0, offset_U = 0, offset_V = 0;
+    char *U, *V;
+    int info;
+    if(nblocks_far == 0)
+    {
+        free(*alloc_U);
+        free(*alloc_V);
+        *alloc_U = NULL;
+        *alloc_V = NULL;
+        return STARSH_SUCCESS;
+    }
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        size_U += far_U[bi]->dtype_size*far_U[bi]->shape[0]*far_rank[bi];
+        size_V += far_V[bi]->dtype_size*far_V[bi]->shape[0]*far_rank[bi];
+    }
+    // Keep at least one byte to avoid malloc() of zero size
+    U = malloc(size_U+1);
+    V = malloc(size_V+1);
+    if(U == NULL || V == NULL)
+    {
+        free(U);
+        free(V);
+        STARSH_ERROR("malloc() failed");
+        return STARSH_MALLOC_ERROR;
+    }
+    for(bi = 0; bi < nblocks_far; bi++)
+    {
+        char dtype = far_U[bi]->dtype;
+        int shape[2] = {far_U[bi]->shape[0], far_rank[bi]};
+        size_t nbytes = far_U[bi]->dtype_size*shape[0]*shape[1];
+        memcpy(U+offset_U, far_U[bi]->data, nbytes);
+        far_U[bi]->data = NULL;
+        array_free(far_U[bi]);
+        info = array_from_buffer(far_U+bi, 2, shape, dtype, 'F', U+offset_U);
+        if(info != STARSH_SUCCESS)
+            return info;
+        offset_U += nbytes;
+        shape[0] = far_V[bi]->shape[0];
+        nbytes = far_V[bi]->dtype_size*shape[0]*shape[1];
+        memcpy(V+offset_V, far_V[bi]->data, nbytes);
+        far_V[bi]->data = NULL;
+        array_free(far_V[bi]);
+        info = array_from_buffer(far_V+bi, 2, shape, dtype, 'F', V+offset_V);
+        if(info != STARSH_SUCCESS)
+            return info;
+        offset_V += nbytes;
+    }
+    free(*alloc_U);
+    free(*alloc_V);
+    *alloc_U = U;
+    *alloc_V = V;
+    return STARSH_SUCCESS;
+}
+
+int starsh_blrm_convert(STARSH_blrm **matrix, STARSH_blrm *src,
+        char dtype)
+//! Create copy of @ref STARSH_blrm object with different precision.
+/*! All low-rank factors and dense near-field blocks of `src` are converted
+ * by array_convert(). Result shares format with `src`, so it must be freed
+ * by starsh_blrm_free() before format of `src` is freed. Main use case is
+ * a single precision copy of a TLR factor, which takes half of memory and
+ * is applied by starsh_blrm__spotrs_omp(). Only non-uniform matrices with
+ * stored dense blocks are supported.
+ *
+ * @param[out] matrix: Address of pointer to @ref STARSH_blrm object.
+ * @param[in] src: Source block low-rank matrix.
+ * @param[in] dtype: New data type (precision).
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa array_convert().
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrm *M = src;
+    if(matrix == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(M == NULL)
+    {
+        STARSH_ERROR("Invalid value of `src`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(M->uniform != 0 || M->onfly != 0)
+    {
+        STARSH_ERROR("Only non-uniform matrices with stored near-field "
+                "blocks are supported");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = M->format;
+    STARSH_int bi, nfar = F->nblocks_far, nnear = F->nblocks_near;
+    int *far_rank = NULL;
+    Array **far_U = NULL, **far_V = NULL, **near_D = NULL;
+    int info = STARSH_SUCCESS;
+    if(nfar > 0)
+    {
+        STARSH_MALLOC(far_rank, nfar);
+        STARSH_MALLOC(far_U, nfar);
+        STARSH_MALLOC(far_V, nfar);
+    }
+    if(nnear > 0)
+    {
+        STARSH_MALLOC(near_D, nnear);
+    }
+    for(bi = 0; bi < nfar; bi++)
+    {
+        far_rank[bi] = M->far_rank[bi];
+        far_U[bi] = NULL;
+        far_V[bi] = NULL;
+    }
+    for(bi = 0; bi < nnear; bi++)
+        near_D[bi] = NULL;
+    for(bi = 0; bi < nfar && info == STARSH_SUCCESS; bi++)
+    {
+        info = array_convert(far_U+bi, M->far_U[bi], dtype);
+        if(info == STARSH_SUCCESS)
+            info = array_convert(far_V+bi, M->far_V[bi], dtype);
+    }
+    for(bi = 0; bi < nnear && info == STARSH_SUCCESS; bi++)
+        info = array_convert(near_D+bi, M->near_D[bi], dtype);
+    if(info != STARSH_SUCCESS)
+    {
+        for(bi = 0; bi < nfar; bi++)
+        {
+            if(far_U[bi] != NULL)
+                array_free(far_U[bi]);
+            if(far_V[bi] != NULL)
+                array_free(far_V[bi]);
+        }
+        for(bi = 0; bi < nnear; bi++)
+            if(near_D[bi] != NULL)
+                array_free(near_D[bi]);
+        free(far_rank);
+        free(far_U);
+        free(far_V);
+        free(near_D);
+        return info;
+    }
+    return starsh_blrm_new(matrix, F, far_rank, far_U, far_V, 0, near_D,
+            NULL, NULL, NULL, '2');
+}
+
+int starsh_blrm_update_parameters(STARSH_blrm *matrix, char type,
+        double scale, double shift, int maxrank, double tol)
+//! Update @ref STARSH_blrm object after change of parameters of kernel.
+/*! Parameters of kernel must be already changed in data of
+ * @ref STARSH_problem object, for example, fields `sigma`, `beta`, `nu` and
+ * `noise` of @ref STARSH_ssdata. Clusterization and admissibility of
+ * blocks are kept, so this is much cheaper, than a new call to
+ * starsh_blrm_approximate().
+ *
+ * If `type` is 'D', matrix is replaced by `scale*A+shift*I` in place
+ * without any call to kernel: far-field blocks are scaled through their
+ * factors `U` and `shift` is added to diagonal of diagonal near-field
+ * blocks. This corresponds to a new variance `sigma` or noise `noise`.
+ * Since Cholesky factor of `scale*A` is `sqrt(scale)*L`, factors, computed
+ * by starsh_blrm__dpotrf_omp(), are updated by the same call with scale
+ * `sqrt(scale)` and zero `shift`. Near-field blocks, computed on demand,
+ * are not changed, as kernel already returns new values.
+ *
+ * If `type` is 'K', all tiles are recomputed by kernel, which is required
+ * for a new correlation length `beta` or smoothness `nu`. Far-field blocks
+ * are approximated by starsh_dense_dlrrsdd_sketch(), where factor `V` of
+ * previous approximation is used as the sketch, so randomized SVD requires
+ * a single pass and no power iterations. Only if the pass does not reach
+ * tolerance, tile is approximated by starsh_dense_dlrrsdd() from scratch.
+ * Blocks, dropped by starsh_blrf_drop_far() for previous parameters, are
+ * approximated from scratch as well, since they can become significant
+ * (e.g., for larger `beta`). Format of matrix is updated in place: such
+ * blocks return to the list of far-field blocks, while blocks, negligible
+ * for new parameters, are dropped. Matrix must be computed by
+ * starsh_blrm__drsdd_omp() or any other approximation routine, that stores
+ * all far-field factors in big buffers.
+ * Far-field blocks, whose rank exceeds `maxrank`, can not become near-field
+ * in the same format, so this case returns error and matrix is not changed.
+ *
+ * @param[in,out] matrix: Block low-rank matrix.
+ * @param[in] type: 'D' for diagonal shift and scaling, 'K' for
+ *      re-approximation with new kernel.
+ * @param[in] scale: Scaling factor, used only if `type` is 'D'.
+ * @param[in] shift: Diagonal shift, used only if `type` is 'D'.
+ * @param[in] maxrank: Maximum possible rank, used only if `type` is 'K'.
+ * @param[in] tol: Relative error tolerance, used only if `type` is 'K'.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_blrm_approximate(), starsh_dense_dlrrsdd_sketch().
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrm *M = matrix;
+    if(M == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(type != 'D' && type != 'K')
+    {
+        STARSH_ERROR("Invalid value of `type`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_blrf *F = M->format;
+    STARSH_problem *P = F->problem;
+    STARSH_cluster *RC = F->row_cluster, *CC = F->col_cluster;
+    STARSH_int bi, nfar = F->nblocks_far, nnear = F->nblocks_near;
+    if(type == 'D')
+    {
+        #pragma omp parallel for schedule(static)
+        for(bi = 0; bi < nfar; bi++)
+        {
+            if(M->uniform == 1)
+                cblas_dscal(M->far_S[bi]->size, scale, M->far_S[bi]->data,
+                        1);
+            else
+                cblas_dscal((size_t)RC->size[F->block_far[2*bi]]*
+                        M->far_rank[bi], scale, M->far_U[bi]->data, 1);
+        }
+        if(M->onfly == 1)
+            return STARSH_SUCCESS;
+        #pragma omp parallel for schedule(static)
+        for(bi = 0; bi < nnear; bi++)
+        {
+            STARSH_int i = F->block_near[2*bi];
+            STARSH_int j = F->block_near[2*bi+1];
+            double *D = M->near_D[bi]->data;
+            int k, nrows = RC->size[i];
+            cblas_dscal(M->near_D[bi]->size, scale, D, 1);
+            if(shift != 0. && i == j && RC == CC)
+                for(k = 0; k < nrows; k++)
+                    D[(size_t)k*(nrows+1)] += shift;
+        }
+        return STARSH_SUCCESS;
+    }
+    if(M->uniform != 0 || M->alloc_type != '1' || P->dtype != 'd')
+    {
+        STARSH_ERROR("Only non-uniform double precision matrices with big "
+                "buffers are supported");
+        return STARSH_WRONG_PARAMETER;
+    }
+    STARSH_kernel *kernel = P->kernel;
+    void *RD = RC->data, *CD = CC->data;
+    const int oversample = starsh_params.oversample;
+    const int poweriter = starsh_params.poweriter;
+    int *far_rank = NULL;
+    Array **far_U = NULL, **far_V = NULL;
+    double *alloc_U = NULL, *alloc_V = NULL;
+    size_t offset_U = 0, offset_V = 0, size_U = 0, size_V = 0;
+    double abstol = 0.;
+    int info = STARSH_SUCCESS;
+    // Blocks, dropped for previous parameters, can be significant for new
+    // parameters, so they are approximated again together with far-field
+    // blocks. New list of far-field blocks starts with the current list,
+    // which keeps correspondence of factors, used as a sketch.
+    STARSH_int nblocks_drop, *block_drop, *block_far = NULL;
+    STARSH_int *block_near = NULL;
+    STARSH_blrf *F2;
+    info = starsh_blrf_get_dropped(F, &nblocks_drop, &block_drop);
+    if(info != STARSH_SUCCESS)
+        return info;
+    STARSH_int new_nfar = nfar+nblocks_drop;
+    if(new_nfar > 0)
+    {
+        STARSH_MALLOC(block_far, 2*new_nfar);
+        for(bi = 0; bi < 2*nfar; bi++)
+            block_far[bi] = F->block_far[bi];
+        for(bi = 0; bi < 2*nblocks_drop; bi++)
+            block_far[2*nfar+bi] = block_drop[bi];
+        free(block_drop);
+    }
+    if(nnear > 0)
+    {
+        STARSH_MALLOC(block_near, 2*nnear);
+        for(bi = 0; bi < 2*nnear; bi++)
+            block_near[bi] = F->block_near[bi];
+    }
+    info = starsh_blrf_new_from_coo(&F2, P, F->symm, RC, CC, new_nfar,
+            block_far, nnear, block_near, F->type);
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(new_nfar > 0)
+    {
+#ifdef OPENMP
+        info = starsh_blrm__dtol_omp(F2, tol, &abstol);
+#else
+        info = starsh_blrm__dtol(F2, tol, &abstol);
+#endif
+        if(info != STARSH_SUCCESS)
+        {
+            starsh_blrf_free(F2);
+            return info;
+        }
+        STARSH_MALLOC(far_rank, new_nfar);
+        STARSH_MALLOC(far_U, new_nfar);
+        STARSH_MALLOC(far_V, new_nfar);
+        for(bi = 0; bi < new_nfar; bi++)
+        {
+            size_U += RC->size[block_far[2*bi]];
+            size_V += CC->size[block_far[2*bi+1]];
+        }
+        STARSH_MALLOC(alloc_U, size_U*maxrank);
+        STARSH_MALLOC(alloc_V, size_V*maxrank);
+        for(bi = 0; bi < new_nfar; bi++)
+        {
+            int nrows = RC->size[block_far[2*bi]];
+            int ncols = CC->size[block_far[2*bi+1]];
+            int shape_U[2] = {nrows, maxrank};
+            int shape_V[2] = {ncols, maxrank};
+            array_from_buffer(far_U+bi, 2, shape_U, 'd', 'F',
+                    alloc_U+offset_U);
+            array_from_buffer(far_V+bi, 2, shape_V, 'd', 'F',
+                    alloc_V+offset_V);
+            offset_U += (size_t)nrows*maxrank;
+            offset_V += (size_t)ncols*maxrank;
+        }
+    }
+    // Approximate far-field blocks into new buffers, so that matrix is not
+    // changed in case of error
+    #pragma omp parallel for schedule(dynamic,1)
+    for(bi = 0; bi < new_nfar; bi++)
+    {
+        STARSH_int i = block_far[2*bi];
+        STARSH_int j = block_far[2*bi+1];
+        int nrows = RC->size[i];
+        int ncols = CC->size[j];
+        int mn = nrows < ncols ? nrows : ncols;
+        int mn2 = maxrank+oversample;
+        if(mn2 > mn)
+            mn2 = mn;
+        int lwork = ncols, lwork_sdd = (4*mn2+7)*mn2;
+        if(lwork_sdd > lwork)
+            lwork = lwork_sdd;
+        lwork += (size_t)mn2*(2*ncols+nrows+mn2+1);
+        int liwork = 8*mn2;
+        double *D, *work;
+        int *iwork;
+        STARSH_PMALLOC(D, (size_t)nrows*(size_t)ncols, info);
+        STARSH_PMALLOC(iwork, liwork, info);
+        STARSH_PMALLOC(work, lwork, info);
+        if(D == NULL || iwork == NULL || work == NULL)
+        {
+            free(D);
+            free(work);
+            free(iwork);
+            continue;
+        }
+        kernel(nrows, ncols, RC->pivot+RC->start[i], CC->pivot+CC->start[j],
+                RD, CD, D, nrows);
+        double tile_norm = LAPACKE_dlange_work(LAPACK_COL_MAJOR, 'F', nrows,
+                ncols, D, nrows, NULL);
+        if(tile_norm <= abstol)
+            far_rank[bi] = 0;
+        else
+        {
+            double tile_tol = tol;
+            // Previously dropped blocks have no basis for a warm start
+            int nsketch = bi < nfar ? M->far_rank[bi] : 0;
+            if(starsh_params.tolmode == STARSH_TOLMODE_GLOBAL)
+                tile_tol = abstol/tile_norm;
+            if(nsketch > maxrank)
+                nsketch = maxrank;
+            far_rank[bi] = -1;
+            // Warm start with previous basis of rows of the tile
+            if(nsketch > 0)
+                starsh_dense_dlrrsdd_sketch(nrows, ncols, D, nrows,
+                        far_U[bi]->data, nrows, far_V[bi]->data, ncols,
+                        far_rank+bi, maxrank, nsketch, M->far_V[bi]->data,
+                        ncols, oversample, tile_tol, work, lwork, iwork);
+            if(far_rank[bi] == -1)
+                starsh_dense_dlrrsdd(nrows, ncols, D, nrows, far_U[bi]->data,
+                        nrows, far_V[bi]->data, ncols, far_rank+bi, maxrank,
+                        oversample, poweriter, tile_tol, work, lwork, iwork);
+            if(far_rank[bi] == -1)
+            {
+                STARSH_ERROR("Rank of far-field block %zu exceeds `maxrank`",
+                        (size_t)bi);
+                #pragma omp atomic write
+                info = STARSH_UNKNOWN_ERROR;
+            }
+        }
+        free(D);
+        free(work);
+        free(iwork);
+    }
+    if(info != STARSH_SUCCESS)
+    {
+        for(bi = 0; bi < new_nfar; bi++)
+        {
+            far_U[bi]->data = NULL;
+            array_free(far_U[bi]);
+            far_V[bi]->data = NULL;
+            array_free(far_V[bi]);
+        }
+        free(far_rank);
+        free(far_U);
+        free(far_V);
+        free(alloc_U);
+        free(alloc_V);
+        starsh_blrf_free(F2);
+        return info;
+    }
+    // Replace far-field factors
+    for(bi = 0; bi < nfar; bi++)
+    {
+        M->nbytes -= M->far_U[bi]->nbytes+M->far_V[bi]->nbytes;
+        M->data_nbytes -= M->far_U[bi]->data_nbytes+
+            M->far_V[bi]->data_nbytes;
+        M->far_U[bi]->data = NULL;
+        array_free(M->far_U[bi]);
+        M->far_V[bi]->data = NULL;
+        array_free(M->far_V[bi]);
+    }
+    M->nbytes -= nfar*(sizeof(*far_rank)+sizeof(*far_U)+sizeof(*far_V));
+    if(nfar > 0)
+    {
+        free(M->alloc_U);
+        free(M->alloc_V);
+        free(M->far_rank);
+        free(M->far_U);
+        free(M->far_V);
+    }
+    M->alloc_U = alloc_U;
+    M->alloc_V = alloc_V;
+    M->far_rank = far_rank;
+    M->far_U = far_U;
+    M->far_V = far_V;
+    // Replace format by the one with previously dropped blocks and drop
+    // negligible blocks for new parameters
+    STARSH_blrf tmp_blrf = *F;
+    *F = *F2;
+    *F2 = tmp_blrf;
+    starsh_blrf_free(F2);
+    info = starsh_blrf_drop_far(F, far_rank, far_U, far_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    info = starsh_blrm_pack_far(F->nblocks_far, far_rank, far_U, far_V,
+            &M->alloc_U, &M->alloc_V);
+    if(info != STARSH_SUCCESS)
+        return info;
+    if(F->nblocks_far == 0)
+    {
+        free(M->far_rank);
+        free(M->far_U);
+        free(M->far_V);
+        M->far_rank = NULL;
+        M->far_U = NULL;
+        M->far_V = NULL;
+    }
+    M->nbytes += F->nblocks_far*(sizeof(*far_rank)+sizeof(*far_U)+
+            sizeof(*far_V));
+    for(bi = 0; bi < F->nblocks_far; bi++)
+    {
+        M->nbytes += far_U[bi]->nbytes+far_V[bi]->nbytes;
+        M->data_nbytes += far_U[bi]->data_nbytes+far_V[bi]->data_nbytes;
+    }
+    // Recompute near-field blocks
+    if(M->onfly == 0)
+    {
+        #pragma omp parallel for schedule(dynamic,1)
+        for(bi = 0; bi < nnear; bi++)
+        {
+            STARSH_int i = F->block_near[2*bi];
+            STARSH_int j = F->block_near[2*bi+1];
+            int nrows = RC->size[i];
+            int ncols = CC->size[j];
+            kernel(nrows, ncols, RC->pivot+RC->start[i],
+                    CC->pivot+CC->start[j], RD, CD, M->near_D[bi]->data,
+                    nrows);
+        }
+    }
+    return STARSH_SUCCESS;
+}
+
 void starsh_blrm_info(STARSH_blrm *matrix)
 //! Print short info on non-nested block low-rank matrix.
 //! @ingroup blrm
@@ -204,6 +869,9 @@ int starsh_blrm_get_block(STARSH_blrm *matrix, STARSH_int i, STARSH_int j,
  * and `D` is NULL (since dense block is not stored). If block is admissible
  * and not low-rank, then its dense version is returned and `U` and `V` are
  * NULL. If block is NOT admissible, then it is computed and returned as dense.
+ * If bases of block rows and columns are shared, then admissible block is
+ * restored and returned as dense. Dense block, that is not stored in `matrix`,
+ * has to be freed by user.
  *
  * @param[in] matrix: Pointer to @ref STARSH_blrm object.
  * @param[in] i: Index of block row.
@@ -282,11 +950,36 @@ int starsh_blrm_get_block(STARSH_blrm *matrix, STARSH_int i, STARSH_int j,
         {
             if(F->block_far[2*F->brow_far[k]+1] == j)
             {
-                bi = k;
+                bi = F->brow_far[k];
                 break;
             }
             k++;
         }
+        if(bi != -1 && M->uniform == 1)
+        {
+            // Restore dense block out of shared bases and coupling matrix
+            STARSH_int bf = bi;
+            int rank_U = M->far_S[bf]->shape[0];
+            int rank_V = M->far_S[bf]->shape[1];
+            double *tmp, *dense;
+            *rank = rank_U < rank_V ? rank_U : rank_V;
+            STARSH_MALLOC(tmp, (size_t)nrows*rank_V+1);
+            STARSH_MALLOC(dense, (size_t)nrows*(size_t)ncols);
+            for(k = 0; k < nrows*ncols; k++)
+                dense[k] = 0.0;
+            if(*rank > 0)
+            {
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nrows,
+                        rank_V, rank_U, 1.0, M->row_U[i]->data, nrows,
+                        M->far_S[bf]->data, rank_U, 0.0, tmp, nrows);
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, nrows,
+                        ncols, rank_V, 1.0, tmp, nrows, M->col_V[j]->data,
+                        ncols, 0.0, dense, nrows);
+            }
+            free(tmp);
+            *D = dense;
+            return info;
+        }
         if(bi != -1)
         {
             *rank = M->far_rank[bi];
@@ -302,7 +995,7 @@ int starsh_blrm_get_block(STARSH_blrm *matrix, STARSH_int i, STARSH_int j,
         {
             if(F->block_near[2*F->brow_near[k]+1] == j)
             {
-                bi = k;
+                bi = F->brow_near[k];
                 break;
             }
             k++;
@@ -413,6 +1106,14 @@ int starsh_blrm_new_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
     M->alloc_V = alloc_V;
     M->alloc_D = alloc_D;
     M->alloc_type = alloc_type;
+    M->uniform = 0;
+    M->row_rank = NULL;
+    M->row_U = NULL;
+    M->col_rank = NULL;
+    M->col_V = NULL;
+    M->far_S = NULL;
+    M->alloc_S = NULL;
+    M->mpi_plan = NULL;
     STARSH_int lbi, bi;
     size_t data_size = 0, size = 0;
     size += sizeof(*M);
@@ -438,6 +1139,8 @@ int starsh_blrm_new_mpi(STARSH_blrm **matrix, STARSH_blrf *format,
             MPI_COMM_WORLD);
     MPI_Allreduce(&data_size, &(M->data_nbytes), 1, my_MPI_SIZE_T, MPI_SUM,
             MPI_COMM_WORLD);
+    if(starsh_params.mpi_dist == STARSH_MPI_DIST_REBALANCE)
+        return starsh_blrm_rebalance_mpi(M);
     return STARSH_SUCCESS;
 }
 
@@ -451,6 +1154,7 @@ void starsh_blrm_free_mpi(STARSH_blrm *matrix)
     STARSH_blrf *F = M->format;
     STARSH_int lbi;
     int info;
+    starsh_blrm__dmml_mpi_tlr_free(M);
     if(F->nblocks_far_local > 0)
     {
         if(M->alloc_type == '1')
@@ -500,6 +1204,348 @@ void starsh_blrm_free_mpi(STARSH_blrm *matrix)
     free(M);
 }
 
+int starsh_blrm_rebalance_mpi(STARSH_blrm *matrix)
+//! Redistribute tiles among MPI nodes by their actual cost.
+/*! Cost of multiplication of a tile by a vector is proportional to
+ * `(m+n)*r` for `m` by `n` far-field tile of rank `r` and to `m*n` for
+ * near-field tile, so after approximation it can be much less uniform, than
+ * predicted before it. Tiles are distributed by @ref
+ * starsh_blrf_partition_mpi() with actual cost and low-rank factors and
+ * dense tiles are sent to their new MPI nodes. Local data of matrix and
+ * lists of local tiles of format are replaced, and buffers are not shared
+ * any more (allocation type becomes `2`). Must be called by all MPI nodes.
+ * Called by @ref starsh_blrm_new_mpi() if distribution of tiles, set by
+ * @ref starsh_set_mpi_dist(), is `REBALANCE`.
+ *
+ * @param[in,out] matrix: Pointer to @ref STARSH_blrm object.
+ * @return Error code @ref STARSH_ERRNO.
+ * @ingroup blrm
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_cluster *R = F->row_cluster, *C = F->col_cluster;
+    STARSH_int nblocks_far = F->nblocks_far;
+    STARSH_int nblocks_near = F->nblocks_near;
+    STARSH_int nblocks_far_local = F->nblocks_far_local;
+    STARSH_int nblocks_near_local = F->nblocks_near_local;
+    STARSH_int ntiles = nblocks_far+nblocks_near;
+    STARSH_int bi, lbi, *block, *local;
+    int info, mpi_size, mpi_rank, r;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    // Cached plan of multiplication depends on distribution of tiles
+    starsh_blrm__dmml_mpi_tlr_free(M);
+    // Far-field tiles go first, followed by near-field tiles
+    int *rank, *old_owner, *owner;
+    double *cost;
+    STARSH_MALLOC(block, 2*ntiles+1);
+    STARSH_MALLOC(local, ntiles+1);
+    STARSH_MALLOC(rank, 3*ntiles+1);
+    STARSH_MALLOC(cost, ntiles+1);
+    old_owner = rank+ntiles;
+    owner = old_owner+ntiles;
+    for(bi = 0; bi < 2*nblocks_far; bi++)
+        block[bi] = F->block_far[bi];
+    for(bi = 0; bi < 2*nblocks_near; bi++)
+        block[2*nblocks_far+bi] = F->block_near[bi];
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        rank[bi] = 0;
+        old_owner[bi] = 0;
+    }
+    for(lbi = 0; lbi < nblocks_far_local; lbi++)
+    {
+        bi = F->block_far_local[lbi];
+        rank[bi] = M->far_rank[lbi];
+        old_owner[bi] = mpi_rank;
+        local[bi] = lbi;
+    }
+    for(lbi = 0; lbi < nblocks_near_local; lbi++)
+    {
+        bi = nblocks_far+F->block_near_local[lbi];
+        old_owner[bi] = mpi_rank;
+        local[bi] = lbi;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, rank, 2*ntiles, MPI_INT, MPI_SUM,
+            MPI_COMM_WORLD);
+    // Size of data of each tile
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        size_t nrows = R->size[block[2*bi]], ncols = C->size[block[2*bi+1]];
+        if(bi < nblocks_far)
+            cost[bi] = (nrows+ncols)*(double)rank[bi];
+        else
+            cost[bi] = nrows*(double)ncols;
+    }
+    info = starsh_blrf_partition_mpi(ntiles, block, cost, owner);
+    if(info != STARSH_SUCCESS)
+        return info;
+    // Near-field tiles have no data if they are computed on fly
+    if(M->onfly == 1)
+        for(bi = nblocks_far; bi < ntiles; bi++)
+            cost[bi] = 0.;
+    // Amounts of data are counted in size_t, since total amount of data of
+    // an MPI node may not fit into int
+    size_t *sendcount, *senddispl, *recvcount, *recvdispl, *sendpos,
+           *recvpos;
+    STARSH_MALLOC(sendcount, 6*mpi_size);
+    senddispl = sendcount+mpi_size;
+    recvcount = senddispl+mpi_size;
+    recvdispl = recvcount+mpi_size;
+    sendpos = recvdispl+mpi_size;
+    recvpos = sendpos+mpi_size;
+    for(r = 0; r < mpi_size; r++)
+    {
+        sendcount[r] = 0;
+        recvcount[r] = 0;
+    }
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        if(old_owner[bi] == mpi_rank && owner[bi] != mpi_rank)
+            sendcount[owner[bi]] += cost[bi];
+        if(old_owner[bi] != mpi_rank && owner[bi] == mpi_rank)
+            recvcount[old_owner[bi]] += cost[bi];
+    }
+    senddispl[0] = 0;
+    recvdispl[0] = 0;
+    for(r = 1; r < mpi_size; r++)
+    {
+        senddispl[r] = senddispl[r-1]+sendcount[r-1];
+        recvdispl[r] = recvdispl[r-1]+recvcount[r-1];
+    }
+    for(r = 0; r < mpi_size; r++)
+    {
+        sendpos[r] = senddispl[r];
+        recvpos[r] = recvdispl[r];
+    }
+    double *sendbuf, *recvbuf;
+    STARSH_MALLOC(sendbuf, senddispl[mpi_size-1]+sendcount[mpi_size-1]+1);
+    STARSH_MALLOC(recvbuf, recvdispl[mpi_size-1]+recvcount[mpi_size-1]+1);
+    // Factors `U` and `V` of far-field tile are sent one after another
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        if(old_owner[bi] != mpi_rank || owner[bi] == mpi_rank ||
+                cost[bi] == 0.)
+            continue;
+        double *buf = sendbuf+sendpos[owner[bi]];
+        if(bi < nblocks_far)
+        {
+            Array *U = M->far_U[local[bi]], *V = M->far_V[local[bi]];
+            memcpy(buf, U->data, U->data_nbytes);
+            memcpy(buf+U->size, V->data, V->data_nbytes);
+        }
+        else
+        {
+            Array *D = M->near_D[local[bi]];
+            memcpy(buf, D->data, D->data_nbytes);
+        }
+        sendpos[owner[bi]] += cost[bi];
+    }
+    // Data is exchanged by point-to-point messages of at most `maxcount`
+    // elements each, since counts of MPI routines are of type int. Messages
+    // between two MPI nodes are not overtaking, so chunks arrive in order.
+    const size_t maxcount = INT_MAX/2;
+    size_t nrequests = 0, ireq = 0, pos;
+    for(r = 0; r < mpi_size; r++)
+        nrequests += (sendcount[r]+maxcount-1)/maxcount+
+            (recvcount[r]+maxcount-1)/maxcount;
+    MPI_Request *request;
+    STARSH_MALLOC(request, nrequests+1);
+    for(r = 0; r < mpi_size; r++)
+        for(pos = 0; pos < recvcount[r]; pos += maxcount)
+        {
+            size_t count = recvcount[r]-pos;
+            if(count > maxcount)
+                count = maxcount;
+            MPI_Irecv(recvbuf+recvdispl[r]+pos, count, MPI_DOUBLE, r, 0,
+                    MPI_COMM_WORLD, request+ireq);
+            ireq++;
+        }
+    for(r = 0; r < mpi_size; r++)
+        for(pos = 0; pos < sendcount[r]; pos += maxcount)
+        {
+            size_t count = sendcount[r]-pos;
+            if(count > maxcount)
+                count = maxcount;
+            MPI_Isend(sendbuf+senddispl[r]+pos, count, MPI_DOUBLE, r, 0,
+                    MPI_COMM_WORLD, request+ireq);
+            ireq++;
+        }
+    MPI_Waitall(nrequests, request, MPI_STATUSES_IGNORE);
+    free(request);
+    free(sendbuf);
+    // New lists of local tiles
+    STARSH_int new_nblocks_far_local = 0, new_nblocks_near_local = 0;
+    for(bi = 0; bi < ntiles; bi++)
+        if(owner[bi] == mpi_rank)
+        {
+            if(bi < nblocks_far)
+                new_nblocks_far_local++;
+            else
+                new_nblocks_near_local++;
+        }
+    STARSH_int *block_far_local, *block_near_local;
+    int *far_rank;
+    Array **far_U, **far_V, **near_D = NULL;
+    STARSH_MALLOC(block_far_local, new_nblocks_far_local+1);
+    STARSH_MALLOC(block_near_local, new_nblocks_near_local+1);
+    STARSH_MALLOC(far_rank, new_nblocks_far_local+1);
+    STARSH_MALLOC(far_U, new_nblocks_far_local+1);
+    STARSH_MALLOC(far_V, new_nblocks_far_local+1);
+    if(M->onfly == 0)
+    {
+        STARSH_MALLOC(near_D, new_nblocks_near_local+1);
+    }
+    STARSH_int lbj = 0, lbk = 0;
+    for(bi = 0; bi < ntiles; bi++)
+    {
+        if(owner[bi] != mpi_rank)
+        {
+            // Tiles, that moved to other nodes, are not needed any more
+            if(old_owner[bi] == mpi_rank && M->alloc_type == '2')
+            {
+                if(bi < nblocks_far)
+                {
+                    array_free(M->far_U[local[bi]]);
+                    array_free(M->far_V[local[bi]]);
+                }
+                else if(M->onfly == 0)
+                    array_free(M->near_D[local[bi]]);
+            }
+            continue;
+        }
+        int nrows = R->size[block[2*bi]], ncols = C->size[block[2*bi+1]];
+        if(bi < nblocks_far)
+        {
+            int shape_U[2] = {nrows, rank[bi]}, shape_V[2] = {ncols, rank[bi]};
+            block_far_local[lbj] = bi;
+            far_rank[lbj] = rank[bi];
+            if(old_owner[bi] != mpi_rank)
+            {
+                double *buf = recvbuf+recvpos[old_owner[bi]];
+                info = array_new(far_U+lbj, 2, shape_U, 'd', 'F');
+                if(info != STARSH_SUCCESS)
+                    return info;
+                info = array_new(far_V+lbj, 2, shape_V, 'd', 'F');
+                if(info != STARSH_SUCCESS)
+                    return info;
+                memcpy(far_U[lbj]->data, buf, far_U[lbj]->data_nbytes);
+                memcpy(far_V[lbj]->data, buf+far_U[lbj]->size,
+                        far_V[lbj]->data_nbytes);
+                recvpos[old_owner[bi]] += cost[bi];
+            }
+            else if(M->alloc_type == '2')
+            {
+                far_U[lbj] = M->far_U[local[bi]];
+                far_V[lbj] = M->far_V[local[bi]];
+            }
+            else
+            {
+                info = array_new_copy(far_U+lbj, M->far_U[local[bi]], 'F');
+                if(info != STARSH_SUCCESS)
+                    return info;
+                info = array_new_copy(far_V+lbj, M->far_V[local[bi]], 'F');
+                if(info != STARSH_SUCCESS)
+                    return info;
+            }
+            lbj++;
+        }
+        else
+        {
+            int shape_D[2] = {nrows, ncols};
+            block_near_local[lbk] = bi-nblocks_far;
+            if(M->onfly == 0 && old_owner[bi] != mpi_rank)
+            {
+                info = array_new(near_D+lbk, 2, shape_D, 'd', 'F');
+                if(info != STARSH_SUCCESS)
+                    return info;
+                memcpy(near_D[lbk]->data, recvbuf+recvpos[old_owner[bi]],
+                        near_D[lbk]->data_nbytes);
+                recvpos[old_owner[bi]] += cost[bi];
+            }
+            else if(M->onfly == 0 && M->alloc_type == '2')
+                near_D[lbk] = M->near_D[local[bi]];
+            else if(M->onfly == 0)
+            {
+                info = array_new_copy(near_D+lbk, M->near_D[local[bi]], 'F');
+                if(info != STARSH_SUCCESS)
+                    return info;
+            }
+            lbk++;
+        }
+    }
+    free(recvbuf);
+    // Free old buffers, if they were shared by tiles
+    if(M->alloc_type == '1')
+    {
+        for(lbi = 0; lbi < nblocks_far_local; lbi++)
+        {
+            M->far_U[lbi]->data = NULL;
+            array_free(M->far_U[lbi]);
+            M->far_V[lbi]->data = NULL;
+            array_free(M->far_V[lbi]);
+        }
+        if(M->onfly == 0)
+            for(lbi = 0; lbi < nblocks_near_local; lbi++)
+            {
+                M->near_D[lbi]->data = NULL;
+                array_free(M->near_D[lbi]);
+            }
+        free(M->alloc_U);
+        free(M->alloc_V);
+        free(M->alloc_D);
+    }
+    free(M->far_rank);
+    free(M->far_U);
+    free(M->far_V);
+    if(M->onfly == 0)
+        free(M->near_D);
+    free(F->block_far_local);
+    free(F->block_near_local);
+    M->far_rank = far_rank;
+    M->far_U = far_U;
+    M->far_V = far_V;
+    M->near_D = near_D;
+    M->alloc_U = NULL;
+    M->alloc_V = NULL;
+    M->alloc_D = NULL;
+    M->alloc_type = '2';
+    F->nblocks_far_local = new_nblocks_far_local;
+    F->block_far_local = block_far_local;
+    F->nblocks_near_local = new_nblocks_near_local;
+    F->block_near_local = block_near_local;
+    // Headers of tiles and lists of local tiles moved between MPI nodes, so
+    // sizes are recomputed in the same way, as in starsh_blrm_new_mpi()
+    size_t size = sizeof(*M), data_size = 0;
+    size += new_nblocks_far_local
+        *(sizeof(*far_rank)+sizeof(*far_U)+sizeof(*far_V));
+    for(lbi = 0; lbi < new_nblocks_far_local; lbi++)
+    {
+        size += far_U[lbi]->nbytes+far_V[lbi]->nbytes;
+        data_size += far_U[lbi]->data_nbytes+far_V[lbi]->data_nbytes;
+    }
+    if(M->onfly == 0)
+    {
+        size += new_nblocks_near_local*sizeof(*near_D);
+        for(lbi = 0; lbi < new_nblocks_near_local; lbi++)
+        {
+            size += near_D[lbi]->nbytes;
+            data_size += near_D[lbi]->data_nbytes;
+        }
+    }
+    MPI_Allreduce(&size, &(M->nbytes), 1, my_MPI_SIZE_T, MPI_SUM,
+            MPI_COMM_WORLD);
+    MPI_Allreduce(&data_size, &(M->data_nbytes), 1, my_MPI_SIZE_T, MPI_SUM,
+            MPI_COMM_WORLD);
+    free(block);
+    free(local);
+    free(rank);
+    free(cost);
+    free(sendcount);
+    return STARSH_SUCCESS;
+}
+
 void starsh_blrm_info_mpi(STARSH_blrm *matrix)
 //! Print short info on non-nested block low-rank matrix.
 //! @ingroup blrm
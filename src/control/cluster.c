@@ -12,6 +12,9 @@
 
 #include "common.h"
 #include "starsh.h"
+#ifdef MPI
+#include "starsh-mpi.h"
+#endif
 
 int starsh_cluster_new(STARSH_cluster **cluster, void *data, STARSH_int ndata,
         STARSH_int *pivot, STARSH_int nblocks, STARSH_int nlevels,
@@ -74,11 +77,20 @@ void starsh_cluster_free(STARSH_cluster *cluster)
     STARSH_cluster *C = cluster;
     if(C == NULL)
         return;
+#ifdef MPI
+    // Pivot, start points and sizes may reside in shared memory
+    starsh_shared_free_mpi(C->pivot);
+    if(C->level != NULL)
+        free(C->level);
+    starsh_shared_free_mpi(C->start);
+    starsh_shared_free_mpi(C->size);
+#else
     free(C->pivot);
     if(C->level != NULL)
         free(C->level);
     free(C->start);
     free(C->size);
+#endif
     if(C->parent != NULL)
         free(C->parent);
     if(C->child_start != NULL)
@@ -145,3 +157,45 @@ int starsh_cluster_new_plain(STARSH_cluster **cluster, void *data,
             start, size, NULL, NULL, NULL, STARSH_PLAIN);
 }
 
+#ifdef MPI
+int starsh_cluster_share_mpi(STARSH_cluster *cluster)
+//! Move pivoting, start points and sizes of clusters into shared memory.
+/*! Clusterization must be the same on all MPI nodes. After this call, fields
+ * `pivot`, `start` and `size` point to a single copy per compute node, and
+ * private copy of each MPI node is freed. Must be called by all MPI nodes.
+ *
+ * @param[in,out] cluster: Pointer to @ref STARSH_cluster object.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_shared_new_mpi(), starsh_particles_share_mpi().
+ * @ingroup cluster
+ * */
+{
+    STARSH_cluster *C = cluster;
+    STARSH_int *pivot, *start, *size;
+    int info;
+    if(C == NULL)
+    {
+        STARSH_ERROR("Invalid value of `cluster`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    info = starsh_shared_new_mpi((void **)&pivot, C->pivot,
+            C->ndata*sizeof(*pivot));
+    if(info != STARSH_SUCCESS)
+        return info;
+    info = starsh_shared_new_mpi((void **)&start, C->start,
+            C->nblocks*sizeof(*start));
+    if(info != STARSH_SUCCESS)
+        return info;
+    info = starsh_shared_new_mpi((void **)&size, C->size,
+            C->nblocks*sizeof(*size));
+    if(info != STARSH_SUCCESS)
+        return info;
+    starsh_shared_free_mpi(C->pivot);
+    starsh_shared_free_mpi(C->start);
+    starsh_shared_free_mpi(C->size);
+    C->pivot = pivot;
+    C->start = start;
+    C->size = size;
+    return STARSH_SUCCESS;
+}
+#endif // MPI
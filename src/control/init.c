@@ -30,12 +30,29 @@ int starsh_init()
  *  STARSH_BACKEND: SEQUENTIAL, MPI (pure MPI), OPENMP (pure OpenMP) or
  *  MPI_OPENMP (hybrid MPI with OpenMP).
  *
- *  STARSH_LRENGINE: SVD (divide-and-conquer SVD), RRQR (LAPACK *geqp3) or
- *  RSVD (randomized SVD).
+ *  STARSH_LRENGINE: SVD (divide-and-conquer SVD), RRQR (LAPACK *geqp3),
+ *  RSVD (randomized SVD), URSVD (randomized SVD with shared bases of block
+ *  rows and columns) or CHEB (Chebyshev interpolation of kernel). Default is
+ *  RSVD. URSVD falls back to RSVD, if shared bases do not save memory.
  *
  *  STARSH_OVERSAMPLE: Number of oversampling vectors for randomized SVD and
  *  RRQR.
  *
+ *  STARSH_POWER_ITER: Maximum number of power iterations for randomized SVD.
+ *
+ *  STARSH_TOLMODE: TILE (tolerance is relative error of each far-field tile)
+ *  or GLOBAL (tolerance is relative error of the entire matrix). In both
+ *  modes negligible far-field tiles are dropped.
+ *
+ *  STARSH_MPI_GRID: AUTO (the most square grid of MPI processes) or shape of
+ *  grid of MPI processes as `PxQ` (e.g. 2x4), where product of `P` and `Q`
+ *  must be equal to number of MPI processes.
+ *
+ *  STARSH_MPI_DIST: CYCLIC (2D block cyclic distribution of tiles over grid
+ *  of MPI processes), COST (tiles are distributed by their estimated cost) or
+ *  REBALANCE (the same as COST, but tiles are redistributed by their actual
+ *  cost after approximation).
+ *
  * @return Error code @ref STARSH_ERRNO.
  * @sa starsh_set_backend(), starsh_set_lrengine().
  * */
@@ -43,6 +60,10 @@ int starsh_init()
     const char *str_backend = "STARSH_BACKEND";
     const char *str_lrengine = "STARSH_LRENGINE";
     const char *str_oversample = "STARSH_OVERSAMPLE";
+    const char *str_poweriter = "STARSH_POWER_ITER";
+    const char *str_tolmode = "STARSH_TOLMODE";
+    const char *str_mpi_grid = "STARSH_MPI_GRID";
+    const char *str_mpi_dist = "STARSH_MPI_DIST";
     //starsh_params = starsh_params_default;
     int info = 0, i;
     // Set backend by STARSH_BACKEND
@@ -60,6 +81,26 @@ int starsh_init()
     // If attempt to use user-defined value fails, then use default one
     if(info != STARSH_SUCCESS)
         starsh_set_oversample(NULL);
+    // Set number of power iterations by STARSH_POWER_ITER
+    info = starsh_set_poweriter(getenv(str_poweriter));
+    // If attempt to use user-defined value fails, then use default one
+    if(info != STARSH_SUCCESS)
+        starsh_set_poweriter(NULL);
+    // Set meaning of tolerance by STARSH_TOLMODE
+    info = starsh_set_tolmode(getenv(str_tolmode));
+    // If attempt to use user-defined value fails, then use default one
+    if(info != STARSH_SUCCESS)
+        starsh_set_tolmode(NULL);
+    // Set shape of grid of MPI processes by STARSH_MPI_GRID
+    info = starsh_set_mpi_grid(getenv(str_mpi_grid));
+    // If attempt to use user-defined value fails, then use default one
+    if(info != STARSH_SUCCESS)
+        starsh_set_mpi_grid(NULL);
+    // Set distribution of tiles among MPI processes by STARSH_MPI_DIST
+    info = starsh_set_mpi_dist(getenv(str_mpi_dist));
+    // If attempt to use user-defined value fails, then use default one
+    if(info != STARSH_SUCCESS)
+        starsh_set_mpi_dist(NULL);
     return STARSH_SUCCESS;
 }
 
@@ -170,3 +211,157 @@ int starsh_set_oversample(const char *string)
     starsh_params.oversample = value;
     return STARSH_SUCCESS;
 }
+
+int starsh_set_poweriter(const char *string)
+//! Set maximum number of power iterations for randomized SVD.
+/*! @param[in] string: Environment variable and value, encoded in a string.
+ *      Example: "STARSH_POWER_ITER=2".
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_init().
+ * */
+{
+    int value;
+    if(string == NULL)
+    {
+        value = starsh_params_default.poweriter;
+    }
+    else
+    {
+        value = atoi(string);
+    }
+    if(value < 0)
+    {
+        fprintf(stderr, "Environment variable STARSH_POWER_ITER=%s is "
+                "invalid\n", string);
+        return STARSH_WRONG_PARAMETER;
+    }
+    fprintf(stderr, "Selected number of power iterations %d\n", value);
+    starsh_params.poweriter = value;
+    return STARSH_SUCCESS;
+}
+
+int starsh_set_tolmode(const char *string)
+//! Set meaning of error tolerance for approximation routines.
+/*! With `TILE` each far-field tile is approximated up to given relative
+ * error. With `GLOBAL` tolerance is distributed among tiles (see
+ * starsh_blrm__dtol()), so that relative error of the entire matrix is
+ * bounded instead.
+ *
+ * @param[in] string: Environment variable and value, encoded in a string.
+ *      Example: "STARSH_TOLMODE=GLOBAL".
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_init().
+ * */
+{
+    int i, selected = -1;
+    if(string == NULL)
+    {
+        selected = starsh_params_default.tolmode;
+    }
+    else
+    {
+        for(i = 0; i < TOLMODE_NUM; i++)
+        {
+            if(!strcmp(string, tolmode[i].string))
+            {
+                selected = i;
+                break;
+            }
+        }
+    }
+    if(selected == -1)
+    {
+        fprintf(stderr, "Environment variable STARSH_TOLMODE=%s is invalid\n",
+                string);
+        return STARSH_WRONG_PARAMETER;
+    }
+    starsh_params.tolmode = tolmode[selected].tolmode;
+    fprintf(stderr, "Selected tolerance mode is %s\n",
+            tolmode[selected].string);
+    return STARSH_SUCCESS;
+}
+
+int starsh_set_mpi_grid(const char *string)
+//! Set shape of grid of MPI processes for TLR distribution.
+/*! With `AUTO` number of rows of grid is the largest divisor of number of
+ * MPI processes, that does not exceed its square root. Otherwise, shape of
+ * grid is given as `PxQ` and it is checked against number of MPI processes
+ * only when distributed format is created.
+ *
+ * @param[in] string: Environment variable and value, encoded in a string.
+ *      Example: "STARSH_MPI_GRID=2x4".
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_init(), starsh_blrf_new_tlr_mpi().
+ * */
+{
+    int grid_nrows, grid_ncols;
+    char tail;
+    if(string == NULL)
+    {
+        grid_nrows = starsh_params_default.grid_nrows;
+        grid_ncols = starsh_params_default.grid_ncols;
+    }
+    else if(!strcmp(string, "AUTO"))
+    {
+        grid_nrows = 0;
+        grid_ncols = 0;
+    }
+    else if(sscanf(string, "%dx%d%c", &grid_nrows, &grid_ncols, &tail) != 2
+            || grid_nrows <= 0 || grid_ncols <= 0)
+    {
+        fprintf(stderr, "Environment variable STARSH_MPI_GRID=%s is "
+                "invalid\n", string);
+        return STARSH_WRONG_PARAMETER;
+    }
+    starsh_params.grid_nrows = grid_nrows;
+    starsh_params.grid_ncols = grid_ncols;
+    if(grid_nrows == 0)
+        fprintf(stderr, "Selected grid of MPI processes is AUTO\n");
+    else
+        fprintf(stderr, "Selected grid of MPI processes is %dx%d\n",
+                grid_nrows, grid_ncols);
+    return STARSH_SUCCESS;
+}
+
+int starsh_set_mpi_dist(const char *string)
+//! Set distribution of tiles among MPI processes.
+/*! With `CYCLIC` tiles are distributed by 2D block cycling over grid of MPI
+ * processes. With `COST` tiles are ordered along Hilbert curve and split into
+ * pieces of approximately equal estimated cost (see
+ * starsh_blrf_new_tlr_mpi()). With `REBALANCE` tiles are distributed as with
+ * `COST` and migrated after approximation to even out actual cost of
+ * multiplication (see starsh_blrm_rebalance_mpi()).
+ *
+ * @param[in] string: Environment variable and value, encoded in a string.
+ *      Example: "STARSH_MPI_DIST=COST".
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_init().
+ * */
+{
+    int i, selected = -1;
+    if(string == NULL)
+    {
+        selected = starsh_params_default.mpi_dist;
+    }
+    else
+    {
+        for(i = 0; i < MPI_DIST_NUM; i++)
+        {
+            if(!strcmp(string, mpi_dist[i].string))
+            {
+                selected = i;
+                break;
+            }
+        }
+    }
+    if(selected == -1)
+    {
+        fprintf(stderr, "Environment variable STARSH_MPI_DIST=%s is invalid\n",
+                string);
+        return STARSH_WRONG_PARAMETER;
+    }
+    starsh_params.mpi_dist = mpi_dist[selected].mpi_dist;
+    fprintf(stderr, "Selected distribution of tiles is %s\n",
+            mpi_dist[selected].string);
+    return STARSH_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/control/shared.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+#ifdef MPI
+#include "starsh-mpi.h"
+
+struct shared_segment
+//! Node-level shared memory segment and its MPI window.
+{
+    void *ptr;
+    //!< Pointer to memory of shared segment.
+    MPI_Win win;
+    //!< MPI window, that owns segment.
+};
+
+//! Communicator of MPI nodes, that share memory with current node.
+static MPI_Comm shared_comm = MPI_COMM_NULL;
+//! List of currently allocated shared segments.
+static struct shared_segment *shared_list = NULL;
+//! Number of currently allocated shared segments.
+static int shared_count = 0;
+
+int starsh_shared_new_mpi(void **ptr, const void *src, size_t nbytes)
+//! Allocate memory, shared by all MPI nodes of a single compute node.
+/*! Only one copy of data is stored on each compute node, which is useful for
+ * data, that is identical on all MPI nodes, like coordinates of particles or
+ * clusterization. Memory is allocated with MPI_Win_allocate_shared() by MPI
+ * node with local rank 0, and other MPI nodes of the same compute node get
+ * pointer to it. If `src` is not `NULL`, then its first `nbytes` bytes are
+ * copied into new memory by MPI node with local rank 0. Must be called by all
+ * MPI nodes, memory must be freed by starsh_shared_free_mpi(). Shared memory
+ * must not be modified after this call, as MPI nodes do not synchronize it
+ * afterwards.
+ *
+ * @param[out] ptr: Address of pointer to shared memory.
+ * @param[in] src: Data to copy into shared memory or `NULL`.
+ * @param[in] nbytes: Size of memory in bytes.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_shared_free_mpi().
+ * @ingroup blrf
+ * */
+{
+    MPI_Aint size;
+    void *base;
+    int disp_unit, shared_rank;
+    if(ptr == NULL)
+    {
+        STARSH_ERROR("Invalid value of `ptr`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(shared_comm == MPI_COMM_NULL)
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0,
+                MPI_INFO_NULL, &shared_comm);
+    MPI_Comm_rank(shared_comm, &shared_rank);
+    STARSH_REALLOC(shared_list, shared_count+1);
+    // Allocate at least one byte, so that all segments have different
+    // addresses
+    size = shared_rank == 0 ? nbytes+1 : 0;
+    MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, shared_comm, &base,
+            &shared_list[shared_count].win);
+    MPI_Win_shared_query(shared_list[shared_count].win, 0, &size, &disp_unit,
+            &base);
+    shared_list[shared_count].ptr = base;
+    shared_count++;
+    if(src != NULL && shared_rank == 0)
+        memcpy(base, src, nbytes);
+    // Make data, written by local rank 0, visible to other MPI nodes
+    MPI_Win_fence(0, shared_list[shared_count-1].win);
+    *ptr = base;
+    return STARSH_SUCCESS;
+}
+
+void starsh_shared_free_mpi(void *ptr)
+//! Free memory, allocated by starsh_shared_new_mpi() or malloc().
+/*! If `ptr` was allocated by starsh_shared_new_mpi(), then it is freed
+ * collectively by all MPI nodes, sharing it. Otherwise, `ptr` is simply
+ * freed by free(), so this function can be used instead of free() for
+ * data, that may reside in shared memory.
+ *
+ * @param[in] ptr: Pointer to memory.
+ * @sa starsh_shared_new_mpi().
+ * @ingroup blrf
+ * */
+{
+    int i;
+    for(i = 0; i < shared_count; i++)
+        if(shared_list[i].ptr == ptr)
+            break;
+    if(i == shared_count)
+    {
+        free(ptr);
+        return;
+    }
+    MPI_Win_free(&shared_list[i].win);
+    shared_list[i] = shared_list[--shared_count];
+    if(shared_count == 0)
+    {
+        free(shared_list);
+        shared_list = NULL;
+    }
+}
+
+#endif // MPI
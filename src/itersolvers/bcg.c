@@ -0,0 +1,164 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/itersolvers/bcg.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include <float.h>
+#include "common.h"
+#include "starsh.h"
+
+static int dbcg_orth(int n, int ncols, double *W, double *P, double *G,
+        double *T, double *w, double *work)
+//! Get orthonormal basis of columns of `W` and return its size.
+/*! Basis is computed with the help of eigenvalue decomposition of Gram
+ * matrix `W^T*W`, so it requires only BLAS-3 operations on tall matrices.
+ * Directions, corresponding to relatively small eigenvalues, are dropped,
+ * so that linearly dependent search directions do not lead to breakdown.
+ * */
+{
+    int i, k = 0;
+    if(ncols == 0)
+        return 0;
+    cblas_dsyrk(CblasColMajor, CblasUpper, CblasTrans, ncols, n, 1.0, W, n,
+            0.0, G, ncols);
+    if(LAPACKE_dsyev_work(LAPACK_COL_MAJOR, 'V', 'U', ncols, G, ncols, w,
+                work, 3*ncols) != 0)
+        return 0;
+    // Eigenvalues are in ascending order
+    double thr = w[ncols-1]*n*DBL_EPSILON;
+    for(i = ncols-1; i >= 0 && w[i] > thr; i--)
+    {
+        cblas_dcopy(ncols, G+(size_t)i*ncols, 1, T+(size_t)k*ncols, 1);
+        cblas_dscal(ncols, 1.0/sqrt(w[i]), T+(size_t)k*ncols, 1);
+        k++;
+    }
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, ncols, 1.0,
+            W, n, T, ncols, 0.0, P, n);
+    return k;
+}
+
+int starsh_itersolvers__dbcg_omp(STARSH_blrm *matrix, int nrhs, double *B,
+        int ldb, double *X, int ldx, double tol, double *work)
+//! Block conjugate gradient method for @ref STARSH_blrm object.
+/*! All right hand sides share the same Krylov space, so each of them
+ * converges at least as fast as with separate conjugate gradient methods.
+ * Search directions are kept orthonormal, linearly dependent directions are
+ * dropped as in breakdown-free block CG, and all the inner products and
+ * updates are done by GEMM. Columns, that converged, are deflated: their
+ * solutions are written into `X` and they are excluded from the following
+ * iterations, so number of columns of matrix-vector product by @ref
+ * starsh_blrm__dmml_omp() decreases. Column converges, when its residual is
+ * `tol` times smaller than its initial residual.
+ *
+ * @param[in] matrix: Block-wise low-rank symmetric positive definite
+ *      matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `4*n*nrhs+3*nrhs*nrhs+5*nrhs`.
+ * @return Number of iterations or -1 if not converged.
+ * @sa starsh_itersolvers__dcg_omp().
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    size_t nn = (size_t)n*nrhs;
+    // Solution, residual, search directions and their product by matrix
+    // for active columns
+    double *Xa = work, *R = Xa+nn, *P = R+nn, *Q = P+nn;
+    double *G = Q+nn, *PQ = G+nrhs*nrhs, *C = PQ+nrhs*nrhs;
+    double *w = C+nrhs*nrhs, *rscheck = w+nrhs, *syev_work = rscheck+nrhs;
+    int *idx;
+    int i, j, nact = 0, k;
+    STARSH_MALLOC(idx, nrhs);
+    // Initial residual
+    for(j = 0; j < nrhs; j++)
+        cblas_dcopy(n, X+(size_t)ldx*j, 1, Xa+(size_t)n*j, 1);
+    starsh_blrm__dmml_omp(M, nrhs, -1.0, Xa, n, 0.0, R, n);
+    for(j = 0; j < nrhs; j++)
+        cblas_daxpy(n, 1., B+(size_t)ldb*j, 1, R+(size_t)n*j, 1);
+    // Columns with zero residual are already solved
+    for(j = 0; j < nrhs; j++)
+    {
+        double norm = cblas_dnrm2(n, R+(size_t)n*j, 1);
+        if(norm == 0.)
+            continue;
+        if(nact != j)
+        {
+            cblas_dcopy(n, Xa+(size_t)n*j, 1, Xa+(size_t)n*nact, 1);
+            cblas_dcopy(n, R+(size_t)n*j, 1, R+(size_t)n*nact, 1);
+        }
+        rscheck[nact] = norm*tol;
+        idx[nact] = j;
+        nact++;
+    }
+    if(nact == 0)
+    {
+        free(idx);
+        return 0;
+    }
+    // Initial search directions
+    k = dbcg_orth(n, nact, R, P, G, C, w, syev_work);
+    for(i = 0; i < n; i++)
+    {
+        if(k == 0)
+            break;
+        starsh_blrm__dmml_omp(M, k, 1.0, P, n, 0.0, Q, n);
+        // alpha = (P^T*Q)^{-1} * P^T*R
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, k, k, n, 1.0, P,
+                n, Q, n, 0.0, PQ, k);
+        if(LAPACKE_dpotrf_work(LAPACK_COL_MAJOR, 'L', k, PQ, k) != 0)
+            break;
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, k, nact, n, 1.0,
+                P, n, R, n, 0.0, C, k);
+        LAPACKE_dpotrs_work(LAPACK_COL_MAJOR, 'L', k, nact, PQ, k, C, k);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, nact, k,
+                1.0, P, n, C, k, 1.0, Xa, n);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, nact, k,
+                -1.0, Q, n, C, k, 1.0, R, n);
+        // Deflate converged columns
+        for(j = nact-1; j >= 0; j--)
+        {
+            if(cblas_dnrm2(n, R+(size_t)n*j, 1) >= rscheck[j])
+                continue;
+            cblas_dcopy(n, Xa+(size_t)n*j, 1, X+(size_t)ldx*idx[j], 1);
+            nact--;
+            if(j == nact)
+                continue;
+            cblas_dcopy(n, Xa+(size_t)n*nact, 1, Xa+(size_t)n*j, 1);
+            cblas_dcopy(n, R+(size_t)n*nact, 1, R+(size_t)n*j, 1);
+            rscheck[j] = rscheck[nact];
+            idx[j] = idx[nact];
+        }
+        if(nact == 0)
+        {
+            free(idx);
+            return i+1;
+        }
+        // beta = -(P^T*Q)^{-1} * Q^T*R, new directions are orthonormal basis
+        // of R+P*beta
+        cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, k, nact, n, 1.0,
+                Q, n, R, n, 0.0, C, k);
+        LAPACKE_dpotrs_work(LAPACK_COL_MAJOR, 'L', k, nact, PQ, k, C, k);
+        LAPACKE_dlacpy_work(LAPACK_COL_MAJOR, 'A', n, nact, R, n, Q, n);
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, nact, k,
+                -1.0, P, n, C, k, 1.0, Q, n);
+        k = dbcg_orth(n, nact, Q, P, G, C, w, syev_work);
+    }
+    // Write solutions of columns, that did not converge
+    for(j = 0; j < nact; j++)
+        cblas_dcopy(n, Xa+(size_t)n*j, 1, X+(size_t)ldx*idx[j], 1);
+    free(idx);
+    return -1;
+}
@@ -0,0 +1,266 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/itersolvers/bicgstab.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-mpi.h"
+
+static void dbicgstab_mml(STARSH_blrm *M, int nrhs, double *A, int lda,
+        double *B, int ldb, int mpi)
+//! Multiply matrix by local or distributed vectors: `B = M*A`.
+{
+#ifdef MPI
+    if(mpi)
+    {
+        starsh_blrm__dmml_mpi_dist(M, nrhs, 1.0, A, lda, 0.0, B, ldb);
+        return;
+    }
+#endif
+    starsh_blrm__dmml_omp(M, nrhs, 1.0, A, lda, 0.0, B, ldb);
+}
+
+static void dbicgstab_sum(double *buf, int count, int mpi)
+//! Sum up local parts of dot products over all MPI nodes.
+{
+#ifdef MPI
+    if(mpi)
+        MPI_Allreduce(MPI_IN_PLACE, buf, count, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+#endif
+}
+
+static int dbicgstab(STARSH_blrm *M, int n, int maxiter, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work,
+        int mpi)
+//! BiCGStab on `n` local rows of all right hand sides at once.
+/*! Each iteration requires 2 matrix-vector products and 3 global
+ * reductions. Converged columns are moved to the end, so that only active
+ * columns take part in matrix-vector products.
+ * */
+{
+    size_t nn = (size_t)n*nrhs;
+    // Residual, shadow residual, search directions and products of matrix
+    // by search directions and by intermediate residual
+    double *R = work, *Rh = R+nn, *P = Rh+nn, *V = P+nn, *T = V+nn;
+    double *rscheck = T+nn, *rho = rscheck+nrhs, *alpha = rho+nrhs;
+    double *omega = alpha+nrhs, *dot = omega+nrhs;
+    int *idx;
+    int i, j, nact = 0;
+    STARSH_MALLOC(idx, nrhs);
+    // Initial residual
+    dbicgstab_mml(M, nrhs, X, ldx, R, n, mpi);
+    for(j = 0; j < nrhs; j++)
+    {
+        double *r = R+(size_t)n*j;
+        cblas_dscal(n, -1.0, r, 1);
+        cblas_daxpy(n, 1.0, B+(size_t)ldb*j, 1, r, 1);
+        rho[j] = cblas_ddot(n, r, 1, r, 1);
+    }
+    dbicgstab_sum(rho, nrhs, mpi);
+    // Columns with zero residual are already solved
+    for(j = 0; j < nrhs; j++)
+    {
+        if(rho[j] == 0.)
+            continue;
+        if(nact != j)
+            cblas_dcopy(n, R+(size_t)n*j, 1, R+(size_t)n*nact, 1);
+        rscheck[nact] = sqrt(rho[j])*tol;
+        rho[nact] = rho[j];
+        idx[nact] = j;
+        nact++;
+    }
+    if(nact == 0)
+    {
+        free(idx);
+        return 0;
+    }
+    // Shadow residual is equal to initial residual
+    cblas_dcopy(n*nact, R, 1, Rh, 1);
+    cblas_dcopy(n*nact, R, 1, P, 1);
+    for(i = 0; i < maxiter; i++)
+    {
+        dbicgstab_mml(M, nact, P, n, V, n, mpi);
+        for(j = 0; j < nact; j++)
+            alpha[j] = cblas_ddot(n, Rh+(size_t)n*j, 1, V+(size_t)n*j, 1);
+        dbicgstab_sum(alpha, nact, mpi);
+        // Intermediate residual s = r - alpha*v overwrites r
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            alpha[j] = alpha[j] == 0. ? 0. : rho[j]/alpha[j];
+            cblas_daxpy(n, -alpha[j], V+(size_t)n*j, 1, R+(size_t)n*j, 1);
+        }
+        dbicgstab_mml(M, nact, R, n, T, n, mpi);
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            double *t = T+(size_t)n*j;
+            dot[2*j] = cblas_ddot(n, t, 1, R+(size_t)n*j, 1);
+            dot[2*j+1] = cblas_ddot(n, t, 1, t, 1);
+        }
+        dbicgstab_sum(dot, 2*nact, mpi);
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            double *x = X+(size_t)ldx*idx[j], *r = R+(size_t)n*j;
+            omega[j] = dot[2*j+1] == 0. ? 0. : dot[2*j]/dot[2*j+1];
+            cblas_daxpy(n, alpha[j], P+(size_t)n*j, 1, x, 1);
+            cblas_daxpy(n, omega[j], r, 1, x, 1);
+            cblas_daxpy(n, -omega[j], T+(size_t)n*j, 1, r, 1);
+            dot[2*j] = cblas_ddot(n, r, 1, r, 1);
+            dot[2*j+1] = cblas_ddot(n, Rh+(size_t)n*j, 1, r, 1);
+        }
+        dbicgstab_sum(dot, 2*nact, mpi);
+        // Exclude converged columns
+        for(j = nact-1; j >= 0; j--)
+        {
+            if(sqrt(dot[2*j]) >= rscheck[j])
+                continue;
+            nact--;
+            if(j == nact)
+                continue;
+            cblas_dcopy(n, R+(size_t)n*nact, 1, R+(size_t)n*j, 1);
+            cblas_dcopy(n, Rh+(size_t)n*nact, 1, Rh+(size_t)n*j, 1);
+            cblas_dcopy(n, P+(size_t)n*nact, 1, P+(size_t)n*j, 1);
+            cblas_dcopy(n, V+(size_t)n*nact, 1, V+(size_t)n*j, 1);
+            rscheck[j] = rscheck[nact];
+            rho[j] = rho[nact];
+            alpha[j] = alpha[nact];
+            omega[j] = omega[nact];
+            dot[2*j] = dot[2*nact];
+            dot[2*j+1] = dot[2*nact+1];
+            idx[j] = idx[nact];
+        }
+        if(nact == 0)
+        {
+            free(idx);
+            return i+1;
+        }
+        // New search directions p = r + beta*(p - omega*v)
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            double *p = P+(size_t)n*j, *r = R+(size_t)n*j;
+            if(dot[2*j+1] == 0. || omega[j] == 0.)
+            {
+                // Breakdown, restart with new shadow residual
+                cblas_dcopy(n, r, 1, Rh+(size_t)n*j, 1);
+                cblas_dcopy(n, r, 1, p, 1);
+                rho[j] = dot[2*j];
+                continue;
+            }
+            double beta = dot[2*j+1]/rho[j]*alpha[j]/omega[j];
+            cblas_daxpy(n, -omega[j], V+(size_t)n*j, 1, p, 1);
+            cblas_dscal(n, beta, p, 1);
+            cblas_daxpy(n, 1.0, r, 1, p, 1);
+            rho[j] = dot[2*j+1];
+        }
+    }
+    free(idx);
+    return -1;
+}
+
+int starsh_itersolvers__dbicgstab_omp(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work)
+//! Biconjugate gradient stabilized method for @ref STARSH_blrm object.
+/*! Solves non-symmetric systems with short recurrences, so memory
+ * requirements do not grow with number of iterations, unlike
+ * starsh_itersolvers__dgmres_omp(). All right hand sides are processed at
+ * once by starsh_blrm__dmml_omp(). Column converges, when its residual is
+ * `tol` times smaller than its initial residual, and it is excluded from
+ * following matrix-vector products.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `5*n*nrhs+6*nrhs`.
+ * @return Number of iterations or -1 if not converged.
+ * @sa starsh_itersolvers__dgmres_omp().
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    return dbicgstab(M, n, n, nrhs, B, ldb, X, ldx, tol, work, 0);
+}
+
+#ifdef MPI
+int starsh_itersolvers__dbicgstab_mpi(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work)
+//! Biconjugate gradient stabilized method on MPI nodes.
+/*! Right hand side and initial solution are distributed among MPI nodes,
+ * solved by @ref starsh_itersolvers__dbicgstab_mpi_dist() and total
+ * solution is collected back on root node.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `5*n_local*nrhs+6*nrhs`, where
+ *      `n_local` is a number of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_int n_local;
+    double *B_local, *X_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    STARSH_MALLOC(B_local, nrhs*n_local+1);
+    STARSH_MALLOC(X_local, nrhs*n_local+1);
+    starsh_blrf_scatter_vector_mpi(F, 'R', nrhs, B, ldb, B_local, n_local);
+    starsh_blrf_scatter_vector_mpi(F, 'C', nrhs, X, ldx, X_local, n_local);
+    int iter = starsh_itersolvers__dbicgstab_mpi_dist(M, nrhs, B_local,
+            n_local, X_local, n_local, tol, work);
+    starsh_blrf_gather_vector_mpi(F, 'C', nrhs, X_local, n_local, X, ldx);
+    free(B_local);
+    free(X_local);
+    return iter;
+}
+
+int starsh_itersolvers__dbicgstab_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work)
+//! Biconjugate gradient stabilized method for distributed vectors.
+/*! Right hand side, solution and all temporary vectors are distributed among
+ * MPI nodes as described in @ref starsh_blrf_get_vector_size_mpi(). Matrix
+ * is multiplied by @ref starsh_blrm__dmml_mpi_dist() and dot products are
+ * summed up by `MPI_Allreduce`, 3 times per iteration.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Local rows of right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Local rows of initial solution as input, local rows of
+ *      total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `5*n_local*nrhs+6*nrhs`, where
+ *      `n_local` is a number of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    STARSH_int n_local;
+    starsh_blrf_get_vector_size_mpi(M->format, 'R', &n_local);
+    return dbicgstab(M, n_local, n, nrhs, B, ldb, X, ldx, tol, work, 1);
+}
+#endif // MPI
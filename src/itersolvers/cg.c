@@ -96,7 +96,11 @@ int starsh_itersolvers__dcg_omp(STARSH_blrm *matrix, int nrhs, double *B,
 int starsh_itersolvers__dcg_mpi(STARSH_blrm *matrix, int nrhs, double *B,
         int ldb, double *X, int ldx, double tol, double *work)
 //! Conjugate gradient method for @ref STARSH_blrm object on MPI nodes.
-/*! @param[in] matrix: Block-wise low-rank matrix.
+/*! Right hand side and initial solution are distributed among MPI nodes,
+ * solved by @ref starsh_itersolvers__dcg_mpi_dist() and total solution is
+ * collected back on root node.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
  * @param[in] nrhs: Number of right havd sides.
  * @param[in] B: Right hand side.
  * @param[in] ldb: Leading dimension of `B`.
@@ -107,76 +111,284 @@ int starsh_itersolvers__dcg_mpi(STARSH_blrm *matrix, int nrhs, double *B,
  * @return Number of iterations or -1 if not converged.
  * @ingroup solvers
  * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_int n_local;
+    double *B_local, *X_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    STARSH_MALLOC(B_local, nrhs*n_local+1);
+    STARSH_MALLOC(X_local, nrhs*n_local+1);
+    starsh_blrf_scatter_vector_mpi(F, 'R', nrhs, B, ldb, B_local, n_local);
+    starsh_blrf_scatter_vector_mpi(F, 'C', nrhs, X, ldx, X_local, n_local);
+    int iter = starsh_itersolvers__dcg_mpi_dist(M, nrhs, B_local, n_local,
+            X_local, n_local, tol, work);
+    starsh_blrf_gather_vector_mpi(F, 'C', nrhs, X_local, n_local, X, ldx);
+    free(B_local);
+    free(X_local);
+    return iter;
+}
+
+int starsh_itersolvers__dcg_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work)
+//! Conjugate gradient method for distributed vectors on MPI nodes.
+/*! Right hand side, solution and all temporary vectors are distributed among
+ * MPI nodes as described in @ref starsh_blrf_get_vector_size_mpi(), so
+ * each node works only with its local rows. Matrix is multiplied by @ref
+ * starsh_blrm__dmml_mpi_dist() and dot products are summed up by
+ * `MPI_Allreduce`.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right havd sides.
+ * @param[in] B: Local rows of right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Local rows of initial solution as input, local rows of
+ *      total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `3*n_local*nrhs+3*nrhs`, where
+ *      `n_local` is a number of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
 {
     STARSH_blrm *M = matrix;
     int n = M->format->problem->shape[0];
+    STARSH_int n_local;
+    starsh_blrf_get_vector_size_mpi(M->format, 'R', &n_local);
     double *R = work;
-    double *P = R+n*nrhs;
-    double *next_P = P+n*nrhs;
-    double *rscheck = next_P+n*nrhs;
+    double *P = R+n_local*nrhs;
+    double *next_P = P+n_local*nrhs;
+    double *rscheck = next_P+n_local*nrhs;
     double *rsold = rscheck+nrhs;
     double *rsnew = rsold+nrhs;
     int i;
     int finished = 0;
-    int mpi_size, mpi_rank;
-    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    int mpi_rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
-    starsh_blrm__dmml_mpi_tlr(M, nrhs, -1.0, X, ldx, 0.0, R, n);
-    if(mpi_rank == 0)
+    starsh_blrm__dmml_mpi_dist(M, nrhs, -1.0, X, ldx, 0.0, R, n_local);
+    for(i = 0; i < nrhs; i++)
+        cblas_daxpy(n_local, 1., B+ldb*i, 1, R+n_local*i, 1);
+    cblas_dcopy(n_local*nrhs, R, 1, P, 1);
+    for(i = 0; i < nrhs; i++)
+        rsold[i] = cblas_ddot(n_local, R+n_local*i, 1, R+n_local*i, 1);
+    MPI_Allreduce(MPI_IN_PLACE, rsold, nrhs, MPI_DOUBLE, MPI_SUM,
+            MPI_COMM_WORLD);
+    for(i = 0; i < nrhs; i++)
+        rscheck[i] = sqrt(rsold[i])*tol;
+    for(i = 0; i < n; i++)
     {
-        for(i = 0; i < nrhs; i++)
-            cblas_daxpy(n, 1., B+ldb*i, 1, R+n*i, 1);
-        cblas_dcopy(n*nrhs, R, 1, P, 1);
-        for(i = 0; i < nrhs; i++)
+        starsh_blrm__dmml_mpi_dist(M, nrhs, 1.0, P, n_local, 0.0, next_P,
+                n_local);
+        // rsnew temporarily holds p^T A p
+        for(int j = 0; j < nrhs; j++)
+            rsnew[j] = cblas_ddot(n_local, P+n_local*j, 1,
+                    next_P+n_local*j, 1);
+        MPI_Allreduce(MPI_IN_PLACE, rsnew, nrhs, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+        for(int j = 0; j < nrhs; j++)
         {
-            rsold[i] = cblas_dnrm2(n, R+n*i, 1);
-            rscheck[i] = rsold[i]*tol;
-            rsnew[i] = rscheck[i];
-            rsold[i] *= rsold[i];
+            if(rscheck[j] < 0)
+                continue;
+            double *p = P+n_local*j;
+            double *next_p = next_P+n_local*j;
+            double *r = R+n_local*j;
+            double *x = X+ldx*j;
+            double alpha = rsold[j]/rsnew[j];
+            cblas_daxpy(n_local, alpha, p, 1, x, 1);
+            cblas_daxpy(n_local, -alpha, next_p, 1, r, 1);
+            rsnew[j] = cblas_ddot(n_local, r, 1, r, 1);
         }
-    }
-    //printf("rsold=%e\n", rsold);
-    for(i = 0; i < n; i++)
-    {
-        starsh_blrm__dmml_mpi_tlr(M, nrhs, 1.0, P, n, 0.0, next_P, n);
-        if(mpi_rank == 0)
+        MPI_Allreduce(MPI_IN_PLACE, rsnew, nrhs, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+        for(int j = 0; j < nrhs; j++)
         {
-            for(int j = 0; j < nrhs; j++)
+            if(rscheck[j] < 0)
+                continue;
+            double *p = P+n_local*j;
+            double *r = R+n_local*j;
+            if(sqrt(rsnew[j]) < rscheck[j])
             {
-                if(rscheck[j] < 0)
-                    continue;
-                double *p = P+n*j;
-                double *next_p = next_P+n*j;
-                double *r = R+n*j;
-                double *x = X+ldx*j;
-                double tmp = cblas_ddot(n, p, 1, next_p, 1);
-                double alpha = rsold[j]/tmp;
-                cblas_daxpy(n, alpha, p, 1, x, 1);
-                cblas_daxpy(n, -alpha, next_p, 1, r, 1);
-                rsnew[j] = cblas_dnrm2(n, r, 1);
-                if(rsnew[j] < rscheck[j])
-                {
-                    finished++;
-                    rscheck[j] = -1.;
+                finished++;
+                rscheck[j] = -1.;
+                if(mpi_rank == 0)
                     printf("%d solve in %d iterations\n", j, i+1);
-                    continue;
-                }
-                rsnew[j] *= rsnew[j];
-                cblas_dscal(n, rsnew[j]/rsold[j], p, 1);
-                cblas_daxpy(n, 1., r, 1, p, 1);
-                rsold[j] = rsnew[j];
+                continue;
             }
+            cblas_dscal(n_local, rsnew[j]/rsold[j], p, 1);
+            cblas_daxpy(n_local, 1., r, 1, p, 1);
+            rsold[j] = rsnew[j];
         }
-        MPI_Bcast(&finished, 1, MPI_INT, 0, MPI_COMM_WORLD);
         if(finished == nrhs)
+            return i;
+    }
+    return -1;
+}
+
+int starsh_itersolvers__dpipecg_mpi(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work)
+//! Pipelined conjugate gradient method for @ref STARSH_blrm on MPI nodes.
+/*! Right hand side and initial solution are distributed among MPI nodes,
+ * solved by @ref starsh_itersolvers__dpipecg_mpi_dist() and total solution
+ * is collected back on root node.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `6*n_local*nrhs+5*nrhs`, where
+ *      `n_local` is a number of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_int n_local;
+    double *B_local, *X_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    STARSH_MALLOC(B_local, nrhs*n_local+1);
+    STARSH_MALLOC(X_local, nrhs*n_local+1);
+    starsh_blrf_scatter_vector_mpi(F, 'R', nrhs, B, ldb, B_local, n_local);
+    starsh_blrf_scatter_vector_mpi(F, 'C', nrhs, X, ldx, X_local, n_local);
+    int iter = starsh_itersolvers__dpipecg_mpi_dist(M, nrhs, B_local,
+            n_local, X_local, n_local, tol, work);
+    starsh_blrf_gather_vector_mpi(F, 'C', nrhs, X_local, n_local, X, ldx);
+    free(B_local);
+    free(X_local);
+    return iter;
+}
+
+int starsh_itersolvers__dpipecg_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, double tol, double *work)
+//! Pipelined conjugate gradient method for distributed vectors.
+/*! Communication hiding variant of @ref starsh_itersolvers__dcg_mpi_dist()
+ * by Ghysels and Vanroose. Both dot products of an iteration are summed up
+ * by a single non-blocking `MPI_Iallreduce`, which is overlapped with
+ * matrix-vector product by @ref starsh_blrm__dmml_mpi_dist(), so there is
+ * no global synchronization on critical path. It requires 3 more vectors
+ * than @ref starsh_itersolvers__dcg_mpi_dist() and its residual is updated
+ * by longer recurrences, so attainable accuracy may be slightly worse.
+ * Columns, that converged, are excluded from following matrix-vector
+ * products.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Local rows of right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Local rows of initial solution as input, local rows of
+ *      total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `6*n_local*nrhs+5*nrhs`, where
+ *      `n_local` is a number of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    STARSH_int n_local;
+    starsh_blrf_get_vector_size_mpi(M->format, 'R', &n_local);
+    size_t nn = (size_t)n_local*nrhs;
+    // Residual r, w=A*r, q=A*w, search directions p, s=A*p and z=A*s
+    double *R = work, *W = R+nn, *Q = W+nn, *P = Q+nn, *S = P+nn, *Z = S+nn;
+    // Buffer for dot products (r,r) and (w,r) of each column
+    double *dot = Z+nn, *rscheck = dot+2*nrhs;
+    double *gamma_old = rscheck+nrhs, *alpha_old = gamma_old+nrhs;
+    int *idx;
+    int i, j, nact = nrhs;
+    MPI_Request request;
+    STARSH_MALLOC(idx, nrhs);
+    for(j = 0; j < nrhs; j++)
+        idx[j] = j;
+    starsh_blrm__dmml_mpi_dist(M, nrhs, -1.0, X, ldx, 0.0, R, n_local);
+    for(j = 0; j < nrhs; j++)
+        cblas_daxpy(n_local, 1., B+ldb*(size_t)j, 1, R+n_local*(size_t)j, 1);
+    starsh_blrm__dmml_mpi_dist(M, nrhs, 1.0, R, n_local, 0.0, W, n_local);
+    for(i = 0; i < n; i++)
+    {
+        for(j = 0; j < nact; j++)
         {
-            // Since I keep result only on root node, following code is
-            // commented
-            //for(int k = 0; k < nrhs; k++)
-            //    MPI_Bcast(X+k*ldx, n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+            double *r = R+n_local*(size_t)j;
+            dot[2*j] = cblas_ddot(n_local, r, 1, r, 1);
+            dot[2*j+1] = cblas_ddot(n_local, W+n_local*(size_t)j, 1, r, 1);
+        }
+        MPI_Iallreduce(MPI_IN_PLACE, dot, 2*nact, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD, &request);
+        // Matrix-vector product overlaps with reduction of dot products
+        starsh_blrm__dmml_mpi_dist(M, nact, 1.0, W, n_local, 0.0, Q,
+                n_local);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        if(i == 0)
+            for(j = 0; j < nact; j++)
+                rscheck[j] = sqrt(dot[2*j])*tol;
+        // Exclude converged columns
+        for(j = nact-1; j >= 0; j--)
+        {
+            if(dot[2*j] > 0. && sqrt(dot[2*j]) >= rscheck[j])
+                continue;
+            nact--;
+            if(j == nact)
+                continue;
+            cblas_dcopy(n_local, R+n_local*(size_t)nact, 1,
+                    R+n_local*(size_t)j, 1);
+            cblas_dcopy(n_local, W+n_local*(size_t)nact, 1,
+                    W+n_local*(size_t)j, 1);
+            cblas_dcopy(n_local, Q+n_local*(size_t)nact, 1,
+                    Q+n_local*(size_t)j, 1);
+            cblas_dcopy(n_local, P+n_local*(size_t)nact, 1,
+                    P+n_local*(size_t)j, 1);
+            cblas_dcopy(n_local, S+n_local*(size_t)nact, 1,
+                    S+n_local*(size_t)j, 1);
+            cblas_dcopy(n_local, Z+n_local*(size_t)nact, 1,
+                    Z+n_local*(size_t)j, 1);
+            dot[2*j] = dot[2*nact];
+            dot[2*j+1] = dot[2*nact+1];
+            rscheck[j] = rscheck[nact];
+            gamma_old[j] = gamma_old[nact];
+            alpha_old[j] = alpha_old[nact];
+            idx[j] = idx[nact];
+        }
+        if(nact == 0)
+        {
+            free(idx);
             return i;
         }
+        for(j = 0; j < nact; j++)
+        {
+            double gamma = dot[2*j], delta = dot[2*j+1], alpha, beta;
+            size_t shift = n_local*(size_t)j;
+            if(i == 0)
+            {
+                beta = 0.;
+                alpha = gamma/delta;
+                cblas_dcopy(n_local, Q+shift, 1, Z+shift, 1);
+                cblas_dcopy(n_local, W+shift, 1, S+shift, 1);
+                cblas_dcopy(n_local, R+shift, 1, P+shift, 1);
+            }
+            else
+            {
+                beta = gamma/gamma_old[j];
+                alpha = gamma/(delta-beta*gamma/alpha_old[j]);
+                cblas_dscal(n_local, beta, Z+shift, 1);
+                cblas_daxpy(n_local, 1., Q+shift, 1, Z+shift, 1);
+                cblas_dscal(n_local, beta, S+shift, 1);
+                cblas_daxpy(n_local, 1., W+shift, 1, S+shift, 1);
+                cblas_dscal(n_local, beta, P+shift, 1);
+                cblas_daxpy(n_local, 1., R+shift, 1, P+shift, 1);
+            }
+            cblas_daxpy(n_local, alpha, P+shift, 1, X+ldx*(size_t)idx[j], 1);
+            cblas_daxpy(n_local, -alpha, S+shift, 1, R+shift, 1);
+            cblas_daxpy(n_local, -alpha, Z+shift, 1, W+shift, 1);
+            gamma_old[j] = gamma;
+            alpha_old[j] = alpha;
+        }
     }
+    free(idx);
     return -1;
 }
 #endif // MPI
@@ -0,0 +1,320 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/itersolvers/gmres.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+#include "starsh-mpi.h"
+
+static void dgmres_mml(STARSH_blrm *M, int nrhs, double *A, int lda,
+        double *B, int ldb, int mpi)
+//! Multiply matrix by local or distributed vectors: `B = M*A`.
+{
+#ifdef MPI
+    if(mpi)
+    {
+        starsh_blrm__dmml_mpi_dist(M, nrhs, 1.0, A, lda, 0.0, B, ldb);
+        return;
+    }
+#endif
+    starsh_blrm__dmml_omp(M, nrhs, 1.0, A, lda, 0.0, B, ldb);
+}
+
+static void dgmres_sum(double *buf, int count, int mpi)
+//! Sum up local parts of dot products over all MPI nodes.
+{
+#ifdef MPI
+    if(mpi)
+        MPI_Allreduce(MPI_IN_PLACE, buf, count, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+#endif
+}
+
+static int dgmres(STARSH_blrm *M, int n, int maxiter, int nrhs, double *B,
+        int ldb, double *X, int ldx, int restart, double tol, double *work,
+        int mpi)
+//! Restarted GMRES on `n` local rows of all right hand sides at once.
+/*! Krylov vectors of all active columns are stored in slices, so that
+ * `k`-th vectors of all columns form a contiguous `n`-by-`nact` matrix for
+ * matrix-vector product and all Krylov vectors of `j`-th column form a
+ * matrix with leading dimension `n*nrhs` for BLAS-2 orthogonalization.
+ * Orthogonalization is done by classical Gram-Schmidt with one step of
+ * reorthogonalization, as it requires only 3 global reductions per
+ * iteration.
+ * */
+{
+    int m = restart;
+    size_t nn = (size_t)n*nrhs;
+    // MPI node may have no local rows, but BLAS requires positive leading
+    // dimension
+    size_t ldv = nn > 0 ? nn : 1;
+    // Krylov vectors, Hessenberg matrices, Givens rotations, right hand sides
+    // of least squares problems and temporary dot products
+    double *V = work, *H = V+nn*(m+1);
+    double *cs = H+(size_t)nrhs*(m+1)*m, *sn = cs+nrhs*m, *g = sn+nrhs*m;
+    double *h = g+nrhs*(m+1), *beta = h+nrhs*(m+1), *rscheck = beta+nrhs;
+    int *idx, *kdim;
+    int i, j, k, nact = nrhs, iter = 0, first = 1;
+    STARSH_MALLOC(idx, 2*nrhs);
+    kdim = idx+nrhs;
+    for(j = 0; j < nrhs; j++)
+        idx[j] = j;
+    while(1)
+    {
+        // Residual of active columns, second slice is a temporary buffer
+        for(j = 0; j < nact; j++)
+            cblas_dcopy(n, X+(size_t)ldx*idx[j], 1, V+nn+(size_t)n*j, 1);
+        dgmres_mml(M, nact, V+nn, n, V, n, mpi);
+        for(j = 0; j < nact; j++)
+        {
+            double *r = V+(size_t)n*j;
+            cblas_dscal(n, -1.0, r, 1);
+            cblas_daxpy(n, 1.0, B+(size_t)ldb*idx[j], 1, r, 1);
+            beta[j] = cblas_ddot(n, r, 1, r, 1);
+        }
+        dgmres_sum(beta, nact, mpi);
+        for(j = 0; j < nact; j++)
+        {
+            beta[j] = sqrt(beta[j]);
+            if(first)
+                rscheck[idx[j]] = beta[j]*tol;
+        }
+        first = 0;
+        // Exclude converged columns
+        k = 0;
+        for(j = 0; j < nact; j++)
+        {
+            if(beta[j] == 0. || beta[j] < rscheck[idx[j]])
+                continue;
+            if(k != j)
+                cblas_dcopy(n, V+(size_t)n*j, 1, V+(size_t)n*k, 1);
+            beta[k] = beta[j];
+            idx[k] = idx[j];
+            k++;
+        }
+        nact = k;
+        if(nact == 0)
+        {
+            free(idx);
+            return iter;
+        }
+        if(iter >= maxiter)
+            break;
+        for(j = 0; j < nact; j++)
+        {
+            cblas_dscal(n, 1.0/beta[j], V+(size_t)n*j, 1);
+            g[j*(m+1)] = beta[j];
+            kdim[j] = -1;
+        }
+        // Arnoldi process for all active columns at once
+        for(k = 0; k < m && iter < maxiter; k++)
+        {
+            double *Vk = V+nn*k, *Vk1 = Vk+nn;
+            int nrun = 0;
+            dgmres_mml(M, nact, Vk, n, Vk1, n, mpi);
+            iter++;
+            // Two passes of classical Gram-Schmidt
+            for(i = 0; i < 2; i++)
+            {
+                // Without local rows dgemv does not touch `h`, while local
+                // dot products must be zero
+                if(n == 0)
+                    for(j = 0; j < nact*(m+1); j++)
+                        h[j] = 0.;
+                #pragma omp parallel for schedule(static)
+                for(j = 0; j < nact; j++)
+                    if(kdim[j] < 0)
+                        cblas_dgemv(CblasColMajor, CblasTrans, n, k+1, 1.0,
+                                V+(size_t)n*j, ldv, Vk1+(size_t)n*j, 1, 0.0,
+                                h+j*(m+1), 1);
+                dgmres_sum(h, nact*(m+1), mpi);
+                #pragma omp parallel for schedule(static)
+                for(j = 0; j < nact; j++)
+                {
+                    if(kdim[j] >= 0)
+                        continue;
+                    double *hk = H+(size_t)j*(m+1)*m+(size_t)k*(m+1);
+                    cblas_dgemv(CblasColMajor, CblasNoTrans, n, k+1, -1.0,
+                            V+(size_t)n*j, ldv, h+j*(m+1), 1, 1.0,
+                            Vk1+(size_t)n*j, 1);
+                    if(i == 0)
+                        cblas_dcopy(k+1, h+j*(m+1), 1, hk, 1);
+                    else
+                        cblas_daxpy(k+1, 1.0, h+j*(m+1), 1, hk, 1);
+                }
+            }
+            for(j = 0; j < nact; j++)
+                beta[j] = cblas_ddot(n, Vk1+(size_t)n*j, 1, Vk1+(size_t)n*j,
+                        1);
+            dgmres_sum(beta, nact, mpi);
+            // Update QR factorization of Hessenberg matrices by Givens
+            // rotations and check estimated residuals
+            for(j = 0; j < nact; j++)
+            {
+                double *vk1 = Vk1+(size_t)n*j;
+                if(kdim[j] >= 0)
+                {
+                    // Finished columns must not pollute next products
+                    for(i = 0; i < n; i++)
+                        vk1[i] = 0.;
+                    continue;
+                }
+                double *hk = H+(size_t)j*(m+1)*m+(size_t)k*(m+1);
+                double *c = cs+j*m, *s = sn+j*m, *gj = g+j*(m+1);
+                double hnorm = sqrt(beta[j]), tmp = hnorm;
+                if(hnorm > 0.)
+                    cblas_dscal(n, 1.0/hnorm, vk1, 1);
+                for(i = 0; i < k; i++)
+                    cblas_drot(1, hk+i, 1, hk+i+1, 1, c[i], s[i]);
+                cblas_drotg(hk+k, &tmp, c+k, s+k);
+                hk[k+1] = 0.;
+                gj[k+1] = -s[k]*gj[k];
+                gj[k] *= c[k];
+                if(hnorm == 0. || fabs(gj[k+1]) < rscheck[idx[j]])
+                    kdim[j] = k+1;
+                else
+                    nrun++;
+            }
+            if(nrun == 0)
+            {
+                k++;
+                break;
+            }
+        }
+        // Update solutions by minimizers of least squares problems
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            int kj = kdim[j] < 0 ? k : kdim[j];
+            double *gj = g+j*(m+1);
+            cblas_dtrsv(CblasColMajor, CblasUpper, CblasNoTrans,
+                    CblasNonUnit, kj, H+(size_t)j*(m+1)*m, m+1, gj, 1);
+            cblas_dgemv(CblasColMajor, CblasNoTrans, n, kj, 1.0,
+                    V+(size_t)n*j, ldv, gj, 1, 1.0, X+(size_t)ldx*idx[j], 1);
+        }
+    }
+    free(idx);
+    return -1;
+}
+
+int starsh_itersolvers__dgmres_omp(STARSH_blrm *matrix, int nrhs, double *B,
+        int ldb, double *X, int ldx, int restart, double tol, double *work)
+//! Restarted GMRES method for @ref STARSH_blrm object.
+/*! Solves non-symmetric systems with Krylov subspaces of dimension up to
+ * `restart`. All right hand sides are processed at once, so that each
+ * iteration requires a single call to starsh_blrm__dmml_omp(). Column
+ * converges, when its residual is `tol` times smaller than its initial
+ * residual. True residuals are recomputed at each restart, and converged
+ * columns are excluded from following matrix-vector products.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] restart: Maximum dimension of Krylov subspace.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size
+ *      `(n+restart+4)*(restart+1)*nrhs`.
+ * @return Number of iterations or -1 if not converged.
+ * @sa starsh_itersolvers__dbicgstab_omp().
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    if(restart < 1)
+    {
+        STARSH_ERROR("Invalid value of `restart`");
+        return -1;
+    }
+    return dgmres(M, n, n, nrhs, B, ldb, X, ldx, restart, tol, work, 0);
+}
+
+#ifdef MPI
+int starsh_itersolvers__dgmres_mpi(STARSH_blrm *matrix, int nrhs, double *B,
+        int ldb, double *X, int ldx, int restart, double tol, double *work)
+//! Restarted GMRES method for @ref STARSH_blrm object on MPI nodes.
+/*! Right hand side and initial solution are distributed among MPI nodes,
+ * solved by @ref starsh_itersolvers__dgmres_mpi_dist() and total solution
+ * is collected back on root node.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] restart: Maximum dimension of Krylov subspace.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size
+ *      `(n_local+restart+4)*(restart+1)*nrhs`, where `n_local` is a number
+ *      of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    STARSH_blrf *F = M->format;
+    STARSH_int n_local;
+    double *B_local, *X_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    STARSH_MALLOC(B_local, nrhs*n_local+1);
+    STARSH_MALLOC(X_local, nrhs*n_local+1);
+    starsh_blrf_scatter_vector_mpi(F, 'R', nrhs, B, ldb, B_local, n_local);
+    starsh_blrf_scatter_vector_mpi(F, 'C', nrhs, X, ldx, X_local, n_local);
+    int iter = starsh_itersolvers__dgmres_mpi_dist(M, nrhs, B_local,
+            n_local, X_local, n_local, restart, tol, work);
+    starsh_blrf_gather_vector_mpi(F, 'C', nrhs, X_local, n_local, X, ldx);
+    free(B_local);
+    free(X_local);
+    return iter;
+}
+
+int starsh_itersolvers__dgmres_mpi_dist(STARSH_blrm *matrix, int nrhs,
+        double *B, int ldb, double *X, int ldx, int restart, double tol,
+        double *work)
+//! Restarted GMRES method for distributed vectors on MPI nodes.
+/*! Right hand side, solution and Krylov vectors are distributed among MPI
+ * nodes as described in @ref starsh_blrf_get_vector_size_mpi(). Matrix is
+ * multiplied by @ref starsh_blrm__dmml_mpi_dist() and dot products are
+ * summed up by `MPI_Allreduce`, 3 times per iteration.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Local rows of right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Local rows of initial solution as input, local rows of
+ *      total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] restart: Maximum dimension of Krylov subspace.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size
+ *      `(n_local+restart+4)*(restart+1)*nrhs`, where `n_local` is a number
+ *      of local rows.
+ * @return Number of iterations or -1 if not converged.
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    STARSH_int n_local;
+    if(restart < 1)
+    {
+        STARSH_ERROR("Invalid value of `restart`");
+        return -1;
+    }
+    starsh_blrf_get_vector_size_mpi(M->format, 'R', &n_local);
+    return dgmres(M, n_local, n, nrhs, B, ldb, X, ldx, restart, tol, work,
+            1);
+}
+#endif // MPI
@@ -0,0 +1,181 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/itersolvers/pcg.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include "common.h"
+#include "starsh.h"
+
+static int dpcg_precond(STARSH_blrm *factor, int n, int nrhs, double *Z,
+        float *Zs)
+//! Apply preconditioner in double or, if `Zs` is not NULL, single precision.
+{
+    size_t i, nn = (size_t)n*nrhs;
+    int info;
+    if(factor == NULL)
+        return STARSH_SUCCESS;
+    if(Zs == NULL)
+        return starsh_blrm__dpotrs_omp(factor, nrhs, Z, n);
+    #pragma omp parallel for schedule(static)
+    for(i = 0; i < nn; i++)
+        Zs[i] = Z[i];
+    info = starsh_blrm__spotrs_omp(factor, nrhs, Zs, n);
+    #pragma omp parallel for schedule(static)
+    for(i = 0; i < nn; i++)
+        Z[i] = Zs[i];
+    return info;
+}
+
+int starsh_itersolvers__dpcg_omp(STARSH_blrm *matrix, STARSH_blrm *factor,
+        int nrhs, double *B, int ldb, double *X, int ldx, double tol,
+        double *work)
+//! Preconditioned conjugate gradient method for @ref STARSH_blrm object.
+/*! Preconditioner is given by its TLR Cholesky factor and is applied by
+ * starsh_blrm__dpotrs_omp() to all right hand sides at once. Block-Jacobi
+ * preconditioner is computed by starsh_blrm__djacobi_omp(), a stronger
+ * preconditioner is a factor of a cheaper approximation of the same matrix
+ * (with lower `maxrank` or larger `tol`), computed by
+ * starsh_blrm__dpotrf_omp(). If `factor` is NULL, no preconditioner is
+ * applied. Columns, that converged, are excluded from following
+ * matrix-vector products and preconditioner applications. Column converges,
+ * when its residual is `tol` times smaller than its initial residual.
+ *
+ * Factor can be converted to single precision by starsh_blrm_convert(), so
+ * that it takes half of memory and is applied by starsh_blrm__spotrs_omp(),
+ * while matrix-vector products and all the vectors stay in double precision.
+ * This is a mixed precision iterative refinement: solution still reaches
+ * double precision accuracy. Rounding errors make such a preconditioner
+ * slightly non-symmetric, so flexible (Polak-Ribiere) formula is used for
+ * search directions in this case.
+ *
+ * @param[in] matrix: Block-wise low-rank symmetric positive definite
+ *      matrix.
+ * @param[in] factor: TLR Cholesky factor of preconditioner in double or
+ *      single precision or NULL.
+ * @param[in] nrhs: Number of right hand sides.
+ * @param[in] B: Right hand side.
+ * @param[in] ldb: Leading dimension of `B`.
+ * @param[in,out] X: Initial solution as input, total solution as output.
+ * @param[in] ldx: Leading dimension of `X`.
+ * @param[in] tol: Relative error threshold for residual.
+ * @param[out] work: Temporary array of size `4*n*nrhs+3*nrhs`.
+ * @return Number of iterations or -1 if not converged.
+ * @sa starsh_itersolvers__dcg_omp(), starsh_blrm__djacobi_omp(),
+ *      starsh_blrm_convert().
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    int n = M->format->problem->shape[0];
+    size_t nn = (size_t)n*nrhs;
+    // Residual, preconditioned residual, search directions and their
+    // product by matrix for active columns
+    double *R = work, *Z = R+nn, *P = Z+nn, *Q = P+nn;
+    double *rscheck = Q+nn, *rz = rscheck+nrhs, *rsnew = rz+nrhs;
+    // Single precision buffer and step sizes for flexible PCG
+    float *Zs = NULL;
+    double *alpha = NULL;
+    int *idx;
+    int i, j, nact = 0;
+    STARSH_MALLOC(idx, nrhs);
+    if(factor != NULL && factor->near_D[0]->dtype == 's')
+    {
+        STARSH_MALLOC(Zs, nn);
+        STARSH_MALLOC(alpha, nrhs);
+    }
+    // Initial residual
+    starsh_blrm__dmml_omp(M, nrhs, -1.0, X, ldx, 0.0, R, n);
+    for(j = 0; j < nrhs; j++)
+        cblas_daxpy(n, 1., B+(size_t)ldb*j, 1, R+(size_t)n*j, 1);
+    // Columns with zero residual are already solved
+    for(j = 0; j < nrhs; j++)
+    {
+        double norm = cblas_dnrm2(n, R+(size_t)n*j, 1);
+        if(norm == 0.)
+            continue;
+        if(nact != j)
+            cblas_dcopy(n, R+(size_t)n*j, 1, R+(size_t)n*nact, 1);
+        rscheck[nact] = norm*tol;
+        idx[nact] = j;
+        nact++;
+    }
+    if(nact == 0)
+    {
+        free(idx);
+        free(Zs);
+        free(alpha);
+        return 0;
+    }
+    // Initial search directions
+    cblas_dcopy(n*nact, R, 1, Z, 1);
+    dpcg_precond(factor, n, nact, Z, Zs);
+    cblas_dcopy(n*nact, Z, 1, P, 1);
+    for(j = 0; j < nact; j++)
+        rz[j] = cblas_ddot(n, R+(size_t)n*j, 1, Z+(size_t)n*j, 1);
+    for(i = 0; i < n; i++)
+    {
+        starsh_blrm__dmml_omp(M, nact, 1.0, P, n, 0.0, Q, n);
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            double *p = P+(size_t)n*j, *q = Q+(size_t)n*j;
+            double a = rz[j]/cblas_ddot(n, p, 1, q, 1);
+            cblas_daxpy(n, a, p, 1, X+(size_t)ldx*idx[j], 1);
+            cblas_daxpy(n, -a, q, 1, R+(size_t)n*j, 1);
+            rsnew[j] = cblas_dnrm2(n, R+(size_t)n*j, 1);
+            if(alpha != NULL)
+                alpha[j] = a;
+        }
+        // Deflate converged columns
+        for(j = nact-1; j >= 0; j--)
+        {
+            if(rsnew[j] >= rscheck[j])
+                continue;
+            nact--;
+            if(j == nact)
+                continue;
+            cblas_dcopy(n, R+(size_t)n*nact, 1, R+(size_t)n*j, 1);
+            cblas_dcopy(n, P+(size_t)n*nact, 1, P+(size_t)n*j, 1);
+            if(alpha != NULL)
+            {
+                cblas_dcopy(n, Q+(size_t)n*nact, 1, Q+(size_t)n*j, 1);
+                alpha[j] = alpha[nact];
+            }
+            rscheck[j] = rscheck[nact];
+            rz[j] = rz[nact];
+            idx[j] = idx[nact];
+        }
+        if(nact == 0)
+        {
+            free(idx);
+            free(Zs);
+            free(alpha);
+            return i+1;
+        }
+        cblas_dcopy(n*nact, R, 1, Z, 1);
+        dpcg_precond(factor, n, nact, Z, Zs);
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nact; j++)
+        {
+            double *p = P+(size_t)n*j, *z = Z+(size_t)n*j;
+            double rz_new = cblas_ddot(n, R+(size_t)n*j, 1, z, 1);
+            // Polak-Ribiere: (z_new, r_new-r_old) = -alpha*(z_new, q)
+            double zr = alpha == NULL ? rz_new :
+                -alpha[j]*cblas_ddot(n, z, 1, Q+(size_t)n*j, 1);
+            cblas_dscal(n, zr/rz[j], p, 1);
+            cblas_daxpy(n, 1., z, 1, p, 1);
+            rz[j] = rz_new;
+        }
+    }
+    free(idx);
+    free(Zs);
+    free(alpha);
+    return -1;
+}
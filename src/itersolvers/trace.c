@@ -0,0 +1,290 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file src/itersolvers/trace.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#include <float.h>
+#include "common.h"
+#include "starsh.h"
+
+static void drademacher(size_t count, int *iseed, double *X)
+//! Generate `count` random signs, reproducible for given `iseed`.
+{
+    size_t i, chunk;
+    // LAPACK generator is sequential, so result does not depend on number of
+    // threads. It takes integer size, so long arrays are generated by chunks,
+    // which continue the same sequence.
+    for(i = 0; i < count; i += chunk)
+    {
+        chunk = count-i < INT_MAX/2 ? count-i : INT_MAX/2;
+        LAPACKE_dlarnv_work(1, iseed, chunk, X+i);
+    }
+    for(i = 0; i < count; i++)
+        X[i] = X[i] < 0.5 ? -1.0 : 1.0;
+}
+
+static void drademacher_seed(int seed, int *iseed)
+//! Convert seed into seed of LAPACK random number generator.
+{
+    unsigned int s = seed;
+    iseed[0] = (s >> 22) & 1023;
+    iseed[1] = (s >> 11) & 2047;
+    iseed[2] = 0;
+    // Last element must be odd
+    iseed[3] = 2*(s & 2047)+1;
+}
+
+int starsh_itersolvers__dlogdet_slq_omp(STARSH_blrm *matrix, int nprobes,
+        int nsteps, int seed, double *logdet)
+//! Estimate log-determinant of @ref STARSH_blrm object.
+/*! Stochastic Lanczos quadrature: `log(det(A)) = trace(log(A))` is
+ * estimated by Hutchinson's method with `nprobes` Rademacher vectors and
+ * each quadratic form `z^T*log(A)*z` is approximated by Gauss quadrature
+ * with `nsteps` nodes, obtained from Lanczos process. Lanczos processes for
+ * all probe vectors are done at once, so each step requires a single call
+ * to starsh_blrm__dmml_omp() with `nprobes` right hand sides. Only 3
+ * vectors per probe are stored (there is no reorthogonalization), so
+ * memory footprint is `3*n*nprobes` doubles and no factorization is
+ * needed. Probe vectors are the same for the same `seed`. Standard error of
+ * the estimate decreases as `1/sqrt(nprobes)`.
+ *
+ * @param[in] matrix: Block-wise low-rank symmetric positive definite
+ *      matrix.
+ * @param[in] nprobes: Number of random probe vectors.
+ * @param[in] nsteps: Number of Lanczos steps per probe vector.
+ * @param[in] seed: Seed of random probe vectors.
+ * @param[out] logdet: Estimated logarithm of determinant.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_itersolvers__dtrace_omp().
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    if(M == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(nprobes < 1)
+    {
+        STARSH_ERROR("Invalid value of `nprobes`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(nsteps < 1)
+    {
+        STARSH_ERROR("Invalid value of `nsteps`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(logdet == NULL)
+    {
+        STARSH_ERROR("Invalid value of `logdet`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    int n = M->format->problem->shape[0];
+    int m = nsteps < n ? nsteps : n;
+    size_t nn = (size_t)n*nprobes;
+    double *buffer, *Vold, *V, *W, *alpha, *beta, *Z, *stev_work, *tmp;
+    int *len;
+    int iseed[4];
+    int i, j, k, nrun = nprobes, info = STARSH_SUCCESS;
+    size_t ii;
+    STARSH_MALLOC(buffer, 3*nn);
+    Vold = buffer;
+    V = Vold+nn;
+    W = V+nn;
+    // Diagonals of Lanczos tridiagonal matrices and work for their
+    // eigenvalue decompositions
+    STARSH_MALLOC(alpha, 2*(size_t)m*nprobes+(size_t)m*m+2*m);
+    beta = alpha+(size_t)m*nprobes;
+    Z = beta+(size_t)m*nprobes;
+    stev_work = Z+(size_t)m*m;
+    STARSH_MALLOC(len, nprobes);
+    // Normalized Rademacher vectors are starting vectors
+    drademacher_seed(seed, iseed);
+    drademacher(nn, iseed, V);
+    for(j = 0; j < nprobes; j++)
+        cblas_dscal(n, 1.0/sqrt(n), V+(size_t)n*j, 1);
+    for(ii = 0; ii < nn; ii++)
+        Vold[ii] = 0.;
+    for(j = 0; j < nprobes; j++)
+        len[j] = -1;
+    for(k = 0; k < m && nrun > 0; k++)
+    {
+        starsh_blrm__dmml_omp(M, nprobes, 1.0, V, n, 0.0, W, n);
+        #pragma omp parallel for schedule(static)
+        for(j = 0; j < nprobes; j++)
+        {
+            double *v = V+(size_t)n*j, *w = W+(size_t)n*j;
+            double *vold = Vold+(size_t)n*j;
+            double a, b;
+            if(len[j] >= 0)
+                continue;
+            a = cblas_ddot(n, v, 1, w, 1);
+            alpha[(size_t)j*m+k] = a;
+            cblas_daxpy(n, -a, v, 1, w, 1);
+            if(k > 0)
+                cblas_daxpy(n, -beta[(size_t)j*m+k-1], vold, 1, w, 1);
+            b = cblas_dnrm2(n, w, 1);
+            beta[(size_t)j*m+k] = b;
+            // Krylov subspace is invariant, quadrature is exact
+            if(b <= n*DBL_EPSILON*fabs(a) || k == m-1)
+            {
+                len[j] = k+1;
+                for(i = 0; i < n; i++)
+                {
+                    v[i] = 0.;
+                    w[i] = 0.;
+                }
+                continue;
+            }
+            cblas_dscal(n, 1.0/b, w, 1);
+        }
+        nrun = 0;
+        for(j = 0; j < nprobes; j++)
+            if(len[j] < 0)
+                nrun++;
+        // Shift Lanczos vectors
+        tmp = Vold;
+        Vold = V;
+        V = W;
+        W = tmp;
+    }
+    // Sum up Gauss quadratures over all probe vectors
+    double sum = 0.;
+    for(j = 0; j < nprobes && info == STARSH_SUCCESS; j++)
+    {
+        int lj = len[j];
+        double *d = alpha+(size_t)j*m, *e = beta+(size_t)j*m, quad = 0.;
+        info = LAPACKE_dstev_work(LAPACK_COL_MAJOR, 'V', lj, d, e, Z, lj,
+                stev_work);
+        if(info != 0)
+        {
+            STARSH_ERROR("Eigenvalues of tridiagonal matrix did not "
+                    "converge");
+            info = STARSH_UNKNOWN_ERROR;
+            break;
+        }
+        for(i = 0; i < lj; i++)
+        {
+            if(d[i] <= 0.)
+            {
+                STARSH_ERROR("Matrix is not positive definite");
+                info = STARSH_NOT_POSITIVE_DEFINITE;
+                break;
+            }
+            quad += Z[(size_t)i*lj]*Z[(size_t)i*lj]*log(d[i]);
+        }
+        sum += quad*n;
+    }
+    *logdet = sum/nprobes;
+    free(buffer);
+    free(alpha);
+    free(len);
+    return info;
+}
+
+int starsh_itersolvers__dtrace_omp(STARSH_blrm *matrix, int nprobes,
+        char method, int seed, double *trace)
+//! Estimate trace of @ref STARSH_blrm object.
+/*! Matrix is accessed only by starsh_blrm__dmml_omp() with a block of
+ * Rademacher vectors, so it works for matrices with on-the-fly near-field
+ * blocks or with uniform bases. Two methods are available: Hutchinson's
+ * method uses `nprobes` random vectors, and its standard error is about
+ * `sqrt(2/nprobes)*|A|_F`. Hutch++ spends `2/3` of matrix-vector products
+ * to find and exactly account for dominant subspace of `A`, and applies
+ * Hutchinson's method only to the remainder, so it requires much less
+ * products for matrices with decaying spectrum. Probe vectors are the same
+ * for the same `seed`.
+ *
+ * @param[in] matrix: Block-wise low-rank matrix.
+ * @param[in] nprobes: Number of matrix-vector products. Must be at least 3
+ *      for Hutch++.
+ * @param[in] method: 'H' for Hutchinson's method or 'P' for Hutch++.
+ * @param[in] seed: Seed of random probe vectors.
+ * @param[out] trace: Estimated trace.
+ * @return Error code @ref STARSH_ERRNO.
+ * @sa starsh_itersolvers__dlogdet_slq_omp().
+ * @ingroup solvers
+ * */
+{
+    STARSH_blrm *M = matrix;
+    if(M == NULL)
+    {
+        STARSH_ERROR("Invalid value of `matrix`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(method != 'H' && method != 'P')
+    {
+        STARSH_ERROR("Invalid value of `method`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(nprobes < 1 || (method == 'P' && nprobes < 3))
+    {
+        STARSH_ERROR("Invalid value of `nprobes`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    if(trace == NULL)
+    {
+        STARSH_ERROR("Invalid value of `trace`");
+        return STARSH_WRONG_PARAMETER;
+    }
+    int n = M->format->problem->shape[0];
+    int iseed[4];
+    int j, k = method == 'H' ? nprobes : nprobes/3;
+    size_t nk = (size_t)n*k;
+    double *S, *G, *W;
+    double sum = 0.;
+    drademacher_seed(seed, iseed);
+    if(method == 'H')
+    {
+        STARSH_MALLOC(S, 2*nk);
+        W = S+nk;
+        drademacher(nk, iseed, S);
+        starsh_blrm__dmml_omp(M, k, 1.0, S, n, 0.0, W, n);
+        for(j = 0; j < k; j++)
+            sum += cblas_ddot(n, S+(size_t)n*j, 1, W+(size_t)n*j, 1);
+        *trace = sum/k;
+        free(S);
+        return STARSH_SUCCESS;
+    }
+    // Hutch++: k products to get basis Q of dominant subspace, k products
+    // for trace(Q^T*A*Q) and k products for Hutchinson's method on
+    // (I-Q*Q^T)*A*(I-Q*Q^T)
+    double *C, *tau, *qr_work;
+    int lwork = k*64;
+    STARSH_MALLOC(S, 3*nk+(size_t)k*k+k+lwork);
+    G = S+nk;
+    W = G+nk;
+    C = W+nk;
+    tau = C+(size_t)k*k;
+    qr_work = tau+k;
+    // S and G are contiguous, so they are generated at once
+    drademacher(2*nk, iseed, S);
+    // Basis Q = orth(A*S) overwrites W
+    starsh_blrm__dmml_omp(M, k, 1.0, S, n, 0.0, W, n);
+    LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, n, k, W, n, tau, qr_work, lwork);
+    LAPACKE_dorgqr_work(LAPACK_COL_MAJOR, n, k, k, W, n, tau, qr_work,
+            lwork);
+    starsh_blrm__dmml_omp(M, k, 1.0, W, n, 0.0, S, n);
+    for(j = 0; j < k; j++)
+        sum += cblas_ddot(n, W+(size_t)n*j, 1, S+(size_t)n*j, 1);
+    // Project probe vectors: G = G - Q*(Q^T*G)
+    cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, k, k, n, 1.0, W, n,
+            G, n, 0.0, C, k);
+    cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, k, -1.0, W,
+            n, C, k, 1.0, G, n);
+    starsh_blrm__dmml_omp(M, k, 1.0, G, n, 0.0, S, n);
+    double sum2 = 0.;
+    for(j = 0; j < k; j++)
+        sum2 += cblas_ddot(n, G+(size_t)n*j, 1, S+(size_t)n*j, 1);
+    *trace = sum+sum2/k;
+    free(S);
+    return STARSH_SUCCESS;
+}
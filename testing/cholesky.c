@@ -0,0 +1,153 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/cholesky.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include <string.h>
+#include <starsh.h>
+#include <starsh-spatial.h>
+
+int main(int argc, char **argv)
+{
+    if(argc != 11)
+    {
+        printf("%d arguments provided, but 10 are needed\n", argc-1);
+        printf("cholesky ndim placement kernel beta nu noise N block_size "
+                "maxrank tol\n");
+        return 1;
+    }
+    int problem_ndim = atoi(argv[1]);
+    int place = atoi(argv[2]);
+    // Possible values can be found in documentation for enum
+    // STARSH_PARTICLES_PLACEMENT
+    int kernel_type = atoi(argv[3]);
+    double beta = atof(argv[4]);
+    double nu = atof(argv[5]);
+    double noise = atof(argv[6]);
+    int N = atoi(argv[7]);
+    int block_size = atoi(argv[8]);
+    int maxrank = atoi(argv[9]);
+    double tol = atof(argv[10]);
+    int onfly = 0;
+    char symm = 'S', dtype = 'd';
+    int ndim = 2;
+    STARSH_int shape[2] = {N, N};
+    int nrhs = 2;
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+        return info;
+    // Generate data for spatial statistics problem
+    STARSH_ssdata *data;
+    STARSH_kernel *kernel;
+    info = starsh_application((void **)&data, &kernel, N, dtype,
+            STARSH_SPATIAL, kernel_type, STARSH_SPATIAL_NDIM, problem_ndim,
+            STARSH_SPATIAL_BETA, beta, STARSH_SPATIAL_NU, nu,
+            STARSH_SPATIAL_NOISE, noise, STARSH_SPATIAL_PLACE, place, 0);
+    if(info != 0)
+    {
+        printf("Problem was NOT generated (wrong parameters)\n");
+        return info;
+    }
+    // Init problem with given data and kernel and print short info
+    STARSH_problem *P;
+    info = starsh_problem_new(&P, ndim, shape, symm, dtype, data, data,
+            kernel, "Spatial Statistics example");
+    if(info != 0)
+        return info;
+    starsh_problem_info(P);
+    // Init plain clusterization and print info
+    STARSH_cluster *C;
+    info = starsh_cluster_new_plain(&C, data, N, block_size);
+    if(info != 0)
+        return info;
+    starsh_cluster_info(C);
+    // Init tlr division into admissible blocks and print short info
+    STARSH_blrf *F;
+    STARSH_blrm *M;
+    starsh_blrf_new_tlr(&F, P, symm, C, C);
+    // Approximate each admissible block
+    double time1 = omp_get_wtime();
+    info = starsh_blrm_approximate(&M, F, maxrank, tol, onfly);
+    if(info != 0)
+        return info;
+    time1 = omp_get_wtime()-time1;
+    starsh_blrm_info(M);
+    printf("TIME TO APPROXIMATE: %e secs\n", time1);
+    // Factorize matrix with sequential and OpenMP backends
+    STARSH_blrm *L, *L_omp;
+    time1 = omp_get_wtime();
+    info = starsh_blrm__dpotrf(&L, M, maxrank, tol);
+    if(info != 0)
+    {
+        printf("Factorization was NOT computed due to error\n");
+        return info;
+    }
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO FACTORIZE: %e secs\n", time1);
+    time1 = omp_get_wtime();
+    info = starsh_blrm__dpotrf_omp(&L_omp, M, maxrank, tol);
+    if(info != 0)
+    {
+        printf("Factorization was NOT computed due to error\n");
+        return info;
+    }
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO FACTORIZE (OPENMP): %e secs\n", time1);
+    starsh_blrm_info(L_omp);
+    // Solve system with random right hand side and measure residual
+    double *b, *x, *x_omp;
+    b = malloc(N*nrhs*sizeof(*b));
+    x = malloc(N*nrhs*sizeof(*x));
+    x_omp = malloc(N*nrhs*sizeof(*x_omp));
+    int iseed[4] = {0, 0, 0, 1};
+    LAPACKE_dlarnv_work(3, iseed, N*nrhs, b);
+    cblas_dcopy(N*nrhs, b, 1, x, 1);
+    cblas_dcopy(N*nrhs, b, 1, x_omp, 1);
+    time1 = omp_get_wtime();
+    starsh_blrm__dpotrs(L, nrhs, x, N);
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO SOLVE: %e secs\n", time1);
+    time1 = omp_get_wtime();
+    starsh_blrm__dpotrs_omp(L_omp, nrhs, x_omp, N);
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO SOLVE (OPENMP): %e secs\n", time1);
+    double norm_b = cblas_dnrm2(N*nrhs, b, 1);
+    starsh_blrm__dmml(M, nrhs, -1.0, x, N, 1.0, b, N);
+    double res = cblas_dnrm2(N*nrhs, b, 1)/norm_b;
+    cblas_daxpy(N*nrhs, -1.0, x, 1, x_omp, 1);
+    double diff = cblas_dnrm2(N*nrhs, x_omp, 1)/cblas_dnrm2(N*nrhs, x, 1);
+    printf("RELATIVE RESIDUAL: %e\nOPENMP SOLUTION DIFF: %e\n", res, diff);
+    free(b);
+    free(x);
+    free(x_omp);
+    STARSH_blrf *LF = L->format, *LF_omp = L_omp->format;
+    starsh_blrm_free(L);
+    starsh_blrf_free(LF);
+    starsh_blrm_free(L_omp);
+    starsh_blrf_free(LF_omp);
+    if(res/tol > 100. || diff/tol > 100.)
+    {
+        printf("Residual of solution is too big\n");
+        return 1;
+    }
+    return 0;
+}
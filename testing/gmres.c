@@ -0,0 +1,125 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/gmres.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include <starsh.h>
+#include <starsh-cauchy.h>
+
+int main(int argc, char **argv)
+{
+    if(argc != 6)
+    {
+        printf("%d arguments provided, but 5 are needed\n", argc-1);
+        printf("gmres N block_size maxrank tol restart\n");
+        return 1;
+    }
+    int N = atoi(argv[1]), block_size = atoi(argv[2]);
+    int maxrank = atoi(argv[3]);
+    double tol = atof(argv[4]);
+    int restart = atoi(argv[5]);
+    int onfly = 0;
+    char dtype = 'd', symm = 'N';
+    int ndim = 2;
+    STARSH_int shape[2] = {N, N};
+    int nrhs = 2;
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+        return info;
+    // Generate data for Cauchy matrix
+    STARSH_cauchy *data;
+    STARSH_kernel *kernel;
+    info = starsh_application((void **)&data, &kernel, N, dtype, STARSH_CAUCHY,
+            STARSH_CAUCHY_KERNEL1, 0);
+    if(info != 0)
+        return info;
+    // Init problem with given data and kernel and print short info
+    STARSH_problem *P;
+    info = starsh_problem_new(&P, ndim, shape, symm, dtype, data, data,
+            kernel, "Cauchy example");
+    if(info != 0)
+        return info;
+    starsh_problem_info(P);
+    // Init plain clusterization and print info
+    STARSH_cluster *C;
+    info = starsh_cluster_new_plain(&C, data, N, block_size);
+    if(info != 0)
+        return info;
+    starsh_cluster_info(C);
+    // Init tlr division into admissible blocks and print short info
+    STARSH_blrf *F;
+    STARSH_blrm *M;
+    info = starsh_blrf_new_tlr(&F, P, symm, C, C);
+    if(info != 0)
+        return info;
+    // Approximate each admissible block
+    double time1 = omp_get_wtime();
+    info = starsh_blrm_approximate(&M, F, maxrank, tol, onfly);
+    if(info != 0)
+        return info;
+    time1 = omp_get_wtime()-time1;
+    starsh_blrm_info(M);
+    printf("TIME TO APPROXIMATE: %e secs\n", time1);
+    // Solve system with random right hand side by GMRES and BiCGStab
+    double *b, *x, *x2, *work;
+    b = malloc(N*nrhs*sizeof(*b));
+    x = malloc(N*nrhs*sizeof(*x));
+    x2 = malloc(N*nrhs*sizeof(*x2));
+    work = malloc((size_t)(N+restart+4)*(restart+1)*nrhs*sizeof(*work));
+    int iseed[4] = {0, 0, 0, 1};
+    LAPACKE_dlarnv_work(3, iseed, N*nrhs, b);
+    for(int i = 0; i < N*nrhs; i++)
+    {
+        x[i] = 0.;
+        x2[i] = 0.;
+    }
+    time1 = omp_get_wtime();
+    int iter = starsh_itersolvers__dgmres_omp(M, nrhs, b, N, x, N, restart,
+            tol, work);
+    time1 = omp_get_wtime()-time1;
+    printf("GMRES(%d) ITERATIONS: %d\nTIME TO SOLVE: %e secs\n", restart,
+            iter, time1);
+    time1 = omp_get_wtime();
+    int iter2 = starsh_itersolvers__dbicgstab_omp(M, nrhs, b, N, x2, N, tol,
+            work);
+    time1 = omp_get_wtime()-time1;
+    printf("BICGSTAB ITERATIONS: %d\nTIME TO SOLVE: %e secs\n", iter2,
+            time1);
+    double norm_b = cblas_dnrm2(N*nrhs, b, 1);
+    cblas_dcopy(N*nrhs, b, 1, work, 1);
+    starsh_blrm__dmml(M, nrhs, -1.0, x, N, 1.0, work, N);
+    double res = cblas_dnrm2(N*nrhs, work, 1)/norm_b;
+    starsh_blrm__dmml(M, nrhs, -1.0, x2, N, 1.0, b, N);
+    double res2 = cblas_dnrm2(N*nrhs, b, 1)/norm_b;
+    printf("GMRES RELATIVE RESIDUAL: %e\nBICGSTAB RELATIVE RESIDUAL: %e\n",
+            res, res2);
+    free(b);
+    free(x);
+    free(x2);
+    free(work);
+    if(iter < 0 || iter2 < 0 || res/tol > 10. || res2/tol > 10.)
+    {
+        printf("Residual of solution is too big\n");
+        return 1;
+    }
+    return 0;
+}
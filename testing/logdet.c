@@ -0,0 +1,149 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/logdet.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+#include <starsh.h>
+#include <starsh-spatial.h>
+
+int main(int argc, char **argv)
+{
+    if(argc != 12)
+    {
+        printf("%d arguments provided, but 11 are needed\n", argc-1);
+        printf("logdet ndim placement kernel beta nu noise N block_size "
+                "maxrank tol nprobes\n");
+        return 1;
+    }
+    int problem_ndim = atoi(argv[1]);
+    int place = atoi(argv[2]);
+    // Possible values can be found in documentation for enum
+    // STARSH_PARTICLES_PLACEMENT
+    int kernel_type = atoi(argv[3]);
+    double beta = atof(argv[4]);
+    double nu = atof(argv[5]);
+    double noise = atof(argv[6]);
+    int N = atoi(argv[7]);
+    int block_size = atoi(argv[8]);
+    int maxrank = atoi(argv[9]);
+    double tol = atof(argv[10]);
+    int nprobes = atoi(argv[11]);
+    int onfly = 0;
+    char symm = 'S', dtype = 'd';
+    int ndim = 2;
+    STARSH_int shape[2] = {N, N};
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+        return info;
+    // Generate data for spatial statistics problem
+    STARSH_ssdata *data;
+    STARSH_kernel *kernel;
+    info = starsh_application((void **)&data, &kernel, N, dtype,
+            STARSH_SPATIAL, kernel_type, STARSH_SPATIAL_NDIM, problem_ndim,
+            STARSH_SPATIAL_BETA, beta, STARSH_SPATIAL_NU, nu,
+            STARSH_SPATIAL_NOISE, noise, STARSH_SPATIAL_PLACE, place, 0);
+    if(info != 0)
+    {
+        printf("Problem was NOT generated (wrong parameters)\n");
+        return info;
+    }
+    // Init problem with given data and kernel and print short info
+    STARSH_problem *P;
+    info = starsh_problem_new(&P, ndim, shape, symm, dtype, data, data,
+            kernel, "Spatial Statistics example");
+    if(info != 0)
+        return info;
+    starsh_problem_info(P);
+    // Init plain clusterization and print info
+    STARSH_cluster *C;
+    info = starsh_cluster_new_plain(&C, data, N, block_size);
+    if(info != 0)
+        return info;
+    starsh_cluster_info(C);
+    // Init tlr division into admissible blocks and print short info
+    STARSH_blrf *F;
+    STARSH_blrm *M;
+    starsh_blrf_new_tlr(&F, P, symm, C, C);
+    // Approximate each admissible block
+    double time1 = omp_get_wtime();
+    info = starsh_blrm_approximate(&M, F, maxrank, tol, onfly);
+    if(info != 0)
+        return info;
+    time1 = omp_get_wtime()-time1;
+    starsh_blrm_info(M);
+    printf("TIME TO APPROXIMATE: %e secs\n", time1);
+    // Get exact log-determinant by TLR Cholesky factorization and exact
+    // trace by diagonal tiles
+    STARSH_blrm *L;
+    time1 = omp_get_wtime();
+    info = starsh_blrm__dpotrf_omp(&L, M, maxrank, tol);
+    if(info != 0)
+        return info;
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO FACTORIZE: %e secs\n", time1);
+    double logdet = 0., trace = 0.;
+    for(STARSH_int k = 0; k < F->nbrows; k++)
+    {
+        int n = C->size[k], shape[2], rank;
+        double *Lk = L->near_D[k]->data;
+        void *U, *V, *D;
+        starsh_blrm_get_block(M, k, k, shape, &rank, &U, &V, &D);
+        for(int i = 0; i < n; i++)
+        {
+            logdet += 2*log(Lk[i*(n+1)]);
+            trace += ((double *)D)[i*(n+1)];
+        }
+    }
+    STARSH_blrf *LF = L->format;
+    starsh_blrm_free(L);
+    starsh_blrf_free(LF);
+    // Estimate log-determinant and trace with random probe vectors
+    double logdet_slq, trace_h, trace_hpp;
+    time1 = omp_get_wtime();
+    info = starsh_itersolvers__dlogdet_slq_omp(M, nprobes, 30, 0,
+            &logdet_slq);
+    if(info != 0)
+        return info;
+    time1 = omp_get_wtime()-time1;
+    printf("TIME FOR STOCHASTIC LANCZOS QUADRATURE: %e secs\n", time1);
+    info = starsh_itersolvers__dtrace_omp(M, nprobes, 'H', 0, &trace_h);
+    if(info != 0)
+        return info;
+    info = starsh_itersolvers__dtrace_omp(M, nprobes, 'P', 0, &trace_hpp);
+    if(info != 0)
+        return info;
+    double err = fabs(logdet_slq-logdet)/fabs(logdet);
+    double err_h = fabs(trace_h-trace)/trace;
+    double err_hpp = fabs(trace_hpp-trace)/trace;
+    printf("LOGDET: %e\nSLQ ESTIMATE: %e\nRELATIVE ERROR: %e\n", logdet,
+            logdet_slq, err);
+    printf("TRACE: %e\nHUTCHINSON ESTIMATE: %e\nRELATIVE ERROR: %e\n"
+            "HUTCH++ ESTIMATE: %e\nRELATIVE ERROR: %e\n", trace, trace_h,
+            err_h, trace_hpp, err_hpp);
+    if(err > 0.05 || err_h > 0.05 || err_hpp > 0.05)
+    {
+        printf("Estimate is too far from exact value\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/loglik.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+#include <starsh.h>
+#include <starsh-spatial.h>
+
+int main(int argc, char **argv)
+{
+    if(argc != 11)
+    {
+        printf("%d arguments provided, but 10 are needed\n", argc-1);
+        printf("loglik ndim placement kernel beta nu noise N block_size "
+                "maxrank tol\n");
+        return 1;
+    }
+    int problem_ndim = atoi(argv[1]);
+    int place = atoi(argv[2]);
+    // Possible values can be found in documentation for enum
+    // STARSH_PARTICLES_PLACEMENT
+    int kernel_type = atoi(argv[3]);
+    double beta = atof(argv[4]);
+    double nu = atof(argv[5]);
+    double noise = atof(argv[6]);
+    int N = atoi(argv[7]);
+    int block_size = atoi(argv[8]);
+    int maxrank = atoi(argv[9]);
+    double tol = atof(argv[10]);
+    char dtype = 'd';
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+        return info;
+    // Generate data for spatial statistics problem
+    STARSH_ssdata *data;
+    STARSH_kernel *kernel;
+    info = starsh_application((void **)&data, &kernel, N, dtype,
+            STARSH_SPATIAL, kernel_type, STARSH_SPATIAL_NDIM, problem_ndim,
+            STARSH_SPATIAL_BETA, beta, STARSH_SPATIAL_NU, nu,
+            STARSH_SPATIAL_NOISE, noise, STARSH_SPATIAL_PLACE, place, 0);
+    if(info != 0)
+    {
+        printf("Problem was NOT generated (wrong parameters)\n");
+        return info;
+    }
+    // Init persistent state of log-likelihood evaluations
+    STARSH_ssloglik *state;
+    info = starsh_ssdata_loglik_new(&state, data, kernel_type, block_size,
+            maxrank, tol);
+    if(info != 0)
+        return info;
+    // Random observations
+    double *z = malloc(N*sizeof(*z));
+    for(int i = 0; i < N; i++)
+        z[i] = (double)rand()/RAND_MAX-0.5;
+    // Dense matrix and indexes for exact log-likelihood
+    double *A = malloc((size_t)N*N*sizeof(*A));
+    double *w = malloc(N*sizeof(*w));
+    STARSH_int *index = malloc(N*sizeof(*index));
+    for(int i = 0; i < N; i++)
+        index[i] = i;
+    // Evaluate log-likelihood for several sets of parameters with the same
+    // state, as it is done by an optimizer. Consecutive sets differ by
+    // scaling only, by scaling and shift and by correlation length, so that
+    // all kinds of update of the previous approximation are checked.
+    double params[5][4] = {{1.0, beta, nu, noise},
+        {1.5, beta, nu, 1.5*noise}, {1.5, beta, nu, 2*noise},
+        {0.5, 2*beta, nu, noise}, {0.5, beta/2, nu, noise}};
+    double pi = 3.14159265358979323846;
+    for(int k = 0; k < 5; k++)
+    {
+        double loglik, loglik_exact, logdet = 0.;
+        double time1 = omp_get_wtime();
+        info = starsh_ssdata_loglik(state, z, params[k], &loglik);
+        if(info != 0)
+            return info;
+        time1 = omp_get_wtime()-time1;
+        printf("TIME TO EVALUATE LOG-LIKELIHOOD: %e secs\n", time1);
+        // Parameters of data are already set by starsh_ssdata_loglik()
+        kernel(N, N, index, index, data, data, A, N);
+        info = LAPACKE_dpotrf(LAPACK_COL_MAJOR, 'L', N, A, N);
+        if(info != 0)
+            return info;
+        for(int i = 0; i < N; i++)
+            logdet += 2*log(A[(size_t)i*(N+1)]);
+        cblas_dcopy(N, z, 1, w, 1);
+        cblas_dtrsv(CblasColMajor, CblasLower, CblasNoTrans, CblasNonUnit,
+                N, A, N, w, 1);
+        loglik_exact = -0.5*(cblas_ddot(N, w, 1, w, 1)+logdet+N*log(2*pi));
+        double err = fabs(loglik-loglik_exact)/fabs(loglik_exact);
+        printf("PARAMETERS: %f %f %f %f\n", params[k][0], params[k][1],
+                params[k][2], params[k][3]);
+        printf("LOG-LIKELIHOOD: %e\nEXACT: %e\nRELATIVE ERROR: %e\n",
+                loglik, loglik_exact, err);
+        if(err > 1e-6)
+        {
+            printf("Log-likelihood is too far from exact value\n");
+            return 1;
+        }
+    }
+    starsh_ssdata_loglik_free(state);
+    free(z);
+    free(A);
+    free(w);
+    free(index);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/lu.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include <starsh.h>
+#include <starsh-cauchy.h>
+
+int main(int argc, char **argv)
+{
+    if(argc != 5 && argc != 6)
+    {
+        printf("%d arguments provided, but 4 or 5 are needed\n", argc-1);
+        printf("lu N block_size maxrank tol [diag]\n");
+        return 1;
+    }
+    int N = atoi(argv[1]), block_size = atoi(argv[2]);
+    int maxrank = atoi(argv[3]);
+    double tol = atof(argv[4]);
+    // Small diagonal forces row interchanges in factorization
+    double diag_value = argc == 6 ? atof(argv[5]) : 1.0;
+    int onfly = 0;
+    char dtype = 'd', symm = 'N';
+    int ndim = 2;
+    STARSH_int shape[2] = {N, N};
+    int nrhs = 2;
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+        return info;
+    // Generate data for Cauchy matrix
+    STARSH_cauchy *data;
+    STARSH_kernel *kernel;
+    double *diag = malloc(N*sizeof(*diag));
+    for(int i = 0; i < N; i++)
+        diag[i] = diag_value;
+    info = starsh_application((void **)&data, &kernel, N, dtype, STARSH_CAUCHY,
+            STARSH_CAUCHY_KERNEL1, STARSH_CAUCHY_DIAG, diag, 0);
+    free(diag);
+    if(info != 0)
+        return info;
+    // Init problem with given data and kernel and print short info
+    STARSH_problem *P;
+    info = starsh_problem_new(&P, ndim, shape, symm, dtype, data, data,
+            kernel, "Cauchy example");
+    if(info != 0)
+        return info;
+    starsh_problem_info(P);
+    // Init plain clusterization and print info
+    STARSH_cluster *C;
+    info = starsh_cluster_new_plain(&C, data, N, block_size);
+    if(info != 0)
+        return info;
+    starsh_cluster_info(C);
+    // Init tlr division into admissible blocks and print short info
+    STARSH_blrf *F;
+    STARSH_blrm *M;
+    info = starsh_blrf_new_tlr(&F, P, symm, C, C);
+    if(info != 0)
+        return info;
+    // Approximate each admissible block
+    double time1 = omp_get_wtime();
+    info = starsh_blrm_approximate(&M, F, maxrank, tol, onfly);
+    if(info != 0)
+        return info;
+    time1 = omp_get_wtime()-time1;
+    starsh_blrm_info(M);
+    printf("TIME TO APPROXIMATE: %e secs\n", time1);
+    // Factorize matrix with sequential and OpenMP backends
+    STARSH_blrm *LU, *LU_omp;
+    int *ipiv = malloc(N*sizeof(*ipiv));
+    int *ipiv_omp = malloc(N*sizeof(*ipiv_omp));
+    time1 = omp_get_wtime();
+    info = starsh_blrm__dgetrf(&LU, ipiv, M, maxrank, tol);
+    if(info != 0)
+    {
+        printf("Factorization was NOT computed due to error\n");
+        return info;
+    }
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO FACTORIZE: %e secs\n", time1);
+    time1 = omp_get_wtime();
+    info = starsh_blrm__dgetrf_omp(&LU_omp, ipiv_omp, M, maxrank, tol);
+    if(info != 0)
+    {
+        printf("Factorization was NOT computed due to error\n");
+        return info;
+    }
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO FACTORIZE (OPENMP): %e secs\n", time1);
+    starsh_blrm_info(LU_omp);
+    // Solve system with random right hand side and measure residual
+    double *b, *x, *x_omp;
+    b = malloc(N*nrhs*sizeof(*b));
+    x = malloc(N*nrhs*sizeof(*x));
+    x_omp = malloc(N*nrhs*sizeof(*x_omp));
+    int iseed[4] = {0, 0, 0, 1};
+    LAPACKE_dlarnv_work(3, iseed, N*nrhs, b);
+    cblas_dcopy(N*nrhs, b, 1, x, 1);
+    cblas_dcopy(N*nrhs, b, 1, x_omp, 1);
+    time1 = omp_get_wtime();
+    starsh_blrm__dgetrs(LU, ipiv, nrhs, x, N);
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO SOLVE: %e secs\n", time1);
+    time1 = omp_get_wtime();
+    starsh_blrm__dgetrs_omp(LU_omp, ipiv_omp, nrhs, x_omp, N);
+    time1 = omp_get_wtime()-time1;
+    printf("TIME TO SOLVE (OPENMP): %e secs\n", time1);
+    double norm_b = cblas_dnrm2(N*nrhs, b, 1);
+    starsh_blrm__dmml(M, nrhs, -1.0, x, N, 1.0, b, N);
+    double res = cblas_dnrm2(N*nrhs, b, 1)/norm_b;
+    cblas_daxpy(N*nrhs, -1.0, x, 1, x_omp, 1);
+    double diff = cblas_dnrm2(N*nrhs, x_omp, 1)/cblas_dnrm2(N*nrhs, x, 1);
+    printf("RELATIVE RESIDUAL: %e\nOPENMP SOLUTION DIFF: %e\n", res, diff);
+    free(b);
+    free(x);
+    free(x_omp);
+    free(ipiv);
+    free(ipiv_omp);
+    STARSH_blrf *LF = LU->format, *LF_omp = LU_omp->format;
+    starsh_blrm_free(LU);
+    starsh_blrf_free(LF);
+    starsh_blrm_free(LU_omp);
+    starsh_blrf_free(LF_omp);
+    if(res/tol > 100. || diff/tol > 100.)
+    {
+        printf("Residual of solution is too big\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/mpi_cg.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include <starsh.h>
+#include <starsh-mpi.h>
+#include <starsh-spatial.h>
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int mpi_size, mpi_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    if(argc != 12)
+    {
+        if(mpi_rank == 0)
+        {
+            printf("%d arguments provided, but 11 are needed\n", argc-1);
+            printf("mpi_cg ndim placement kernel beta nu noise N "
+                    "block_size maxrank tol nrhs\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    int problem_ndim = atoi(argv[1]);
+    int place = atoi(argv[2]);
+    // Possible values can be found in documentation for enum
+    // STARSH_PARTICLES_PLACEMENT
+    int kernel_type = atoi(argv[3]);
+    double beta = atof(argv[4]);
+    double nu = atof(argv[5]);
+    double noise = atof(argv[6]);
+    int N = atoi(argv[7]);
+    int block_size = atoi(argv[8]);
+    int maxrank = atoi(argv[9]);
+    double tol = atof(argv[10]);
+    int nrhs = atoi(argv[11]);
+    int onfly = 0;
+    char symm = 'S', dtype = 'd';
+    int ndim = 2;
+    STARSH_int shape[2] = {N, N};
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    // Generate data for spatial statistics problem
+    STARSH_ssdata *data;
+    STARSH_kernel *kernel;
+    info = starsh_application((void **)&data, &kernel, N, dtype,
+            STARSH_SPATIAL, kernel_type, STARSH_SPATIAL_NDIM, problem_ndim,
+            STARSH_SPATIAL_BETA, beta, STARSH_SPATIAL_NU, nu,
+            STARSH_SPATIAL_NOISE, noise, STARSH_SPATIAL_PLACE, place, 0);
+    if(info != 0)
+    {
+        if(mpi_rank == 0)
+            printf("Problem was NOT generated (wrong parameters)\n");
+        MPI_Finalize();
+        return 1;
+    }
+    // Init problem with given data and kernel and print short info
+    STARSH_problem *P;
+    info = starsh_problem_new(&P, ndim, shape, symm, dtype, data, data,
+            kernel, "Spatial Statistics example");
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    if(mpi_rank == 0)
+        starsh_problem_info(P);
+    // Init plain clusterization and print info
+    STARSH_cluster *C;
+    info = starsh_cluster_new_plain(&C, data, N, block_size);
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    if(mpi_rank == 0)
+        starsh_cluster_info(C);
+    // Init tlr division into admissible blocks and print short info
+    STARSH_blrf *F;
+    STARSH_blrm *M;
+    info = starsh_blrf_new_tlr_mpi(&F, P, symm, C, C);
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    // Approximate each admissible block
+    MPI_Barrier(MPI_COMM_WORLD);
+    double time1 = MPI_Wtime();
+    info = starsh_blrm_approximate(&M, F, maxrank, tol, onfly);
+    if(info != 0)
+    {
+        if(mpi_rank == 0)
+            printf("Approximation was NOT computed due to error\n");
+        MPI_Finalize();
+        return 1;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    if(mpi_rank == 0)
+    {
+        starsh_blrm_info(M);
+        printf("TIME TO APPROXIMATE: %e secs\n", time1);
+    }
+    // Solve system with random right hand sides by CG and by pipelined CG
+    STARSH_int n_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    double *b, *x, *x_pipe, *work;
+    b = malloc(N*nrhs*sizeof(*b));
+    x = malloc(N*nrhs*sizeof(*x));
+    x_pipe = malloc(N*nrhs*sizeof(*x_pipe));
+    work = malloc((6*n_local*nrhs+5*nrhs)*sizeof(*work));
+    if(mpi_rank == 0)
+    {
+        int iseed[4] = {0, 0, 0, 1};
+        LAPACKE_dlarnv_work(3, iseed, N*nrhs, b);
+        cblas_dscal(N*nrhs, 0.0, x, 1);
+        cblas_dscal(N*nrhs, 0.0, x_pipe, 1);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime();
+    int iter = starsh_itersolvers__dcg_mpi(M, nrhs, b, N, x, N, tol, work);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    if(mpi_rank == 0)
+        printf("TIME TO SOLVE BY CG: %e secs\nITERATIONS: %d\n", time1,
+                iter);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime();
+    int iter_pipe = starsh_itersolvers__dpipecg_mpi(M, nrhs, b, N, x_pipe,
+            N, tol, work);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    if(mpi_rank == 0)
+        printf("TIME TO SOLVE BY PIPELINED CG: %e secs\nITERATIONS: %d\n",
+                time1, iter_pipe);
+    // Measure residual of pipelined CG on root node
+    double res = 0;
+    double norm_b = cblas_dnrm2(N*nrhs, b, 1);
+    starsh_blrm__dmml_mpi(M, nrhs, 1.0, x_pipe, N, 0.0, x, N);
+    if(mpi_rank == 0)
+    {
+        cblas_daxpy(N*nrhs, -1.0, b, 1, x, 1);
+        res = cblas_dnrm2(N*nrhs, x, 1)/norm_b;
+        printf("RELATIVE RESIDUAL: %e\n", res);
+    }
+    MPI_Bcast(&res, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    free(b);
+    free(x);
+    free(x_pipe);
+    free(work);
+    MPI_Finalize();
+    if(iter_pipe < 0 || res/tol > 10.)
+        return 1;
+    return 0;
+}
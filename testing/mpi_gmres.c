@@ -0,0 +1,189 @@
+/*! @copyright (c) 2017 King Abdullah University of Science and
+ *                      Technology (KAUST). All rights reserved.
+ *
+ * STARS-H is a software package, provided by King Abdullah
+ *             University of Science and Technology (KAUST)
+ *
+ * @file testing/mpi_gmres.c
+ * @version 1.3.0
+ * @author Aleksandr Mikhalev
+ * @date 2017-11-07
+ * */
+
+#ifdef MKL
+    #include <mkl.h>
+#else
+    #include <cblas.h>
+    #include <lapacke.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include <starsh.h>
+#include <starsh-mpi.h>
+#include <starsh-cauchy.h>
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int mpi_size, mpi_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &mpi_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpi_rank);
+    if(argc != 6)
+    {
+        if(mpi_rank == 0)
+        {
+            printf("%d arguments provided, but 5 are needed\n", argc-1);
+            printf("mpi_gmres N block_size maxrank tol restart\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    int N = atoi(argv[1]), block_size = atoi(argv[2]);
+    int maxrank = atoi(argv[3]);
+    double tol = atof(argv[4]);
+    int restart = atoi(argv[5]);
+    int onfly = 0;
+    char dtype = 'd', symm = 'N';
+    int ndim = 2;
+    STARSH_int shape[2] = {N, N};
+    int nrhs = 2;
+    int info;
+    srand(0);
+    // Init STARS-H
+    info = starsh_init();
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    // Generate data for Cauchy matrix
+    STARSH_cauchy *data;
+    STARSH_kernel *kernel;
+    info = starsh_application((void **)&data, &kernel, N, dtype, STARSH_CAUCHY,
+            STARSH_CAUCHY_KERNEL1, 0);
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    // Init problem with given data and kernel and print short info
+    STARSH_problem *P;
+    info = starsh_problem_new(&P, ndim, shape, symm, dtype, data, data,
+            kernel, "Cauchy example");
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    if(mpi_rank == 0)
+        starsh_problem_info(P);
+    // Init plain clusterization and print info
+    STARSH_cluster *C;
+    info = starsh_cluster_new_plain(&C, data, N, block_size);
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    if(mpi_rank == 0)
+        starsh_cluster_info(C);
+    // Init tlr division into admissible blocks and print short info
+    STARSH_blrf *F;
+    STARSH_blrm *M;
+    info = starsh_blrf_new_tlr_mpi(&F, P, symm, C, C);
+    if(info != 0)
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    // Approximate each admissible block
+    MPI_Barrier(MPI_COMM_WORLD);
+    double time1 = MPI_Wtime();
+    info = starsh_blrm_approximate(&M, F, maxrank, tol, onfly);
+    if(info != 0)
+    {
+        if(mpi_rank == 0)
+            printf("Approximation was NOT computed due to error\n");
+        MPI_Finalize();
+        return 1;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    if(mpi_rank == 0)
+    {
+        starsh_blrm_info(M);
+        printf("TIME TO APPROXIMATE: %e secs\n", time1);
+    }
+    // Solve system with random right hand sides by GMRES and BiCGStab. Each
+    // node stores only its local rows of vectors.
+    STARSH_int n_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    double *b, *x, *x2, *work;
+    // Workspace is shared by GMRES and BiCGStab
+    size_t lwork = (size_t)(n_local+restart+4)*(restart+1)*nrhs;
+    size_t lwork2 = (size_t)(5*n_local+6)*nrhs;
+    if(lwork < lwork2)
+        lwork = lwork2;
+    b = malloc(N*nrhs*sizeof(*b));
+    x = malloc(N*nrhs*sizeof(*x));
+    x2 = malloc(N*nrhs*sizeof(*x2));
+    work = malloc(lwork*sizeof(*work));
+    if(mpi_rank == 0)
+    {
+        int iseed[4] = {0, 0, 0, 1};
+        LAPACKE_dlarnv_work(3, iseed, N*nrhs, b);
+        cblas_dscal(N*nrhs, 0.0, x, 1);
+        cblas_dscal(N*nrhs, 0.0, x2, 1);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime();
+    int iter = starsh_itersolvers__dgmres_mpi(M, nrhs, b, N, x, N, restart,
+            tol, work);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    if(mpi_rank == 0)
+        printf("GMRES(%d) ITERATIONS: %d\nTIME TO SOLVE: %e secs\n",
+                restart, iter, time1);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime();
+    int iter2 = starsh_itersolvers__dbicgstab_mpi(M, nrhs, b, N, x2, N, tol,
+            work);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    if(mpi_rank == 0)
+        printf("BICGSTAB ITERATIONS: %d\nTIME TO SOLVE: %e secs\n", iter2,
+                time1);
+    // Measure residuals on root node
+    double res[2] = {0, 0};
+    double *r = malloc(N*nrhs*sizeof(*r));
+    double norm_b = cblas_dnrm2(N*nrhs, b, 1);
+    starsh_blrm__dmml_mpi(M, nrhs, 1.0, x, N, 0.0, r, N);
+    if(mpi_rank == 0)
+    {
+        cblas_daxpy(N*nrhs, -1.0, b, 1, r, 1);
+        res[0] = cblas_dnrm2(N*nrhs, r, 1)/norm_b;
+    }
+    starsh_blrm__dmml_mpi(M, nrhs, 1.0, x2, N, 0.0, r, N);
+    if(mpi_rank == 0)
+    {
+        cblas_daxpy(N*nrhs, -1.0, b, 1, r, 1);
+        res[1] = cblas_dnrm2(N*nrhs, r, 1)/norm_b;
+        printf("GMRES RELATIVE RESIDUAL: %e\nBICGSTAB RELATIVE RESIDUAL: "
+                "%e\n", res[0], res[1]);
+    }
+    MPI_Bcast(res, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    free(b);
+    free(x);
+    free(x2);
+    free(r);
+    free(work);
+    MPI_Finalize();
+    if(iter < 0 || iter2 < 0 || res[0]/tol > 10. || res[1]/tol > 10.)
+    {
+        if(mpi_rank == 0)
+            printf("Residual of solution is too big\n");
+        return 1;
+    }
+    return 0;
+}
@@ -169,7 +169,37 @@ int main(int argc, char **argv)
         printf("MATVEC DIFF: %e\n", cblas_dnrm2(N, y_tlr, 1)
                 /cblas_dnrm2(N, y, 1));
     }
+    // Measure time for 10 matvecs with distributed vectors
+    STARSH_int n_local;
+    starsh_blrf_get_vector_size_mpi(F, 'R', &n_local);
+    double *x_local = malloc(n_local*nrhs*sizeof(*x_local)+1);
+    double *y_local = malloc(n_local*nrhs*sizeof(*y_local)+1);
+    starsh_blrf_scatter_vector_mpi(F, 'C', nrhs, x, N, x_local, n_local);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime();
+    for(int i = 0; i < 10; i++)
+        starsh_blrm__dmml_mpi_dist(M, nrhs, 1.0, x_local, n_local, 0.0,
+                y_local, n_local);
+    MPI_Barrier(MPI_COMM_WORLD);
+    time1 = MPI_Wtime()-time1;
+    starsh_blrf_gather_vector_mpi(F, 'R', nrhs, y_local, n_local, y_tlr, N);
+    double dist_diff = 0;
+    if(mpi_rank == 0)
+    {
+        cblas_daxpy(N, -1.0, y, 1, y_tlr, 1);
+        dist_diff = cblas_dnrm2(N, y_tlr, 1)/cblas_dnrm2(N, y, 1);
+        printf("TIME FOR 10 DISTRIBUTED MATVECS: %e secs\n", time1);
+        printf("DISTRIBUTED MATVEC DIFF: %e\n", dist_diff);
+    }
+    MPI_Bcast(&dist_diff, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    free(x_local);
+    free(y_local);
+    free(x);
+    free(y);
+    free(y_tlr);
     MPI_Finalize();
+    if(dist_diff > 1e-12)
+        return 1;
     return 0;
 }
 
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <mpi.h>
 #include <starpu.h>
+#include <starpu_mpi.h>
 #include <starsh.h>
 #include <starsh-electrodynamics.h>
 
@@ -113,6 +114,7 @@ int main(int argc, char **argv)
         starsh_blrf_info(F);
     // Init StarPU
     (void)starpu_init(NULL);
+    (void)starpu_mpi_init(NULL, NULL, 0);
     // Approximate each admissible block
     MPI_Barrier(MPI_COMM_WORLD);
     double time1 = MPI_Wtime();
@@ -153,7 +155,6 @@ int main(int argc, char **argv)
         return 1;
     }
     // Measure time for 10 BLRM matvecs and for 10 BLRM TLR matvecs
-    /* Not performed due to no matvec yet with STARPU
     double *x, *y, *y_tlr;
     int nrhs = 1;
     x = malloc(N*nrhs*sizeof(*x));
@@ -169,7 +170,7 @@ int main(int argc, char **argv)
     MPI_Barrier(MPI_COMM_WORLD);
     time1 = MPI_Wtime();
     for(int i = 0; i < 10; i++)
-        starsh_blrm__dmml_mpi(M, nrhs, 1.0, x, N, 0.0, y, N);
+        starsh_blrm__dmml_mpi_starpu(M, nrhs, 1.0, x, N, 0.0, y, N);
     MPI_Barrier(MPI_COMM_WORLD);
     time1 = MPI_Wtime()-time1;
     if(mpi_rank == 0)
@@ -179,17 +180,39 @@ int main(int argc, char **argv)
     MPI_Barrier(MPI_COMM_WORLD);
     time1 = MPI_Wtime();
     for(int i = 0; i < 10; i++)
-        starsh_blrm__dmml_mpi_tlr(M, nrhs, 1.0, x, N, 0.0, y_tlr, N);
+        starsh_blrm__dmml_mpi_starpu_tlr(M, nrhs, 1.0, x, N, 0.0, y_tlr, N);
     MPI_Barrier(MPI_COMM_WORLD);
     time1 = MPI_Wtime()-time1;
+    // Compare with MPI matvec
+    double norm = 0., diff = 0., diff_tlr = 0.;
+    if(mpi_rank == 0)
+        norm = cblas_dnrm2(N, y, 1);
+    starsh_blrm__dmml_mpi(M, nrhs, 1.0, x, N, -1.0, y, N);
+    starsh_blrm__dmml_mpi(M, nrhs, 1.0, x, N, -1.0, y_tlr, N);
+    if(mpi_rank == 0)
+    {
+        diff = cblas_dnrm2(N, y, 1)/norm;
+        diff_tlr = cblas_dnrm2(N, y_tlr, 1)/norm;
+    }
+    MPI_Bcast(&diff, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&diff_tlr, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     if(mpi_rank == 0)
     {
-        cblas_daxpy(N, -1.0, y, 1, y_tlr, 1);
         printf("TIME FOR 10 TLR MATVECS: %e secs\n", time1);
-        printf("MATVEC DIFF: %e\n", cblas_dnrm2(N, y_tlr, 1)
-                /cblas_dnrm2(N, y, 1));
+        printf("MATVEC DIFF (MPI_STARPU vs MPI): %e\n", diff);
+        printf("MATVEC DIFF (MPI_STARPU_TLR vs MPI): %e\n", diff_tlr);
+        if(diff > 1e-12 || diff_tlr > 1e-12)
+            printf("Resulting matvec is wrong\n");
+    }
+    if(diff > 1e-12 || diff_tlr > 1e-12)
+    {
+        MPI_Finalize();
+        return 1;
     }
-    */
+    free(x);
+    free(y);
+    free(y_tlr);
+    starpu_mpi_shutdown();
     starpu_shutdown();
     MPI_Finalize();
     return 0;
@@ -25,11 +25,11 @@
 
 int main(int argc, char **argv)
 {
-    if(argc != 10)
+    if(argc != 10 && argc != 11)
     {
-        printf("%d arguments provided, but 9 are needed\n", argc-1);
+        printf("%d arguments provided, but 9 or 10 are needed\n", argc-1);
         printf("spatial ndim placement kernel beta nu N block_size maxrank"
-                " tol\n");
+                " tol [maxerr]\n");
         return 1;
     }
     int problem_ndim = atoi(argv[1]);
@@ -43,6 +43,8 @@ int main(int argc, char **argv)
     int block_size = atoi(argv[7]);
     int maxrank = atoi(argv[8]);
     double tol = atof(argv[9]);
+    // Relative error must not exceed maxerr*tol
+    double maxerr = argc == 11 ? atof(argv[10]) : 10.;
     double noise = 0;
     int onfly = 0;
     char symm = 'N', dtype = 'd';
@@ -102,7 +104,7 @@ int main(int argc, char **argv)
     time1 = omp_get_wtime()-time1;
     printf("TIME TO MEASURE ERROR: %e secs\nRELATIVE ERROR: %e\n",
             time1, rel_err);
-    if(rel_err/tol > 10.)
+    if(rel_err/tol > maxerr)
     {
         printf("Resulting relative error is too big\n");
         return 1;
@@ -99,7 +99,6 @@ int main(int argc, char **argv)
         return 1;
     }
     // Measure time for 10 matvecs
-    /* Not performed due to no matvec yet with STARPU
     double *x, *y;
     int nrhs = 1;
     x = malloc(N*nrhs*sizeof(*x));
@@ -109,10 +108,21 @@ int main(int argc, char **argv)
     cblas_dscal(N*nrhs, 0.0, y, 1);
     time1 = omp_get_wtime();
     for(int i = 0; i < 10; i++)
-        starsh_blrm__dmml(M, nrhs, 1.0, x, N, 0.0, y, N);
+        starsh_blrm__dmml_starpu(M, nrhs, 1.0, x, N, 0.0, y, N);
     time1 = omp_get_wtime()-time1;
     printf("TIME FOR 10 BLRM MATVECS: %e secs\n", time1);
-    */
+    // Compare with sequential matvec
+    double norm = cblas_dnrm2(N*nrhs, y, 1);
+    starsh_blrm__dmml(M, nrhs, 1.0, x, N, -1.0, y, N);
+    double diff = cblas_dnrm2(N*nrhs, y, 1);
+    printf("MATVEC DIFF (STARPU vs SEQUENTIAL): %e\n", diff/norm);
+    if(diff/norm > 1e-12)
+    {
+        printf("Resulting matvec is wrong\n");
+        return 1;
+    }
+    free(x);
+    free(y);
     // Deinit StarPU
     starpu_shutdown();
     return 0;